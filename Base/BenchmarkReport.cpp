@@ -0,0 +1,172 @@
+/*
+ * BenchmarkReport.cpp
+ *
+ *  Created on: Feb 27, 2012
+ *      Author: TF
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <limits>
+
+#include "BenchmarkReport.h"
+
+BenchmarkStatistics computeBenchmarkStatistics(std::vector<double> const& samples)
+{
+	BenchmarkStatistics stats;
+	stats.n_samples = samples.size();
+	stats.min = stats.max = stats.median = stats.mean = stats.stddev = 0.0;
+	if (samples.empty())
+		return stats;
+
+	std::vector<double> sorted(samples);
+	std::sort(sorted.begin(), sorted.end());
+	const std::size_t n(sorted.size());
+	stats.min = sorted[0];
+	stats.max = sorted[n-1];
+	stats.median = (n % 2 == 1) ? sorted[n/2] : 0.5 * (sorted[n/2-1] + sorted[n/2]);
+
+	for (std::size_t k(0); k < n; k++)
+		stats.mean += sorted[k];
+	stats.mean /= n;
+	if (n > 1) {
+		for (std::size_t k(0); k < n; k++)
+			stats.stddev += (sorted[k] - stats.mean) * (sorted[k] - stats.mean);
+		stats.stddev = sqrt(stats.stddev / (n - 1));
+	}
+	return stats;
+}
+
+void BenchmarkReport::beginRecord()
+{
+	_records.push_back(Record());
+}
+
+void BenchmarkReport::addField(std::string const& key, std::string const& value, bool numeric)
+{
+	if (_records.empty())
+		beginRecord();
+	Field f;
+	f.key = key;
+	f.value = value;
+	f.numeric = numeric;
+	_records.back().push_back(f);
+}
+
+void BenchmarkReport::add(std::string const& key, std::string const& value)
+{
+	addField(key, value, false);
+}
+
+void BenchmarkReport::add(std::string const& key, double value)
+{
+	std::ostringstream os;
+	os.precision(std::numeric_limits<double>::digits10);
+	// JSON does not know inf and nan
+	if (value != value || fabs(value) > std::numeric_limits<double>::max())
+		os << "null";
+	else
+		os << value;
+	addField(key, os.str(), true);
+}
+
+void BenchmarkReport::add(std::string const& prefix, BenchmarkStatistics const& stats)
+{
+	add(prefix + "_min", stats.min);
+	add(prefix + "_median", stats.median);
+	add(prefix + "_mean", stats.mean);
+	add(prefix + "_max", stats.max);
+	add(prefix + "_stddev", stats.stddev);
+}
+
+void BenchmarkReport::setMetaData(std::string const& key, std::string const& value)
+{
+	for (std::size_t k(0); k < _meta.size(); k++) {
+		if (_meta[k].first == key) {
+			_meta[k].second = value;
+			return;
+		}
+	}
+	_meta.push_back(std::make_pair(key, value));
+}
+
+/** quotes the string and escapes the special characters */
+static std::string quoteJSON(std::string const& s)
+{
+	std::string q("\"");
+	for (std::size_t k(0); k < s.size(); k++) {
+		const char c(s[k]);
+		if (c == '"' || c == '\\') {
+			q += '\\';
+			q += c;
+		} else if (c == '\n') q += "\\n";
+		else if (c == '\t') q += "\\t";
+		else q += c;
+	}
+	return q + "\"";
+}
+
+/** quotes the string if it contains a separator or a quote */
+static std::string quoteCSV(std::string const& s)
+{
+	if (s.find_first_of(",\"\n") == std::string::npos)
+		return s;
+	std::string q("\"");
+	for (std::size_t k(0); k < s.size(); k++) {
+		if (s[k] == '"')
+			q += '"';
+		q += s[k];
+	}
+	return q + "\"";
+}
+
+void BenchmarkReport::writeJSON(std::ostream &os) const
+{
+	os << "{" << std::endl << "  \"meta\": {";
+	for (std::size_t k(0); k < _meta.size(); k++) {
+		os << (k == 0 ? "" : ",") << std::endl << "    " << quoteJSON(_meta[k].first)
+			<< ": " << quoteJSON(_meta[k].second);
+	}
+	os << std::endl << "  }," << std::endl << "  \"results\": [";
+	for (std::size_t r(0); r < _records.size(); r++) {
+		os << (r == 0 ? "" : ",") << std::endl << "    {";
+		Record const& rec(_records[r]);
+		for (std::size_t k(0); k < rec.size(); k++) {
+			os << (k == 0 ? "" : ", ") << quoteJSON(rec[k].key) << ": "
+				<< (rec[k].numeric ? rec[k].value : quoteJSON(rec[k].value));
+		}
+		os << "}";
+	}
+	os << std::endl << "  ]" << std::endl << "}" << std::endl;
+}
+
+void BenchmarkReport::writeCSV(std::ostream &os) const
+{
+	std::vector<std::string> keys;
+	for (std::size_t r(0); r < _records.size(); r++) {
+		for (std::size_t k(0); k < _records[r].size(); k++) {
+			if (std::find(keys.begin(), keys.end(), _records[r][k].key) == keys.end())
+				keys.push_back(_records[r][k].key);
+		}
+	}
+
+	for (std::size_t j(0); j < keys.size(); j++)
+		os << (j == 0 ? "" : ",") << quoteCSV(keys[j]);
+	os << std::endl;
+
+	for (std::size_t r(0); r < _records.size(); r++) {
+		Record const& rec(_records[r]);
+		for (std::size_t j(0); j < keys.size(); j++) {
+			if (j > 0)
+				os << ",";
+			for (std::size_t k(0); k < rec.size(); k++) {
+				if (rec[k].key == keys[j]) {
+					os << (rec[k].value == "null" && rec[k].numeric ? "" : quoteCSV(rec[k].value));
+					break;
+				}
+			}
+		}
+		os << std::endl;
+	}
+}
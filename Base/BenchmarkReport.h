@@ -0,0 +1,84 @@
+/*
+ * BenchmarkReport.h
+ *
+ *  Created on: Feb 27, 2012
+ *      Author: TF
+ */
+
+#ifndef BENCHMARKREPORT_H_
+#define BENCHMARKREPORT_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+
+/**
+ * statistics of the run times of the repetitions of a benchmark
+ */
+struct BenchmarkStatistics
+{
+	std::size_t n_samples;
+	double min;
+	double max;
+	double median;
+	double mean;
+	double stddev; //!< sample standard deviation (0 for a single sample)
+};
+
+/**
+ * computes minimum, maximum, median, mean and the standard deviation
+ * of the samples
+ */
+BenchmarkStatistics computeBenchmarkStatistics(std::vector<double> const& samples);
+
+/**
+ * Collects the results of benchmarks as records of (key, value) pairs and
+ * writes them in a machine readable format. The keys of the records do not
+ * have to coincide, the CSV output contains a column for every key that
+ * appears in any record (in the order of the first appearance), missing
+ * values are left empty.
+ */
+class BenchmarkReport
+{
+public:
+	/** starts a new record, the following calls of add() refer to it */
+	void beginRecord();
+
+	void add(std::string const& key, std::string const& value);
+	void add(std::string const& key, double value);
+
+	/** adds the fields prefix_min, prefix_median, ... */
+	void add(std::string const& prefix, BenchmarkStatistics const& stats);
+
+	/** sets a field that is written once for the whole report (JSON only) */
+	void setMetaData(std::string const& key, std::string const& value);
+
+	std::size_t getNumberOfRecords() const { return _records.size(); }
+
+	/**
+	 * writes {"meta": {...}, "results": [{...}, ...]}
+	 */
+	void writeJSON(std::ostream &os) const;
+
+	/**
+	 * writes a header line with the keys and a line per record
+	 */
+	void writeCSV(std::ostream &os) const;
+
+private:
+	struct Field {
+		std::string key;
+		std::string value;
+		bool numeric;
+	};
+	typedef std::vector<Field> Record;
+
+	void addField(std::string const& key, std::string const& value, bool numeric);
+
+	std::vector<std::pair<std::string, std::string> > _meta;
+	std::vector<Record> _records;
+};
+
+#endif /* BENCHMARKREPORT_H_ */
@@ -0,0 +1,79 @@
+/*
+ * MemoryMappedFile.cpp
+ *
+ *  Created on: Jan 30, 2012
+ *      Author: TF
+ */
+
+#include "MemoryMappedFile.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+namespace BaseLib {
+
+#ifndef _WIN32
+MemoryMappedFile::MemoryMappedFile(std::string const& fname) :
+	_data(NULL), _size(0)
+{
+	const int fd(open(fname.c_str(), O_RDONLY));
+	if (fd == -1)
+		return;
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+		void* addr(mmap(NULL, file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0));
+		if (addr != MAP_FAILED) {
+			_data = static_cast<char*>(addr);
+			_size = file_stat.st_size;
+			// the arrays are read sequentially by the first matrix vector multiplication
+			madvise(addr, _size, MADV_WILLNEED);
+		}
+	}
+	// the mapping remains valid after closing the file descriptor
+	close(fd);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	if (_data != NULL)
+		munmap(_data, _size);
+}
+#else
+MemoryMappedFile::MemoryMappedFile(std::string const& fname) :
+	_data(NULL), _size(0), _file_handle(INVALID_HANDLE_VALUE), _mapping_handle(NULL)
+{
+	_file_handle = CreateFileA(fname.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+					OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (_file_handle == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER file_size;
+	if (GetFileSizeEx(_file_handle, &file_size) && file_size.QuadPart > 0) {
+		_mapping_handle = CreateFileMappingA(_file_handle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		if (_mapping_handle != NULL) {
+			_data = static_cast<char*>(MapViewOfFile(_mapping_handle, FILE_MAP_COPY, 0, 0, 0));
+			if (_data != NULL)
+				_size = static_cast<std::size_t>(file_size.QuadPart);
+		}
+	}
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	if (_data != NULL)
+		UnmapViewOfFile(_data);
+	if (_mapping_handle != NULL)
+		CloseHandle(_mapping_handle);
+	if (_file_handle != INVALID_HANDLE_VALUE)
+		CloseHandle(_file_handle);
+}
+#endif
+
+} // end namespace BaseLib
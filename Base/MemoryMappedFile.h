@@ -0,0 +1,60 @@
+/*
+ * MemoryMappedFile.h
+ *
+ *  Created on: Jan 30, 2012
+ *      Author: TF
+ */
+
+#ifndef MEMORYMAPPEDFILE_H_
+#define MEMORYMAPPEDFILE_H_
+
+#include <string>
+#include <cstddef>
+
+namespace BaseLib {
+
+/**
+ * Class MemoryMappedFile maps a file into the address space of the process.
+ * The mapping is private (copy on write), i.e. the content of the mapped
+ * memory can be changed without changing the file. The pages are loaded
+ * on demand by the operating system, there is no copy through a stream buffer.
+ */
+class MemoryMappedFile
+{
+public:
+	/**
+	 * maps the file, if it is not possible to map the file isValid() returns false
+	 * @param fname the name of the file
+	 */
+	explicit MemoryMappedFile(std::string const& fname);
+	~MemoryMappedFile();
+
+	bool isValid() const { return _data != NULL; }
+	char* getData() const { return _data; }
+	std::size_t getSize() const { return _size; }
+
+	/**
+	 * checks if the address belongs to the mapped memory
+	 */
+	bool contains(void const* ptr) const
+	{
+		char const* p(static_cast<char const*>(ptr));
+		return _data != NULL && _data <= p && p < _data + _size;
+	}
+
+private:
+	// noncopyable
+	MemoryMappedFile(MemoryMappedFile const&);
+	MemoryMappedFile& operator= (MemoryMappedFile const&);
+
+	char* _data;
+	std::size_t _size;
+#ifdef _WIN32
+	void* _file_handle;
+	void* _mapping_handle;
+#endif
+};
+
+} // end namespace BaseLib
+
+#endif /* MEMORYMAPPEDFILE_H_ */
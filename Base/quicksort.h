@@ -14,16 +14,6 @@
 // Base
 #include "swap.h"
 
-template <class T>
-void quickSort(T* array, unsigned beg, unsigned end)
-{
-  if (beg < end) {
-    unsigned p = partition_(array, beg, end);
-    quickSort(array, beg, p);
-    quickSort(array, p+1, end);
-  }
-}
-
 template <class T>
 unsigned partition_(T* array, unsigned beg, unsigned end)
 {
@@ -43,6 +33,16 @@ unsigned partition_(T* array, unsigned beg, unsigned end)
   return j;
 }
 
+template <class T>
+void quickSort(T* array, unsigned beg, unsigned end)
+{
+  if (beg < end) {
+    unsigned p = partition_(array, beg, end);
+    quickSort(array, beg, p);
+    quickSort(array, p+1, end);
+  }
+}
+
 /**
  * Permutes the entries of a part of an array such that all entries that are smaller
  * than a certain value are at the beginning of the array and all entries that are
@@ -0,0 +1,96 @@
+/*
+ * radixSort.h
+ *
+ *  Created on: Feb 8, 2012
+ *      Author: TF
+ */
+
+#ifndef RADIXSORT_H_
+#define RADIXSORT_H_
+
+// STL
+#include <cstddef>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace BaseLib {
+
+/**
+ * Stable LSD radix sort of records by their member key, an unsigned integer
+ * type. The keys are processed in digits of at most 11 bits. Each pass is parallelized
+ * with OpenMP: the array is split into one chunk per thread, every thread
+ * counts the digits of its chunk and scatters its chunk to the positions given
+ * by the prefix sums over (digit, chunk). Passes where all keys have the same
+ * digit are skipped.
+ * @param data the records (input), the array is used as buffer
+ * @param tmp buffer of length n
+ * @param n number of records
+ * @param key_bits number of significant bits of the keys, i.e. all keys are
+ * smaller than 2^key_bits
+ * @return pointer to the sorted records, either data or tmp
+ */
+template <typename T>
+T* radixSort(T* data, T* tmp, std::size_t n, unsigned key_bits)
+{
+	// digits of (nearly) equal size with at most 11 bits, i.e. the histograms
+	// of the threads fit into the cache
+	const unsigned n_passes((key_bits + 10) / 11);
+	const unsigned digit_bits(n_passes == 0 ? 1 : (key_bits + n_passes - 1) / n_passes);
+	const unsigned n_buckets(1 << digit_bits);
+#ifdef _OPENMP
+	const unsigned n_chunks(omp_get_max_threads());
+#else
+	const unsigned n_chunks(1);
+#endif
+	std::size_t *hist(new std::size_t[n_chunks * n_buckets]);
+
+	T *src(data), *dst(tmp);
+	for (unsigned shift(0); shift < key_bits; shift += digit_bits) {
+		OPENMP_LOOP_TYPE c;
+		#pragma omp parallel for
+		for (c = 0; c < n_chunks; c++) {
+			std::size_t *h(hist + c * n_buckets);
+			for (unsigned b(0); b < n_buckets; b++)
+				h[b] = 0;
+			const std::size_t end(n * (c + 1) / n_chunks);
+			for (std::size_t k(n * c / n_chunks); k < end; k++)
+				h[(src[k].key >> shift) & (n_buckets - 1)]++;
+		}
+
+		// exclusive prefix sum, the buckets are ordered by digit and then by chunk
+		std::size_t sum(0);
+		bool skip(false);
+		for (unsigned b(0); b < n_buckets && !skip; b++) {
+			std::size_t bucket_size(0);
+			for (unsigned c(0); c < n_chunks; c++) {
+				const std::size_t cnt(hist[c * n_buckets + b]);
+				hist[c * n_buckets + b] = sum;
+				sum += cnt;
+				bucket_size += cnt;
+			}
+			skip = bucket_size == n;
+		}
+		if (skip)
+			continue;
+
+		#pragma omp parallel for
+		for (c = 0; c < n_chunks; c++) {
+			std::size_t *h(hist + c * n_buckets);
+			const std::size_t end(n * (c + 1) / n_chunks);
+			for (std::size_t k(n * c / n_chunks); k < end; k++)
+				dst[h[(src[k].key >> shift) & (n_buckets - 1)]++] = src[k];
+		}
+		T *swap_tmp(src);
+		src = dst;
+		dst = swap_tmp;
+	}
+
+	delete [] hist;
+	return src;
+}
+
+} // end namespace BaseLib
+
+#endif /* RADIXSORT_H_ */
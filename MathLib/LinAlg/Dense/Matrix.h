@@ -15,6 +15,8 @@
 #include <stdexcept>
 #include <iostream>
 
+#include "denseKernels.h"
+
 namespace MathLib {
 
 /**
@@ -32,10 +34,31 @@ public:
    size_t getNRows () const { return nrows; }
    size_t getNCols () const { return ncols; }
    /**
-    * \f$ y = \alpha \cdot A x + \beta y\f$
+    * \f$ y = \alpha \cdot A x + \beta y\f$ (see gemvBlocked())
     */
    void axpy ( T alpha, const T* x, T beta, T* y) const;
 
+   /**
+    * \f$ C = \alpha \cdot A B + \beta C\f$ (see gemmBlocked())
+    * @param mat the matrix \f$ B \f$
+    * @param result the matrix \f$ C \f$, the dimensions have to fit
+    */
+   void axpy ( T alpha, const Matrix<T>& mat, T beta, Matrix<T>& result) const throw (std::range_error);
+
+   /**
+    * Matrix vector multiplication \f$ y = A x \f$ into the given storage
+    * @param x vector of length getNCols()
+    * @param y vector of length getNRows(), at the end the result
+    */
+   void mult (const T* x, T* y) const;
+
+   /**
+    * Matrix matrix multiplication \f$ C = A B \f$ into the given matrix
+    * @param mat the matrix \f$ B \f$
+    * @param result the matrix \f$ C \f$, the dimensions have to fit
+    */
+   void mult (const Matrix<T>& mat, Matrix<T>& result) const throw (std::range_error);
+
    /**
     * Matrix vector multiplication
     * @param x
@@ -87,7 +110,11 @@ public:
     */
    void write (std::ostream& out) const;
 
-   T const* getData () { return data; }
+   /**
+    * @return the entries of the matrix in C storage layout (row by row)
+    */
+   T* getData () { return data; }
+   T const* getData () const { return data; }
 
 private:
    // zero based addressing, but Fortran storage layout
@@ -104,6 +131,13 @@ template<class T> Matrix<T>::Matrix (size_t rows, size_t cols)
       : nrows (rows), ncols (cols), data (new T[nrows*ncols])
 {}
 
+template<class T> Matrix<T>::Matrix (size_t rows, size_t cols, const T& val)
+      : nrows (rows), ncols (cols), data (new T[nrows*ncols])
+{
+   for (size_t k = 0; k < nrows*ncols; k++)
+      data[k] = val;
+}
+
 template<class T> Matrix<T>::Matrix (const Matrix& src) :
 	nrows (src.getNRows ()), ncols (src.getNCols ()), data (new T[nrows * ncols])
 {
@@ -119,24 +153,34 @@ template <class T> Matrix<T>::~Matrix ()
 
 template<class T> void Matrix<T>::axpy ( T alpha, const T* x, T beta, T* y) const
 {
-   for (size_t i(0); i<nrows; i++) {
-      y[i] += beta * y[i];
-      for (size_t j(0); j<ncols; j++) {
-         y[i] += alpha * data[address(i,j)] * x[j];
-      }
-   }
+   gemvBlocked (nrows, ncols, alpha, data, ncols, x, beta, y);
+}
+
+template<class T> void Matrix<T>::axpy ( T alpha, const Matrix<T>& mat, T beta, Matrix<T>& result) const
+	throw (std::range_error)
+{
+	if (ncols != mat.getNRows() || nrows != result.getNRows() || mat.getNCols() != result.getNCols())
+		throw std::range_error("Matrix::axpy, illegal matrix size!");
+
+	gemmBlocked (nrows, mat.getNCols(), ncols, alpha, data, ncols,
+			mat.getData(), mat.getNCols(), beta, result.getData(), result.getNCols());
+}
+
+template<class T> void Matrix<T>::mult (const T* x, T* y) const
+{
+   gemvBlocked (nrows, ncols, T(1), data, ncols, x, T(0), y);
+}
+
+template<class T> void Matrix<T>::mult (const Matrix<T>& mat, Matrix<T>& result) const
+	throw (std::range_error)
+{
+	axpy (T(1), mat, T(0), result);
 }
 
 template<class T> T* Matrix<T>::operator* (const T *x) const
 {
 	T *y (new T[nrows]);
-	for (size_t i(0); i < nrows; i++) {
-		y[i] = 0.0;
-		for (size_t j(0); j < ncols; j++) {
-			y[i] += data[address(i, j)] * x[j];
-		}
-	}
-
+	mult (x, y);
 	return y;
 }
 
@@ -182,15 +226,8 @@ template<class T> Matrix<T>* Matrix<T>::operator* (const Matrix<T>& mat) const t
 		throw std::range_error(
 				"Matrix::operator*, number of rows and cols should be the same!");
 
-	size_t y_cols(mat.getNCols());
-	Matrix<T>* y(new Matrix<T> (nrows, y_cols, T(0)));
-
-	for (size_t i = 0; i < nrows; i++) {
-		for (size_t j = 0; j < y_cols; j++) {
-			for (size_t k = 0; k < ncols; k++)
-				(*y)(i, j) += data[address(i, k)] * mat(k, j);
-		}
-	}
+	Matrix<T>* y(new Matrix<T> (nrows, mat.getNCols()));
+	mult (mat, *y);
 
 	return y;
 }
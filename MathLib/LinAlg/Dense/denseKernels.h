@@ -0,0 +1,223 @@
+/*
+ * denseKernels.h
+ *
+ *  Created on: Feb 20, 2012
+ *      Author: TF
+ */
+
+#ifndef DENSEKERNELS_H_
+#define DENSEKERNELS_H_
+
+#include <cstddef>
+#include <algorithm>
+
+namespace MathLib {
+
+/** number of rows of the register block of gemmBlocked() */
+const std::size_t GEMM_MR = 4;
+/** number of columns of the register block of gemmBlocked() */
+const std::size_t GEMM_NR = 8;
+/** number of rows of the packed block of A (stays in the L2 cache) */
+const std::size_t GEMM_MC = 128;
+/** inner dimension of the packed blocks of A and B */
+const std::size_t GEMM_KC = 256;
+/** number of columns of the packed block of B (stays in the L3 cache) */
+const std::size_t GEMM_NC = 2048;
+
+/**
+ * copies the mc x kc block of the row major matrix A into a_pack, the rows
+ * are grouped to micro panels of GEMM_MR rows, within a micro panel the
+ * entries are stored column by column, the last panel is padded with zeros
+ */
+template <typename T>
+void packGEMMBlockA (std::size_t mc, std::size_t kc, T const*const A, std::size_t lda, T* a_pack)
+{
+	for (std::size_t i0(0); i0 < mc; i0 += GEMM_MR) {
+		const std::size_t mr (std::min(GEMM_MR, mc - i0));
+		for (std::size_t k(0); k < kc; k++) {
+			for (std::size_t i(0); i < mr; i++)
+				a_pack[i] = A[(i0 + i) * lda + k];
+			for (std::size_t i(mr); i < GEMM_MR; i++)
+				a_pack[i] = T(0);
+			a_pack += GEMM_MR;
+		}
+	}
+}
+
+/**
+ * copies the kc x nc block of the row major matrix B into b_pack, the
+ * columns are grouped to micro panels of GEMM_NR columns, within a micro
+ * panel the entries are stored row by row, the last panel is padded with zeros
+ */
+template <typename T>
+void packGEMMBlockB (std::size_t kc, std::size_t nc, T const*const B, std::size_t ldb, T* b_pack)
+{
+	for (std::size_t j0(0); j0 < nc; j0 += GEMM_NR) {
+		const std::size_t nr (std::min(GEMM_NR, nc - j0));
+		for (std::size_t k(0); k < kc; k++) {
+			T const*const b_k (B + k * ldb + j0);
+			for (std::size_t j(0); j < nr; j++)
+				b_pack[j] = b_k[j];
+			for (std::size_t j(nr); j < GEMM_NR; j++)
+				b_pack[j] = T(0);
+			b_pack += GEMM_NR;
+		}
+	}
+}
+
+/**
+ * register blocked kernel: \f$C = C + \alpha a b\f$ for a GEMM_MR x kc
+ * micro panel a and a kc x GEMM_NR micro panel b, only the upper left
+ * mr x nr block of C is written. The accumulators are kept in registers, the
+ * innermost loop is vectorized by the compiler.
+ */
+template <typename T>
+void gemmMicroKernel (std::size_t kc, T alpha, T const* __restrict__ a, T const* __restrict__ b,
+				T* __restrict__ C, std::size_t ldc, std::size_t mr, std::size_t nr)
+{
+	T acc[GEMM_MR][GEMM_NR];
+	for (std::size_t i(0); i < GEMM_MR; i++)
+		for (std::size_t j(0); j < GEMM_NR; j++)
+			acc[i][j] = T(0);
+
+	for (std::size_t k(0); k < kc; k++) {
+		for (std::size_t i(0); i < GEMM_MR; i++) {
+			const T a_ik (a[i]);
+			for (std::size_t j(0); j < GEMM_NR; j++)
+				acc[i][j] += a_ik * b[j];
+		}
+		a += GEMM_MR;
+		b += GEMM_NR;
+	}
+
+	for (std::size_t i(0); i < mr; i++) {
+		T* c_i (C + i * ldc);
+		for (std::size_t j(0); j < nr; j++)
+			c_i[j] += alpha * acc[i][j];
+	}
+}
+
+/**
+ * Matrix matrix multiplication \f$C = \alpha A B + \beta C\f$ for row major
+ * matrices. The loops are blocked for the cache hierarchy: a GEMM_KC x GEMM_NC
+ * block of B and a GEMM_MC x GEMM_KC block of A are packed into contiguous
+ * buffers and multiplied by gemmMicroKernel(). The blocks of rows of A are
+ * distributed to the OpenMP threads, every thread packs its own blocks of A.
+ * @param m number of rows of A and C
+ * @param n number of columns of B and C
+ * @param k number of columns of A and rows of B
+ * @param lda, ldb, ldc the leading dimensions (row strides) of A, B and C
+ */
+template <typename T>
+void gemmBlocked (std::size_t m, std::size_t n, std::size_t k, T alpha,
+				T const*const A, std::size_t lda, T const*const B, std::size_t ldb,
+				T beta, T* C, std::size_t ldc)
+{
+	// C = beta * C, C is not read if beta is zero
+	for (std::size_t i(0); i < m; i++) {
+		T* c_i (C + i * ldc);
+		if (beta == T(0)) {
+			for (std::size_t j(0); j < n; j++)
+				c_i[j] = T(0);
+		} else if (beta != T(1)) {
+			for (std::size_t j(0); j < n; j++)
+				c_i[j] *= beta;
+		}
+	}
+	if (m == 0 || n == 0 || k == 0 || alpha == T(0))
+		return;
+
+	const std::size_t n_row_blocks ((m + GEMM_MC - 1) / GEMM_MC);
+	// sizes of the packed blocks, the micro panels are padded
+	const std::size_t a_pack_size (((GEMM_MC + GEMM_MR - 1) / GEMM_MR) * GEMM_MR * GEMM_KC);
+	T* b_pack (new T[GEMM_KC * ((std::min(n, GEMM_NC) + GEMM_NR - 1) / GEMM_NR) * GEMM_NR]);
+
+	for (std::size_t jc(0); jc < n; jc += GEMM_NC) {
+		const std::size_t nc (std::min(GEMM_NC, n - jc));
+		for (std::size_t pc(0); pc < k; pc += GEMM_KC) {
+			const std::size_t kc (std::min(GEMM_KC, k - pc));
+			packGEMMBlockB (kc, nc, B + pc * ldb + jc, ldb, b_pack);
+
+#pragma omp parallel
+			{
+				T* a_pack (new T[a_pack_size]);
+				OPENMP_LOOP_TYPE ib;
+#pragma omp for schedule(dynamic)
+				for (ib = 0; ib < n_row_blocks; ib++) {
+					const std::size_t ic (ib * GEMM_MC);
+					const std::size_t mc (std::min(GEMM_MC, m - ic));
+					packGEMMBlockA (mc, kc, A + ic * lda + pc, lda, a_pack);
+					for (std::size_t jr(0); jr < nc; jr += GEMM_NR) {
+						const std::size_t nr (std::min(GEMM_NR, nc - jr));
+						T const*const b_panel (b_pack + jr * kc);
+						for (std::size_t ir(0); ir < mc; ir += GEMM_MR) {
+							gemmMicroKernel (kc, alpha, a_pack + ir * kc, b_panel,
+											C + (ic + ir) * ldc + jc + jr, ldc,
+											std::min(GEMM_MR, mc - ir), nr);
+						}
+					}
+				}
+				delete [] a_pack;
+			}
+		}
+	}
+	delete [] b_pack;
+}
+
+/**
+ * Matrix vector multiplication \f$y = \alpha A x + \beta y\f$ for a row
+ * major matrix A. Four rows are processed at once, such that every loaded
+ * entry of x is used four times. The blocks of rows are distributed to the
+ * OpenMP threads.
+ * @param m number of rows of A
+ * @param n number of columns of A
+ * @param lda leading dimension (row stride) of A
+ */
+template <typename T>
+void gemvBlocked (std::size_t m, std::size_t n, T alpha, T const*const A, std::size_t lda,
+				T const* __restrict__ x, T beta, T* __restrict__ y)
+{
+	const std::size_t n_row_blocks ((m + 3) / 4);
+	OPENMP_LOOP_TYPE ib;
+#pragma omp parallel for if (m * n > 100000)
+	for (ib = 0; ib < n_row_blocks; ib++) {
+		const std::size_t i (4 * ib);
+		if (i + 4 <= m) {
+			T const* __restrict__ a0 (A + i * lda);
+			T const* __restrict__ a1 (a0 + lda);
+			T const* __restrict__ a2 (a1 + lda);
+			T const* __restrict__ a3 (a2 + lda);
+			T s0 (0), s1 (0), s2 (0), s3 (0);
+			for (std::size_t j(0); j < n; j++) {
+				const T x_j (x[j]);
+				s0 += a0[j] * x_j;
+				s1 += a1[j] * x_j;
+				s2 += a2[j] * x_j;
+				s3 += a3[j] * x_j;
+			}
+			if (beta == T(0)) {
+				y[i] = alpha * s0;
+				y[i + 1] = alpha * s1;
+				y[i + 2] = alpha * s2;
+				y[i + 3] = alpha * s3;
+			} else {
+				y[i] = alpha * s0 + beta * y[i];
+				y[i + 1] = alpha * s1 + beta * y[i + 1];
+				y[i + 2] = alpha * s2 + beta * y[i + 2];
+				y[i + 3] = alpha * s3 + beta * y[i + 3];
+			}
+		} else {
+			for (std::size_t r(i); r < m; r++) {
+				T const*const a_r (A + r * lda);
+				T s (0);
+				for (std::size_t j(0); j < n; j++)
+					s += a_r[j] * x[j];
+				y[r] = (beta == T(0)) ? alpha * s : alpha * s + beta * y[r];
+			}
+		}
+	}
+}
+
+} // end namespace MathLib
+
+#endif /* DENSEKERNELS_H_ */
@@ -0,0 +1,557 @@
+/*
+ * SmoothedAggregationAMG.cpp
+ *
+ *  Created on: Jan 27, 2012
+ *      Author: TF
+ */
+
+#include <cstddef>
+#include <cmath>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "SmoothedAggregationAMG.h"
+#include "../Sparse/partitionRowsByNNZ.h"
+
+namespace MathLib {
+
+namespace {
+
+/**
+ * y = A x (overwrites y)
+ */
+void crsMult(unsigned n, unsigned const*const iA, unsigned const*const jA,
+				double const*const A, double const*const x, double* y)
+{
+	OPENMP_LOOP_TYPE i;
+	#pragma omp parallel for
+	for (i = 0; i < static_cast<OPENMP_LOOP_TYPE>(n); i++) {
+		double t(0.0);
+		const unsigned end(iA[i + 1]);
+		for (unsigned j(iA[i]); j < end; j++)
+			t += A[j] * x[jA[j]];
+		y[i] = t;
+	}
+}
+
+/**
+ * r = b - A x
+ */
+void crsResidual(unsigned n, unsigned const*const iA, unsigned const*const jA,
+				double const*const A, double const*const x, double const*const b, double* r)
+{
+	OPENMP_LOOP_TYPE i;
+	#pragma omp parallel for
+	for (i = 0; i < static_cast<OPENMP_LOOP_TYPE>(n); i++) {
+		double t(b[i]);
+		const unsigned end(iA[i + 1]);
+		for (unsigned j(iA[i]); j < end; j++)
+			t -= A[j] * x[jA[j]];
+		r[i] = t;
+	}
+}
+
+/**
+ * Computes the product \f$C = A B\f$ of two matrices in compressed row
+ * storage format (row wise Gustavson algorithm). In the first (symbolic) pass
+ * the number of entries of every row of C is counted, in the second
+ * (numeric) pass the entries are computed. Both passes are parallelized over
+ * the rows of C, every thread uses its own marker array. The arrays of C are
+ * allocated within the function.
+ * @param n number of rows of A
+ * @param m number of columns of B
+ */
+void crsMultMat(unsigned n, unsigned m,
+				unsigned const*const iA, unsigned const*const jA, double const*const A,
+				unsigned const*const iB, unsigned const*const jB, double const*const B,
+				unsigned* &iC, unsigned* &jC, double* &C)
+{
+	const unsigned no_entry(std::numeric_limits<unsigned>::max());
+	iC = new unsigned[n + 1];
+
+	#pragma omp parallel
+	{
+		unsigned *marker(new unsigned[m]);
+		for (unsigned k(0); k < m; k++)
+			marker[k] = no_entry;
+
+		OPENMP_LOOP_TYPE i;
+		#pragma omp for
+		for (i = 0; i < static_cast<OPENMP_LOOP_TYPE>(n); i++) {
+			unsigned cnt(0);
+			const unsigned end(iA[i + 1]);
+			for (unsigned j(iA[i]); j < end; j++) {
+				const unsigned k(jA[j]);
+				const unsigned end_k(iB[k + 1]);
+				for (unsigned jj(iB[k]); jj < end_k; jj++) {
+					if (marker[jB[jj]] != static_cast<unsigned>(i)) {
+						marker[jB[jj]] = i;
+						cnt++;
+					}
+				}
+			}
+			iC[i + 1] = cnt;
+		}
+		delete [] marker;
+	}
+
+	iC[0] = 0;
+	for (unsigned i(0); i < n; i++)
+		iC[i + 1] += iC[i];
+	jC = new unsigned[iC[n]];
+	C = new double[iC[n]];
+
+	#pragma omp parallel
+	{
+		// pos[c] is the position of the entry (i,c) within the current row i,
+		// positions of rows computed earlier by the thread are smaller than iC[i]
+		unsigned *pos(new unsigned[m]);
+		for (unsigned k(0); k < m; k++)
+			pos[k] = no_entry;
+
+		OPENMP_LOOP_TYPE i;
+		#pragma omp for
+		for (i = 0; i < static_cast<OPENMP_LOOP_TYPE>(n); i++) {
+			const unsigned beg(iC[i]);
+			unsigned last(beg);
+			const unsigned end(iA[i + 1]);
+			for (unsigned j(iA[i]); j < end; j++) {
+				const unsigned k(jA[j]);
+				const double a(A[j]);
+				const unsigned end_k(iB[k + 1]);
+				for (unsigned jj(iB[k]); jj < end_k; jj++) {
+					const unsigned c(jB[jj]);
+					if (pos[c] == no_entry || pos[c] < beg) {
+						pos[c] = last;
+						jC[last] = c;
+						C[last] = a * B[jj];
+						last++;
+					} else {
+						C[pos[c]] += a * B[jj];
+					}
+				}
+			}
+		}
+		delete [] pos;
+	}
+}
+
+/**
+ * transposes the \f$n \times m\f$ matrix A, the arrays of the transposed
+ * matrix are allocated within the function
+ */
+void crsTranspose(unsigned n, unsigned m,
+				unsigned const*const iA, unsigned const*const jA, double const*const A,
+				unsigned* &iT, unsigned* &jT, double* &T)
+{
+	const unsigned nnz(iA[n]);
+	iT = new unsigned[m + 1];
+	jT = new unsigned[nnz];
+	T = new double[nnz];
+
+	for (unsigned k(0); k <= m; k++)
+		iT[k] = 0;
+	for (unsigned k(0); k < nnz; k++)
+		iT[jA[k] + 1]++;
+	for (unsigned k(0); k < m; k++)
+		iT[k + 1] += iT[k];
+
+	unsigned *pos(new unsigned[m]);
+	for (unsigned k(0); k < m; k++)
+		pos[k] = iT[k];
+	for (unsigned i(0); i < n; i++) {
+		for (unsigned j(iA[i]); j < iA[i + 1]; j++) {
+			const unsigned k(pos[jA[j]]++);
+			jT[k] = i;
+			T[k] = A[j];
+		}
+	}
+	delete [] pos;
+}
+
+} // end anonymous namespace
+
+SmoothedAggregationAMG::Level::Level() :
+	_n(0), _owns_matrix(false), _iA(NULL), _jA(NULL), _A(NULL), _inv_diag(NULL), _omega(0.0),
+	_iP(NULL), _jP(NULL), _P(NULL), _iR(NULL), _jR(NULL), _R(NULL),
+	_x(NULL), _b(NULL), _r(NULL)
+{}
+
+SmoothedAggregationAMG::Level::~Level()
+{
+	if (_owns_matrix) {
+		delete [] _iA;
+		delete [] _jA;
+		delete [] _A;
+	}
+	delete [] _inv_diag;
+	delete [] _iP;
+	delete [] _jP;
+	delete [] _P;
+	delete [] _iR;
+	delete [] _jR;
+	delete [] _R;
+	delete [] _x;
+	delete [] _b;
+	delete [] _r;
+}
+
+SmoothedAggregationAMG::SmoothedAggregationAMG(unsigned n, unsigned const*const iA,
+				unsigned const*const jA, double const*const A, double theta,
+				unsigned coarse_size, unsigned max_levels, unsigned n_smooth) :
+	_theta(theta), _coarse_size(coarse_size), _n_smooth(n_smooth),
+	_coarse_mat(NULL), _coarse_solver(NULL)
+{
+	Level *level(new Level);
+	level->_n = n;
+	level->_iA = iA;
+	level->_jA = jA;
+	level->_A = A;
+	initLevel(*level);
+	_levels.push_back(level);
+
+	// the entries of the coarse operators are less distinct, i.e. the
+	// threshold for strong connections is reduced from level to level
+	double level_theta(_theta);
+	while (level->_n > _coarse_size && _levels.size() < max_levels) {
+		level = coarsen(*_levels.back(), level_theta);
+		level_theta *= 0.5;
+		if (level == NULL)
+			break;
+		initLevel(*level);
+		_levels.push_back(level);
+	}
+
+	// the coarsest level is solved directly if it is small enough,
+	// otherwise (coarsening stagnates) the smoother is applied
+	Level const& coarsest(*_levels.back());
+	if (_levels.size() > 1 && coarsest._n <= 4 * _coarse_size) {
+		const unsigned nc(coarsest._n);
+		_coarse_mat = new Matrix<double>(nc, nc);
+		for (unsigned i(0); i < nc; i++) {
+			for (unsigned j(0); j < nc; j++)
+				(*_coarse_mat)(i, j) = 0.0;
+			for (unsigned j(coarsest._iA[i]); j < coarsest._iA[i + 1]; j++)
+				(*_coarse_mat)(i, coarsest._jA[j]) += coarsest._A[j];
+		}
+		_coarse_solver = new GaussAlgorithm(*_coarse_mat);
+	}
+}
+
+SmoothedAggregationAMG::~SmoothedAggregationAMG()
+{
+	delete _coarse_solver;
+	delete _coarse_mat;
+	for (unsigned l(0); l < _levels.size(); l++)
+		delete _levels[l];
+}
+
+double SmoothedAggregationAMG::getOperatorComplexity() const
+{
+	double nnz(0.0);
+	for (unsigned l(0); l < _levels.size(); l++)
+		nnz += getNNZ(l);
+	return nnz / getNNZ(0);
+}
+
+void SmoothedAggregationAMG::initLevel(Level &level) const
+{
+	const unsigned n(level._n);
+	unsigned const*const iA(level._iA);
+	unsigned const*const jA(level._jA);
+	double const*const A(level._A);
+
+	level._inv_diag = new double[n];
+	level._x = new double[n];
+	level._b = new double[n];
+	level._r = new double[n];
+
+	// Gershgorin estimate of the spectral radius of D^{-1} A
+	double rho(0.0);
+	#pragma omp parallel
+	{
+		double rho_local(0.0);
+		OPENMP_LOOP_TYPE i;
+		#pragma omp for
+		for (i = 0; i < static_cast<OPENMP_LOOP_TYPE>(n); i++) {
+			double diag(0.0), row_sum(0.0);
+			const unsigned end(iA[i + 1]);
+			for (unsigned j(iA[i]); j < end; j++) {
+				if (jA[j] == static_cast<unsigned>(i))
+					diag += A[j];
+				row_sum += fabs(A[j]);
+			}
+			level._inv_diag[i] = (diag != 0.0) ? 1.0 / diag : 0.0;
+			if (fabs(level._inv_diag[i]) * row_sum > rho_local)
+				rho_local = fabs(level._inv_diag[i]) * row_sum;
+		}
+		#pragma omp critical
+		{
+			if (rho_local > rho)
+				rho = rho_local;
+		}
+	}
+	level._omega = (rho > 0.0) ? 4.0 / (3.0 * rho) : 1.0;
+}
+
+unsigned SmoothedAggregationAMG::aggregate(Level const& level, double theta, unsigned* agg) const
+{
+	const unsigned n(level._n);
+	unsigned const*const iA(level._iA);
+	unsigned const*const jA(level._jA);
+	double const*const A(level._A);
+	double const*const inv_diag(level._inv_diag);
+	const double theta2(theta * theta);
+	const unsigned no_agg(std::numeric_limits<unsigned>::max());
+
+#ifdef _OPENMP
+	const unsigned n_blocks(omp_get_max_threads());
+#else
+	const unsigned n_blocks(1);
+#endif
+	unsigned *partition(new unsigned[n_blocks + 1]);
+	partitionRowsByNNZ(n, iA, n_blocks, partition);
+	unsigned *n_aggs(new unsigned[n_blocks + 1]);
+	// marks the nodes aggregated within the first pass
+	bool *root(new bool[n]);
+
+	OPENMP_LOOP_TYPE b;
+	#pragma omp parallel for schedule(static, 1)
+	for (b = 0; b < static_cast<OPENMP_LOOP_TYPE>(n_blocks); b++) {
+		const unsigned beg(partition[b]);
+		const unsigned end(partition[b + 1]);
+		for (unsigned i(beg); i < end; i++) {
+			agg[i] = no_agg;
+			root[i] = false;
+		}
+
+		// a_ij is strong if a_ij^2 >= theta^2 |a_ii a_jj|, only connections
+		// within the block are considered (decoupled aggregation)
+#define STRONG(i, j, k) ((j) != (i) && (j) >= beg && (j) < end && \
+	A[k] * A[k] * fabs(inv_diag[i] * inv_diag[j]) >= theta2)
+
+		unsigned cnt(0);
+		// first pass: nodes with strong connections whose strong neighbourhood
+		// is not aggregated yet form a new aggregate together with the
+		// neighbourhood
+		for (unsigned i(beg); i < end; i++) {
+			if (agg[i] != no_agg)
+				continue;
+			bool free(true), strong(false);
+			for (unsigned k(iA[i]); k < iA[i + 1] && free; k++) {
+				const unsigned j(jA[k]);
+				if (STRONG(i, j, k)) {
+					strong = true;
+					if (agg[j] != no_agg)
+						free = false;
+				}
+			}
+			if (!free || !strong)
+				continue;
+			agg[i] = cnt;
+			root[i] = true;
+			for (unsigned k(iA[i]); k < iA[i + 1]; k++) {
+				const unsigned j(jA[k]);
+				if (STRONG(i, j, k)) {
+					agg[j] = cnt;
+					root[j] = true;
+				}
+			}
+			cnt++;
+		}
+
+		// second pass: remaining nodes join an aggregate of the first pass
+		for (unsigned i(beg); i < end; i++) {
+			if (agg[i] != no_agg)
+				continue;
+			for (unsigned k(iA[i]); k < iA[i + 1]; k++) {
+				const unsigned j(jA[k]);
+				if (STRONG(i, j, k) && root[j]) {
+					agg[i] = agg[j];
+					break;
+				}
+			}
+		}
+
+		// third pass: the remaining nodes (mostly nodes without strong
+		// connections) join the aggregate of the neighbour with the largest
+		// connection, one aggregate per node would stall the coarsening
+		for (unsigned i(beg); i < end; i++) {
+			if (agg[i] != no_agg)
+				continue;
+			double max_conn(0.0);
+			for (unsigned k(iA[i]); k < iA[i + 1]; k++) {
+				const unsigned j(jA[k]);
+				if (j != i && j >= beg && j < end && agg[j] != no_agg
+						&& fabs(A[k]) > max_conn) {
+					max_conn = fabs(A[k]);
+					agg[i] = agg[j];
+				}
+			}
+			if (agg[i] != no_agg)
+				continue;
+			// no aggregated neighbour: new aggregate with the neighbours
+			agg[i] = cnt;
+			for (unsigned k(iA[i]); k < iA[i + 1]; k++) {
+				const unsigned j(jA[k]);
+				if (j >= beg && j < end && agg[j] == no_agg)
+					agg[j] = cnt;
+			}
+			cnt++;
+		}
+#undef STRONG
+		n_aggs[b + 1] = cnt;
+	}
+
+	// global numbering of the aggregates
+	n_aggs[0] = 0;
+	for (unsigned k(0); k < n_blocks; k++)
+		n_aggs[k + 1] += n_aggs[k];
+
+	#pragma omp parallel for schedule(static, 1)
+	for (b = 0; b < static_cast<OPENMP_LOOP_TYPE>(n_blocks); b++) {
+		for (unsigned i(partition[b]); i < partition[b + 1]; i++)
+			agg[i] += n_aggs[b];
+	}
+
+	const unsigned nc(n_aggs[n_blocks]);
+	delete [] root;
+	delete [] n_aggs;
+	delete [] partition;
+	return nc;
+}
+
+SmoothedAggregationAMG::Level* SmoothedAggregationAMG::coarsen(Level &level, double theta) const
+{
+	const unsigned n(level._n);
+	unsigned *agg(new unsigned[n]);
+	const unsigned nc(aggregate(level, theta, agg));
+	// a level that is not much smaller than the finer level costs more than
+	// it improves the convergence
+	if (nc == 0 || nc > AMG_MAX_COARSENING_RATIO * n) {
+		delete [] agg;
+		return NULL;
+	}
+
+	// tentative prolongator T: entry (i, agg[i]) = 1/sqrt(|aggregate|)
+	unsigned *agg_size(new unsigned[nc]);
+	for (unsigned k(0); k < nc; k++)
+		agg_size[k] = 0;
+	for (unsigned i(0); i < n; i++)
+		agg_size[agg[i]]++;
+	unsigned *iT(new unsigned[n + 1]);
+	double *T(new double[n]);
+	OPENMP_LOOP_TYPE i;
+	#pragma omp parallel for
+	for (i = 0; i < static_cast<OPENMP_LOOP_TYPE>(n); i++) {
+		iT[i] = i;
+		T[i] = 1.0 / sqrt(static_cast<double>(agg_size[agg[i]]));
+	}
+	iT[n] = n;
+	delete [] agg_size;
+
+	// smoothed prolongator P = (I - omega D^{-1} A) T
+	crsMultMat(n, nc, level._iA, level._jA, level._A, iT, agg, T,
+					level._iP, level._jP, level._P);
+	#pragma omp parallel for
+	for (i = 0; i < static_cast<OPENMP_LOOP_TYPE>(n); i++) {
+		const double s(-level._omega * level._inv_diag[i]);
+		const unsigned end(level._iP[i + 1]);
+		for (unsigned j(level._iP[i]); j < end; j++) {
+			level._P[j] *= s;
+			if (level._jP[j] == agg[i])
+				level._P[j] += T[i];
+		}
+	}
+	delete [] iT;
+	delete [] T;
+	delete [] agg;
+
+	crsTranspose(n, nc, level._iP, level._jP, level._P, level._iR, level._jR, level._R);
+
+	// Galerkin product A_c = R (A P)
+	unsigned *iAP, *jAP;
+	double *AP;
+	crsMultMat(n, nc, level._iA, level._jA, level._A, level._iP, level._jP, level._P,
+					iAP, jAP, AP);
+	Level *coarse(new Level);
+	coarse->_n = nc;
+	coarse->_owns_matrix = true;
+	unsigned *iAc, *jAc;
+	double *Ac;
+	crsMultMat(nc, nc, level._iR, level._jR, level._R, iAP, jAP, AP, iAc, jAc, Ac);
+	coarse->_iA = iAc;
+	coarse->_jA = jAc;
+	coarse->_A = Ac;
+	delete [] iAP;
+	delete [] jAP;
+	delete [] AP;
+
+	return coarse;
+}
+
+void SmoothedAggregationAMG::apply(double* x) const
+{
+	Level const& fine(*_levels[0]);
+	const unsigned n(fine._n);
+	for (unsigned i(0); i < n; i++)
+		fine._b[i] = x[i];
+	cycle(0);
+	for (unsigned i(0); i < n; i++)
+		x[i] = fine._x[i];
+}
+
+void SmoothedAggregationAMG::cycle(unsigned l) const
+{
+	Level const& level(*_levels[l]);
+	const OPENMP_LOOP_TYPE n(level._n);
+	double *x(level._x);
+	double const*const b(level._b);
+	double *r(level._r);
+	double const*const inv_diag(level._inv_diag);
+	const double omega(level._omega);
+	OPENMP_LOOP_TYPE i;
+
+	if (l + 1 == _levels.size() && _coarse_solver) {
+		for (i = 0; i < n; i++)
+			x[i] = b[i];
+		_coarse_solver->execute(x);
+		return;
+	}
+
+	// pre smoothing, the first damped Jacobi step starts with x = 0
+	#pragma omp parallel for
+	for (i = 0; i < n; i++)
+		x[i] = omega * inv_diag[i] * b[i];
+	for (unsigned s(1); s < _n_smooth; s++) {
+		crsResidual(n, level._iA, level._jA, level._A, x, b, r);
+		#pragma omp parallel for
+		for (i = 0; i < n; i++)
+			x[i] += omega * inv_diag[i] * r[i];
+	}
+
+	// coarse grid correction
+	if (l + 1 < _levels.size()) {
+		Level const& coarse(*_levels[l + 1]);
+		crsResidual(n, level._iA, level._jA, level._A, x, b, r);
+		crsMult(coarse._n, level._iR, level._jR, level._R, r, coarse._b);
+		cycle(l + 1);
+		crsMult(n, level._iP, level._jP, level._P, coarse._x, r);
+		#pragma omp parallel for
+		for (i = 0; i < n; i++)
+			x[i] += r[i];
+	}
+
+	// post smoothing
+	for (unsigned s(0); s < _n_smooth; s++) {
+		crsResidual(n, level._iA, level._jA, level._A, x, b, r);
+		#pragma omp parallel for
+		for (i = 0; i < n; i++)
+			x[i] += omega * inv_diag[i] * r[i];
+	}
+}
+
+} // end namespace MathLib
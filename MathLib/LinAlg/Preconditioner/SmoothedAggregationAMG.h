@@ -0,0 +1,143 @@
+/*
+ * SmoothedAggregationAMG.h
+ *
+ *  Created on: Jan 27, 2012
+ *      Author: TF
+ */
+
+#ifndef SMOOTHEDAGGREGATIONAMG_H_
+#define SMOOTHEDAGGREGATIONAMG_H_
+
+#include <vector>
+
+#include "../Dense/Matrix.h"
+#include "../Solvers/GaussAlgorithm.h"
+
+namespace MathLib {
+
+/**
+ * the coarsening stops if a coarse level would have more than this ratio of
+ * the rows of the finer level
+ */
+const double AMG_MAX_COARSENING_RATIO = 0.5;
+
+/**
+ * Class SmoothedAggregationAMG builds an algebraic multigrid hierarchy for a
+ * symmetric positive definite matrix in compressed row storage format using
+ * smoothed aggregation and applies one V-cycle as preconditioner.
+ *
+ * Setup per level:
+ * - the nodes are grouped into aggregates of strongly connected nodes
+ *   (\f$a_{ij}^2 \ge \theta_l^2 |a_{ii} a_{jj}|\f$, \f$\theta_l = \theta 0.5^l\f$
+ *   on level l); nodes without strong connections join the aggregate of
+ *   the neighbour with the largest connection; in order to run in
+ *   parallel every thread aggregates the nodes of its own row block
+ *   (decoupled aggregation)
+ * - the tentative prolongator \f$T\f$ interpolates the constant vector per aggregate
+ * - the prolongator is smoothed by one damped Jacobi step,
+ *   \f$P = (I - \omega D^{-1} A) T\f$, \f$\omega = 4 / (3 \rho(D^{-1}A))\f$,
+ *   where \f$\rho\f$ is estimated by the Gershgorin circle theorem
+ * - restriction \f$R = P^T\f$ and coarse matrix \f$A_c = R A P\f$ (Galerkin product)
+ *
+ * The coarsening stops if the number of rows drops below a given size or if
+ * a level would be reduced by less than AMG_MAX_COARSENING_RATIO, then
+ * the coarsest system is solved by the dense GaussAlgorithm. The V-cycle uses
+ * damped Jacobi as (symmetric) pre- and post smoother, i.e. the
+ * preconditioner is symmetric and can be used within CG.
+ *
+ * All parts of setup and cycle except the transposition of the prolongators
+ * are OpenMP parallel.
+ */
+class SmoothedAggregationAMG
+{
+public:
+	/**
+	 * Constructs the multigrid hierarchy. The arrays of the matrix are not
+	 * copied, they have to be valid for the life time of the object.
+	 * @param n number of rows / columns
+	 * @param iA row pointer of compressed row storage format
+	 * @param jA column index of compressed row storage format
+	 * @param A data entries of compressed row storage format
+	 * @param theta threshold for strong connections on the finest level
+	 * @param coarse_size the coarsening stops if a level has at most coarse_size rows
+	 * @param max_levels maximal number of levels
+	 * @param n_smooth number of pre and post smoothing steps
+	 */
+	SmoothedAggregationAMG(unsigned n, unsigned const*const iA, unsigned const*const jA,
+					double const*const A, double theta = 0.08, unsigned coarse_size = 500,
+					unsigned max_levels = 25, unsigned n_smooth = 1);
+	~SmoothedAggregationAMG();
+
+	/**
+	 * applies one V-cycle with zero initial guess, i.e. \f$x = M^{-1} x\f$
+	 * @param x at the beginning the right hand side, at the end the result
+	 */
+	void apply(double* x) const;
+
+	unsigned getNLevels() const { return _levels.size(); }
+	unsigned getNRows(unsigned level) const { return _levels[level]->_n; }
+	unsigned getNNZ(unsigned level) const { return _levels[level]->_iA[_levels[level]->_n]; }
+	/**
+	 * get the operator complexity, i.e. the sum of the non-zero entries of
+	 * all levels divided by the number of non-zero entries of the finest level
+	 */
+	double getOperatorComplexity() const;
+
+private:
+	// noncopyable
+	SmoothedAggregationAMG(SmoothedAggregationAMG const&);
+	SmoothedAggregationAMG& operator= (SmoothedAggregationAMG const&);
+
+	struct Level {
+		Level();
+		~Level();
+		unsigned _n;
+		/** the matrix of the finest level belongs to the user */
+		bool _owns_matrix;
+		unsigned const* _iA;
+		unsigned const* _jA;
+		double const* _A;
+		double* _inv_diag;
+		/** weight of the Jacobi smoother */
+		double _omega;
+		/** prolongator to this level from the next coarser level (n x n_coarse) */
+		unsigned *_iP, *_jP;
+		double *_P;
+		/** restriction from this level to the next coarser level (n_coarse x n) */
+		unsigned *_iR, *_jR;
+		double *_R;
+		/** work vectors of the V-cycle */
+		double *_x, *_b, *_r;
+	};
+
+	/**
+	 * computes the inverse diagonal and the Jacobi weight of the level
+	 */
+	void initLevel(Level &level) const;
+	/**
+	 * creates the next coarser level
+	 * @param theta threshold for strong connections on this level
+	 * @return the coarser level or NULL if the aggregation does not coarsen
+	 * enough (see AMG_MAX_COARSENING_RATIO)
+	 */
+	Level* coarsen(Level &level, double theta) const;
+	/**
+	 * aggregates the nodes of the level
+	 * @param theta threshold for strong connections
+	 * @param agg on output the aggregate of every node
+	 * @return number of aggregates
+	 */
+	unsigned aggregate(Level const& level, double theta, unsigned* agg) const;
+	void cycle(unsigned l) const;
+
+	double const _theta;
+	unsigned const _coarse_size;
+	unsigned const _n_smooth;
+	std::vector<Level*> _levels;
+	Matrix<double>* _coarse_mat;
+	GaussAlgorithm* _coarse_solver;
+};
+
+} // end namespace MathLib
+
+#endif /* SMOOTHEDAGGREGATIONAMG_H_ */
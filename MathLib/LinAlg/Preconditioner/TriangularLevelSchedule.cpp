@@ -0,0 +1,136 @@
+/*
+ * TriangularLevelSchedule.cpp
+ *
+ *  Created on: Jan 25, 2012
+ *      Author: TF
+ */
+
+#include <cstddef>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "TriangularLevelSchedule.h"
+
+namespace MathLib {
+
+TriangularLevelSchedule::TriangularLevelSchedule() :
+	_n_levels(0), _level_ptr(NULL), _level_rows(NULL)
+{}
+
+TriangularLevelSchedule::~TriangularLevelSchedule()
+{
+	delete [] _level_ptr;
+	delete [] _level_rows;
+}
+
+void TriangularLevelSchedule::calcLower(unsigned n, unsigned const*const iA, unsigned const*const jA)
+{
+	unsigned *level(new unsigned[n]);
+	for (unsigned i(0); i < n; i++) {
+		unsigned l(0);
+		const unsigned end(iA[i + 1]);
+		for (unsigned j(iA[i]); j < end; j++) {
+			if (jA[j] < i && level[jA[j]] + 1 > l)
+				l = level[jA[j]] + 1;
+		}
+		level[i] = l;
+	}
+	setLevels(n, level);
+	delete [] level;
+}
+
+void TriangularLevelSchedule::calcUpper(unsigned n, unsigned const*const iA, unsigned const*const jA)
+{
+	unsigned *level(new unsigned[n]);
+	for (unsigned i(n); i > 0; i--) {
+		const unsigned r(i - 1);
+		unsigned l(0);
+		const unsigned end(iA[r + 1]);
+		for (unsigned j(iA[r]); j < end; j++) {
+			if (jA[j] > r && level[jA[j]] + 1 > l)
+				l = level[jA[j]] + 1;
+		}
+		level[r] = l;
+	}
+	setLevels(n, level);
+	delete [] level;
+}
+
+void TriangularLevelSchedule::setLevels(unsigned n, unsigned const*const level)
+{
+	_n_levels = 0;
+	for (unsigned i(0); i < n; i++) {
+		if (level[i] + 1 > _n_levels)
+			_n_levels = level[i] + 1;
+	}
+
+	// counting sort of the rows by the levels
+	delete [] _level_ptr;
+	delete [] _level_rows;
+	_level_ptr = new unsigned[_n_levels + 1];
+	_level_rows = new unsigned[n];
+	for (unsigned l(0); l <= _n_levels; l++)
+		_level_ptr[l] = 0;
+	for (unsigned i(0); i < n; i++)
+		_level_ptr[level[i] + 1]++;
+	for (unsigned l(0); l < _n_levels; l++)
+		_level_ptr[l + 1] += _level_ptr[l];
+
+	unsigned *pos(new unsigned[_n_levels]);
+	for (unsigned l(0); l < _n_levels; l++)
+		pos[l] = _level_ptr[l];
+	for (unsigned i(0); i < n; i++)
+		_level_rows[pos[level[i]]++] = i;
+	delete [] pos;
+}
+
+void TriangularLevelSchedule::forwardSolve(unsigned const*const iA, unsigned const*const jA,
+				double const*const A, unsigned const*const diag_idx, double* x) const
+{
+#pragma omp parallel
+	{
+		for (unsigned l(0); l < _n_levels; l++) {
+			const OPENMP_LOOP_TYPE end_level(_level_ptr[l + 1]);
+			OPENMP_LOOP_TYPE k;
+			// the implicit barrier at the end of the loop separates the levels
+#pragma omp for
+			for (k = _level_ptr[l]; k < end_level; k++) {
+				const unsigned i(_level_rows[k]);
+				double t(x[i]);
+				const unsigned end(iA[i + 1]);
+				for (unsigned j(iA[i]); j < end; j++) {
+					if (jA[j] < i)
+						t -= A[j] * x[jA[j]];
+				}
+				x[i] = (diag_idx == NULL) ? t : t / A[diag_idx[i]];
+			}
+		}
+	}
+}
+
+void TriangularLevelSchedule::backwardSolve(unsigned const*const iA, unsigned const*const jA,
+				double const*const A, unsigned const*const diag_idx, double* x) const
+{
+#pragma omp parallel
+	{
+		for (unsigned l(0); l < _n_levels; l++) {
+			const OPENMP_LOOP_TYPE end_level(_level_ptr[l + 1]);
+			OPENMP_LOOP_TYPE k;
+#pragma omp for
+			for (k = _level_ptr[l]; k < end_level; k++) {
+				const unsigned i(_level_rows[k]);
+				double t(x[i]);
+				const unsigned end(iA[i + 1]);
+				for (unsigned j(iA[i]); j < end; j++) {
+					if (jA[j] > i)
+						t -= A[j] * x[jA[j]];
+				}
+				x[i] = (diag_idx == NULL) ? t : t / A[diag_idx[i]];
+			}
+		}
+	}
+}
+
+} // end namespace MathLib
@@ -0,0 +1,89 @@
+/*
+ * TriangularLevelSchedule.h
+ *
+ *  Created on: Jan 25, 2012
+ *      Author: TF
+ */
+
+#ifndef TRIANGULARLEVELSCHEDULE_H_
+#define TRIANGULARLEVELSCHEDULE_H_
+
+namespace MathLib {
+
+/**
+ * Class TriangularLevelSchedule groups the rows of a sparse triangular matrix
+ * in compressed row storage format into levels. The rows of one level depend
+ * only on rows of previous levels, i.e. within the forward / backward
+ * substitution all rows of a level can be processed in parallel.
+ */
+class TriangularLevelSchedule
+{
+public:
+	TriangularLevelSchedule();
+	~TriangularLevelSchedule();
+
+	/**
+	 * computes the levels of the lower triangular part (the entries with
+	 * column index < row index) of the matrix
+	 * @param n number of rows / columns
+	 * @param iA row pointer of compressed row storage format
+	 * @param jA column index of compressed row storage format
+	 */
+	void calcLower(unsigned n, unsigned const*const iA, unsigned const*const jA);
+
+	/**
+	 * computes the levels of the upper triangular part (the entries with
+	 * column index > row index) of the matrix
+	 * @param n number of rows / columns
+	 * @param iA row pointer of compressed row storage format
+	 * @param jA column index of compressed row storage format
+	 */
+	void calcUpper(unsigned n, unsigned const*const iA, unsigned const*const jA);
+
+	/**
+	 * solves \f$L y = b\f$ in place, where \f$L\f$ is the lower triangular part
+	 * of the matrix. The schedule has to be computed via calcLower().
+	 * @param iA row pointer of compressed row storage format
+	 * @param jA column index of compressed row storage format
+	 * @param A data entries of compressed row storage format
+	 * @param diag_idx position of the diagonal entries in jA / A, if NULL the
+	 * diagonal entries are assumed to be 1
+	 * @param x at the beginning the right hand side, at the end the solution
+	 */
+	void forwardSolve(unsigned const*const iA, unsigned const*const jA, double const*const A,
+					unsigned const*const diag_idx, double* x) const;
+
+	/**
+	 * solves \f$U y = b\f$ in place, where \f$U\f$ is the upper triangular part
+	 * of the matrix. The schedule has to be computed via calcUpper().
+	 * @param iA row pointer of compressed row storage format
+	 * @param jA column index of compressed row storage format
+	 * @param A data entries of compressed row storage format
+	 * @param diag_idx position of the diagonal entries in jA / A, if NULL the
+	 * diagonal entries are assumed to be 1
+	 * @param x at the beginning the right hand side, at the end the solution
+	 */
+	void backwardSolve(unsigned const*const iA, unsigned const*const jA, double const*const A,
+					unsigned const*const diag_idx, double* x) const;
+
+	unsigned getNLevels() const { return _n_levels; }
+
+private:
+	// noncopyable
+	TriangularLevelSchedule(TriangularLevelSchedule const&);
+	TriangularLevelSchedule& operator= (TriangularLevelSchedule const&);
+
+	/**
+	 * sorts the rows by the given levels
+	 */
+	void setLevels(unsigned n, unsigned const*const level);
+
+	unsigned _n_levels;
+	/** the rows of level l are _level_rows[_level_ptr[l]], ..., _level_rows[_level_ptr[l+1]-1] */
+	unsigned *_level_ptr;
+	unsigned *_level_rows;
+};
+
+} // end namespace MathLib
+
+#endif /* TRIANGULARLEVELSCHEDULE_H_ */
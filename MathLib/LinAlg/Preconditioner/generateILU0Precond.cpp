@@ -0,0 +1,120 @@
+/*
+ * generateILU0Precond.cpp
+ *
+ *  Created on: Jan 25, 2012
+ *      Author: TF
+ */
+
+#include <iostream>
+#include <limits>
+#include <cmath>
+
+#include "generateILU0Precond.h"
+
+namespace MathLib {
+
+bool generateILU0Precond(unsigned n, unsigned const*const iA, unsigned const*const jA,
+				double const*const A, double* LU, unsigned* diag_idx)
+{
+	const unsigned nnz(iA[n]);
+	for (unsigned k(0); k < nnz; k++)
+		LU[k] = A[k];
+
+	for (unsigned r(0); r < n; r++) {
+		unsigned j(iA[r]);
+		const unsigned end(iA[r + 1]);
+		while (j < end && jA[j] < r)
+			j++;
+		if (j == end || jA[j] != r) {
+			std::cout << "row " << r << " has no diagonal element " << std::endl;
+			return false;
+		}
+		diag_idx[r] = j;
+	}
+
+	// pos[c] is the position of the entry (i,c) within the current row i
+	const unsigned no_entry(std::numeric_limits<unsigned>::max());
+	unsigned *pos(new unsigned[n]);
+	for (unsigned k(0); k < n; k++)
+		pos[k] = no_entry;
+
+	bool ok(true);
+	for (unsigned i(0); i < n && ok; i++) {
+		const unsigned end(iA[i + 1]);
+		for (unsigned j(iA[i]); j < end; j++)
+			pos[jA[j]] = j;
+
+		// eliminate the entries left of the diagonal
+		for (unsigned j(iA[i]); j < diag_idx[i]; j++) {
+			const unsigned k(jA[j]);
+			LU[j] /= LU[diag_idx[k]];
+			const unsigned end_k(iA[k + 1]);
+			for (unsigned jj(diag_idx[k] + 1); jj < end_k; jj++) {
+				if (pos[jA[jj]] != no_entry)
+					LU[pos[jA[jj]]] -= LU[j] * LU[jj];
+			}
+		}
+
+		if (fabs(LU[diag_idx[i]]) < std::numeric_limits<double>::epsilon()) {
+			std::cout << "zero pivot in row " << i << std::endl;
+			ok = false;
+		}
+
+		for (unsigned j(iA[i]); j < end; j++)
+			pos[jA[j]] = no_entry;
+	}
+
+	delete [] pos;
+	return ok;
+}
+
+bool generateIC0Precond(unsigned n, unsigned const*const iL, unsigned const*const jL, double* L)
+{
+	const unsigned no_entry(std::numeric_limits<unsigned>::max());
+	unsigned *pos(new unsigned[n]);
+	for (unsigned k(0); k < n; k++)
+		pos[k] = no_entry;
+
+	bool ok(true);
+	for (unsigned i(0); i < n && ok; i++) {
+		const unsigned beg(iL[i]);
+		const unsigned diag(iL[i + 1] - 1);
+		if (iL[i + 1] == beg || jL[diag] != i) {
+			std::cout << "row " << i << " has no diagonal element " << std::endl;
+			ok = false;
+			break;
+		}
+
+		// L_ik = (a_ik - sum_{m<k} L_im L_km) / L_kk
+		for (unsigned j(beg); j < diag; j++) {
+			const unsigned k(jL[j]);
+			double s(L[j]);
+			const unsigned diag_k(iL[k + 1] - 1);
+			for (unsigned jj(iL[k]); jj < diag_k; jj++) {
+				if (pos[jL[jj]] != no_entry)
+					s -= L[pos[jL[jj]]] * L[jj];
+			}
+			L[j] = s / L[diag_k];
+			pos[k] = j;
+		}
+
+		// L_ii = sqrt(a_ii - sum_{k<i} L_ik^2)
+		double s(L[diag]);
+		for (unsigned j(beg); j < diag; j++)
+			s -= L[j] * L[j];
+		if (s <= 0.0) {
+			std::cout << "incomplete Cholesky factorization breaks down in row " << i << std::endl;
+			ok = false;
+		} else {
+			L[diag] = sqrt(s);
+		}
+
+		for (unsigned j(beg); j < diag; j++)
+			pos[jL[j]] = no_entry;
+	}
+
+	delete [] pos;
+	return ok;
+}
+
+} // end namespace MathLib
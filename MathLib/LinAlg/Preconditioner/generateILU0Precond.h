@@ -0,0 +1,48 @@
+/*
+ * generateILU0Precond.h
+ *
+ *  Created on: Jan 25, 2012
+ *      Author: TF
+ */
+
+#ifndef GENERATEILU0PRECOND_H_
+#define GENERATEILU0PRECOND_H_
+
+namespace MathLib {
+
+/**
+ * incomplete LU factorization without fill in (ILU(0)) of the \f$n \times n\f$
+ * matrix \f$A\f$, i.e. \f$L U \approx A\f$, where \f$L\f$ (unit lower triangular)
+ * and \f$U\f$ (upper triangular) have the sparsity pattern of \f$A\f$. The
+ * column indices within a row have to be sorted ascending.
+ * @param n number of rows / columns
+ * @param iA row pointer of compressed row storage format
+ * @param jA column index of compressed row storage format
+ * @param A data entries of compressed row storage format
+ * @param LU array of length iA[n], on output the entries of \f$L\f$ (without
+ * the unit diagonal) and \f$U\f$ with respect to the pattern iA, jA
+ * @param diag_idx array of length n, on output the position of the diagonal
+ * entries in jA / LU
+ * @return true, if all rows have a diagonal entry and no zero pivot occurs, else false
+ */
+bool generateILU0Precond(unsigned n, unsigned const*const iA, unsigned const*const jA,
+				double const*const A, double* LU, unsigned* diag_idx);
+
+/**
+ * incomplete Cholesky factorization without fill in (IC(0)) of a symmetric
+ * positive definite \f$n \times n\f$ matrix \f$A\f$, i.e. \f$L L^T \approx A\f$,
+ * where \f$L\f$ has the sparsity pattern of the lower triangular part of \f$A\f$.
+ * The factorization is computed in place.
+ * @param n number of rows / columns
+ * @param iL row pointer of the lower triangular part (including the diagonal)
+ * @param jL column index of the lower triangular part, sorted ascending, i.e.
+ * the diagonal entry is the last entry of each row
+ * @param L on input the entries of the lower triangular part of \f$A\f$,
+ * on output the entries of \f$L\f$
+ * @return true, if the factorization does not break down, else false
+ */
+bool generateIC0Precond(unsigned n, unsigned const*const iL, unsigned const*const jL, double* L);
+
+} // end namespace MathLib
+
+#endif /* GENERATEILU0PRECOND_H_ */
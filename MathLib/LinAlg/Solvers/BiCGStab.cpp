@@ -9,11 +9,12 @@
 
 #include "MathTools.h"
 #include "blas.h"
+#include "SolverObserver.h"
 
 namespace MathLib {
 
 unsigned BiCGStab(CRSMatrix<double, unsigned> const& A, double* const b, double* const x,
-		double& eps, unsigned& nsteps)
+		double& eps, unsigned& nsteps, SolverObserver* observer)
 {
 	const unsigned N(A.getNRows());
 	double *v (new double[8* N]);
@@ -25,14 +26,15 @@ unsigned BiCGStab(CRSMatrix<double, unsigned> const& A, double* const b, double*
 	double *r (t + N);
 	double *r0 (r + N);
 	double resid;
+	SolverProbe probe(observer);
 
 	// normb = |b|
 	double nrmb = blas::nrm2(N, b);
 	if (nrmb < D_PREC) nrmb = D_ONE;
 
 	// r = r0 = b - A x0
-	blas::copy(N, b, r0);
 	A.amux(D_MONE, x, r0);
+	blas::axpy(N, D_ONE, b, r0);
 	blas::copy(N, r0, r);
 
 	resid = blas::nrm2(N, r) / nrmb;
@@ -41,18 +43,20 @@ unsigned BiCGStab(CRSMatrix<double, unsigned> const& A, double* const b, double*
 		eps = resid;
 		nsteps = 0;
 		delete[] v;
-		return 0;
+		return probe.finished(0, 0, eps);
 	}
 
 	double alpha = D_ZERO, omega = D_ZERO, rho2 = D_ZERO;
 
 	for (unsigned l = 1; l <= nsteps; ++l) {
 		// rho1 = r0 * r
+		probe.start();
 		const double rho1 = blas::scpr(N, r0, r);
+		probe.stop(SOLVER_PHASE_DOT);
 		if (fabs(rho1) < D_PREC) {
 			eps = blas::nrm2(N, r) / nrmb;
 			delete[] v;
-			return 2;
+			return probe.finished(2, l, eps);
 		}
 
 		if (l == 1)
@@ -70,12 +74,16 @@ unsigned BiCGStab(CRSMatrix<double, unsigned> const& A, double* const b, double*
 
 		// p^ = C p
 		blas::copy(N, p, phat);
+		probe.stop(SOLVER_PHASE_UPDATE);
 		A.precondApply(phat);
+		probe.stop(SOLVER_PHASE_PRECOND);
 		// v = A p^
 		blas::setzero(N, v);
 		A.amux(D_ONE, phat, v);
+		probe.stop(SOLVER_PHASE_SPMV);
 
 		alpha = rho1 / blas::scpr(N, r0, v);
+		probe.stop(SOLVER_PHASE_DOT);
 
 		// s = r - alpha v
 //		blas::copy(N, r, s);
@@ -83,30 +91,35 @@ unsigned BiCGStab(CRSMatrix<double, unsigned> const& A, double* const b, double*
 		for (unsigned k(0); k<N; k++) {
 			s[k] = r[k] - alpha * v[k];
 		}
+		probe.stop(SOLVER_PHASE_UPDATE);
 
 		resid = blas::nrm2(N, s) / nrmb;
-#ifndef NDEBUG
-		std::cout << "Step " << l << ", resid=" << resid << std::endl;
-#endif
+		probe.stop(SOLVER_PHASE_DOT);
 		if (resid < eps) {
 			// x += alpha p^
 			blas::axpy(N, alpha, phat, x);
+			probe.stop(SOLVER_PHASE_UPDATE);
+			probe.iteration(l, resid);
 			eps = resid;
 			nsteps = l;
 			delete[] v;
-			return 0;
+			return probe.finished(0, l, eps);
 		}
 
 		// s^ = C s
 		blas::copy(N, s, shat);
+		probe.stop(SOLVER_PHASE_UPDATE);
 		A.precondApply(shat);
+		probe.stop(SOLVER_PHASE_PRECOND);
 
 		// t = A s^
 		blas::setzero(N, t);
 		A.amux(D_ONE, shat, t);
+		probe.stop(SOLVER_PHASE_SPMV);
 
 		// omega = t*s / t*t
 		omega = blas::scpr(N, t, s) / blas::scpr(N, t, t);
+		probe.stop(SOLVER_PHASE_DOT);
 
 		// x += alpha p^ + omega s^
 		blas::axpy(N, alpha, phat, x);
@@ -115,28 +128,31 @@ unsigned BiCGStab(CRSMatrix<double, unsigned> const& A, double* const b, double*
 		// r = s - omega t
 		blas::copy(N, s, r);
 		blas::axpy(N, -omega, t, r);
+		probe.stop(SOLVER_PHASE_UPDATE);
 
 		rho2 = rho1;
 
 		resid = blas::nrm2(N, r) / nrmb;
+		probe.stop(SOLVER_PHASE_DOT);
+		probe.iteration(l, resid);
 
 		if (resid < eps) {
 			eps = resid;
 			nsteps = l;
 			delete[] v;
-			return 0;
+			return probe.finished(0, l, eps);
 		}
 
 		if (fabs(omega) < D_PREC) {
 			eps = resid;
 			delete[] v;
-			return 3;
+			return probe.finished(3, l, eps);
 		}
 	}
 
 	eps = resid;
 	delete[] v;
-	return 1;
+	return probe.finished(1, nsteps, eps);
 }
 
 } // end namespace MathLib
@@ -14,8 +14,23 @@
 
 namespace MathLib {
 
+class SolverObserver;
+
+/**
+ * Preconditioned BiCGStab method.
+ * @param observer optional observer, see CG()
+ * @return 0 in case of convergence, 1 if the maximal number of iterations is
+ * reached, 2 or 3 in case of a breakdown
+ */
 unsigned BiCGStab(CRSMatrix<double, unsigned> const& A, double* const b, double* const x,
-                  double& eps, unsigned& nsteps);
+                  double& eps, unsigned& nsteps, SolverObserver* observer = NULL);
+
+/**
+ * Mixed precision iterative refinement with Jacobi preconditioned BiCGStab
+ * as inner solver, see CGMixedPrecision().
+ */
+unsigned BiCGStabMixedPrecision(CRSMatrix<double,unsigned> const& A, double const* const b,
+		double* const x, double& eps, unsigned& nsteps, double inner_eps = 1e-4);
 
 } // end namespace MathLib
 
@@ -0,0 +1,180 @@
+/*
+ * BiCGStabTemplate.h
+ *
+ *  Created on: Feb 6, 2012
+ *      Author: TF
+ */
+
+#ifndef BICGSTABTEMPLATE_H_
+#define BICGSTABTEMPLATE_H_
+
+#include <cmath>
+
+#include "blas.h"
+#include "SolverWorkspace.h"
+#include "SolverObserver.h"
+
+namespace MathLib {
+
+/**
+ * Preconditioned BiCGStab method. In contrast to
+ * BiCGStab(CRSMatrix<double,unsigned> const&, ...) the matrix and the
+ * preconditioner are template parameters and the work vectors are taken from
+ * a workspace, i.e. the method does not allocate memory if the workspace is
+ * large enough (8 vectors). The requirements on MATRIX and PRECOND and the
+ * meaning of the parameters are the same as for CG(MATRIX const&, PRECOND
+ * const&, FP_TYPE const*, FP_TYPE*, double&, unsigned&, SolverWorkspace<FP_TYPE>&,
+ * SolverObserver*).
+ * @return 0 in case of convergence, 1 if the maximal number of iterations is
+ * reached, 2 or 3 in case of a breakdown
+ */
+template <typename MATRIX, typename PRECOND, typename FP_TYPE>
+unsigned BiCGStab(MATRIX const& A, PRECOND const& precond, FP_TYPE const* const b,
+		FP_TYPE* const x, double& eps, unsigned& nsteps, SolverWorkspace<FP_TYPE>& work,
+		SolverObserver* observer = NULL)
+{
+	const unsigned N(A.getNRows());
+	SolverProbe probe(observer);
+	FP_TYPE *v(work.getVectors(8, N));
+	FP_TYPE *p(v + N);
+	FP_TYPE *phat(p + N);
+	FP_TYPE *s(phat + N);
+	FP_TYPE *shat(s + N);
+	FP_TYPE *t(shat + N);
+	FP_TYPE *r(t + N);
+	FP_TYPE *r0(r + N);
+	const FP_TYPE one(static_cast<FP_TYPE>(1.0));
+
+	// normb = |b|
+	double nrmb(blas::nrm2(N, b));
+	if (nrmb < D_PREC) nrmb = D_ONE;
+
+	// r = r0 = b - A x0
+	A.amux(-one, x, r0);
+	blas::axpy(N, one, b, r0);
+	blas::copy(N, r0, r);
+
+	double resid(blas::nrm2(N, r) / nrmb);
+	if (resid < eps) {
+		eps = resid;
+		nsteps = 0;
+		return probe.finished(0, 0, eps);
+	}
+
+	double alpha(D_ZERO), omega(D_ZERO), rho2(D_ZERO);
+
+	for (unsigned l = 1; l <= nsteps; ++l) {
+		// rho1 = r0 * r
+		probe.start();
+		const double rho1(blas::scpr(N, r0, r));
+		probe.stop(SOLVER_PHASE_DOT);
+		if (fabs(rho1) < D_PREC) {
+			eps = blas::nrm2(N, r) / nrmb;
+			nsteps = l;
+			return probe.finished(2, l, eps);
+		}
+
+		if (l == 1)
+			blas::copy(N, r, p); // p = r
+		else {
+			// p = (p-omega v)*beta+r
+			const FP_TYPE beta(static_cast<FP_TYPE>(rho1 * alpha / (rho2 * omega)));
+			const FP_TYPE omega_f(static_cast<FP_TYPE>(omega));
+			for (unsigned k(0); k < N; k++) {
+				p[k] = (p[k] - omega_f * v[k]) * beta + r[k];
+			}
+		}
+
+		// p^ = C p
+		blas::copy(N, p, phat);
+		probe.stop(SOLVER_PHASE_UPDATE);
+		precond.precondApply(phat);
+		probe.stop(SOLVER_PHASE_PRECOND);
+		// v = A p^
+		A.amux(one, phat, v);
+		probe.stop(SOLVER_PHASE_SPMV);
+
+		alpha = rho1 / blas::scpr(N, r0, v);
+		const FP_TYPE alpha_f(static_cast<FP_TYPE>(alpha));
+		probe.stop(SOLVER_PHASE_DOT);
+
+		// s = r - alpha v
+		double ss(0.0);
+		for (unsigned k(0); k < N; k++) {
+			s[k] = r[k] - alpha_f * v[k];
+			ss += s[k] * s[k];
+		}
+
+		resid = sqrt(ss) / nrmb;
+		probe.stop(SOLVER_PHASE_UPDATE);
+		if (resid < eps) {
+			// x += alpha p^
+			blas::axpy(N, alpha_f, phat, x);
+			probe.stop(SOLVER_PHASE_UPDATE);
+			probe.iteration(l, resid);
+			eps = resid;
+			nsteps = l;
+			return probe.finished(0, l, eps);
+		}
+
+		// s^ = C s
+		blas::copy(N, s, shat);
+		probe.stop(SOLVER_PHASE_UPDATE);
+		precond.precondApply(shat);
+		probe.stop(SOLVER_PHASE_PRECOND);
+
+		// t = A s^
+		A.amux(one, shat, t);
+		probe.stop(SOLVER_PHASE_SPMV);
+
+		// omega = t*s / t*t
+		omega = blas::scpr(N, t, s) / blas::scpr(N, t, t);
+		const FP_TYPE omega_f(static_cast<FP_TYPE>(omega));
+		probe.stop(SOLVER_PHASE_DOT);
+
+		// x += alpha p^ + omega s^, r = s - omega t
+		double rr(0.0);
+		for (unsigned k(0); k < N; k++) {
+			x[k] += alpha_f * phat[k] + omega_f * shat[k];
+			r[k] = s[k] - omega_f * t[k];
+			rr += r[k] * r[k];
+		}
+
+		rho2 = rho1;
+
+		resid = sqrt(rr) / nrmb;
+		probe.stop(SOLVER_PHASE_UPDATE);
+		probe.iteration(l, resid);
+
+		if (resid < eps) {
+			eps = resid;
+			nsteps = l;
+			return probe.finished(0, l, eps);
+		}
+
+		if (fabs(omega) < D_PREC) {
+			eps = resid;
+			nsteps = l;
+			return probe.finished(3, l, eps);
+		}
+	}
+
+	eps = resid;
+	return probe.finished(1, nsteps, eps);
+}
+
+/**
+ * Preconditioned BiCGStab method, where the matrix object is used as
+ * preconditioner, see BiCGStab(MATRIX const&, PRECOND const&, FP_TYPE const*,
+ * FP_TYPE*, double&, unsigned&, SolverWorkspace<FP_TYPE>&, SolverObserver*).
+ */
+template <typename MATRIX, typename FP_TYPE>
+unsigned BiCGStab(MATRIX const& A, FP_TYPE const* const b, FP_TYPE* const x, double& eps,
+		unsigned& nsteps, SolverWorkspace<FP_TYPE>& work, SolverObserver* observer = NULL)
+{
+	return BiCGStab(A, A, b, x, eps, nsteps, work, observer);
+}
+
+} // end namespace MathLib
+
+#endif /* BICGSTABTEMPLATE_H_ */
@@ -0,0 +1,495 @@
+/*
+ * BlockKrylovTemplate.h
+ *
+ *  Created on: Feb 22, 2012
+ *      Author: TF
+ */
+
+#ifndef BLOCKKRYLOVTEMPLATE_H_
+#define BLOCKKRYLOVTEMPLATE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+#include "blas.h"
+#include "SolverWorkspace.h"
+#include "SolverObserver.h"
+
+namespace MathLib {
+
+namespace BlockKrylovDetail {
+
+/** minimal length of the segments the block vectors are processed in */
+const std::size_t SEGMENT_LENGTH = 64;
+
+/**
+ * The blocks of k vectors are stored row by row, i.e. entry j of the flat
+ * array belongs to vector j % k. The loops of the solvers run over segments of
+ * L entries (L a multiple of k) of the flat arrays, the coefficients of the
+ * vectors are expanded to the length of a segment and the column wise sums
+ * are accumulated in L partial sums. Thus the innermost loops are contiguous
+ * and vectorizable for every k.
+ * @return the length L of the segments
+ */
+inline std::size_t segmentLength(unsigned k)
+{
+	return ((SEGMENT_LENGTH + k - 1) / k) * k;
+}
+
+/**
+ * c_exp[j] = c[j % k] for j = 0, ..., L-1
+ */
+template <typename T>
+void expand(unsigned k, std::size_t L, T const* const c, T* c_exp)
+{
+	for (std::size_t j(0); j < L; j++)
+		c_exp[j] = c[j % k];
+}
+
+/**
+ * s[q] = sum of the partial sums s_exp[j] with j % k == q
+ */
+inline void fold(unsigned k, std::size_t L, double const* const s_exp, double* s)
+{
+	for (unsigned q(0); q < k; q++)
+		s[q] = 0.0;
+	for (std::size_t j(0); j < L; j++)
+		s[j % k] += s_exp[j];
+}
+
+/**
+ * column wise scalar products s[q] = X_q * Y_q of two blocks (Nk entries),
+ * s_exp is a buffer of length L
+ */
+template <typename FP_TYPE>
+void scpr(unsigned k, std::size_t L, std::size_t Nk, FP_TYPE const* const X,
+		FP_TYPE const* const Y, double* s_exp, double* s)
+{
+	for (std::size_t j(0); j < L; j++)
+		s_exp[j] = 0.0;
+	for (std::size_t off(0); off < Nk; off += L) {
+		const std::size_t len(std::min(L, Nk - off));
+		FP_TYPE const*const x(X + off);
+		FP_TYPE const*const y(Y + off);
+		for (std::size_t j(0); j < len; j++)
+			s_exp[j] += x[j] * y[j];
+	}
+	fold(k, L, s_exp, s);
+}
+
+/**
+ * @return the number of columns with active[q] != 0
+ */
+inline unsigned countActive(unsigned k, unsigned char const* const active)
+{
+	unsigned cnt(0);
+	for (unsigned q(0); q < k; q++)
+		if (active[q])
+			cnt++;
+	return cnt;
+}
+
+/**
+ * @return the largest of the k residuals
+ */
+inline double maxResidual(unsigned k, double const* const resid)
+{
+	double r(0.0);
+	for (unsigned q(0); q < k; q++)
+		r = std::max(r, resid[q]);
+	return r;
+}
+
+} // end namespace BlockKrylovDetail
+
+/**
+ * Preconditioned Conjugate Gradient method for k right hand sides at once.
+ * The k systems \f$A x_q = b_q\f$ are solved by k CG iterations running in
+ * lock step: the vectors are stored as blocks row by row (entry i of vector q
+ * at position i*k+q) and the matrix is applied to all search directions by
+ * one call of amuxBlock(), i.e. the matrix is read once per iteration for
+ * all right hand sides. The scalars of the iterations are computed column
+ * wise, the iterates equal the iterates of k separate CG runs. A column whose
+ * residual is small enough is frozen, the iteration stops when all columns
+ * have converged.
+ *
+ * @param mat the matrix, MATRIX has to provide getNRows() and
+ * amuxBlock(FP_TYPE d, unsigned k, FP_TYPE const* X, FP_TYPE* Y) computing
+ * Y = d A X (see CRSOperator)
+ * @param precond the preconditioner, PRECOND has to provide
+ * precondApplyBlock(unsigned k, FP_TYPE* X) const applying the preconditioner
+ * to every vector of the block
+ * @param k number of right hand sides
+ * @param B the right hand sides (n x k block)
+ * @param X start vectors (input) and approximate solutions (output), n x k block
+ * @param eps required relative accuracy for every column (input), the largest
+ * reached relative accuracy (output)
+ * @param nsteps maximal number of iterations (input), number of performed
+ * iterations (output)
+ * @param work workspace for the work vectors (4 blocks of n x k entries)
+ * @param observer optional observer (see SolverObserver), the residual
+ * given to SolverObserver::iteration() is the largest residual of the columns
+ * @return 0 in case of convergence of all columns, 1 otherwise
+ */
+template <typename MATRIX, typename PRECOND, typename FP_TYPE>
+unsigned BlockCG(MATRIX const& mat, PRECOND const& precond, unsigned k,
+		FP_TYPE const* const B, FP_TYPE* const X, double& eps, unsigned& nsteps,
+		SolverWorkspace<FP_TYPE>& work, SolverObserver* observer = NULL)
+{
+	using BlockKrylovDetail::countActive;
+	using BlockKrylovDetail::expand;
+	using BlockKrylovDetail::fold;
+	using BlockKrylovDetail::maxResidual;
+	SolverProbe probe(observer);
+
+	const std::size_t N(mat.getNRows());
+	const std::size_t Nk(N * k);
+	const std::size_t L(BlockKrylovDetail::segmentLength(k));
+	FP_TYPE *P(work.getVectors(4, Nk));
+	FP_TYPE *Q(P + Nk);
+	FP_TYPE *R(Q + Nk);
+	FP_TYPE *Rhat(R + Nk);
+
+	// scalars of the k iterations and their expansions to a segment
+	double *nrmb(new double[5 * k + L]);
+	double *resid(nrmb + k);
+	double *rho(resid + k);
+	double *rho1(rho + k);
+	double *pq(rho1 + k);
+	double *s_exp(pq + k);
+	unsigned char *active(new unsigned char[k]);
+	FP_TYPE *alpha(new FP_TYPE[k + L]);
+	FP_TYPE *c_exp(alpha + k);
+
+	BlockKrylovDetail::scpr(k, L, Nk, B, B, s_exp, nrmb);
+	for (unsigned q(0); q < k; q++) {
+		nrmb[q] = sqrt(nrmb[q]);
+		if (nrmb[q] < std::numeric_limits<FP_TYPE>::epsilon()) {
+			// b_q = 0, the solution is 0
+			for (std::size_t i(0); i < N; i++)
+				X[i * k + q] = 0.0;
+			nrmb[q] = 1.0;
+		}
+	}
+
+	// R = B - A X
+	mat.amuxBlock(static_cast<FP_TYPE>(-1.0), k, X, R);
+	blas::axpy(Nk, static_cast<FP_TYPE>(1.0), B, R);
+
+	BlockKrylovDetail::scpr(k, L, Nk, R, R, s_exp, resid);
+	for (unsigned q(0); q < k; q++) {
+		resid[q] = sqrt(resid[q]) / nrmb[q];
+		active[q] = resid[q] > eps;
+	}
+
+	unsigned l(1);
+	for (; l <= nsteps && countActive(k, active) > 0; ++l) {
+		// R^ = C R
+		probe.start();
+		blas::copy(Nk, R, Rhat);
+		probe.stop(SOLVER_PHASE_UPDATE);
+		precond.precondApplyBlock(k, Rhat);
+		probe.stop(SOLVER_PHASE_PRECOND);
+
+		// rho = R * R^
+		BlockKrylovDetail::scpr(k, L, Nk, R, Rhat, s_exp, rho);
+		probe.stop(SOLVER_PHASE_DOT);
+
+		if (l > 1) {
+			// P = R^ + beta * P
+			FP_TYPE *beta(alpha);
+			for (unsigned q(0); q < k; q++)
+				beta[q] = active[q] ? static_cast<FP_TYPE>(rho[q] / rho1[q]) : 0.0;
+			expand(k, L, beta, c_exp);
+			for (std::size_t off(0); off < Nk; off += L) {
+				const std::size_t len(std::min(L, Nk - off));
+				FP_TYPE *p(P + off);
+				FP_TYPE const*const rhat(Rhat + off);
+				for (std::size_t j(0); j < len; j++)
+					p[j] = rhat[j] + c_exp[j] * p[j];
+			}
+		} else blas::copy(Nk, Rhat, P);
+		probe.stop(SOLVER_PHASE_UPDATE);
+
+		// Q = A P
+		mat.amuxBlock(static_cast<FP_TYPE>(1.0), k, P, Q);
+		probe.stop(SOLVER_PHASE_SPMV);
+
+		// alpha = rho / P*Q, the frozen columns are not changed
+		BlockKrylovDetail::scpr(k, L, Nk, P, Q, s_exp, pq);
+		for (unsigned q(0); q < k; q++)
+			alpha[q] = active[q] ? static_cast<FP_TYPE>(rho[q] / pq[q]) : 0.0;
+		expand(k, L, alpha, c_exp);
+		probe.stop(SOLVER_PHASE_DOT);
+
+		// X += alpha * P, R -= alpha * Q
+		for (std::size_t j(0); j < L; j++)
+			s_exp[j] = 0.0;
+		for (std::size_t off(0); off < Nk; off += L) {
+			const std::size_t len(std::min(L, Nk - off));
+			FP_TYPE *x(X + off);
+			FP_TYPE *r(R + off);
+			FP_TYPE const*const p(P + off);
+			FP_TYPE const*const q(Q + off);
+			for (std::size_t j(0); j < len; j++) {
+				x[j] += c_exp[j] * p[j];
+				r[j] -= c_exp[j] * q[j];
+				s_exp[j] += r[j] * r[j];
+			}
+		}
+		fold(k, L, s_exp, resid);
+
+		for (unsigned q(0); q < k; q++) {
+			resid[q] = sqrt(resid[q]) / nrmb[q];
+			if (resid[q] <= eps)
+				active[q] = 0;
+			rho1[q] = rho[q];
+		}
+		probe.stop(SOLVER_PHASE_UPDATE);
+		probe.iteration(l, maxResidual(k, resid));
+	}
+
+	const unsigned n_active(countActive(k, active));
+	eps = maxResidual(k, resid);
+	nsteps = l - 1;
+
+	delete [] nrmb;
+	delete [] active;
+	delete [] alpha;
+
+	return probe.finished(n_active == 0 ? 0 : 1, nsteps, eps);
+}
+
+/**
+ * Preconditioned BiCGStab method for k right hand sides at once, the k
+ * iterations run in lock step (see BlockCG()), such that both matrix vector
+ * multiplications of a step read the matrix once for all right hand sides.
+ * A column that converged (or broke down) is frozen. The requirements on
+ * MATRIX and PRECOND and the meaning of the parameters are the same as for
+ * BlockCG(), the workspace has to hold 8 blocks of n x k entries.
+ * @return 0 in case of convergence of all columns, 1 if the maximal number of
+ * iterations is reached, 2 or 3 in case of a breakdown in a column
+ */
+template <typename MATRIX, typename PRECOND, typename FP_TYPE>
+unsigned BlockBiCGStab(MATRIX const& A, PRECOND const& precond, unsigned k,
+		FP_TYPE const* const B, FP_TYPE* const X, double& eps, unsigned& nsteps,
+		SolverWorkspace<FP_TYPE>& work, SolverObserver* observer = NULL)
+{
+	using BlockKrylovDetail::countActive;
+	using BlockKrylovDetail::expand;
+	using BlockKrylovDetail::fold;
+	using BlockKrylovDetail::maxResidual;
+	SolverProbe probe(observer);
+
+	const std::size_t N(A.getNRows());
+	const std::size_t Nk(N * k);
+	const std::size_t L(BlockKrylovDetail::segmentLength(k));
+	FP_TYPE *V(work.getVectors(8, Nk));
+	FP_TYPE *P(V + Nk);
+	FP_TYPE *Phat(P + Nk);
+	FP_TYPE *S(Phat + Nk);
+	FP_TYPE *Shat(S + Nk);
+	FP_TYPE *T(Shat + Nk);
+	FP_TYPE *R(T + Nk);
+	FP_TYPE *R0(R + Nk);
+	const FP_TYPE one(static_cast<FP_TYPE>(1.0));
+
+	// scalars of the k iterations and their expansions to a segment
+	double *nrmb(new double[9 * k + L]);
+	double *resid(nrmb + k);
+	double *rho1(resid + k);
+	double *rho2(rho1 + k);
+	double *alpha(rho2 + k);
+	double *omega(alpha + k);
+	double *tmp(omega + k);
+	double *ts(tmp + k);
+	double *tt(ts + k);
+	double *s_exp(tt + k);
+	unsigned char *active(new unsigned char[k]);
+	FP_TYPE *c0(new FP_TYPE[2 * (k + L)]);
+	FP_TYPE *c1(c0 + k);
+	FP_TYPE *c0_exp(c1 + k);
+	FP_TYPE *c1_exp(c0_exp + L);
+	unsigned ret(0);
+
+	BlockKrylovDetail::scpr(k, L, Nk, B, B, s_exp, nrmb);
+	for (unsigned q(0); q < k; q++) {
+		nrmb[q] = sqrt(nrmb[q]);
+		if (nrmb[q] < D_PREC) nrmb[q] = D_ONE;
+	}
+
+	// R = R0 = B - A X
+	A.amuxBlock(-one, k, X, R0);
+	blas::axpy(Nk, one, B, R0);
+	blas::copy(Nk, R0, R);
+
+	BlockKrylovDetail::scpr(k, L, Nk, R, R, s_exp, resid);
+	for (unsigned q(0); q < k; q++) {
+		resid[q] = sqrt(resid[q]) / nrmb[q];
+		active[q] = resid[q] >= eps;
+		alpha[q] = omega[q] = rho2[q] = 0.0;
+	}
+
+	unsigned l(1);
+	for (; l <= nsteps && countActive(k, active) > 0; ++l) {
+		// rho1 = R0 * R
+		probe.start();
+		BlockKrylovDetail::scpr(k, L, Nk, R0, R, s_exp, rho1);
+		for (unsigned q(0); q < k; q++) {
+			if (active[q] && fabs(rho1[q]) < D_PREC) {
+				active[q] = 0;
+				ret = 2;
+			}
+		}
+		probe.stop(SOLVER_PHASE_DOT);
+
+		if (l == 1)
+			blas::copy(Nk, R, P); // P = R
+		else {
+			// P = (P - omega V) * beta + R
+			for (unsigned q(0); q < k; q++) {
+				c0[q] = active[q] ? static_cast<FP_TYPE>(rho1[q] * alpha[q] / (rho2[q] * omega[q])) : 0.0;
+				c1[q] = static_cast<FP_TYPE>(omega[q]);
+			}
+			expand(k, L, c0, c0_exp);
+			expand(k, L, c1, c1_exp);
+			for (std::size_t off(0); off < Nk; off += L) {
+				const std::size_t len(std::min(L, Nk - off));
+				FP_TYPE *p(P + off);
+				FP_TYPE const*const v(V + off);
+				FP_TYPE const*const r(R + off);
+				for (std::size_t j(0); j < len; j++)
+					p[j] = (p[j] - c1_exp[j] * v[j]) * c0_exp[j] + r[j];
+			}
+		}
+
+		// P^ = C P
+		blas::copy(Nk, P, Phat);
+		probe.stop(SOLVER_PHASE_UPDATE);
+		precond.precondApplyBlock(k, Phat);
+		probe.stop(SOLVER_PHASE_PRECOND);
+		// V = A P^
+		A.amuxBlock(one, k, Phat, V);
+		probe.stop(SOLVER_PHASE_SPMV);
+
+		BlockKrylovDetail::scpr(k, L, Nk, R0, V, s_exp, tmp);
+		for (unsigned q(0); q < k; q++) {
+			alpha[q] = active[q] ? rho1[q] / tmp[q] : 0.0;
+			c0[q] = static_cast<FP_TYPE>(alpha[q]);
+		}
+		expand(k, L, c0, c0_exp);
+		probe.stop(SOLVER_PHASE_DOT);
+
+		// S = R - alpha V
+		for (std::size_t j(0); j < L; j++)
+			s_exp[j] = 0.0;
+		for (std::size_t off(0); off < Nk; off += L) {
+			const std::size_t len(std::min(L, Nk - off));
+			FP_TYPE *s(S + off);
+			FP_TYPE const*const r(R + off);
+			FP_TYPE const*const v(V + off);
+			for (std::size_t j(0); j < len; j++) {
+				s[j] = r[j] - c0_exp[j] * v[j];
+				s_exp[j] += s[j] * s[j];
+			}
+		}
+		fold(k, L, s_exp, tmp);
+
+		// columns converged after the half step: x_q += alpha p^_q, the
+		// second half of the step does not change these columns
+		unsigned n_half(0);
+		for (unsigned q(0); q < k; q++) {
+			c1[q] = 0.0;
+			if (active[q] && sqrt(tmp[q]) / nrmb[q] < eps) {
+				resid[q] = sqrt(tmp[q]) / nrmb[q];
+				c1[q] = c0[q];
+				c0[q] = 0.0;
+				active[q] = 0;
+				n_half++;
+			}
+		}
+		if (n_half > 0) {
+			expand(k, L, c0, c0_exp);
+			expand(k, L, c1, c1_exp);
+			for (std::size_t off(0); off < Nk; off += L) {
+				const std::size_t len(std::min(L, Nk - off));
+				FP_TYPE *x(X + off);
+				FP_TYPE const*const phat(Phat + off);
+				for (std::size_t j(0); j < len; j++)
+					x[j] += c1_exp[j] * phat[j];
+			}
+		}
+		probe.stop(SOLVER_PHASE_UPDATE);
+
+		// S^ = C S
+		blas::copy(Nk, S, Shat);
+		probe.stop(SOLVER_PHASE_UPDATE);
+		precond.precondApplyBlock(k, Shat);
+		probe.stop(SOLVER_PHASE_PRECOND);
+
+		// T = A S^
+		A.amuxBlock(one, k, Shat, T);
+		probe.stop(SOLVER_PHASE_SPMV);
+
+		// omega = T*S / T*T
+		BlockKrylovDetail::scpr(k, L, Nk, T, S, s_exp, ts);
+		BlockKrylovDetail::scpr(k, L, Nk, T, T, s_exp, tt);
+		for (unsigned q(0); q < k; q++) {
+			omega[q] = active[q] ? ts[q] / tt[q] : 0.0;
+			c1[q] = static_cast<FP_TYPE>(omega[q]);
+		}
+		expand(k, L, c1, c1_exp);
+		probe.stop(SOLVER_PHASE_DOT);
+
+		// X += alpha P^ + omega S^, R = S - omega T (only active columns)
+		for (std::size_t j(0); j < L; j++)
+			s_exp[j] = 0.0;
+		for (std::size_t off(0); off < Nk; off += L) {
+			const std::size_t len(std::min(L, Nk - off));
+			FP_TYPE *x(X + off);
+			FP_TYPE *r(R + off);
+			FP_TYPE const*const phat(Phat + off);
+			FP_TYPE const*const shat(Shat + off);
+			FP_TYPE const*const s(S + off);
+			FP_TYPE const*const t(T + off);
+			for (std::size_t j(0); j < len; j++) {
+				x[j] += c0_exp[j] * phat[j] + c1_exp[j] * shat[j];
+				r[j] = s[j] - c1_exp[j] * t[j];
+				s_exp[j] += r[j] * r[j];
+			}
+		}
+		fold(k, L, s_exp, tmp);
+
+		for (unsigned q(0); q < k; q++) {
+			if (!active[q])
+				continue;
+			rho2[q] = rho1[q];
+			resid[q] = sqrt(tmp[q]) / nrmb[q];
+			if (resid[q] < eps)
+				active[q] = 0;
+			else if (fabs(omega[q]) < D_PREC) {
+				active[q] = 0;
+				ret = 3;
+			}
+		}
+		probe.stop(SOLVER_PHASE_UPDATE);
+		probe.iteration(l, maxResidual(k, resid));
+	}
+
+	if (ret == 0 && countActive(k, active) > 0)
+		ret = 1;
+	eps = maxResidual(k, resid);
+	nsteps = l - 1;
+
+	delete [] nrmb;
+	delete [] active;
+	delete [] c0;
+
+	return probe.finished(ret, nsteps, eps);
+}
+
+} // end namespace MathLib
+
+#endif /* BLOCKKRYLOVTEMPLATE_H_ */
@@ -11,6 +11,7 @@
 #include "blas.h"
 #include "../Sparse/CRSMatrix.h"
 #include "../Sparse/CRSMatrixDiagPrecond.h"
+#include "SolverObserver.h"
 
 // CG solves the symmetric positive definite linear
 // system Ax=b using the Conjugate Gradient method.
@@ -28,10 +29,11 @@
 namespace MathLib {
 
 unsigned CG(CRSMatrix<double,unsigned> const * mat, double const * const b,
-		double* const x, double& eps, unsigned& nsteps)
+		double* const x, double& eps, unsigned& nsteps, SolverObserver* observer)
 {
 	unsigned N = mat->getNRows();
 	double *p, *q, *r, *rhat, rho, rho1 = 0.0;
+	SolverProbe probe(observer);
 
 	p = new double[4* N];
 	q = p + N;
@@ -44,11 +46,11 @@ unsigned CG(CRSMatrix<double,unsigned> const * mat, double const * const b,
 		eps = 0.0;
 		nsteps = 0;
 		delete[] p;
-		return 0;
+		return probe.finished(0, 0, 0.0);
 	}
 
 	// r0 = b - Ax0
-	mat->amux(D_MONE, x, r);
+	mat->amux(D_ONE, x, r);
 	for (unsigned k(0); k < N; k++) {
 		r[k] = b[k] - r[k];
 	}
@@ -58,19 +60,20 @@ unsigned CG(CRSMatrix<double,unsigned> const * mat, double const * const b,
 		eps = resid / nrmb;
 		nsteps = 0;
 		delete[] p;
-		return 0;
+		return probe.finished(0, 0, eps);
 	}
 
 	for (unsigned l = 1; l <= nsteps; ++l) {
-#ifndef NDEBUG
-		std::cout << "Step " << l << ", resid=" << resid / nrmb << std::endl;
-#endif
 		// r^ = C r
+		probe.start();
 		blas::copy(N, r, rhat);
+		probe.stop(SOLVER_PHASE_UPDATE);
 		mat->precondApply(rhat);
+		probe.stop(SOLVER_PHASE_PRECOND);
 
 		// rho = r * r^;
 		rho = scpr(r, rhat, N); // num_threads);
+		probe.stop(SOLVER_PHASE_DOT);
 
 		if (l > 1) {
 			double beta = rho / rho1;
@@ -80,34 +83,40 @@ unsigned CG(CRSMatrix<double,unsigned> const * mat, double const * const b,
 				p[k] = rhat[k] + beta * p[k];
 			}
 		} else blas::copy(N, rhat, p);
+		probe.stop(SOLVER_PHASE_UPDATE);
 
 		// q = Ap
 		blas::setzero(N, q);
 		mat->amux(D_ONE, p, q);
+		probe.stop(SOLVER_PHASE_SPMV);
 
 		// alpha = rho / p*q
 		double alpha = rho / scpr(p, q, N);
+		probe.stop(SOLVER_PHASE_DOT);
 
 		// x += alpha * p
 		blas::axpy(N, alpha, p, x);
 
 		// r -= alpha * q
 		blas::axpy(N, -alpha, q, r);
+		probe.stop(SOLVER_PHASE_UPDATE);
 
 		resid = sqrt(scpr(r, r, N));
+		probe.stop(SOLVER_PHASE_DOT);
+		probe.iteration(l, resid / nrmb);
 
 		if (resid <= eps * nrmb) {
 			eps = resid / nrmb;
 			nsteps = l;
 			delete[] p;
-			return 0;
+			return probe.finished(0, l, eps);
 		}
 
 		rho1 = rho;
 	}
 	eps = resid / nrmb;
 	delete[] p;
-	return 1;
+	return probe.finished(1, nsteps, eps);
 }
 
 } // end namespace MathLib
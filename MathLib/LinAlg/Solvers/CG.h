@@ -8,17 +8,52 @@
 #ifndef CG_H_
 #define CG_H_
 
+#include <cstddef>
+
 namespace MathLib {
 
-// forward declaration
+// forward declarations
 template <typename PF_TYPE, typename IDX_TYPE> class CRSMatrix;
+class SolverObserver;
 
+/**
+ * Preconditioned Conjugate Gradient method.
+ * @param observer optional observer that is informed about every iteration
+ * and (if requested) accumulates the time of the phases of the iterations,
+ * see SolverObserver
+ */
 unsigned CG(CRSMatrix<double,unsigned> const * mat, double const * const b,
-		double* const x, double& eps, unsigned& nsteps);
+		double* const x, double& eps, unsigned& nsteps, SolverObserver* observer = NULL);
+
+/**
+ * Conjugate Gradient method in the formulation of Chronopoulos and Gear: the
+ * scalar products of an iteration are computed within a single reduction and
+ * the vector updates within a single loop, i.e. there are two passes over the
+ * vectors per iteration (additionally to the matrix vector multiplication
+ * and the application of the preconditioner). The parameters have the same
+ * meaning as for CG().
+ */
+unsigned CGPipelined(CRSMatrix<double,unsigned> const * mat, double const * const b,
+		double* const x, double& eps, unsigned& nsteps, SolverObserver* observer = NULL);
+
+/**
+ * Mixed precision iterative refinement with Jacobi preconditioned CG as inner
+ * solver: the inner iterations are performed in single precision, the
+ * residual and the update of the solution in double precision, i.e. the
+ * result has double precision accuracy. The preconditioner of the matrix
+ * object is not used. The parameters have the same meaning as for CG(),
+ * nsteps counts the inner iterations.
+ * @param inner_eps the relative accuracy of the inner solves
+ */
+unsigned CGMixedPrecision(CRSMatrix<double,unsigned> const * mat, double const * const b,
+		double* const x, double& eps, unsigned& nsteps, double inner_eps = 1e-4);
 
 #ifdef _OPENMP
+/**
+ * OpenMP parallelized version of CG(), the parameters have the same meaning.
+ */
 unsigned CGParallel(CRSMatrix<double,unsigned> const * mat, double const * const b,
-		double* const x, double& eps, unsigned& nsteps);
+		double* const x, double& eps, unsigned& nsteps, SolverObserver* observer = NULL);
 #endif
 
 } // end namespace MathLib
@@ -15,6 +15,7 @@
 #include "blas.h"
 #include "../Sparse/CRSMatrix.h"
 #include "../Sparse/CRSMatrixDiagPrecond.h"
+#include "SolverObserver.h"
 
 // CG solves the symmetric positive definite linear
 // system Ax=b using the Conjugate Gradient method.
@@ -33,7 +34,7 @@ namespace MathLib {
 
 #ifdef _OPENMP
 unsigned CGParallel(CRSMatrix<double,unsigned> const * mat, double const * const b,
-		double* const x, double& eps, unsigned& nsteps)
+		double* const x, double& eps, unsigned& nsteps, SolverObserver* observer)
 {
 	const unsigned N(mat->getNRows());
 	double * __restrict__ p(new double[N]);
@@ -41,6 +42,7 @@ unsigned CGParallel(CRSMatrix<double,unsigned> const * mat, double const * const
 	double * __restrict__ r(new double[N]);
 	double * __restrict__ rhat(new double[N]);
 	double rho, rho1 = 0.0;
+	SolverProbe probe(observer);
 
 	double nrmb = sqrt(scpr(b, b, N));
 
@@ -49,11 +51,14 @@ unsigned CGParallel(CRSMatrix<double,unsigned> const * mat, double const * const
 		eps = 0.0;
 		nsteps = 0;
 		delete[] p;
-		return 0;
+		delete[] q;
+		delete[] r;
+		delete[] rhat;
+		return probe.finished(0, 0, 0.0);
 	}
 
 	// r0 = b - Ax0
-	mat->amux(D_MONE, x, r);
+	mat->amux(D_ONE, x, r);
 	for (unsigned k(0); k < N; k++) {
 		r[k] = b[k] - r[k];
 	}
@@ -66,26 +71,26 @@ unsigned CGParallel(CRSMatrix<double,unsigned> const * mat, double const * const
 		delete[] q;
 		delete[] r;
 		delete[] rhat;
-		return 0;
+		return probe.finished(0, 0, eps);
 	}
 
 	OPENMP_LOOP_TYPE k;
 	for (unsigned l = 1; l <= nsteps; ++l) {
-#ifndef NDEBUG
-		std::cout << "Step " << l << ", resid=" << resid / nrmb << std::endl;
-#endif
-
 		// r^ = C r
+		probe.start();
 		// rhat = r
 //		blas::copy(N, r, rhat);
 		#pragma omp parallel for
 		for (k = 0; k < N; k++) {
 			rhat[k] = r[k];
 		}
+		probe.stop(SOLVER_PHASE_UPDATE);
 		mat->precondApply(rhat);
+		probe.stop(SOLVER_PHASE_PRECOND);
 
 		// rho = r * r^;
 		rho = scpr(r, rhat, N);
+		probe.stop(SOLVER_PHASE_DOT);
 
 		if (l > 1) {
 			double beta = rho / rho1;
@@ -101,12 +106,15 @@ unsigned CGParallel(CRSMatrix<double,unsigned> const * mat, double const * const
 				p[k] = rhat[k];
 			}
 		}
+		probe.stop(SOLVER_PHASE_UPDATE);
 
 		// q = Ap
 		mat->amux(D_ONE, p, q);
+		probe.stop(SOLVER_PHASE_SPMV);
 
 		// alpha = rho / p*q
 		double alpha = rho / scpr(p, q, N);
+		probe.stop(SOLVER_PHASE_DOT);
 
 		#pragma omp parallel
 		{
@@ -124,8 +132,11 @@ unsigned CGParallel(CRSMatrix<double,unsigned> const * mat, double const * const
 
 			#pragma omp barrier
 		} // end #pragma omp parallel
+		probe.stop(SOLVER_PHASE_UPDATE);
 
 		resid = sqrt(scpr(r, r, N));
+		probe.stop(SOLVER_PHASE_DOT);
+		probe.iteration(l, resid / nrmb);
 
 		if (resid <= eps * nrmb) {
 			eps = resid / nrmb;
@@ -134,7 +145,7 @@ unsigned CGParallel(CRSMatrix<double,unsigned> const * mat, double const * const
 			delete[] q;
 			delete[] r;
 			delete[] rhat;
-			return 0;
+			return probe.finished(0, l, eps);
 		}
 
 		rho1 = rho;
@@ -144,7 +155,7 @@ unsigned CGParallel(CRSMatrix<double,unsigned> const * mat, double const * const
 	delete[] q;
 	delete[] r;
 	delete[] rhat;
-	return 1;
+	return probe.finished(1, nsteps, eps);
 }
 #endif
 
@@ -0,0 +1,146 @@
+/*
+ * CGPipelined.cpp
+ *
+ *  Created on: Jan 23, 2012
+ *      Author: TF
+ */
+
+#include <limits>
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "MathTools.h"
+#include "blas.h"
+#include "CG.h"
+#include "../Sparse/CRSMatrix.h"
+#include "SolverObserver.h"
+
+// CGPipelined solves the symmetric positive definite linear system Ax=b
+// using the Conjugate Gradient method in the formulation of Chronopoulos
+// and Gear. In contrast to the classical formulation (see CG(), CGParallel())
+// the scalar products are computed together within one reduction per
+// iteration and all vector updates are fused into one loop:
+//
+// loop:
+//    p = u + beta p,  s = w + beta s,  x += alpha p,  r -= alpha s,  u = r
+//    u = C u
+//    w = A u
+//    gamma = (r, u),  delta = (w, u),  resid = sqrt((r, r))
+//    beta = gamma / gamma_old,  alpha = gamma / (delta - beta * gamma / alpha_old)
+//
+// The return value indicates convergence within max_iter (input)
+// iterations (0), or no convergence within max_iter iterations (1).
+//
+// Upon successful return, output arguments have the following values:
+//
+//      x  --  approximate solution to Ax = b
+// nsteps  --  the number of iterations performed before the
+//             tolerance was reached
+//    eps  --  the residual after the final iteration
+
+namespace MathLib {
+
+unsigned CGPipelined(CRSMatrix<double,unsigned> const * mat, double const * const b,
+		double* const x, double& eps, unsigned& nsteps, SolverObserver* observer)
+{
+	const unsigned N(mat->getNRows());
+	SolverProbe probe(observer);
+	double * const work(new double[5 * N]);
+	double * __restrict__ p(work);
+	double * __restrict__ s(p + N);
+	double * __restrict__ r(s + N);
+	double * __restrict__ u(r + N);
+	double * __restrict__ w(u + N);
+
+	double nrmb = sqrt(scpr(b, b, N));
+	if (nrmb < std::numeric_limits<double>::epsilon()) {
+		blas::setzero(N, x);
+		eps = 0.0;
+		nsteps = 0;
+		delete[] work;
+		return probe.finished(0, 0, 0.0);
+	}
+
+	// r0 = b - Ax0
+	mat->amux(D_ONE, x, r);
+	OPENMP_LOOP_TYPE k;
+	#pragma omp parallel for
+	for (k = 0; k < N; k++) {
+		r[k] = b[k] - r[k];
+		u[k] = r[k];
+		p[k] = 0.0;
+		s[k] = 0.0;
+	}
+
+	// u0 = C r0, w0 = A u0
+	mat->precondApply(u);
+	mat->amux(D_ONE, u, w);
+
+	double gamma(0.0), delta(0.0), rr(0.0);
+	#pragma omp parallel for reduction (+:gamma,delta,rr)
+	for (k = 0; k < N; k++) {
+		gamma += r[k] * u[k];
+		delta += w[k] * u[k];
+		rr += r[k] * r[k];
+	}
+
+	double resid = sqrt(rr);
+	if (resid <= eps * nrmb) {
+		eps = resid / nrmb;
+		nsteps = 0;
+		delete[] work;
+		return probe.finished(0, 0, eps);
+	}
+
+	double alpha(gamma / delta), beta(0.0);
+	for (unsigned l = 1; l <= nsteps; ++l) {
+		// one sweep for all vector updates
+		probe.start();
+		#pragma omp parallel for
+		for (k = 0; k < N; k++) {
+			p[k] = u[k] + beta * p[k];
+			s[k] = w[k] + beta * s[k];
+			x[k] += alpha * p[k];
+			r[k] -= alpha * s[k];
+			u[k] = r[k];
+		}
+		probe.stop(SOLVER_PHASE_UPDATE);
+
+		// u = C r, w = A u
+		mat->precondApply(u);
+		probe.stop(SOLVER_PHASE_PRECOND);
+		mat->amux(D_ONE, u, w);
+		probe.stop(SOLVER_PHASE_SPMV);
+
+		// one sweep / one reduction for all scalar products
+		const double gamma_old(gamma);
+		gamma = delta = rr = 0.0;
+		#pragma omp parallel for reduction (+:gamma,delta,rr)
+		for (k = 0; k < N; k++) {
+			gamma += r[k] * u[k];
+			delta += w[k] * u[k];
+			rr += r[k] * r[k];
+		}
+
+		resid = sqrt(rr);
+		probe.stop(SOLVER_PHASE_DOT);
+		probe.iteration(l, resid / nrmb);
+		if (resid <= eps * nrmb) {
+			eps = resid / nrmb;
+			nsteps = l;
+			delete[] work;
+			return probe.finished(0, l, eps);
+		}
+
+		beta = gamma / gamma_old;
+		alpha = gamma / (delta - beta * gamma / alpha);
+	}
+	eps = resid / nrmb;
+	delete[] work;
+	return probe.finished(1, nsteps, eps);
+}
+
+} // end namespace MathLib
@@ -0,0 +1,140 @@
+/*
+ * CGTemplate.h
+ *
+ *  Created on: Feb 6, 2012
+ *      Author: TF
+ */
+
+#ifndef CGTEMPLATE_H_
+#define CGTEMPLATE_H_
+
+#include <cmath>
+#include <limits>
+
+#include "blas.h"
+#include "SolverWorkspace.h"
+#include "SolverObserver.h"
+
+namespace MathLib {
+
+/**
+ * Preconditioned Conjugate Gradient method for symmetric positive definite
+ * systems. In contrast to CG(CRSMatrix<double,unsigned> const*, ...) the
+ * matrix and the preconditioner are template parameters and the work vectors
+ * are taken from a workspace, i.e. the method does not allocate memory if the
+ * workspace is large enough (4 vectors) and the calls of amux() and
+ * precondApply() can be inlined if they are not virtual.
+ *
+ * @param mat the matrix, MATRIX has to provide getNRows() and
+ * amux(FP_TYPE d, FP_TYPE const* x, FP_TYPE* y) computing y = d A x
+ * @param precond the preconditioner, PRECOND has to provide
+ * precondApply(FP_TYPE* x) const applying the preconditioner in place (a
+ * matrix object can be used as its own preconditioner)
+ * @param b right hand side
+ * @param x start vector (input) and approximate solution (output)
+ * @param eps required relative accuracy (input), reached accuracy (output)
+ * @param nsteps maximal number of iterations (input), number of performed
+ * iterations (output)
+ * @param work workspace for the work vectors
+ * @param observer optional observer, see SolverObserver
+ * @return 0 in case of convergence, 1 otherwise
+ */
+template <typename MATRIX, typename PRECOND, typename FP_TYPE>
+unsigned CG(MATRIX const& mat, PRECOND const& precond, FP_TYPE const* const b,
+		FP_TYPE* const x, double& eps, unsigned& nsteps, SolverWorkspace<FP_TYPE>& work,
+		SolverObserver* observer = NULL)
+{
+	const unsigned N(mat.getNRows());
+	SolverProbe probe(observer);
+	FP_TYPE *p(work.getVectors(4, N));
+	FP_TYPE *q(p + N);
+	FP_TYPE *r(q + N);
+	FP_TYPE *rhat(r + N);
+
+	const double nrmb(blas::nrm2(N, b));
+	if (nrmb < std::numeric_limits<FP_TYPE>::epsilon()) {
+		blas::setzero(N, x);
+		eps = 0.0;
+		nsteps = 0;
+		return probe.finished(0, 0, 0.0);
+	}
+
+	// r0 = b - A x0
+	mat.amux(static_cast<FP_TYPE>(-1.0), x, r);
+	blas::axpy(N, static_cast<FP_TYPE>(1.0), b, r);
+
+	double resid(blas::nrm2(N, r));
+	if (resid <= eps * nrmb) {
+		eps = resid / nrmb;
+		nsteps = 0;
+		return probe.finished(0, 0, eps);
+	}
+
+	double rho, rho1(0.0);
+	for (unsigned l = 1; l <= nsteps; ++l) {
+		// r^ = C r
+		probe.start();
+		blas::copy(N, r, rhat);
+		probe.stop(SOLVER_PHASE_UPDATE);
+		precond.precondApply(rhat);
+		probe.stop(SOLVER_PHASE_PRECOND);
+
+		// rho = r * r^
+		rho = blas::scpr(N, r, rhat);
+		probe.stop(SOLVER_PHASE_DOT);
+
+		if (l > 1) {
+			// p = r^ + beta * p
+			const FP_TYPE beta(static_cast<FP_TYPE>(rho / rho1));
+			for (unsigned k(0); k < N; k++) {
+				p[k] = rhat[k] + beta * p[k];
+			}
+		} else blas::copy(N, rhat, p);
+		probe.stop(SOLVER_PHASE_UPDATE);
+
+		// q = A p
+		mat.amux(static_cast<FP_TYPE>(1.0), p, q);
+		probe.stop(SOLVER_PHASE_SPMV);
+
+		// alpha = rho / p*q
+		const FP_TYPE alpha(static_cast<FP_TYPE>(rho / blas::scpr(N, p, q)));
+		probe.stop(SOLVER_PHASE_DOT);
+
+		// x += alpha * p, r -= alpha * q
+		double rr(0.0);
+		for (unsigned k(0); k < N; k++) {
+			x[k] += alpha * p[k];
+			r[k] -= alpha * q[k];
+			rr += r[k] * r[k];
+		}
+		resid = sqrt(rr);
+		probe.stop(SOLVER_PHASE_UPDATE);
+		probe.iteration(l, resid / nrmb);
+
+		if (resid <= eps * nrmb) {
+			eps = resid / nrmb;
+			nsteps = l;
+			return probe.finished(0, l, eps);
+		}
+
+		rho1 = rho;
+	}
+	eps = resid / nrmb;
+	return probe.finished(1, nsteps, eps);
+}
+
+/**
+ * Preconditioned Conjugate Gradient method, where the matrix object is used
+ * as preconditioner, see CG(MATRIX const&, PRECOND const&, FP_TYPE const*,
+ * FP_TYPE*, double&, unsigned&, SolverWorkspace<FP_TYPE>&, SolverObserver*).
+ */
+template <typename MATRIX, typename FP_TYPE>
+unsigned CG(MATRIX const& mat, FP_TYPE const* const b, FP_TYPE* const x, double& eps,
+		unsigned& nsteps, SolverWorkspace<FP_TYPE>& work, SolverObserver* observer = NULL)
+{
+	return CG(mat, mat, b, x, eps, nsteps, work, observer);
+}
+
+} // end namespace MathLib
+
+#endif /* CGTEMPLATE_H_ */
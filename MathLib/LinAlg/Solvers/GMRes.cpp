@@ -9,7 +9,9 @@
 
 #include <cmath>
 #include <limits>
+#include <algorithm>
 #include "blas.h"
+#include "SolverObserver.h"
 
 namespace MathLib {
 
@@ -36,6 +38,152 @@ inline void applPlRot(double& dx, double& dy, double cs, double sn)
 	dx = tmp;
 }
 
+/**
+ * number of rows of a block in the passes of the classical Gram-Schmidt, the
+ * rows of a block of all basis vectors should fit into the L2 cache, the
+ * segments should be long enough for the hardware prefetcher
+ */
+const size_t CGS_BLOCK_SIZE = 2048;
+/**
+ * number of partial sums per dot product in projectCGSBlock(), the partial
+ * sums are independent, such that the compiler can vectorize the loop
+ */
+const size_t CGS_LANES = 8;
+
+/**
+ * c = c + V^T w for the rows beg, ..., end-1 of the first k basis vectors
+ * (V is stored column by column, the leading dimension is n)
+ */
+static void projectCGSBlock(size_t n, size_t beg, size_t end, unsigned k,
+		double const*const V, double const*const w, double* c)
+{
+	const size_t end_lanes (beg + ((end - beg) / CGS_LANES) * CGS_LANES);
+	unsigned l(0);
+	// four basis vectors at once, every loaded entry of w is used four times
+	for (; l + 4 <= k; l += 4) {
+		double const*const v0 (V + l * n);
+		double const*const v1 (v0 + n);
+		double const*const v2 (v1 + n);
+		double const*const v3 (v2 + n);
+		double t[4][CGS_LANES];
+		for (size_t q(0); q < CGS_LANES; q++)
+			t[0][q] = t[1][q] = t[2][q] = t[3][q] = 0.0;
+		for (size_t r(beg); r < end_lanes; r += CGS_LANES) {
+			for (size_t q(0); q < CGS_LANES; q++) {
+				const double w_r (w[r + q]);
+				t[0][q] += v0[r + q] * w_r;
+				t[1][q] += v1[r + q] * w_r;
+				t[2][q] += v2[r + q] * w_r;
+				t[3][q] += v3[r + q] * w_r;
+			}
+		}
+		for (size_t r(end_lanes); r < end; r++) {
+			t[0][0] += v0[r] * w[r];
+			t[1][0] += v1[r] * w[r];
+			t[2][0] += v2[r] * w[r];
+			t[3][0] += v3[r] * w[r];
+		}
+		for (size_t q(0); q < CGS_LANES; q++) {
+			c[l] += t[0][q];
+			c[l + 1] += t[1][q];
+			c[l + 2] += t[2][q];
+			c[l + 3] += t[3][q];
+		}
+	}
+	for (; l < k; l++) {
+		double const*const v (V + l * n);
+		double tmp (0.0);
+		for (size_t r(beg); r < end; r++)
+			tmp += v[r] * w[r];
+		c[l] += tmp;
+	}
+}
+
+/**
+ * w = w - V c for the rows beg, ..., end-1 of the first k basis vectors
+ */
+static void correctCGSBlock(size_t n, size_t beg, size_t end, unsigned k,
+		double const*const V, double const*const c, double* w)
+{
+	unsigned l(0);
+	// four basis vectors at once, w is loaded and stored once for four vectors
+	for (; l + 4 <= k; l += 4) {
+		double const*const v0 (V + l * n);
+		double const*const v1 (v0 + n);
+		double const*const v2 (v1 + n);
+		double const*const v3 (v2 + n);
+		const double c0 (c[l]), c1 (c[l + 1]), c2 (c[l + 2]), c3 (c[l + 3]);
+		for (size_t r(beg); r < end; r++)
+			w[r] -= c0 * v0[r] + c1 * v1[r] + c2 * v2[r] + c3 * v3[r];
+	}
+	for (; l < k; l++) {
+		double const*const v (V + l * n);
+		const double c_l (c[l]);
+		for (size_t r(beg); r < end; r++)
+			w[r] -= c_l * v[r];
+	}
+}
+
+/**
+ * Passes of the classical Gram-Schmidt with reorthogonalization over the rows
+ * of the basis V (n x k, stored column by column). If h is NULL the
+ * projections c = V^T w are computed. Otherwise w = w - V h is computed and in
+ * the same pass (the rows of the block of V are still in the cache) the
+ * projections c = V^T w of the updated vector w for the reorthogonalization.
+ */
+static void projectCGS(size_t n, unsigned k, double const*const V, double const*const h,
+		double* w, double* c)
+{
+	const size_t n_blocks ((n + CGS_BLOCK_SIZE - 1) / CGS_BLOCK_SIZE);
+	for (unsigned l(0); l < k; l++)
+		c[l] = 0.0;
+
+#pragma omp parallel
+	{
+		double *c_local (new double[k]);
+		for (unsigned l(0); l < k; l++)
+			c_local[l] = 0.0;
+
+		OPENMP_LOOP_TYPE b;
+#pragma omp for nowait
+		for (b = 0; b < n_blocks; b++) {
+			const size_t beg (b * CGS_BLOCK_SIZE);
+			const size_t end (std::min(n, beg + CGS_BLOCK_SIZE));
+			if (h)
+				correctCGSBlock(n, beg, end, k, V, h, w);
+			projectCGSBlock(n, beg, end, k, V, w, c_local);
+		}
+
+#pragma omp critical
+		{
+			for (unsigned l(0); l < k; l++)
+				c[l] += c_local[l];
+		}
+		delete [] c_local;
+	}
+}
+
+/**
+ * computes w = w - V c in one pass over the rows of the basis V
+ * @return the square of the euclidean norm of the updated vector w
+ */
+static double correctCGS(size_t n, unsigned k, double const*const V, double const*const c, double* w)
+{
+	const size_t n_blocks ((n + CGS_BLOCK_SIZE - 1) / CGS_BLOCK_SIZE);
+	double nrm2 (0.0);
+
+	OPENMP_LOOP_TYPE b;
+#pragma omp parallel for reduction(+:nrm2)
+	for (b = 0; b < n_blocks; b++) {
+		const size_t beg (b * CGS_BLOCK_SIZE);
+		const size_t end (std::min(n, beg + CGS_BLOCK_SIZE));
+		correctCGSBlock(n, beg, end, k, V, c, w);
+		for (size_t r(beg); r < end; r++)
+			nrm2 += w[r] * w[r];
+	}
+	return nrm2;
+}
+
 // solve H y = s and update x += MVy
 static void update(const CRSMatrix<double,unsigned>& A, unsigned k, double* H,
 		unsigned ldH, double* s, double* V, double* x)
@@ -60,20 +208,23 @@ static void update(const CRSMatrix<double,unsigned>& A, unsigned k, double* H,
 }
 
 unsigned GMRes(const CRSMatrix<double,unsigned>& A, double* const b, double* const x,
-		double& eps, unsigned m, unsigned& nsteps)
+		double& eps, unsigned m, unsigned& nsteps, GMResOrthogonalization orth,
+		SolverObserver* observer)
 {
 	double resid;
+	SolverProbe probe(observer);
 	unsigned j = 1;
 
 	const size_t n (A.getNRows());
 
-	double *r = new double[2*n + (n + m + 4) * (m + 1)]; // n
+	double *r = new double[2*n + (n + m + 5) * (m + 1)]; // n
 	double *V = r + n; // n x (m+1)
 	double *H = V + n * (m + 1); // m+1 x m
 	double *cs = H + (m + 1) * m; // m+1
 	double *sn = cs + m + 1; // m+1
 	double *s = sn + m + 1; // m+1
-	double *xh = s + m + 1; // m+1
+	double *xh = s + m + 1; // n
+	double *c = xh + n; // m+1, corrections of the reorthogonalization
 
 	// normb = norm(b)
 	double normb = blas::nrm2(n, b);
@@ -82,12 +233,12 @@ unsigned GMRes(const CRSMatrix<double,unsigned>& A, double* const b, double* con
 		eps = 0.0;
 		nsteps = 0;
 		delete[] r;
-		return 0;
+		return probe.finished(0, 0, 0.0);
 	}
 
 	// r = b - Ax
-	blas::copy(n, b, r);
 	A.amux(D_MONE, x, r);
+	blas::axpy(n, D_ONE, b, r);
 
 	double beta = blas::nrm2(n, r);
 
@@ -95,12 +246,14 @@ unsigned GMRes(const CRSMatrix<double,unsigned>& A, double* const b, double* con
 		eps = resid;
 		nsteps = 0;
 		delete[] r;
-		return 0;
+		return probe.finished(0, 0, eps);
 	}
 
 	while (j <= nsteps) {
+		probe.start();
 		blas::copy(n, r, V); // v0 first orthonormal vector
 		blas::scal(n, 1.0 / beta, V);
+		probe.stop(SOLVER_PHASE_UPDATE);
 
 		s[0] = beta;
 		blas::setzero(m, s + 1);
@@ -108,18 +261,40 @@ unsigned GMRes(const CRSMatrix<double,unsigned>& A, double* const b, double* con
 		for (unsigned i = 0; i < m && j <= nsteps; i++, j++) {
 
 			// w = A M * v[i];
+			probe.start();
 			blas::copy(n, V + i * n, xh);
+			probe.stop(SOLVER_PHASE_UPDATE);
 			A.precondApply(xh);
+			probe.stop(SOLVER_PHASE_PRECOND);
 			blas::setzero(n, V + (i + 1) * n);
 			A.amux(D_ONE, xh, V + (i + 1) * n);
+			probe.stop(SOLVER_PHASE_SPMV);
 
-			for (unsigned k = 0; k <= i; k++) {
-				H[k + i * (m + 1)] = blas::scpr(n, V + (i + 1) * n, V + k * n);
-				blas::axpy(n, -H[k + i * (m + 1)], V + k * n, V + (i + 1) * n);
+			if (orth == GMRES_CGS2) {
+				// h = V^T w
+				projectCGS(n, i + 1, V, NULL, V + (i + 1) * n, H + i * (m + 1));
+				probe.stop(SOLVER_PHASE_DOT);
+				// w = w - V h and c = V^T w (the fused passes count as updates)
+				projectCGS(n, i + 1, V, H + i * (m + 1), V + (i + 1) * n, c);
+				// reorthogonalization w = w - V c
+				const double nrm2 (correctCGS(n, i + 1, V, c, V + (i + 1) * n));
+				probe.stop(SOLVER_PHASE_UPDATE);
+				for (unsigned k = 0; k <= i; k++)
+					H[k + i * (m + 1)] += c[k];
+				H[i * (m + 2) + 1] = sqrt(nrm2);
+			} else {
+				for (unsigned k = 0; k <= i; k++) {
+					H[k + i * (m + 1)] = blas::scpr(n, V + (i + 1) * n, V + k * n);
+					probe.stop(SOLVER_PHASE_DOT);
+					blas::axpy(n, -H[k + i * (m + 1)], V + k * n, V + (i + 1) * n);
+					probe.stop(SOLVER_PHASE_UPDATE);
+				}
+				H[i * (m + 2) + 1] = blas::nrm2(n, V + (i + 1) * n);
+				probe.stop(SOLVER_PHASE_DOT);
 			}
 
-			H[i * (m + 2) + 1] = blas::nrm2(n, V + (i + 1) * n);
 			blas::scal(n, 1.0 / H[i * (m + 2) + 1], V + (i + 1) * n);
+			probe.stop(SOLVER_PHASE_UPDATE);
 
 			// apply old Givens rotations to the last column in H
 			for (unsigned k = 0; k < i; k++)
@@ -132,36 +307,42 @@ unsigned GMRes(const CRSMatrix<double,unsigned>& A, double* const b, double* con
 			applPlRot(H[i * (m + 2)], H[i * (m + 2) + 1], cs[i], sn[i]);
 			applPlRot(s[i], s[i + 1], cs[i], sn[i]);
 
-			if ((resid = fabs(s[i + 1] / normb)) < eps) {
+			resid = fabs(s[i + 1] / normb);
+			probe.iteration(j, resid);
+			if (resid < eps) {
+				probe.start();
 				update(A, i + 1, H, m + 1, s, V, x);
+				probe.stop(SOLVER_PHASE_UPDATE);
 				eps = resid;
 				nsteps = j;
 				delete[] r;
-				return 0;
+				return probe.finished(0, j, eps);
 			}
-#ifndef NDEBUG
-			std::cout << "Step " << j << ", resid=" << resid << std::endl;
-#endif
 		}
 
+		// the update of x contains an application of the preconditioner
+		probe.start();
 		update(A, m, H, m + 1, s, V, x);
+		probe.stop(SOLVER_PHASE_UPDATE);
 
 		// r = b - A x;
-		blas::copy(n, b, r);
 		A.amux(D_MONE, x, r);
+		blas::axpy(n, D_ONE, b, r);
+		probe.stop(SOLVER_PHASE_SPMV);
 		beta = blas::nrm2(n, r);
+		probe.stop(SOLVER_PHASE_DOT);
 
 		if ((resid = beta / normb) < eps) {
 			eps = resid;
 			nsteps = j;
 			delete[] r;
-			return 0;
+			return probe.finished(0, j, eps);
 		}
 	}
 
 	eps = resid;
 	delete[] r;
-	return 1;
+	return probe.finished(1, nsteps, eps);
 }
 
 } // end namespace MathLib
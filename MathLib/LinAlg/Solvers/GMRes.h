@@ -12,8 +12,35 @@
 
 namespace MathLib {
 
+class SolverObserver;
+
+/**
+ * orthogonalization method of the Arnoldi process within GMRes
+ */
+enum GMResOrthogonalization {
+	GMRES_MGS, //!< modified Gram-Schmidt, a dot product and an axpy per basis vector
+	GMRES_CGS2 //!< classical Gram-Schmidt with one reorthogonalization
+};
+
+/**
+ * Restarted GMRes(m) method with right preconditioning.
+ *
+ * With GMRES_CGS2 all projections onto the basis vectors are computed in one
+ * pass over the basis and subtracted in a second pass; since classical
+ * Gram-Schmidt loses orthogonality this is repeated once. The subtraction and
+ * the projections of the reorthogonalization share a pass, i.e. the basis is
+ * read three times (modified Gram-Schmidt reads it twice, but needs two
+ * reductions per basis vector instead of two per step). The passes work on
+ * blocks of rows and are parallelized with OpenMP.
+ * @param m dimension of the Krylov subspace (restart parameter)
+ * @param orth the orthogonalization method
+ * @param observer optional observer, see CG()
+ * @return 0 in case of convergence, 1 otherwise
+ */
 unsigned GMRes(const CRSMatrix<double,unsigned>& mat, double* const b, double* const x,
-                        double& eps, unsigned m, unsigned& steps);
+                        double& eps, unsigned m, unsigned& steps,
+                        GMResOrthogonalization orth = GMRES_MGS,
+                        SolverObserver* observer = NULL);
 
 } // end namespace MathLib
 
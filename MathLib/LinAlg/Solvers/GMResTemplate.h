@@ -0,0 +1,212 @@
+/*
+ * GMResTemplate.h
+ *
+ *  Created on: Feb 6, 2012
+ *      Author: TF
+ */
+
+#ifndef GMRESTEMPLATE_H_
+#define GMRESTEMPLATE_H_
+
+#include <cmath>
+#include <limits>
+
+#include "blas.h"
+#include "SolverWorkspace.h"
+#include "SolverObserver.h"
+
+namespace MathLib {
+
+namespace GMResDetail {
+
+template <typename FP_TYPE>
+void genPlRot(FP_TYPE dx, FP_TYPE dy, FP_TYPE& cs, FP_TYPE& sn)
+{
+	if (dy <= std::numeric_limits<FP_TYPE>::epsilon()) {
+		cs = 1.0;
+		sn = 0.0;
+	} else if (fabs(dy) > fabs(dx)) {
+		const FP_TYPE tmp = dx / dy;
+		sn = 1.0 / sqrt(1.0 + tmp * tmp);
+		cs = tmp * sn;
+	} else {
+		const FP_TYPE tmp = dy / dx;
+		cs = 1.0 / sqrt(1.0 + tmp * tmp);
+		sn = tmp * cs;
+	}
+}
+
+template <typename FP_TYPE>
+inline void applPlRot(FP_TYPE& dx, FP_TYPE& dy, FP_TYPE cs, FP_TYPE sn)
+{
+	const FP_TYPE tmp = cs * dx + sn * dy;
+	dy = cs * dy - sn * dx;
+	dx = tmp;
+}
+
+// solve H y = s (H upper triangular k x k) and update x += M V y,
+// y has length k, xh length n
+template <typename PRECOND, typename FP_TYPE>
+void update(PRECOND const& precond, unsigned n, unsigned k, FP_TYPE const* H,
+		unsigned ldH, FP_TYPE const* s, FP_TYPE const* V, FP_TYPE* y, FP_TYPE* xh, FP_TYPE* x)
+{
+	for (unsigned i(k); i > 0; i--) {
+		FP_TYPE tmp(s[i - 1]);
+		for (unsigned j(i); j < k; j++)
+			tmp -= H[(i - 1) + j * ldH] * y[j];
+		y[i - 1] = tmp / H[(i - 1) + (i - 1) * ldH];
+	}
+
+	// x += M V y
+	blas::setzero(n, xh);
+	for (unsigned j(0); j < k; j++)
+		blas::axpy(n, y[j], V + j * n, xh);
+	precond.precondApply(xh);
+	blas::axpy(n, static_cast<FP_TYPE>(1.0), xh, x);
+}
+
+} // end namespace GMResDetail
+
+/**
+ * Restarted GMRes(m) method with right preconditioning. In contrast to
+ * GMRes(const CRSMatrix<double,unsigned>&, ...) the matrix and the
+ * preconditioner are template parameters and the work vectors are taken from
+ * a workspace, i.e. the method does not allocate memory if the workspace is
+ * large enough (2 n + (n + m + 4) (m + 1) entries). The requirements on
+ * MATRIX and PRECOND and the meaning of the parameters are the same as for
+ * CG(MATRIX const&, PRECOND const&, FP_TYPE const*, FP_TYPE*, double&,
+ * unsigned&, SolverWorkspace<FP_TYPE>&, SolverObserver*).
+ * @param m dimension of the Krylov subspace (restart parameter)
+ * @return 0 in case of convergence, 1 otherwise
+ */
+template <typename MATRIX, typename PRECOND, typename FP_TYPE>
+unsigned GMRes(MATRIX const& A, PRECOND const& precond, FP_TYPE const* const b,
+		FP_TYPE* const x, double& eps, unsigned m, unsigned& nsteps, SolverWorkspace<FP_TYPE>& work,
+		SolverObserver* observer = NULL)
+{
+	using GMResDetail::applPlRot;
+	using GMResDetail::genPlRot;
+
+	const unsigned n(A.getNRows());
+	const FP_TYPE one(static_cast<FP_TYPE>(1.0));
+	SolverProbe probe(observer);
+
+	FP_TYPE *r(work.get(2 * n + (n + m + 4) * (m + 1))); // n
+	FP_TYPE *V(r + n); // n x (m+1)
+	FP_TYPE *xh(V + n * (m + 1)); // n
+	FP_TYPE *H(xh + n); // m+1 x m
+	FP_TYPE *cs(H + (m + 1) * m); // m+1
+	FP_TYPE *sn(cs + m + 1); // m+1
+	FP_TYPE *s(sn + m + 1); // m+1
+	FP_TYPE *y(s + m + 1); // m+1
+
+	// normb = norm(b)
+	const double normb(blas::nrm2(n, b));
+	if (normb == 0.0) {
+		blas::setzero(n, x);
+		eps = 0.0;
+		nsteps = 0;
+		return probe.finished(0, 0, 0.0);
+	}
+
+	// r = b - Ax
+	A.amux(-one, x, r);
+	blas::axpy(n, one, b, r);
+
+	FP_TYPE beta(blas::nrm2(n, r));
+	double resid;
+	if ((resid = beta / normb) <= eps) {
+		eps = resid;
+		nsteps = 0;
+		return probe.finished(0, 0, eps);
+	}
+
+	unsigned j(1);
+	while (j <= nsteps) {
+		blas::copy(n, r, V); // v0 first orthonormal vector
+		blas::scal(n, one / beta, V);
+
+		s[0] = beta;
+		blas::setzero(m, s + 1);
+
+		unsigned i(0);
+		for (; i < m && j <= nsteps; i++, j++) {
+			FP_TYPE *w(V + (i + 1) * n);
+			FP_TYPE *h(H + i * (m + 1));
+
+			// w = A M * v[i];
+			probe.start();
+			blas::copy(n, V + i * n, xh);
+			probe.stop(SOLVER_PHASE_UPDATE);
+			precond.precondApply(xh);
+			probe.stop(SOLVER_PHASE_PRECOND);
+			A.amux(one, xh, w);
+			probe.stop(SOLVER_PHASE_SPMV);
+
+			for (unsigned k = 0; k <= i; k++) {
+				h[k] = blas::scpr(n, w, V + k * n);
+				probe.stop(SOLVER_PHASE_DOT);
+				blas::axpy(n, -h[k], V + k * n, w);
+				probe.stop(SOLVER_PHASE_UPDATE);
+			}
+
+			h[i + 1] = blas::nrm2(n, w);
+			probe.stop(SOLVER_PHASE_DOT);
+			blas::scal(n, one / h[i + 1], w);
+			probe.stop(SOLVER_PHASE_UPDATE);
+
+			// apply old Givens rotations to the last column in H
+			for (unsigned k = 0; k < i; k++)
+				applPlRot(h[k], h[k + 1], cs[k], sn[k]);
+
+			// generate new Givens rotation which eleminates h[i+1]
+			genPlRot(h[i], h[i + 1], cs[i], sn[i]);
+			// apply it to H and s
+			applPlRot(h[i], h[i + 1], cs[i], sn[i]);
+			applPlRot(s[i], s[i + 1], cs[i], sn[i]);
+
+			resid = fabs(s[i + 1] / normb);
+			probe.iteration(j, resid);
+			if (resid < eps) {
+				GMResDetail::update(precond, n, i + 1, H, m + 1, s, V, y, xh, x);
+				eps = resid;
+				nsteps = j;
+				return probe.finished(0, j, eps);
+			}
+		}
+
+		// the cycle is cut short if the maximal number of iterations is
+		// reached, only the first i columns of H are set up
+		GMResDetail::update(precond, n, i, H, m + 1, s, V, y, xh, x);
+
+		// r = b - A x;
+		A.amux(-one, x, r);
+		blas::axpy(n, one, b, r);
+		beta = blas::nrm2(n, r);
+
+		if ((resid = beta / normb) < eps) {
+			eps = resid;
+			nsteps = j;
+			return probe.finished(0, j, eps);
+		}
+	}
+
+	eps = resid;
+	return probe.finished(1, nsteps, eps);
+}
+
+/**
+ * Restarted GMRes(m) method, where the matrix object is used as
+ * preconditioner, see GMRes(MATRIX const&, PRECOND const&, FP_TYPE const*,
+ * FP_TYPE*, double&, unsigned, unsigned&, SolverWorkspace<FP_TYPE>&, SolverObserver*).
+ */
+template <typename MATRIX, typename FP_TYPE>
+unsigned GMRes(MATRIX const& A, FP_TYPE const* const b, FP_TYPE* const x, double& eps,
+		unsigned m, unsigned& nsteps, SolverWorkspace<FP_TYPE>& work, SolverObserver* observer = NULL)
+{
+	return GMRes(A, A, b, x, eps, m, nsteps, work, observer);
+}
+
+} // end namespace MathLib
+
+#endif /* GMRESTEMPLATE_H_ */
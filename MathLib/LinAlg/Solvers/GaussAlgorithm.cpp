@@ -6,42 +6,88 @@
  */
 
 #include <cmath>
+#include <algorithm>
 #include "GaussAlgorithm.h"
 #include "swap.h"
+#include "LinAlg/Dense/denseKernels.h"
 
 namespace MathLib {
 
+/** number of columns of a panel of the blocked LU factorization */
+const size_t GAUSS_BLOCK_SIZE = 64;
+/** number of columns of a tile of the block row update */
+const size_t GAUSS_TILE_COLS = 256;
+/** number of right hand sides solved simultaneously by execute() */
+const size_t GAUSS_RHS_BLOCK_SIZE = 16;
+
 GaussAlgorithm::GaussAlgorithm (Matrix <double> &A) :
 	_mat (A), _n(_mat.getNRows()), _perm (new size_t [_n])
 {
-	size_t k, i, j, nr (_mat.getNRows()), nc(_mat.getNCols());
-	double l;
+	const size_t nr (_mat.getNRows()), nc(_mat.getNCols());
+	const size_t n_steps (std::min(nr, nc));
+	double *a (_mat.getData());
 
-	for (k=0; k<nc; k++) {
-		// search pivot
-		double t = fabs(_mat(k, k));
-		_perm[k] = k;
-		for (i=k+1; i<nr; i++) {
-			if (fabs(_mat(i,k)) > t) {
-				t = _mat(i,k);
-				_perm[k] = i;
+	// right looking blocked LU factorization, in step kb the panel consisting
+	// of the columns kb, ..., kb+nb-1 is factorized, then the block row U12 and
+	// the trailing matrix A22 -= L21 * U12 are updated
+	for (size_t kb=0; kb<n_steps; kb+=GAUSS_BLOCK_SIZE) {
+		const size_t nb (std::min(GAUSS_BLOCK_SIZE, n_steps-kb));
+		const size_t panel_end (kb+nb);
+
+		// *** panel factorization with partial pivoting
+		for (size_t k=kb; k<panel_end; k++) {
+			// search pivot
+			double t = fabs(a[k*nc+k]);
+			_perm[k] = k;
+			for (size_t i=k+1; i<nr; i++) {
+				if (fabs(a[i*nc+k]) > t) {
+					t = fabs(a[i*nc+k]);
+					_perm[k] = i;
+				}
 			}
-		}
 
-		// exchange rows
-		if (_perm[k] != k) {
-			for (j=0; j<nc; j++) BaseLib::swap (_mat(_perm[k],j), _mat(k,j));
+			// exchange rows (the whole rows are contiguous in memory)
+			if (_perm[k] != k)
+				std::swap_ranges(a+_perm[k]*nc, a+(_perm[k]+1)*nc, a+k*nc);
+
+			// eliminate within the panel
+			double const*const row_k (a+k*nc);
+			for (size_t i=k+1; i<nr; i++) {
+				double *row_i (a+i*nc);
+				const double l (row_i[k] / row_k[k]);
+				row_i[k] = l;
+				for (size_t j=k+1; j<panel_end; j++)
+					row_i[j] -= l * row_k[j];
+			}
 		}
 
-		// eliminate
-		for (i=k+1; i<nr; i++) {
-			l=_mat(i,k)/_mat(k,k);
-			for (j=k; j<nc; j++) {
-				_mat(i,j) -= _mat(k,j) * l;
+		if (panel_end >= nc)
+			continue;
+
+		// U12 = L11^{-1} A12, tiles of columns right of the panel
+		const size_t n_col_tiles ((nc - panel_end + GAUSS_TILE_COLS - 1) / GAUSS_TILE_COLS);
+		OPENMP_LOOP_TYPE ct;
+		#pragma omp parallel for
+		for (ct=0; ct<n_col_tiles; ct++) {
+			const size_t j_beg (panel_end + ct*GAUSS_TILE_COLS);
+			const size_t j_end (std::min(nc, j_beg + GAUSS_TILE_COLS));
+			for (size_t k=kb; k<panel_end; k++) {
+				double const*const row_k (a+k*nc);
+				for (size_t i=k+1; i<panel_end; i++) {
+					double *row_i (a+i*nc);
+					const double l (row_i[k]);
+					for (size_t j=j_beg; j<j_end; j++)
+						row_i[j] -= l * row_k[j];
+				}
 			}
-			_mat(i,k) = l;
 		}
+
+		// A22 -= L21 * U12
+		gemmBlocked (nr-panel_end, nc-panel_end, nb, -1.0, a+panel_end*nc+kb, nc,
+				a+kb*nc+panel_end, nc, 1.0, a+panel_end*nc+panel_end, nc);
 	}
+	for (size_t k=n_steps; k<_n; k++)
+		_perm[k] = k;
 }
 
 GaussAlgorithm::~GaussAlgorithm()
@@ -51,9 +97,63 @@ GaussAlgorithm::~GaussAlgorithm()
 
 void GaussAlgorithm::execute (double *b) const
 {
-	permuteRHS (b);
-	forwardSolve (_mat, b); // L z = b, b will be overwritten by z
-	backwardSolve (_mat, b); // U x = z, b (z) will be overwritten by x
+	execute (b, 1);
+}
+
+void GaussAlgorithm::execute (double *b, size_t n_rhs) const
+{
+	const size_t nc (_mat.getNCols());
+	double const*const a (_mat.getData());
+	const size_t n_blocks ((n_rhs + GAUSS_RHS_BLOCK_SIZE - 1) / GAUSS_RHS_BLOCK_SIZE);
+
+	// the right hand sides are processed in blocks, within a block the
+	// vectors are stored row by row, i.e. every row of the factors is read
+	// once per block
+	OPENMP_LOOP_TYPE blk;
+	#pragma omp parallel for schedule(dynamic)
+	for (blk=0; blk<n_blocks; blk++) {
+		const size_t r_beg (blk*GAUSS_RHS_BLOCK_SIZE);
+		const size_t w (std::min(GAUSS_RHS_BLOCK_SIZE, n_rhs - r_beg));
+		double *x (new double[_n * w]);
+		for (size_t q=0; q<w; q++) {
+			double *b_q (b + (r_beg+q)*_n);
+			permuteRHS (b_q);
+			for (size_t i=0; i<_n; i++)
+				x[i*w+q] = b_q[i];
+		}
+
+		// L z = b, the diagonal entries of L are 1.0
+		for (size_t r=0; r<_n; r++) {
+			double const*const row_r (a+r*nc);
+			double *x_r (x+r*w);
+			for (size_t c=0; c<r; c++) {
+				const double l (row_r[c]);
+				double const*const x_c (x+c*w);
+				for (size_t q=0; q<w; q++)
+					x_r[q] -= l * x_c[q];
+			}
+		}
+		// U x = z
+		for (size_t r=_n; r>0; r--) {
+			double const*const row_r (a+(r-1)*nc);
+			double *x_r (x+(r-1)*w);
+			for (size_t c=r; c<_n; c++) {
+				const double u (row_r[c]);
+				double const*const x_c (x+c*w);
+				for (size_t q=0; q<w; q++)
+					x_r[q] -= u * x_c[q];
+			}
+			for (size_t q=0; q<w; q++)
+				x_r[q] /= row_r[r-1];
+		}
+
+		for (size_t q=0; q<w; q++) {
+			double *b_q (b + (r_beg+q)*_n);
+			for (size_t i=0; i<_n; i++)
+				b_q[i] = x[i*w+q];
+		}
+		delete [] x;
+	}
 }
 
 void GaussAlgorithm::permuteRHS (double* b) const
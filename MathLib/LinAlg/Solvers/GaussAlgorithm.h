@@ -22,6 +22,11 @@ namespace MathLib {
  * Gauss-Elimination with partial pivoting (rows are exchanged). In doing so
  * the entries of A change! The solution for a specific
  * right hand side is computed by the method execute().
+ *
+ * The factorization is blocked (right looking): a panel of columns is
+ * factorized with partial pivoting, afterwards the block row right of the
+ * panel is updated tile by tile and the trailing matrix by gemmBlocked(),
+ * both in parallel by OpenMP.
  */
 class GaussAlgorithm : public MathLib::DenseDirectLinearSolver {
 public:
@@ -47,6 +52,15 @@ public:
 	 */
 	void execute (double *b) const;
 
+	/**
+	 * Method solves the linear systems \f$A x_i = b_i\f$, \f$i=0,...,n_{rhs}-1\f$.
+	 * The right hand sides are processed in blocks, the blocks in parallel.
+	 * @param b array of length \f$n \cdot n_{rhs}\f$, the vectors \f$b_i\f$
+	 * stored one after another, at the end the solutions
+	 * @param n_rhs number of right hand sides
+	 */
+	void execute (double *b, size_t n_rhs) const;
+
 private:
 	/**
 	 * permute the right hand side vector according to the
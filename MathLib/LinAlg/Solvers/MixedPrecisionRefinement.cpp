@@ -0,0 +1,342 @@
+/*
+ * MixedPrecisionRefinement.cpp
+ *
+ *  Created on: Feb 3, 2012
+ *      Author: TF
+ */
+
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "MathTools.h"
+#include "blas.h"
+#include "CG.h"
+#include "BiCGStab.h"
+#include "../Sparse/CRSMatrix.h"
+#include "../Sparse/CRSSymMatrix.h"
+#include "../Sparse/amuxCRS.h"
+
+// Mixed precision iterative refinement: the correction equation A d = r is
+// solved approximately in single precision, the residual r = b - A x and the
+// update x += d are computed in double precision:
+//
+// loop:
+//    r = b - A x                    (double)
+//    solve A_f d = r / |r|          (float, inner Krylov method, relative accuracy inner_eps)
+//    x += |r| d                     (double)
+//
+// The inner iterations use a float copy of the matrix entries (the index
+// arrays are shared with the double precision matrix) and Jacobi
+// preconditioning. A CRSSymMatrix stores only the upper triangular part,
+// in this case the inner iterations use a CRSSymMatrix<float, unsigned>. Since the matrix vector multiplication is memory bandwidth
+// bound the inner iterations are nearly twice as fast as in double precision.
+// The method converges as long as the condition number of the matrix is
+// small compared to the inverse of the single precision machine epsilon.
+
+namespace MathLib {
+
+namespace {
+
+/**
+ * the single precision copy of the matrix used in the inner iterations
+ */
+struct FloatSystem {
+	unsigned n;
+	unsigned const* iA;
+	unsigned const* jA;
+	float* A;
+	float* inv_diag;
+	unsigned n_blocks;
+	unsigned const* row_partition;
+	/** the single precision copy of a symmetric matrix, NULL for a general matrix */
+	CRSSymMatrix<float, unsigned>* sym;
+};
+
+// y = A x
+void amux(FloatSystem const& S, float const* const x, float* const y)
+{
+	if (S.sym) {
+		S.sym->amux(1.0f, x, y);
+		return;
+	}
+#ifdef _OPENMP
+	amuxCRSParallelOpenMP(1.0f, S.iA, S.jA, S.A, x, y, S.n_blocks, S.row_partition);
+#else
+	amuxCRS(1.0f, S.n, S.iA, S.jA, S.A, x, y);
+#endif
+}
+
+// the scalar products are accumulated in double precision
+double dot(unsigned n, float const* const x, float const* const y)
+{
+	double s(0.0);
+	OPENMP_LOOP_TYPE k;
+	#pragma omp parallel for reduction(+:s)
+	for (k = 0; k < static_cast<OPENMP_LOOP_TYPE>(n); k++)
+		s += static_cast<double>(x[k]) * y[k];
+	return s;
+}
+
+// z = D^{-1} r
+void precond(FloatSystem const& S, float const* const r, float* const z)
+{
+	OPENMP_LOOP_TYPE k;
+	#pragma omp parallel for
+	for (k = 0; k < static_cast<OPENMP_LOOP_TYPE>(S.n); k++)
+		z[k] = S.inv_diag[k] * r[k];
+}
+
+/**
+ * inner solver, the start vector is zero
+ * @param S the system in single precision
+ * @param b right hand side
+ * @param x solution
+ * @param eps relative accuracy
+ * @param max_steps maximal number of iterations
+ * @param work work vectors
+ * @return number of iterations
+ */
+typedef unsigned (*InnerSolver)(FloatSystem const& S, float const* b, float* x, double eps,
+				unsigned max_steps, float* work);
+
+// Jacobi preconditioned CG, work contains 4 vectors
+unsigned innerCG(FloatSystem const& S, float const* const b, float* const x, double eps,
+				unsigned max_steps, float* work)
+{
+	const OPENMP_LOOP_TYPE n(S.n);
+	float *r(work), *z(r + n), *p(z + n), *q(p + n);
+	OPENMP_LOOP_TYPE k;
+
+	#pragma omp parallel for
+	for (k = 0; k < n; k++) {
+		x[k] = 0.0f;
+		r[k] = b[k];
+		z[k] = S.inv_diag[k] * b[k];
+		p[k] = z[k];
+	}
+	const double nrmb(sqrt(dot(n, b, b)));
+	double rho(dot(n, r, z));
+
+	for (unsigned l(1); l <= max_steps; l++) {
+		amux(S, p, q);
+		const float alpha(static_cast<float>(rho / dot(n, p, q)));
+		double rr(0.0);
+		#pragma omp parallel for reduction(+:rr)
+		for (k = 0; k < n; k++) {
+			x[k] += alpha * p[k];
+			r[k] -= alpha * q[k];
+			z[k] = S.inv_diag[k] * r[k];
+			rr += static_cast<double>(r[k]) * r[k];
+		}
+		if (sqrt(rr) <= eps * nrmb)
+			return l;
+
+		const double rho_new(dot(n, r, z));
+		const float beta(static_cast<float>(rho_new / rho));
+		rho = rho_new;
+		#pragma omp parallel for
+		for (k = 0; k < n; k++)
+			p[k] = z[k] + beta * p[k];
+	}
+	return max_steps;
+}
+
+// Jacobi preconditioned BiCGStab, work contains 8 vectors
+unsigned innerBiCGStab(FloatSystem const& S, float const* const b, float* const x, double eps,
+				unsigned max_steps, float* work)
+{
+	const OPENMP_LOOP_TYPE n(S.n);
+	float *r(work), *r0(r + n), *p(r0 + n), *v(p + n), *phat(v + n), *s(phat + n),
+		*shat(s + n), *t(shat + n);
+	OPENMP_LOOP_TYPE k;
+
+	#pragma omp parallel for
+	for (k = 0; k < n; k++) {
+		x[k] = 0.0f;
+		r[k] = r0[k] = b[k];
+		p[k] = v[k] = 0.0f;
+	}
+	const double nrmb(sqrt(dot(n, b, b)));
+	double rho(1.0), alpha(1.0), omega(1.0);
+
+	for (unsigned l(1); l <= max_steps; l++) {
+		const double rho1(dot(n, r0, r));
+		if (rho1 == 0.0)
+			return l;
+		const float beta(static_cast<float>((rho1 / rho) * (alpha / omega)));
+		const float omega_f(static_cast<float>(omega));
+		#pragma omp parallel for
+		for (k = 0; k < n; k++)
+			p[k] = r[k] + beta * (p[k] - omega_f * v[k]);
+		precond(S, p, phat);
+		amux(S, phat, v);
+		alpha = rho1 / dot(n, r0, v);
+		const float alpha_f(static_cast<float>(alpha));
+
+		double ss(0.0);
+		#pragma omp parallel for reduction(+:ss)
+		for (k = 0; k < n; k++) {
+			s[k] = r[k] - alpha_f * v[k];
+			ss += static_cast<double>(s[k]) * s[k];
+		}
+		if (sqrt(ss) <= eps * nrmb) {
+			#pragma omp parallel for
+			for (k = 0; k < n; k++)
+				x[k] += alpha_f * phat[k];
+			return l;
+		}
+
+		precond(S, s, shat);
+		amux(S, shat, t);
+		omega = dot(n, t, s) / dot(n, t, t);
+		const float omega_new(static_cast<float>(omega));
+		double rr(0.0);
+		#pragma omp parallel for reduction(+:rr)
+		for (k = 0; k < n; k++) {
+			x[k] += alpha_f * phat[k] + omega_new * shat[k];
+			r[k] = s[k] - omega_new * t[k];
+			rr += static_cast<double>(r[k]) * r[k];
+		}
+		if (sqrt(rr) <= eps * nrmb || omega == 0.0)
+			return l;
+		rho = rho1;
+	}
+	return max_steps;
+}
+
+unsigned refine(CRSMatrix<double,unsigned> const* mat, double const* const b, double* const x,
+				double& eps, unsigned& nsteps, double inner_eps, InnerSolver solver,
+				unsigned n_work_vectors)
+{
+	const unsigned n(mat->getNRows());
+	const OPENMP_LOOP_TYPE n_loop(n);
+	OPENMP_LOOP_TYPE k;
+
+	const double nrmb(sqrt(scpr(b, b, n)));
+	if (nrmb < std::numeric_limits<double>::epsilon()) {
+		blas::setzero(n, x);
+		eps = 0.0;
+		nsteps = 0;
+		return 0;
+	}
+
+	// single precision copy of the matrix entries and the inverse diagonal
+	unsigned const* iA(mat->getRowPtrArray());
+	unsigned const* jA(mat->getColIdxArray());
+	double const*const A(mat->getEntryArray());
+	FloatSystem S;
+	S.n = n;
+	S.A = new float[iA[n]];
+	S.inv_diag = new float[n];
+	S.sym = NULL;
+	#pragma omp parallel for
+	for (k = 0; k < n_loop; k++) {
+		S.inv_diag[k] = 1.0f;
+		for (unsigned j(iA[k]); j < iA[k + 1]; j++) {
+			S.A[j] = static_cast<float>(A[j]);
+			if (jA[j] == static_cast<unsigned>(k) && A[j] != 0.0)
+				S.inv_diag[k] = static_cast<float>(1.0 / A[j]);
+		}
+	}
+
+	// the arrays of a symmetric matrix contain only the upper triangular part,
+	// the float matrix takes over copies of the arrays
+	if (dynamic_cast<CRSSymMatrix<double, unsigned> const*>(mat) != NULL) {
+		unsigned *iA_copy(new unsigned[n + 1]);
+		unsigned *jA_copy(new unsigned[iA[n]]);
+		std::copy(iA, iA + n + 1, iA_copy);
+		std::copy(jA, jA + iA[n], jA_copy);
+		S.sym = new CRSSymMatrix<float, unsigned>(n, iA_copy, jA_copy, S.A);
+		S.A = NULL;
+		iA = S.sym->getRowPtrArray();
+		jA = S.sym->getColIdxArray();
+	}
+	S.iA = iA;
+	S.jA = jA;
+#ifdef _OPENMP
+	S.n_blocks = omp_get_max_threads();
+	S.row_partition = S.sym ? NULL : mat->getRowPartition(S.n_blocks);
+#else
+	S.n_blocks = 1;
+	S.row_partition = NULL;
+#endif
+
+	double *r(new double[n]);
+	float *r_f(new float[n]);
+	float *d_f(new float[n]);
+	float *work(new float[n_work_vectors * n]);
+
+	const unsigned max_steps(nsteps);
+	unsigned steps(0), ret(1);
+	double resid(std::numeric_limits<double>::max());
+	for (;;) {
+		// r = b - A x in double precision
+		mat->amux(D_ONE, x, r);
+		double rr(0.0);
+		#pragma omp parallel for reduction(+:rr)
+		for (k = 0; k < n_loop; k++) {
+			r[k] = b[k] - r[k];
+			rr += r[k] * r[k];
+		}
+		const double resid_new(sqrt(rr));
+		if (resid_new <= eps * nrmb) {
+			resid = resid_new;
+			ret = 0;
+			break;
+		}
+		// stop if the maximal number of iterations is reached or the refinement stagnates
+		if (steps >= max_steps || resid_new >= resid) {
+			resid = resid_new;
+			break;
+		}
+		resid = resid_new;
+
+		// the scaled residual is representable in single precision
+		const double scale(1.0 / resid);
+		#pragma omp parallel for
+		for (k = 0; k < n_loop; k++)
+			r_f[k] = static_cast<float>(r[k] * scale);
+
+		// the last inner solve does not need to be more accurate than required
+		const double required_eps(0.5 * eps * nrmb / resid);
+		steps += solver(S, r_f, d_f, required_eps > inner_eps ? required_eps : inner_eps,
+						max_steps - steps, work);
+
+		#pragma omp parallel for
+		for (k = 0; k < n_loop; k++)
+			x[k] += resid * d_f[k];
+	}
+
+	eps = resid / nrmb;
+	nsteps = steps;
+
+	delete [] work;
+	delete [] d_f;
+	delete [] r_f;
+	delete [] r;
+	delete [] S.inv_diag;
+	delete [] S.A;
+	delete S.sym;
+	return ret;
+}
+
+} // end anonymous namespace
+
+unsigned CGMixedPrecision(CRSMatrix<double,unsigned> const * mat, double const * const b,
+		double* const x, double& eps, unsigned& nsteps, double inner_eps)
+{
+	return refine(mat, b, x, eps, nsteps, inner_eps, innerCG, 4);
+}
+
+unsigned BiCGStabMixedPrecision(CRSMatrix<double,unsigned> const& A, double const* const b,
+		double* const x, double& eps, unsigned& nsteps, double inner_eps)
+{
+	return refine(&A, b, x, eps, nsteps, inner_eps, innerBiCGStab, 8);
+}
+
+} // end namespace MathLib
@@ -0,0 +1,30 @@
+/*
+ * SolverObserver.cpp
+ *
+ *  Created on: Feb 24, 2012
+ *      Author: TF
+ */
+
+#include "SolverObserver.h"
+
+namespace MathLib {
+
+void SolverObserver::printTiming(std::ostream &os) const
+{
+	const char* names[SOLVER_N_PHASES] = { "spmv", "precond", "dot", "update" };
+	uint64_t sum (0);
+	for (unsigned k(0); k < SOLVER_N_PHASES; k++)
+		sum += _cycles[k];
+	const double total (_total_cycles > 0 ? static_cast<double>(_total_cycles) : 1.0);
+
+	for (unsigned k(0); k < SOLVER_N_PHASES; k++) {
+		os << names[k] << ": " << static_cast<double>(_cycles[k]) << " cycles ("
+			<< 100.0 * _cycles[k] / total << " %)" << std::endl;
+	}
+	const uint64_t other (_total_cycles > sum ? _total_cycles - sum : 0);
+	os << "other: " << static_cast<double>(other) << " cycles ("
+		<< 100.0 * other / total << " %)" << std::endl;
+	os << "total: " << static_cast<double>(_total_cycles) << " cycles" << std::endl;
+}
+
+} // end namespace MathLib
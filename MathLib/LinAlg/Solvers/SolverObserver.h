@@ -0,0 +1,233 @@
+/*
+ * SolverObserver.h
+ *
+ *  Created on: Feb 24, 2012
+ *      Author: TF
+ */
+
+#ifndef SOLVEROBSERVER_H_
+#define SOLVEROBSERVER_H_
+
+#include <iostream>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace MathLib {
+
+/**
+ * the parts of an iteration of a Krylov solver the time is attributed to
+ */
+enum SolverPhase {
+	SOLVER_PHASE_SPMV,    //!< (sparse) matrix vector multiplications
+	SOLVER_PHASE_PRECOND, //!< applications of the preconditioner
+	SOLVER_PHASE_DOT,     //!< scalar products and norms
+	SOLVER_PHASE_UPDATE,  //!< vector updates (axpy, copy, ...)
+	SOLVER_N_PHASES
+};
+
+/**
+ * @return the value of the time stamp counter of the processor, 0 on
+ * platforms without a cycle counter
+ */
+inline uint64_t readCycleCounter()
+{
+#if defined(_MSC_VER)
+	return __rdtsc();
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	// x86intrin.h can not be used together with -fno-nonansi-builtins
+	unsigned lo, hi;
+	__asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+	return (static_cast<uint64_t>(hi) << 32) | lo;
+#else
+	return 0;
+#endif
+}
+
+/**
+ * Interface of the observers of the iterative solvers CG(), CGParallel(),
+ * CGPipelined(), BiCGStab(), GMRes(), the solver templates (CGTemplate.h,
+ * BiCGStabTemplate.h, GMResTemplate.h) and the block solvers
+ * (BlockKrylovTemplate.h). The solver calls iteration() after every step
+ * and finished() before it returns. If the observer is constructed with
+ * timing = true the solver additionally accumulates the processor cycles
+ * spent in the phases of SolverPhase, the remaining cycles (scalar work,
+ * the computation of the initial residual, ...) are only contained in the
+ * total number of cycles.
+ */
+class SolverObserver
+{
+public:
+	explicit SolverObserver(bool timing = false) :
+		_timing (timing)
+	{
+		reset();
+	}
+	virtual ~SolverObserver() {}
+
+	/**
+	 * called by the solver after iteration step
+	 * @param step the number of the iteration
+	 * @param resid the relative residual after the iteration
+	 */
+	virtual void iteration(unsigned step, double resid)
+	{
+		(void)step; (void)resid;
+	}
+
+	/**
+	 * called by the solver before it returns
+	 * @param ret the return value of the solver
+	 * @param steps the number of iterations
+	 * @param resid the final relative residual
+	 */
+	virtual void finished(unsigned ret, unsigned steps, double resid)
+	{
+		(void)ret; (void)steps; (void)resid;
+	}
+
+	bool timing() const { return _timing; }
+
+	/** sets the counters to zero, has to be called if the observer is reused */
+	void reset()
+	{
+		for (unsigned k(0); k < SOLVER_N_PHASES; k++)
+			_cycles[k] = 0;
+		_total_cycles = 0;
+	}
+
+	uint64_t getCycles(SolverPhase phase) const { return _cycles[phase]; }
+	uint64_t getTotalCycles() const { return _total_cycles; }
+
+	void addCycles(SolverPhase phase, uint64_t cycles) { _cycles[phase] += cycles; }
+	void addTotalCycles(uint64_t cycles) { _total_cycles += cycles; }
+
+	/**
+	 * writes the cycles of the phases (and their shares of the total number
+	 * of cycles) to the stream
+	 */
+	void printTiming(std::ostream &os) const;
+
+private:
+	const bool _timing;
+	uint64_t _cycles[SOLVER_N_PHASES];
+	uint64_t _total_cycles;
+};
+
+/**
+ * Observer that records the history of the residuals and optionally writes
+ * every iteration to a stream (this replaces the former debug output of the
+ * solvers).
+ */
+class SolverStatistics : public SolverObserver
+{
+public:
+	SolverStatistics(bool timing = true, std::ostream* log = NULL) :
+		SolverObserver (timing), _log (log), _ret (0), _steps (0), _resid (0.0)
+	{}
+
+	virtual void iteration(unsigned step, double resid)
+	{
+		_history.push_back(resid);
+		if (_log)
+			*_log << "Step " << step << ", resid=" << resid << std::endl;
+	}
+
+	virtual void finished(unsigned ret, unsigned steps, double resid)
+	{
+		_ret = ret;
+		_steps = steps;
+		_resid = resid;
+	}
+
+	std::vector<double> const& getResidualHistory() const { return _history; }
+	unsigned getReturnValue() const { return _ret; }
+	unsigned getNSteps() const { return _steps; }
+	double getResidual() const { return _resid; }
+
+private:
+	std::ostream* _log;
+	std::vector<double> _history;
+	unsigned _ret;
+	unsigned _steps;
+	double _resid;
+};
+
+/**
+ * Helper used within the solvers: the cycles between two consecutive calls
+ * of stop() are attributed to the phase given to stop(), i.e. an iteration
+ * costs one read of the cycle counter per phase. Without an observer (or
+ * if the observer does not request timing) every call reduces to a test of
+ * a flag. If NO_SOLVER_TELEMETRY is defined the timing is compiled out,
+ * the observer is still informed by iteration() and finished().
+ */
+class SolverProbe
+{
+public:
+	explicit SolverProbe(SolverObserver* observer) :
+		_observer (observer), _timing (observer && observer->timing()), _t_begin (0), _t0 (0)
+	{
+#ifndef NO_SOLVER_TELEMETRY
+		if (_timing)
+			_t_begin = _t0 = readCycleCounter();
+#endif
+	}
+
+	/** starts the measurement of the next phase */
+	void start()
+	{
+#ifndef NO_SOLVER_TELEMETRY
+		if (_timing)
+			_t0 = readCycleCounter();
+#endif
+	}
+
+	/** attributes the cycles since the last call of start() or stop() to phase */
+	void stop(SolverPhase phase)
+	{
+#ifndef NO_SOLVER_TELEMETRY
+		if (_timing) {
+			const uint64_t t1 (readCycleCounter());
+			_observer->addCycles(phase, t1 - _t0);
+			_t0 = t1;
+		}
+#else
+		(void)phase;
+#endif
+	}
+
+	void iteration(unsigned step, double resid)
+	{
+		if (_observer)
+			_observer->iteration(step, resid);
+	}
+
+	/**
+	 * informs the observer about the result of the solver
+	 * @return ret
+	 */
+	unsigned finished(unsigned ret, unsigned steps, double resid)
+	{
+#ifndef NO_SOLVER_TELEMETRY
+		if (_timing)
+			_observer->addTotalCycles(readCycleCounter() - _t_begin);
+#endif
+		if (_observer)
+			_observer->finished(ret, steps, resid);
+		return ret;
+	}
+
+private:
+	SolverObserver* const _observer;
+	const bool _timing;
+	uint64_t _t_begin;
+	uint64_t _t0;
+};
+
+} // end namespace MathLib
+
+#endif /* SOLVEROBSERVER_H_ */
@@ -0,0 +1,106 @@
+/*
+ * SolverWorkspace.h
+ *
+ *  Created on: Feb 6, 2012
+ *      Author: TF
+ */
+
+#ifndef SOLVERWORKSPACE_H_
+#define SOLVERWORKSPACE_H_
+
+#include <cstddef>
+
+namespace MathLib {
+
+/**
+ * Memory for the work vectors of the templated iterative solvers (see
+ * CGTemplate.h, BiCGStabTemplate.h and GMResTemplate.h). The memory is
+ * allocated at the first request and reused by subsequent requests, it grows
+ * only if a request exceeds the current size. Thus a sequence of solves (for
+ * instance in a time stepping scheme or a Newton iteration) with the same
+ * workspace does not allocate memory within the solver.
+ *
+ * A workspace must not be shared by solves running at the same time.
+ */
+template <typename FP_TYPE>
+class SolverWorkspace
+{
+public:
+	SolverWorkspace() :
+		_data(NULL), _size(0)
+	{}
+
+	/**
+	 * @param size initial size (number of entries)
+	 */
+	explicit SolverWorkspace(std::size_t size) :
+		_data(new FP_TYPE[size]), _size(size)
+	{}
+
+	~SolverWorkspace()
+	{
+		delete [] _data;
+	}
+
+	/**
+	 * get memory for at least size entries, the content of the memory is
+	 * undefined
+	 * @param size number of entries
+	 * @return pointer to the memory, valid until the next call of get() with
+	 * a larger size or until release()
+	 */
+	FP_TYPE* get(std::size_t size)
+	{
+		if (size > _size) {
+			delete [] _data;
+			_data = new FP_TYPE[size];
+			_size = size;
+		}
+		return _data;
+	}
+
+	/**
+	 * get memory for n_vectors vectors of length n
+	 */
+	FP_TYPE* getVectors(std::size_t n_vectors, std::size_t n)
+	{
+		return get(n_vectors * n);
+	}
+
+	/**
+	 * @return the number of currently allocated entries
+	 */
+	std::size_t getSize() const { return _size; }
+
+	/**
+	 * free the memory
+	 */
+	void release()
+	{
+		delete [] _data;
+		_data = NULL;
+		_size = 0;
+	}
+
+private:
+	// the workspace owns its memory
+	SolverWorkspace(SolverWorkspace const&);
+	SolverWorkspace& operator=(SolverWorkspace const&);
+
+	FP_TYPE* _data;
+	std::size_t _size;
+};
+
+/**
+ * The identity as preconditioner for the templated iterative solvers.
+ */
+template <typename FP_TYPE>
+struct IdentityPreconditioner
+{
+	void precondApply(FP_TYPE* /*x*/) const {}
+	void precondApplyBlock(unsigned /*k*/, FP_TYPE* /*X*/) const {}
+};
+
+} // end namespace MathLib
+
+#endif /* SOLVERWORKSPACE_H_ */
@@ -0,0 +1,397 @@
+/*
+ * SparseCholesky.cpp
+ *
+ *  Created on: Feb 13, 2012
+ *      Author: TF
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "SparseCholesky.h"
+
+namespace MathLib {
+
+SparseCholesky::SparseCholesky(unsigned n, unsigned const*const iA, unsigned const*const jA,
+				unsigned const*const op_perm, unsigned const*const po_perm) :
+	_n(n), _op_perm(new unsigned[n]), _po_perm(new unsigned[n]), _a_col_ptr(new unsigned[n + 1]),
+	_a_row_idx(NULL), _a_map(NULL), _n_supernodes(0), _sn_first(NULL), _sn_row_ptr(NULL),
+	_sn_rows(NULL), _sn_son_ptr(NULL), _sn_sons(NULL), _sn_father(NULL), _sn_L_ptr(NULL),
+	_L(NULL), _factorized(false)
+{
+	for (unsigned i(0); i < n; i++) {
+		_op_perm[i] = op_perm ? op_perm[i] : i;
+		_po_perm[i] = po_perm ? po_perm[i] : i;
+	}
+
+	// *** lower triangular part of the permuted matrix by columns and by rows
+	unsigned *l_row_ptr(new unsigned[n + 1]);
+	for (unsigned i(0); i <= n; i++)
+		_a_col_ptr[i] = l_row_ptr[i] = 0;
+	for (unsigned i(0); i < n; i++) {
+		const unsigned r(_po_perm[i]);
+		for (unsigned k(iA[i]); k < iA[i + 1]; k++) {
+			const unsigned c(_po_perm[jA[k]]);
+			if (r >= c)
+				_a_col_ptr[c + 1]++;
+			if (r > c)
+				l_row_ptr[r + 1]++;
+		}
+	}
+	for (unsigned i(0); i < n; i++) {
+		_a_col_ptr[i + 1] += _a_col_ptr[i];
+		l_row_ptr[i + 1] += l_row_ptr[i];
+	}
+	_a_row_idx = new unsigned[_a_col_ptr[n]];
+	_a_map = new unsigned[_a_col_ptr[n]];
+	unsigned *l_col_idx(new unsigned[l_row_ptr[n]]);
+	unsigned *col_pos(new unsigned[n]);
+	unsigned *row_pos(new unsigned[n]);
+	for (unsigned i(0); i < n; i++) {
+		col_pos[i] = _a_col_ptr[i];
+		row_pos[i] = l_row_ptr[i];
+	}
+	for (unsigned i(0); i < n; i++) {
+		const unsigned r(_po_perm[i]);
+		for (unsigned k(iA[i]); k < iA[i + 1]; k++) {
+			const unsigned c(_po_perm[jA[k]]);
+			if (r >= c) {
+				_a_row_idx[col_pos[c]] = r;
+				_a_map[col_pos[c]++] = k;
+			}
+			if (r > c)
+				l_col_idx[row_pos[r]++] = c;
+		}
+	}
+	delete [] col_pos;
+	delete [] row_pos;
+
+	// *** elimination tree (algorithm of Liu with path compression), the
+	// father of a column has a greater index than the column
+	unsigned *parent(new unsigned[n]);
+	unsigned *ancestor(new unsigned[n]);
+	for (unsigned i(0); i < n; i++) {
+		parent[i] = ancestor[i] = n;
+		for (unsigned k(l_row_ptr[i]); k < l_row_ptr[i + 1]; k++) {
+			unsigned r(l_col_idx[k]);
+			while (ancestor[r] != n && ancestor[r] != i) {
+				const unsigned next(ancestor[r]);
+				ancestor[r] = i;
+				r = next;
+			}
+			if (ancestor[r] == n) {
+				ancestor[r] = i;
+				parent[r] = i;
+			}
+		}
+	}
+	delete [] ancestor;
+	delete [] l_col_idx;
+	delete [] l_row_ptr;
+
+	unsigned *child_ptr(new unsigned[n + 1]);
+	unsigned *children(new unsigned[n]);
+	for (unsigned i(0); i <= n; i++)
+		child_ptr[i] = 0;
+	for (unsigned i(0); i < n; i++)
+		if (parent[i] != n)
+			child_ptr[parent[i] + 1]++;
+	for (unsigned i(0); i < n; i++)
+		child_ptr[i + 1] += child_ptr[i];
+	for (unsigned i(0); i < n; i++)
+		if (parent[i] != n)
+			children[child_ptr[parent[i]]++] = i;
+	for (unsigned i(n); i > 0; i--)
+		child_ptr[i] = child_ptr[i - 1];
+	child_ptr[0] = 0;
+
+	// *** row structures of the columns of L and fundamental supernodes:
+	// struct(L_j) = {j} + struct(A_j) + union over the children c of
+	// struct(L_c) \ {c}. Column j belongs to the supernode of column j-1 if j-1
+	// is the only child of j and struct(L_j) = struct(L_{j-1}) \ {j-1}. Only
+	// the structure of the first column of every supernode is stored, the
+	// structure of the column j of supernode s is the tail of it.
+	std::vector<unsigned> sn_first;
+	std::vector<std::size_t> sn_row_ptr(1, 0);
+	std::vector<unsigned> sn_rows;
+	unsigned *col_to_sn(new unsigned[n]);
+	unsigned *mark(new unsigned[n]);
+	unsigned *tmp(new unsigned[n]);
+	unsigned last_count(0);
+	for (unsigned i(0); i < n; i++)
+		mark[i] = n;
+	for (unsigned j(0); j < n; j++) {
+		unsigned cnt(0);
+		tmp[cnt++] = j;
+		mark[j] = j;
+		for (unsigned k(_a_col_ptr[j]); k < _a_col_ptr[j + 1]; k++) {
+			const unsigned r(_a_row_idx[k]);
+			if (mark[r] != j) {
+				mark[r] = j;
+				tmp[cnt++] = r;
+			}
+		}
+		for (unsigned k(child_ptr[j]); k < child_ptr[j + 1]; k++) {
+			const unsigned c(children[k]);
+			const unsigned s(col_to_sn[c]);
+			for (std::size_t l(sn_row_ptr[s] + c - sn_first[s] + 1); l < sn_row_ptr[s + 1]; l++) {
+				const unsigned r(sn_rows[l]);
+				if (mark[r] != j) {
+					mark[r] = j;
+					tmp[cnt++] = r;
+				}
+			}
+		}
+
+		if (j > 0 && parent[j - 1] == j && child_ptr[j + 1] - child_ptr[j] == 1
+				&& last_count == cnt + 1) {
+			col_to_sn[j] = sn_first.size() - 1;
+		} else {
+			col_to_sn[j] = sn_first.size();
+			sn_first.push_back(j);
+			std::sort(tmp, tmp + cnt);
+			sn_rows.insert(sn_rows.end(), tmp, tmp + cnt);
+			sn_row_ptr.push_back(sn_rows.size());
+		}
+		last_count = cnt;
+	}
+	delete [] tmp;
+	delete [] mark;
+	delete [] children;
+	delete [] child_ptr;
+
+	// *** supernodal elimination tree and storage of L
+	_n_supernodes = sn_first.size();
+	_sn_first = new unsigned[_n_supernodes + 1];
+	std::copy(sn_first.begin(), sn_first.end(), _sn_first);
+	_sn_first[_n_supernodes] = n;
+	_sn_row_ptr = new std::size_t[_n_supernodes + 1];
+	std::copy(sn_row_ptr.begin(), sn_row_ptr.end(), _sn_row_ptr);
+	_sn_rows = new unsigned[sn_rows.size()];
+	std::copy(sn_rows.begin(), sn_rows.end(), _sn_rows);
+
+	_sn_father = new unsigned[_n_supernodes];
+	_sn_son_ptr = new unsigned[_n_supernodes + 1];
+	_sn_L_ptr = new std::size_t[_n_supernodes + 1];
+	for (unsigned s(0); s <= _n_supernodes; s++)
+		_sn_son_ptr[s] = 0;
+	_sn_L_ptr[0] = 0;
+	for (unsigned s(0); s < _n_supernodes; s++) {
+		const unsigned p(parent[_sn_first[s + 1] - 1]);
+		_sn_father[s] = (p == n) ? _n_supernodes : col_to_sn[p];
+		if (p != n)
+			_sn_son_ptr[_sn_father[s] + 1]++;
+		_sn_L_ptr[s + 1] = _sn_L_ptr[s] + (_sn_row_ptr[s + 1] - _sn_row_ptr[s]) * (_sn_first[s + 1] - _sn_first[s]);
+	}
+	for (unsigned s(0); s < _n_supernodes; s++)
+		_sn_son_ptr[s + 1] += _sn_son_ptr[s];
+	_sn_sons = new unsigned[_sn_son_ptr[_n_supernodes]];
+	for (unsigned s(0); s < _n_supernodes; s++)
+		if (_sn_father[s] != _n_supernodes)
+			_sn_sons[_sn_son_ptr[_sn_father[s]]++] = s;
+	for (unsigned s(_n_supernodes); s > 0; s--)
+		_sn_son_ptr[s] = _sn_son_ptr[s - 1];
+	_sn_son_ptr[0] = 0;
+
+	delete [] col_to_sn;
+	delete [] parent;
+
+	_L = new double[_sn_L_ptr[_n_supernodes]];
+}
+
+SparseCholesky::~SparseCholesky()
+{
+	delete [] _op_perm;
+	delete [] _po_perm;
+	delete [] _a_col_ptr;
+	delete [] _a_row_idx;
+	delete [] _a_map;
+	delete [] _sn_first;
+	delete [] _sn_row_ptr;
+	delete [] _sn_rows;
+	delete [] _sn_son_ptr;
+	delete [] _sn_sons;
+	delete [] _sn_father;
+	delete [] _sn_L_ptr;
+	delete [] _L;
+}
+
+bool SparseCholesky::factorize(double const*const A)
+{
+	_factorized = true;
+	double **updates(new double*[_n_supernodes]);
+	unsigned *n_pending_sons(new unsigned[_n_supernodes]);
+	std::vector<unsigned> leaves;
+	for (unsigned s(0); s < _n_supernodes; s++) {
+		updates[s] = NULL;
+		n_pending_sons[s] = _sn_son_ptr[s + 1] - _sn_son_ptr[s];
+		if (n_pending_sons[s] == 0)
+			leaves.push_back(s);
+	}
+
+	// every thread starts at a leaf and walks towards the root as long as it
+	// has finished the last son of the next supernode
+	const unsigned n_leaves(leaves.size());
+	OPENMP_LOOP_TYPE k;
+	#pragma omp parallel for schedule(dynamic, 1)
+	for (k = 0; k < n_leaves; k++) {
+		unsigned s(leaves[k]);
+		while (true) {
+			updates[s] = factorizeSupernode(s, A, updates);
+			const unsigned father(_sn_father[s]);
+			if (father == _n_supernodes)
+				break;
+			unsigned remaining;
+			#pragma omp critical (SparseCholeskyPendingSons)
+			remaining = --n_pending_sons[father];
+			if (remaining > 0)
+				break;
+			s = father;
+		}
+	}
+
+	delete [] n_pending_sons;
+	delete [] updates;
+	return _factorized;
+}
+
+double* SparseCholesky::factorizeSupernode(unsigned s, double const*const A, double** updates)
+{
+	const unsigned first(_sn_first[s]);
+	const unsigned n_cols(_sn_first[s + 1] - first);
+	const unsigned m(_sn_row_ptr[s + 1] - _sn_row_ptr[s]);
+	unsigned const*const rows(_sn_rows + _sn_row_ptr[s]);
+
+	// *** assemble the frontal matrix (dense, column major, lower part)
+	double *F(new double[static_cast<std::size_t>(m) * m]);
+	std::fill(F, F + static_cast<std::size_t>(m) * m, 0.0);
+	for (unsigned q(0); q < n_cols; q++) {
+		const unsigned j(first + q);
+		for (unsigned k(_a_col_ptr[j]); k < _a_col_ptr[j + 1]; k++) {
+			const unsigned p(std::lower_bound(rows, rows + m, _a_row_idx[k]) - rows);
+			F[p + static_cast<std::size_t>(q) * m] += A[_a_map[k]];
+		}
+	}
+
+	// extend-add of the update matrices of the sons
+	unsigned *rel(new unsigned[m]);
+	for (unsigned l(_sn_son_ptr[s]); l < _sn_son_ptr[s + 1]; l++) {
+		const unsigned son(_sn_sons[l]);
+		const unsigned son_cols(_sn_first[son + 1] - _sn_first[son]);
+		const unsigned u(_sn_row_ptr[son + 1] - _sn_row_ptr[son] - son_cols);
+		unsigned const*const son_rows(_sn_rows + _sn_row_ptr[son] + son_cols);
+		// the rows of the update matrix are a subset of the rows of s
+		unsigned p(0);
+		for (unsigned i(0); i < u; i++) {
+			while (rows[p] != son_rows[i])
+				p++;
+			rel[i] = p;
+		}
+		double const*const U(updates[son]);
+		for (unsigned q(0); q < u; q++) {
+			double *F_col(F + static_cast<std::size_t>(rel[q]) * m);
+			double const*const U_col(U + static_cast<std::size_t>(q) * u);
+			for (unsigned i(q); i < u; i++)
+				F_col[rel[i]] += U_col[i];
+		}
+		delete [] updates[son];
+		updates[son] = NULL;
+	}
+	delete [] rel;
+
+	// *** factorize the columns of the supernode, the trailing part of F
+	// becomes the Schur complement
+	for (unsigned q(0); q < n_cols; q++) {
+		double *F_q(F + static_cast<std::size_t>(q) * m);
+		double d(F_q[q]);
+		if (d <= 0.0) {
+			#pragma omp critical (SparseCholeskyFailure)
+			_factorized = false;
+			d = 1.0;
+		}
+		d = sqrt(d);
+		F_q[q] = d;
+		for (unsigned i(q + 1); i < m; i++)
+			F_q[i] /= d;
+		for (unsigned c(q + 1); c < m; c++) {
+			const double l(F_q[c]);
+			if (l == 0.0)
+				continue;
+			double *F_c(F + static_cast<std::size_t>(c) * m);
+			for (unsigned i(c); i < m; i++)
+				F_c[i] -= F_q[i] * l;
+		}
+	}
+
+	std::copy(F, F + static_cast<std::size_t>(m) * n_cols, _L + _sn_L_ptr[s]);
+
+	double *U(NULL);
+	const unsigned u(m - n_cols);
+	if (_sn_father[s] != _n_supernodes && u > 0) {
+		U = new double[static_cast<std::size_t>(u) * u];
+		for (unsigned q(0); q < u; q++) {
+			double const*const F_col(F + static_cast<std::size_t>(n_cols + q) * m + n_cols);
+			double *U_col(U + static_cast<std::size_t>(q) * u);
+			for (unsigned i(q); i < u; i++)
+				U_col[i] = F_col[i];
+		}
+	}
+	delete [] F;
+	return U;
+}
+
+void SparseCholesky::execute(double* b) const
+{
+	double *y(new double[_n]);
+	for (unsigned i(0); i < _n; i++)
+		y[i] = b[_op_perm[i]];
+
+	// forward solve L z = y
+	for (unsigned s(0); s < _n_supernodes; s++) {
+		const unsigned first(_sn_first[s]);
+		const unsigned n_cols(_sn_first[s + 1] - first);
+		const unsigned m(_sn_row_ptr[s + 1] - _sn_row_ptr[s]);
+		unsigned const*const rows(_sn_rows + _sn_row_ptr[s]);
+		double const*const L(_L + _sn_L_ptr[s]);
+		for (unsigned q(0); q < n_cols; q++) {
+			double const*const L_q(L + static_cast<std::size_t>(q) * m);
+			const double z(y[first + q] / L_q[q]);
+			y[first + q] = z;
+			for (unsigned i(q + 1); i < m; i++)
+				y[rows[i]] -= L_q[i] * z;
+		}
+	}
+
+	// backward solve L^T x = z
+	for (unsigned s(_n_supernodes); s > 0; s--) {
+		const unsigned first(_sn_first[s - 1]);
+		const unsigned n_cols(_sn_first[s] - first);
+		const unsigned m(_sn_row_ptr[s] - _sn_row_ptr[s - 1]);
+		unsigned const*const rows(_sn_rows + _sn_row_ptr[s - 1]);
+		double const*const L(_L + _sn_L_ptr[s - 1]);
+		for (unsigned q(n_cols); q > 0; q--) {
+			double const*const L_q(L + static_cast<std::size_t>(q - 1) * m);
+			double x(y[first + q - 1]);
+			for (unsigned i(q); i < m; i++)
+				x -= L_q[i] * y[rows[i]];
+			y[first + q - 1] = x / L_q[q - 1];
+		}
+	}
+
+	for (unsigned i(0); i < _n; i++)
+		b[_op_perm[i]] = y[i];
+	delete [] y;
+}
+
+std::size_t SparseCholesky::getNNZ() const
+{
+	std::size_t nnz(0);
+	for (unsigned s(0); s < _n_supernodes; s++) {
+		const std::size_t n_cols(_sn_first[s + 1] - _sn_first[s]);
+		nnz += (_sn_row_ptr[s + 1] - _sn_row_ptr[s]) * n_cols - n_cols * (n_cols - 1) / 2;
+	}
+	return nnz;
+}
+
+} // end namespace MathLib
@@ -0,0 +1,123 @@
+/*
+ * SparseCholesky.h
+ *
+ *  Created on: Feb 13, 2012
+ *      Author: TF
+ */
+
+#ifndef SPARSECHOLESKY_H_
+#define SPARSECHOLESKY_H_
+
+#include <cstddef>
+
+#include "DirectLinearSolver.h"
+
+namespace MathLib {
+
+/**
+ * Class SparseCholesky is a supernodal multifrontal Cholesky factorization
+ * \f$P A P^T = L L^T\f$ of a sparse symmetric positive definite matrix in
+ * compressed row storage format (both triangular parts stored).
+ *
+ * The elimination ordering \f$P\f$ is given by the permutation arrays of
+ * Cluster::createClusterTree() (nested dissection), the ordering of
+ * reverseCuthillMcKee() works as well. The factorization is split into two
+ * phases:
+ * - the symbolic phase (constructor) computes the elimination tree, the
+ *   fundamental supernodes and their row structures; it depends only on the
+ *   sparsity pattern
+ * - the numeric phase (factorize()) computes the entries of \f$L\f$, it can
+ *   be repeated for matrices with the same sparsity pattern
+ *
+ * In the numeric phase every supernode assembles the entries of \f$A\f$ and
+ * the update matrices of its sons into a dense frontal matrix, factorizes
+ * its columns and passes the Schur complement to its father. The sub-trees
+ * of the supernodal elimination tree are independent: for a nested dissection
+ * ordering these are the sub-trees of the clusters decoupled by a separator.
+ * The threads start at the leaves of the tree, the thread finishing the last
+ * son of a supernode continues with the supernode.
+ */
+class SparseCholesky : public MathLib::DirectLinearSolver
+{
+public:
+	/**
+	 * Symbolic factorization. The arrays are not copied.
+	 * @param n number of rows / columns
+	 * @param iA row pointer of compressed row storage format
+	 * @param jA column index of compressed row storage format
+	 * @param op_perm permutation (original_idx = op_perm[permuted_idx]), NULL for the identity
+	 * @param po_perm inverse permutation (permuted_idx = po_perm[original_idx]), NULL for the identity
+	 */
+	SparseCholesky(unsigned n, unsigned const*const iA, unsigned const*const jA,
+					unsigned const*const op_perm = NULL, unsigned const*const po_perm = NULL);
+	virtual ~SparseCholesky();
+
+	/**
+	 * Numeric factorization of the matrix with the sparsity pattern given in
+	 * the constructor.
+	 * @param A data entries of compressed row storage format
+	 * @return false if the matrix is not (numerically) positive definite
+	 */
+	bool factorize(double const*const A);
+
+	/**
+	 * solves \f$A x = b\f$ using the factorization
+	 * @param b at the beginning the right hand side, at the end the solution
+	 */
+	void execute(double* b) const;
+
+	unsigned getNSupernodes() const { return _n_supernodes; }
+	/**
+	 * @return the number of non-zero entries of \f$L\f$ (including the
+	 * explicitly stored zeros within the dense blocks of the supernodes)
+	 */
+	std::size_t getNNZ() const;
+
+private:
+	// noncopyable
+	SparseCholesky(SparseCholesky const&);
+	SparseCholesky& operator= (SparseCholesky const&);
+
+	/**
+	 * assembles and factorizes the frontal matrix of the supernode s
+	 * @param updates the update matrices of the supernodes, the update
+	 * matrices of the sons of s are released
+	 * @return the update matrix (Schur complement) for the father of s, NULL
+	 * if s is a root
+	 */
+	double* factorizeSupernode(unsigned s, double const*const A, double** updates);
+
+	unsigned const _n;
+	unsigned *_op_perm;
+	unsigned *_po_perm;
+
+	/**
+	 * entries of the lower triangular part of the permuted matrix by columns:
+	 * column j consists of the rows _a_row_idx[k] with the values
+	 * A[_a_map[k]] for _a_col_ptr[j] <= k < _a_col_ptr[j+1]
+	 */
+	unsigned *_a_col_ptr;
+	unsigned *_a_row_idx;
+	unsigned *_a_map;
+
+	unsigned _n_supernodes;
+	/** supernode s consists of the columns _sn_first[s], ..., _sn_first[s+1]-1 */
+	unsigned *_sn_first;
+	/** rows of supernode s: _sn_rows[_sn_row_ptr[s]], ..., _sn_rows[_sn_row_ptr[s+1]-1] (sorted) */
+	std::size_t *_sn_row_ptr;
+	unsigned *_sn_rows;
+	/** the sons of supernode s: _sn_sons[_sn_son_ptr[s]], ..., _sn_sons[_sn_son_ptr[s+1]-1] */
+	unsigned *_sn_son_ptr;
+	unsigned *_sn_sons;
+	/** father of supernode s, _n_supernodes for roots */
+	unsigned *_sn_father;
+
+	/** the dense column major blocks (rows x columns) of L of the supernodes */
+	std::size_t *_sn_L_ptr;
+	double *_L;
+	bool _factorized;
+};
+
+} // end namespace MathLib
+
+#endif /* SPARSECHOLESKY_H_ */
@@ -0,0 +1,186 @@
+/*
+ * AmuxThreadPool.cpp
+ *
+ *  Created on: Jan 18, 2012
+ *      Author: TF
+ */
+
+#include <cstddef>
+#include <iostream>
+
+#ifdef HAVE_PTHREADS
+#include <unistd.h>
+#include <sched.h>
+#endif
+
+#include "AmuxThreadPool.h"
+
+namespace MathLib {
+
+/**
+ * number of checks of the generation counter before a waiting worker thread
+ * parks on the condition variable
+ */
+const unsigned AMUX_THREAD_POOL_SPIN_COUNT = 1 << 16;
+
+AmuxThreadPool::AmuxThreadPool(unsigned num_of_threads, bool pin_threads) :
+#ifdef HAVE_PTHREADS
+	_threads(NULL), _worker_params(NULL),
+#endif
+	_num_of_threads(num_of_threads == 0 ? 1 : num_of_threads),
+	_task(NULL), _task_data(NULL),
+	_spin_count(AMUX_THREAD_POOL_SPIN_COUNT),
+	_generation(0), _n_finished(0), _n_parked(0), _terminate(false)
+{
+#ifdef HAVE_PTHREADS
+	pthread_mutex_init(&_mutex, NULL);
+	pthread_cond_init(&_cond, NULL);
+
+	if (_num_of_threads == 1)
+		return;
+
+	// if there are more threads than processors spinning threads would
+	// steal the processor from the working threads
+	const long n_procs(sysconf(_SC_NPROCESSORS_ONLN));
+	if (n_procs > 0 && _num_of_threads > static_cast<unsigned>(n_procs))
+		_spin_count = 0;
+
+	_threads = new pthread_t[_num_of_threads - 1];
+	_worker_params = new WorkerParam[_num_of_threads - 1];
+
+#ifndef __linux__
+	(void) pin_threads;
+#endif
+
+	for (unsigned k(1); k < _num_of_threads; k++) {
+		_worker_params[k - 1]._pool = this;
+		_worker_params[k - 1]._thread_id = k;
+
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		bool pinned(false);
+#ifdef __linux__
+		if (pin_threads && n_procs > 0) {
+			cpu_set_t cpu_set;
+			CPU_ZERO(&cpu_set);
+			CPU_SET(k % n_procs, &cpu_set);
+			pinned = pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpu_set) == 0;
+		}
+#endif
+		int err(pthread_create(&(_threads[k - 1]), &attr, workerEntry, &(_worker_params[k - 1])));
+		pthread_attr_destroy(&attr);
+		// the processor may not be available to the process (cpuset)
+		if (err != 0 && pinned)
+			err = pthread_create(&(_threads[k - 1]), NULL, workerEntry, &(_worker_params[k - 1]));
+		if (err != 0) {
+			// continue with the threads created so far, the calling thread
+			// alone computes the multiplication if no worker is running
+			std::cerr << "AmuxThreadPool: could not create thread " << k << " (error " << err
+					<< "), using " << k << " threads" << std::endl;
+			_num_of_threads = k;
+			break;
+		}
+	}
+#else
+	(void) pin_threads;
+#endif
+}
+
+AmuxThreadPool::~AmuxThreadPool()
+{
+#ifdef HAVE_PTHREADS
+	if (_num_of_threads > 1) {
+		_terminate = true;
+		__sync_fetch_and_add(&_generation, 1);
+		pthread_mutex_lock(&_mutex);
+		pthread_cond_broadcast(&_cond);
+		pthread_mutex_unlock(&_mutex);
+
+		for (unsigned k(1); k < _num_of_threads; k++) {
+			pthread_join(_threads[k - 1], NULL);
+		}
+	}
+
+	delete [] _threads;
+	delete [] _worker_params;
+	pthread_cond_destroy(&_cond);
+	pthread_mutex_destroy(&_mutex);
+#endif
+}
+
+void AmuxThreadPool::run(TaskFunction task, void const* data)
+{
+	_task = task;
+	_task_data = data;
+
+#ifdef HAVE_PTHREADS
+	if (_num_of_threads > 1) {
+		_n_finished = 0;
+		// __sync_fetch_and_add is a full memory barrier, i.e. the task
+		// is visible for the worker threads before the new generation
+		__sync_fetch_and_add(&_generation, 1);
+		if (_n_parked > 0) {
+			pthread_mutex_lock(&_mutex);
+			pthread_cond_broadcast(&_cond);
+			pthread_mutex_unlock(&_mutex);
+		}
+	}
+#endif
+
+	_task(_task_data, 0);
+
+#ifdef HAVE_PTHREADS
+	unsigned cnt(0);
+	while (_n_finished != _num_of_threads - 1) {
+		if (cnt < _spin_count)
+			cnt++;
+		else
+			sched_yield();
+	}
+	__sync_synchronize();
+#else
+	for (unsigned k(1); k < _num_of_threads; k++)
+		_task(_task_data, k);
+#endif
+}
+
+#ifdef HAVE_PTHREADS
+void* AmuxThreadPool::workerEntry(void* ptr)
+{
+	WorkerParam* param(static_cast<WorkerParam*>(ptr));
+	param->_pool->work(param->_thread_id);
+	return NULL;
+}
+
+void AmuxThreadPool::work(unsigned thread_id)
+{
+	unsigned generation(0);
+	while (true) {
+		// spin ...
+		unsigned cnt(0);
+		while (_generation == generation && cnt < _spin_count) {
+			cnt++;
+		}
+		// ... then park
+		if (_generation == generation) {
+			pthread_mutex_lock(&_mutex);
+			__sync_fetch_and_add(&_n_parked, 1);
+			while (_generation == generation) {
+				pthread_cond_wait(&_cond, &_mutex);
+			}
+			__sync_fetch_and_sub(&_n_parked, 1);
+			pthread_mutex_unlock(&_mutex);
+		}
+		__sync_synchronize();
+		generation = _generation;
+
+		if (_terminate)
+			return;
+
+		_task(_task_data, thread_id);
+		__sync_fetch_and_add(&_n_finished, 1);
+	}
+}
+#endif
+
+} // end namespace MathLib
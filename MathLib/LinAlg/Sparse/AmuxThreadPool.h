@@ -0,0 +1,190 @@
+/*
+ * AmuxThreadPool.h
+ *
+ *  Created on: Jan 18, 2012
+ *      Author: TF
+ */
+
+#ifndef AMUXTHREADPOOL_H_
+#define AMUXTHREADPOOL_H_
+
+#include <cstddef>
+
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
+#include "amuxCRS.h"
+
+namespace MathLib {
+
+/**
+ * Class AmuxThreadPool holds a fixed number of worker threads that are created
+ * once and reused for every matrix vector multiplication. In contrast to
+ * amuxCRSParallelPThreads(), where the threads are created and joined for every
+ * single multiplication, the cost per call is a barrier only.
+ *
+ * The calling thread works on the first row block, the remaining row blocks are
+ * processed by num_of_threads-1 worker threads. Waiting worker threads spin a
+ * while on the generation counter before they park on a condition variable,
+ * i.e. within an iterative solver, where the multiplications follow each other
+ * closely, the threads are woken up without a system call. If there are more
+ * threads than processors the threads park immediately.
+ */
+class AmuxThreadPool
+{
+public:
+	/**
+	 * Constructor creates num_of_threads-1 worker threads. If a thread can
+	 * not be created the pool continues with the threads created so far,
+	 * see getNumberOfThreads().
+	 * @param num_of_threads number of threads (including the calling thread)
+	 * @param pin_threads if true, worker thread k is bound to processor k (only linux)
+	 */
+	AmuxThreadPool(unsigned num_of_threads, bool pin_threads = true);
+	~AmuxThreadPool();
+
+	/**
+	 * y = a * A * x, where A is given in compressed row storage format
+	 * @param a scalar factor
+	 * @param iA row pointer array
+	 * @param jA column index array
+	 * @param A entries of the matrix
+	 * @param x vector to multiply with
+	 * @param y result vector
+	 * @param row_partition array of length getNumberOfThreads()+1, thread k
+	 * works on the rows row_partition[k], ..., row_partition[k+1]-1
+	 */
+	template <typename FP_TYPE, typename IDX_TYPE>
+	void amux(FP_TYPE a, IDX_TYPE const * const iA, IDX_TYPE const * const jA,
+					FP_TYPE const * const A, FP_TYPE const * const x, FP_TYPE* y,
+					IDX_TYPE const * const row_partition)
+	{
+		AmuxTask<FP_TYPE, IDX_TYPE> task = { a, iA, jA, A, x, y, row_partition };
+		run(&AmuxTask<FP_TYPE, IDX_TYPE>::rowBlock, &task);
+	}
+
+	/**
+	 * Y = a * A * X for a block of k vectors stored row by row, see
+	 * amuxCRSBlock(), for the other parameters see amux()
+	 */
+	template <typename FP_TYPE, typename IDX_TYPE>
+	void amuxBlock(FP_TYPE a, IDX_TYPE const * const iA, IDX_TYPE const * const jA,
+					FP_TYPE const * const A, unsigned k, FP_TYPE const * const X, FP_TYPE* Y,
+					IDX_TYPE const * const row_partition)
+	{
+		AmuxBlockTask<FP_TYPE, IDX_TYPE> task = { a, iA, jA, A, k, X, Y, row_partition };
+		run(&AmuxBlockTask<FP_TYPE, IDX_TYPE>::rowBlock, &task);
+	}
+
+	/**
+	 * function type of a task: the task is split into getNumberOfThreads()
+	 * blocks, the function is called once for every block
+	 */
+	typedef void (*TaskFunction)(void const* data, unsigned block);
+
+	/**
+	 * calls task(data, k) for k = 0, ..., getNumberOfThreads()-1 in
+	 * parallel and returns when all blocks are finished
+	 */
+	void run(TaskFunction task, void const* data);
+
+	unsigned getNumberOfThreads() const { return _num_of_threads; }
+
+private:
+	// noncopyable
+	AmuxThreadPool(AmuxThreadPool const&);
+	AmuxThreadPool& operator= (AmuxThreadPool const&);
+
+	/**
+	 * The worker threads wait within this method for the next task.
+	 * @param thread_id number of the worker thread, 1 <= thread_id < _num_of_threads
+	 */
+	void work(unsigned thread_id);
+	/**
+	 * parameters of amux(), rowBlock() computes the rows of the given block
+	 */
+	template <typename FP_TYPE, typename IDX_TYPE>
+	struct AmuxTask {
+		FP_TYPE _a;
+		IDX_TYPE const* _iA;
+		IDX_TYPE const* _jA;
+		FP_TYPE const* _A;
+		FP_TYPE const* _x;
+		FP_TYPE* _y;
+		IDX_TYPE const* _row_partition;
+
+		static void rowBlock(void const* data, unsigned block)
+		{
+			AmuxTask const& t(*static_cast<AmuxTask const*>(data));
+			const IDX_TYPE beg_row(t._row_partition[block]);
+			const IDX_TYPE end_row(t._row_partition[block + 1]);
+			for (IDX_TYPE i(beg_row); i < end_row; i++) {
+				FP_TYPE tmp(0.0);
+				const IDX_TYPE end(t._iA[i + 1]);
+				for (IDX_TYPE j(t._iA[i]); j < end; j++) {
+					tmp += t._A[j] * t._x[t._jA[j]];
+				}
+				t._y[i] = t._a * tmp;
+			}
+		}
+	};
+
+	/**
+	 * parameters of amuxBlock(), rowBlock() computes the rows of the given block
+	 */
+	template <typename FP_TYPE, typename IDX_TYPE>
+	struct AmuxBlockTask {
+		FP_TYPE _a;
+		IDX_TYPE const* _iA;
+		IDX_TYPE const* _jA;
+		FP_TYPE const* _A;
+		unsigned _k;
+		FP_TYPE const* _X;
+		FP_TYPE* _Y;
+		IDX_TYPE const* _row_partition;
+
+		static void rowBlock(void const* data, unsigned block)
+		{
+			AmuxBlockTask const& t(*static_cast<AmuxBlockTask const*>(data));
+			const IDX_TYPE beg_row(t._row_partition[block]);
+			amuxCRSBlock(t._a, t._row_partition[block + 1] - beg_row, t._iA + beg_row, t._jA,
+							t._A, t._k, t._X, t._Y + static_cast<std::size_t>(beg_row) * t._k);
+		}
+	};
+
+#ifdef HAVE_PTHREADS
+	struct WorkerParam {
+		AmuxThreadPool* _pool;
+		unsigned _thread_id;
+	};
+	/** start routine of the worker threads, ptr points to a WorkerParam object */
+	static void* workerEntry(void* ptr);
+
+	pthread_t* _threads;
+	WorkerParam* _worker_params;
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+#endif
+
+	/** number of threads, less than requested if a worker thread could not be created */
+	unsigned _num_of_threads;
+
+	// the current task
+	TaskFunction _task;
+	void const* _task_data;
+
+	/** number of checks of a shared variable before a waiting thread gives up its processor */
+	unsigned _spin_count;
+	/** is incremented for every new task */
+	volatile unsigned _generation;
+	/** number of worker threads that finished the current task */
+	volatile unsigned _n_finished;
+	/** number of worker threads waiting on the condition variable */
+	volatile unsigned _n_parked;
+	volatile bool _terminate;
+};
+
+} // end namespace MathLib
+
+#endif /* AMUXTHREADPOOL_H_ */
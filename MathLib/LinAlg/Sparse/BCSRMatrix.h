@@ -0,0 +1,359 @@
+/*
+ * BCSRMatrix.h
+ *
+ *  Created on: Feb 7, 2012
+ *      Author: TF
+ */
+
+#ifndef BCSRMATRIX_H_
+#define BCSRMATRIX_H_
+
+#include <string>
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "CRSMatrix.h"
+#include "SparseMatrixBase.h"
+#include "amuxBCSR.h"
+#include "partitionRowsByNNZ.h"
+
+namespace MathLib {
+
+/**
+ * Class BCSRMatrix represents a sparse matrix in block compressed row storage
+ * format, i.e. the matrix consists of dense BS x BS blocks and only one column
+ * index is stored per block. This is suitable for systems with BS unknowns per
+ * mesh node (for instance coupled hydro-mechanical problems): in comparison to
+ * the compressed row storage format the amount of column indices and thus the
+ * memory traffic for indices within the matrix vector multiplication is
+ * reduced by the factor BS^2.
+ *
+ * The unknowns of a node have to be numbered consecutively, i.e. the block
+ * row i consists of the rows i*BS, ..., i*BS+BS-1. Blocks that are only
+ * partially occupied in the original matrix are filled with zeros.
+ *
+ * The preconditioner is block Jacobi, i.e. the inverses of the diagonal
+ * blocks are applied. It has to be calculated explicitly via calcPrecond().
+ * The class provides amux() and precondApply(), so it can be used with the
+ * templated iterative solvers (see CGTemplate.h, BiCGStabTemplate.h and
+ * GMResTemplate.h).
+ */
+template<typename FP_TYPE, typename IDX_TYPE, unsigned BS>
+class BCSRMatrix: public SparseMatrixBase<FP_TYPE, IDX_TYPE>
+{
+public:
+	/**
+	 * Constructor reads the matrix in binary compressed row storage format
+	 * (see CRSMatrix::CRSMatrix(std::string const&)) and converts it into the
+	 * block compressed row storage format.
+	 * @param fname the name of the file that contains the matrix
+	 */
+	BCSRMatrix(std::string const& fname) :
+		SparseMatrixBase<FP_TYPE, IDX_TYPE>(),
+		_block_row_ptr(NULL), _block_col_idx(NULL), _data(NULL), _inv_diag(NULL),
+		_row_partitions()
+	{
+		CRSMatrix<FP_TYPE, IDX_TYPE> mat(fname);
+		convert(mat);
+	}
+
+	/**
+	 * Constructor converts a matrix in compressed row storage format into the
+	 * block compressed row storage format.
+	 * @param mat the matrix, the number of rows has to be a multiple of BS
+	 * (otherwise the program is aborted)
+	 */
+	BCSRMatrix(CRSMatrix<FP_TYPE, IDX_TYPE> const& mat) :
+		SparseMatrixBase<FP_TYPE, IDX_TYPE>(),
+		_block_row_ptr(NULL), _block_col_idx(NULL), _data(NULL), _inv_diag(NULL),
+		_row_partitions()
+	{
+		convert(mat);
+	}
+
+	virtual ~BCSRMatrix()
+	{
+		delete [] _block_row_ptr;
+		delete [] _block_col_idx;
+		delete [] _data;
+		delete [] _inv_diag;
+		for (std::size_t k(0); k < _row_partitions.size(); k++)
+			delete [] _row_partitions[k].second;
+	}
+
+	virtual void amux(FP_TYPE d, FP_TYPE const * const __restrict__ x, FP_TYPE * __restrict__ y) const
+	{
+#ifdef _OPENMP
+		const unsigned n_threads(omp_get_max_threads());
+		if (n_threads > 1) {
+			amuxBCSRParallelOpenMP<FP_TYPE, IDX_TYPE, BS>(d, _block_row_ptr, _block_col_idx, _data,
+							x, y, n_threads, getBlockRowPartition(n_threads));
+			return;
+		}
+#endif
+		amuxBCSR<FP_TYPE, IDX_TYPE, BS>(d, getNBlockRows(), _block_row_ptr, _block_col_idx, _data, x, y);
+	}
+
+	/**
+	 * calculates the block Jacobi preconditioner, i.e. the inverses of the
+	 * diagonal blocks. If a diagonal block is missing or singular the
+	 * identity is used for this block.
+	 * @return the number of missing or singular diagonal blocks
+	 */
+	unsigned calcPrecond()
+	{
+		const IDX_TYPE nb(getNBlockRows());
+		delete [] _inv_diag;
+		_inv_diag = new FP_TYPE[nb * BS * BS];
+
+		unsigned n_singular(0);
+		OPENMP_LOOP_TYPE i;
+		#pragma omp parallel for reduction(+:n_singular)
+		for (i = 0; i < nb; i++) {
+			FP_TYPE *inv(_inv_diag + i * BS * BS);
+			bool found(false);
+			for (IDX_TYPE j(_block_row_ptr[i]); j < _block_row_ptr[i + 1] && !found; j++) {
+				if (_block_col_idx[j] == static_cast<IDX_TYPE>(i)) {
+					found = invertBlock(_data + j * BS * BS, inv);
+				}
+			}
+			if (!found) {
+				for (unsigned k(0); k < BS * BS; k++)
+					inv[k] = 0.0;
+				for (unsigned k(0); k < BS; k++)
+					inv[k * (BS + 1)] = 1.0;
+				n_singular++;
+			}
+		}
+		return n_singular;
+	}
+
+	/**
+	 * applies the block Jacobi preconditioner in place, the preconditioner
+	 * has to be calculated via calcPrecond() before
+	 */
+	void precondApply(FP_TYPE* x) const
+	{
+		if (_inv_diag == NULL)
+			return;
+		const IDX_TYPE nb(getNBlockRows());
+		OPENMP_LOOP_TYPE i;
+		#pragma omp parallel for
+		for (i = 0; i < nb; i++) {
+			FP_TYPE const*const inv(_inv_diag + i * BS * BS);
+			FP_TYPE *const xi(x + i * BS);
+			FP_TYPE tmp[BS];
+			for (unsigned r(0); r < BS; r++) {
+				tmp[r] = 0.0;
+				for (unsigned c(0); c < BS; c++)
+					tmp[r] += inv[r * BS + c] * xi[c];
+			}
+			for (unsigned r(0); r < BS; r++)
+				xi[r] = tmp[r];
+		}
+	}
+
+	/**
+	 * get the number of block rows / block columns
+	 */
+	IDX_TYPE getNBlockRows() const { return static_cast<IDX_TYPE>(MatrixBase::_n_rows / BS); }
+
+	/**
+	 * get the number of (non-zero) blocks
+	 */
+	IDX_TYPE getNBlocks() const { return _block_row_ptr[getNBlockRows()]; }
+
+	/**
+	 * get the number of stored entries including the zeros filled into the blocks
+	 */
+	IDX_TYPE getNNZ() const { return getNBlocks() * BS * BS; }
+
+	/**
+	 * get the block row pointer array
+	 */
+	IDX_TYPE const* getBlockRowPtrArray() const { return _block_row_ptr; }
+
+	/**
+	 * get the block column index array
+	 */
+	IDX_TYPE const* getBlockColIdxArray() const { return _block_col_idx; }
+
+	/**
+	 * get the entries, the blocks are stored consecutively, each row by row
+	 */
+	FP_TYPE const* getEntryArray() const { return _data; }
+
+	/**
+	 * get a partition of the block rows into n_blocks parts with (nearly) the
+	 * same number of blocks (see partitionRowsByNNZ()), the partitions are
+	 * cached in the same way as in CRSMatrix::getRowPartition()
+	 */
+	IDX_TYPE const* getBlockRowPartition(unsigned n_blocks) const
+	{
+		IDX_TYPE const* partition(NULL);
+		#pragma omp critical (BCSRMatrix_getBlockRowPartition)
+		{
+			for (std::size_t k(0); k < _row_partitions.size() && partition == NULL; k++) {
+				if (_row_partitions[k].first == n_blocks)
+					partition = _row_partitions[k].second;
+			}
+			if (partition == NULL) {
+				IDX_TYPE *new_partition(new IDX_TYPE[n_blocks + 1]);
+				partitionRowsByNNZ(getNBlockRows(), _block_row_ptr, n_blocks, new_partition);
+				_row_partitions.push_back(std::make_pair(n_blocks, new_partition));
+				partition = new_partition;
+			}
+		}
+		return partition;
+	}
+
+private:
+	// noncopyable
+	BCSRMatrix(BCSRMatrix const&);
+	BCSRMatrix& operator= (BCSRMatrix const&);
+
+	void convert(CRSMatrix<FP_TYPE, IDX_TYPE> const& mat)
+	{
+		const IDX_TYPE n(mat.getNRows());
+		if (n % BS != 0) {
+			// truncating the matrix would change the operator
+			std::cerr << "BCSRMatrix: number of rows " << n << " is not a multiple of the block size "
+					<< BS << std::endl;
+			std::abort();
+		}
+		const IDX_TYPE nb(n / BS);
+		MatrixBase::_n_rows = MatrixBase::_n_cols = nb * BS;
+
+		IDX_TYPE const*const iA(mat.getRowPtrArray());
+		IDX_TYPE const*const jA(mat.getColIdxArray());
+		FP_TYPE const*const A(mat.getEntryArray());
+
+		// the matrix is square, entries outside would be lost
+		for (IDX_TYPE j(0); j < iA[n]; j++) {
+			if (jA[j] >= n) {
+				std::cerr << "BCSRMatrix: column index " << jA[j] << " exceeds the number of columns "
+						<< n << std::endl;
+				std::abort();
+			}
+		}
+
+		// marker[J] is the last block row containing the block column J (first
+		// pass) or the position of the last block of block column J (second pass)
+		const IDX_TYPE unused(static_cast<IDX_TYPE>(-1));
+		IDX_TYPE *marker(new IDX_TYPE[nb]);
+		for (IDX_TYPE J(0); J < nb; J++)
+			marker[J] = unused;
+
+		// count the blocks of every block row
+		_block_row_ptr = new IDX_TYPE[nb + 1];
+		_block_row_ptr[0] = 0;
+		for (IDX_TYPE I(0); I < nb; I++) {
+			IDX_TYPE cnt(0);
+			for (IDX_TYPE i(I * BS); i < (I + 1) * BS; i++) {
+				for (IDX_TYPE j(iA[i]); j < iA[i + 1]; j++) {
+					const IDX_TYPE J(jA[j] / BS);
+					if (marker[J] != I) {
+						marker[J] = I;
+						cnt++;
+					}
+				}
+			}
+			_block_row_ptr[I + 1] = _block_row_ptr[I] + cnt;
+		}
+
+		// fill the blocks, the block columns are stored in the order of their
+		// first occurrence within the block row
+		const IDX_TYPE n_blocks(_block_row_ptr[nb]);
+		_block_col_idx = new IDX_TYPE[n_blocks];
+		_data = new FP_TYPE[n_blocks * BS * BS];
+		for (IDX_TYPE J(0); J < nb; J++)
+			marker[J] = unused;
+		for (IDX_TYPE I(0); I < nb; I++) {
+			IDX_TYPE pos(_block_row_ptr[I]);
+			for (IDX_TYPE i(I * BS); i < (I + 1) * BS; i++) {
+				for (IDX_TYPE j(iA[i]); j < iA[i + 1]; j++) {
+					const IDX_TYPE J(jA[j] / BS);
+					if (marker[J] == unused || marker[J] < _block_row_ptr[I]) {
+						marker[J] = pos;
+						_block_col_idx[pos] = J;
+						for (unsigned k(0); k < BS * BS; k++)
+							_data[pos * BS * BS + k] = 0.0;
+						pos++;
+					}
+					_data[marker[J] * BS * BS + (i - I * BS) * BS + (jA[j] - J * BS)] = A[j];
+				}
+			}
+		}
+		delete [] marker;
+	}
+
+	/**
+	 * inverts a dense BS x BS block (stored row by row) via Gauss-Jordan
+	 * elimination with partial pivoting
+	 * @return false if the block is singular
+	 */
+	static bool invertBlock(FP_TYPE const* block, FP_TYPE* inv)
+	{
+		FP_TYPE a[BS * BS];
+		for (unsigned k(0); k < BS * BS; k++) {
+			a[k] = block[k];
+			inv[k] = 0.0;
+		}
+		for (unsigned k(0); k < BS; k++)
+			inv[k * (BS + 1)] = 1.0;
+
+		for (unsigned c(0); c < BS; c++) {
+			unsigned p(c);
+			for (unsigned r(c + 1); r < BS; r++)
+				if (fabs(a[r * BS + c]) > fabs(a[p * BS + c]))
+					p = r;
+			if (a[p * BS + c] == 0.0)
+				return false;
+			if (p != c) {
+				for (unsigned k(0); k < BS; k++) {
+					std::swap(a[c * BS + k], a[p * BS + k]);
+					std::swap(inv[c * BS + k], inv[p * BS + k]);
+				}
+			}
+			const FP_TYPE d(static_cast<FP_TYPE>(1.0) / a[c * BS + c]);
+			for (unsigned k(0); k < BS; k++) {
+				a[c * BS + k] *= d;
+				inv[c * BS + k] *= d;
+			}
+			for (unsigned r(0); r < BS; r++) {
+				if (r == c)
+					continue;
+				const FP_TYPE f(a[r * BS + c]);
+				for (unsigned k(0); k < BS; k++) {
+					a[r * BS + k] -= f * a[c * BS + k];
+					inv[r * BS + k] -= f * inv[c * BS + k];
+				}
+			}
+		}
+		return true;
+	}
+
+	/** block row pointer array of length n/BS+1 */
+	IDX_TYPE *_block_row_ptr;
+	/** block column indices */
+	IDX_TYPE *_block_col_idx;
+	/** entries of the blocks, each block is stored row by row */
+	FP_TYPE *_data;
+	/** inverses of the diagonal blocks (block Jacobi preconditioner) */
+	FP_TYPE *_inv_diag;
+
+	/** cached partitions of the block rows, see getBlockRowPartition() */
+	mutable std::vector<std::pair<unsigned, IDX_TYPE*> > _row_partitions;
+};
+
+} // end namespace MathLib
+
+#endif /* BCSRMATRIX_H_ */
@@ -0,0 +1,243 @@
+/*
+ * CRSAssembler.h
+ *
+ *  Created on: Feb 8, 2012
+ *      Author: TF
+ */
+
+#ifndef CRSASSEMBLER_H_
+#define CRSASSEMBLER_H_
+
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <stdint.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Base
+#include "radixSort.h"
+
+// MathLib
+#include "CRSMatrix.h"
+
+namespace MathLib {
+
+/**
+ * Class CRSAssembler builds a (square) matrix in compressed row storage format
+ * from unordered triplets (row, column, value), for instance from the
+ * contributions of the element matrices of a finite element mesh. The sparsity
+ * pattern has not to be known in advance.
+ *
+ * The triplets can be added concurrently by the threads of an OpenMP parallel
+ * region, every thread appends to its own buffer. The method assemble() sorts
+ * the triplets by (row, column) via a parallel radix sort, sums up the values
+ * of duplicate entries and creates the arrays of the compressed row storage
+ * format in parallel.
+ *
+ * Example:
+ * \code
+ * CRSAssembler<double, unsigned> assembler(n);
+ * #pragma omp parallel for
+ * for (e = 0; e < n_elements; e++)
+ *     for all entries (i,j) of the element matrix K_e
+ *         assembler.add(i, j, K_e(i,j));
+ * CRSMatrix<double, unsigned>* mat(assembler.createMatrix());
+ * \endcode
+ */
+template<typename FP_TYPE, typename IDX_TYPE>
+class CRSAssembler
+{
+public:
+	/**
+	 * @param n number of rows / columns of the matrix
+	 */
+	explicit CRSAssembler(IDX_TYPE n) :
+		_n(n), _col_bits(1),
+#ifdef _OPENMP
+		_n_buffers(omp_get_max_threads()),
+#else
+		_n_buffers(1),
+#endif
+		_buffers(new Buffer[_n_buffers])
+	{
+		while (_col_bits < 64 && (static_cast<uint64_t>(1) << _col_bits) < static_cast<uint64_t>(n))
+			_col_bits++;
+	}
+
+	~CRSAssembler()
+	{
+		delete [] _buffers;
+	}
+
+	/**
+	 * reserves memory for the given number of triplets in the buffer of every thread
+	 */
+	void reserve(std::size_t n_triplets_per_thread)
+	{
+		for (unsigned k(0); k < _n_buffers; k++)
+			_buffers[k].triplets.reserve(n_triplets_per_thread);
+	}
+
+	/**
+	 * adds the value to the entry (row, col), the values of multiple
+	 * contributions to the same entry are summed up. The method can be called
+	 * concurrently from the threads of an OpenMP parallel region, the number
+	 * of threads must not exceed the maximal number of threads at the time
+	 * the object was constructed.
+	 */
+	void add(IDX_TYPE row, IDX_TYPE col, FP_TYPE val)
+	{
+		assert(row < _n && col < _n);
+#ifdef _OPENMP
+		const unsigned thread(omp_get_thread_num());
+		assert(thread < _n_buffers);
+#else
+		const unsigned thread(0);
+#endif
+		Triplet t;
+		t.key = (static_cast<uint64_t>(row) << _col_bits) | static_cast<uint64_t>(col);
+		t.val = val;
+		_buffers[thread].triplets.push_back(t);
+	}
+
+	/**
+	 * get the number of triplets added so far
+	 */
+	std::size_t getNTriplets() const
+	{
+		std::size_t n(0);
+		for (unsigned k(0); k < _n_buffers; k++)
+			n += _buffers[k].triplets.size();
+		return n;
+	}
+
+	/**
+	 * Creates the arrays of the compressed row storage format from the added
+	 * triplets. The arrays are allocated via new [], the buffers of the
+	 * triplets are released.
+	 * @param iA row pointer array (output)
+	 * @param jA column index array (output), the column indices of a row are sorted
+	 * @param A data array (output)
+	 */
+	void assemble(IDX_TYPE* &iA, IDX_TYPE* &jA, FP_TYPE* &A)
+	{
+		// gather the triplets of all threads
+		std::size_t *offsets(new std::size_t[_n_buffers + 1]);
+		offsets[0] = 0;
+		for (unsigned k(0); k < _n_buffers; k++)
+			offsets[k + 1] = offsets[k] + _buffers[k].triplets.size();
+		const std::size_t m(offsets[_n_buffers]);
+		Triplet *triplets(new Triplet[m]);
+		Triplet *tmp(new Triplet[m]);
+
+		OPENMP_LOOP_TYPE b;
+		#pragma omp parallel for schedule(dynamic)
+		for (b = 0; b < _n_buffers; b++) {
+			std::vector<Triplet> &buffer(_buffers[b].triplets);
+			for (std::size_t k(0); k < buffer.size(); k++)
+				triplets[offsets[b] + k] = buffer[k];
+			std::vector<Triplet>().swap(buffer);
+		}
+
+		Triplet *sorted(BaseLib::radixSort(triplets, tmp, m, 2 * _col_bits));
+
+		// count the distinct entries within the chunks of the sorted triplets
+#ifdef _OPENMP
+		const unsigned n_chunks(omp_get_max_threads());
+#else
+		const unsigned n_chunks(1);
+#endif
+		std::size_t *chunk_offsets(new std::size_t[n_chunks + 1]);
+		OPENMP_LOOP_TYPE c;
+		#pragma omp parallel for
+		for (c = 0; c < n_chunks; c++) {
+			std::size_t cnt(0);
+			const std::size_t end(m * (c + 1) / n_chunks);
+			for (std::size_t k(m * c / n_chunks); k < end; k++)
+				if (k == 0 || sorted[k].key != sorted[k - 1].key)
+					cnt++;
+			chunk_offsets[c + 1] = cnt;
+		}
+		chunk_offsets[0] = 0;
+		for (unsigned k(0); k < n_chunks; k++)
+			chunk_offsets[k + 1] += chunk_offsets[k];
+		const std::size_t nnz(chunk_offsets[n_chunks]);
+
+		// merge the duplicates, a thread processes all distinct entries starting
+		// within its chunk and sets the row pointers of the rows starting there
+		iA = new IDX_TYPE[_n + 1];
+		jA = new IDX_TYPE[nnz];
+		A = new FP_TYPE[nnz];
+		const uint64_t col_mask((static_cast<uint64_t>(1) << _col_bits) - 1);
+		#pragma omp parallel for
+		for (c = 0; c < n_chunks; c++) {
+			std::size_t pos(chunk_offsets[c]);
+			const std::size_t end(m * (c + 1) / n_chunks);
+			for (std::size_t k(m * c / n_chunks); k < end; k++) {
+				if (k > 0 && sorted[k].key == sorted[k - 1].key)
+					continue;
+				const IDX_TYPE row(static_cast<IDX_TYPE>(sorted[k].key >> _col_bits));
+				const IDX_TYPE first_row(k == 0 ? 0 : static_cast<IDX_TYPE>(sorted[k - 1].key >> _col_bits) + 1);
+				for (IDX_TYPE r(first_row); r <= row; r++)
+					iA[r] = static_cast<IDX_TYPE>(pos);
+				FP_TYPE sum(sorted[k].val);
+				for (std::size_t j(k + 1); j < m && sorted[j].key == sorted[k].key; j++)
+					sum += sorted[j].val;
+				jA[pos] = static_cast<IDX_TYPE>(sorted[k].key & col_mask);
+				A[pos] = sum;
+				pos++;
+			}
+		}
+		// the rows behind the last entry are empty
+		const IDX_TYPE last_row(m == 0 ? 0 : static_cast<IDX_TYPE>(sorted[m - 1].key >> _col_bits) + 1);
+		for (IDX_TYPE r(last_row); r <= _n; r++)
+			iA[r] = static_cast<IDX_TYPE>(nnz);
+
+		delete [] chunk_offsets;
+		delete [] tmp;
+		delete [] triplets;
+		delete [] offsets;
+	}
+
+	/**
+	 * Creates a matrix from the added triplets, see assemble(). The buffers of
+	 * the triplets are released.
+	 * @return the matrix, the caller is responsible for deleting it
+	 */
+	CRSMatrix<FP_TYPE, IDX_TYPE>* createMatrix()
+	{
+		IDX_TYPE *iA(NULL), *jA(NULL);
+		FP_TYPE *A(NULL);
+		assemble(iA, jA, A);
+		return new CRSMatrix<FP_TYPE, IDX_TYPE>(_n, iA, jA, A);
+	}
+
+private:
+	// noncopyable
+	CRSAssembler(CRSAssembler const&);
+	CRSAssembler& operator= (CRSAssembler const&);
+
+	/** the entry (row, col) is encoded in the key as row * 2^_col_bits + col */
+	struct Triplet {
+		uint64_t key;
+		FP_TYPE val;
+	};
+
+	/** the buffer of a thread, padded in order to avoid false sharing */
+	struct Buffer {
+		std::vector<Triplet> triplets;
+		char padding[64];
+	};
+
+	const IDX_TYPE _n;
+	unsigned _col_bits;
+	const unsigned _n_buffers;
+	Buffer *_buffers;
+};
+
+} // end namespace MathLib
+
+#endif /* CRSASSEMBLER_H_ */
@@ -0,0 +1,185 @@
+/*
+ * CRSFile.cpp
+ *
+ *  Created on: Feb 1, 2012
+ *      Author: TF
+ */
+
+#include <cstring>
+
+#include "CRSFile.h"
+
+namespace MathLib {
+
+namespace {
+const char crs_file_magic[8] = { 'O', 'G', 'S', 'C', 'R', 'S', '\r', '\n' };
+
+uint64_t alignCRSFileOffset(uint64_t offset)
+{
+	return (offset + CRS_FILE_ALIGNMENT - 1) / CRS_FILE_ALIGNMENT * CRS_FILE_ALIGNMENT;
+}
+
+uint64_t getNumberOfBlocks(uint64_t size, uint64_t block_size)
+{
+	return (size + block_size - 1) / block_size;
+}
+} // end anonymous namespace
+
+bool isCRSFile(char const* data, std::size_t size)
+{
+	return size >= sizeof(crs_file_magic) && std::memcmp(data, crs_file_magic, sizeof(crs_file_magic)) == 0;
+}
+
+void initCRSFileHeader(CRSFileHeader& header, uint64_t n, uint64_t nnz, uint32_t index_size,
+				uint32_t value_type, bool checksums)
+{
+	std::memset(&header, 0, sizeof(CRSFileHeader));
+	std::memcpy(header.magic, crs_file_magic, sizeof(crs_file_magic));
+	header.version = CRS_FILE_VERSION;
+	header.endian_tag = CRS_FILE_ENDIAN_TAG;
+	header.index_size = index_size;
+	header.value_type = value_type;
+	header.n_rows = n;
+	header.n_cols = n;
+	header.nnz = nnz;
+
+	const uint64_t value_size(value_type == CRS_FILE_FLOAT ? sizeof(float) : sizeof(double));
+	header.row_ptr_offset = alignCRSFileOffset(sizeof(CRSFileHeader));
+	header.col_idx_offset = alignCRSFileOffset(header.row_ptr_offset + (n + 1) * index_size);
+	header.data_offset = alignCRSFileOffset(header.col_idx_offset + nnz * index_size);
+	header.checksum_block_size = CRS_FILE_CHECKSUM_BLOCK_SIZE;
+	if (checksums) {
+		header.checksum_offset = alignCRSFileOffset(header.data_offset + nnz * value_size);
+		header.n_checksums = getNumberOfBlocks((n + 1) * index_size, CRS_FILE_CHECKSUM_BLOCK_SIZE)
+						+ getNumberOfBlocks(nnz * index_size, CRS_FILE_CHECKSUM_BLOCK_SIZE)
+						+ getNumberOfBlocks(nnz * value_size, CRS_FILE_CHECKSUM_BLOCK_SIZE);
+	}
+}
+
+bool checkCRSFileHeader(CRSFileHeader const& header, uint64_t file_size)
+{
+	if (header.endian_tag != CRS_FILE_ENDIAN_TAG) {
+		std::cerr << "CRS file: the byte order of the file differs from the byte order of the machine" << std::endl;
+		return false;
+	}
+	if (header.version != CRS_FILE_VERSION) {
+		std::cerr << "CRS file: unsupported version " << header.version << std::endl;
+		return false;
+	}
+	if ((header.index_size != 4 && header.index_size != 8)
+		|| (header.value_type != CRS_FILE_FLOAT && header.value_type != CRS_FILE_DOUBLE)) {
+		std::cerr << "CRS file: unsupported index size or value type" << std::endl;
+		return false;
+	}
+	if (header.checksum_block_size == 0 || header.checksum_block_size % sizeof(uint64_t) != 0) {
+		std::cerr << "CRS file: invalid checksum block size" << std::endl;
+		return false;
+	}
+
+	// bound the sizes and offsets such that the computations below do not overflow
+	const uint64_t max_size(static_cast<uint64_t>(1) << 56);
+	if (header.n_rows >= max_size || header.nnz >= max_size || header.row_ptr_offset >= max_size
+		|| header.col_idx_offset >= max_size || header.data_offset >= max_size
+		|| header.checksum_offset >= max_size || header.n_checksums >= max_size) {
+		std::cerr << "CRS file: invalid sizes or section offsets" << std::endl;
+		return false;
+	}
+
+	// the sections have to be aligned, ascending and must not overlap
+	CRSFileHeader expected;
+	initCRSFileHeader(expected, header.n_rows, header.nnz, header.index_size, header.value_type,
+					header.checksum_offset != 0);
+	if (header.row_ptr_offset % CRS_FILE_ALIGNMENT != 0 || header.row_ptr_offset < expected.row_ptr_offset
+		|| header.col_idx_offset % CRS_FILE_ALIGNMENT != 0
+		|| header.col_idx_offset < header.row_ptr_offset + (header.n_rows + 1) * header.index_size
+		|| header.data_offset % CRS_FILE_ALIGNMENT != 0
+		|| header.data_offset < header.col_idx_offset + header.nnz * header.index_size) {
+		std::cerr << "CRS file: invalid section offsets" << std::endl;
+		return false;
+	}
+	const uint64_t value_size(header.value_type == CRS_FILE_FLOAT ? sizeof(float) : sizeof(double));
+	uint64_t end(header.data_offset + header.nnz * value_size);
+	if (header.checksum_offset != 0) {
+		if (header.checksum_offset < end) {
+			std::cerr << "CRS file: invalid section offsets" << std::endl;
+			return false;
+		}
+		const uint64_t bs(header.checksum_block_size);
+		if (header.n_checksums != getNumberOfBlocks((header.n_rows + 1) * header.index_size, bs)
+			+ getNumberOfBlocks(header.nnz * header.index_size, bs)
+			+ getNumberOfBlocks(header.nnz * value_size, bs)) {
+			std::cerr << "CRS file: invalid number of checksums" << std::endl;
+			return false;
+		}
+		end = header.checksum_offset + header.n_checksums * sizeof(uint64_t);
+	}
+	if (file_size != 0 && file_size < end) {
+		std::cerr << "CRS file: the file is truncated" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+uint64_t fletcher64(char const* data, uint64_t size)
+{
+	uint32_t const* words(reinterpret_cast<uint32_t const*>(data));
+	const uint64_t n(size / sizeof(uint32_t));
+	const uint64_t mod(0xffffffffULL);
+	uint64_t sum1(0), sum2(0);
+	// sum2 does not overflow within 92679 steps
+	const uint64_t n_max(92679);
+	for (uint64_t beg(0); beg < n; beg += n_max) {
+		const uint64_t end(beg + n_max < n ? beg + n_max : n);
+		for (uint64_t k(beg); k < end; k++) {
+			sum1 += words[k];
+			sum2 += sum1;
+		}
+		sum1 %= mod;
+		sum2 %= mod;
+	}
+	return (sum2 << 32) | sum1;
+}
+
+void computeCRSFileChecksums(char const* data, uint64_t size, uint64_t block_size, uint64_t* checksums)
+{
+	const OPENMP_LOOP_TYPE n_blocks(getNumberOfBlocks(size, block_size));
+	OPENMP_LOOP_TYPE b;
+	#pragma omp parallel for schedule(dynamic)
+	for (b = 0; b < n_blocks; b++) {
+		const uint64_t beg(b * block_size);
+		const uint64_t end(beg + block_size < size ? beg + block_size : size);
+		checksums[b] = fletcher64(data + beg, end - beg);
+	}
+}
+
+bool verifyCRSFileChecksums(char const* file, CRSFileHeader const& header)
+{
+	if (header.checksum_offset == 0)
+		return true;
+
+	const uint64_t bs(header.checksum_block_size);
+	const uint64_t value_size(header.value_type == CRS_FILE_FLOAT ? sizeof(float) : sizeof(double));
+	const uint64_t offsets[3] = { header.row_ptr_offset, header.col_idx_offset, header.data_offset };
+	const uint64_t sizes[3] = { (header.n_rows + 1) * header.index_size,
+					header.nnz * header.index_size, header.nnz * value_size };
+
+	uint64_t *sums(new uint64_t[header.n_checksums]);
+	uint64_t *s(sums);
+	for (unsigned k(0); k < 3; k++) {
+		computeCRSFileChecksums(file + offsets[k], sizes[k], bs, s);
+		s += getNumberOfBlocks(sizes[k], bs);
+	}
+
+	uint64_t const*const file_sums(reinterpret_cast<uint64_t const*>(file + header.checksum_offset));
+	bool ok(true);
+	for (uint64_t b(0); b < header.n_checksums; b++) {
+		if (sums[b] != file_sums[b]) {
+			std::cerr << "CRS file: checksum error in block " << b << std::endl;
+			ok = false;
+		}
+	}
+	delete [] sums;
+	return ok;
+}
+
+} // end namespace MathLib
@@ -0,0 +1,323 @@
+/*
+ * CRSFile.h
+ *
+ *  Created on: Feb 1, 2012
+ *      Author: TF
+ */
+
+#ifndef CRSFILE_H_
+#define CRSFILE_H_
+
+#include <iostream>
+#include <string>
+#include <cstddef>
+#include <limits>
+#include <stdint.h>
+
+namespace MathLib {
+
+/**
+ * Versioned binary container for matrices in compressed row storage format.
+ *
+ * Layout (all numbers in the byte order of the writing machine, checked
+ * by means of the field endian_tag):
+ * - header (struct CRSFileHeader, 120 bytes, padded to 128 bytes)
+ * - row pointer array (n_rows+1 entries of index_size bytes)
+ * - column index array (nnz entries of index_size bytes)
+ * - data array (nnz entries of type value_type)
+ * - optional checksums (Fletcher-64 of every block of checksum_block_size
+ *   bytes of the three arrays, blocks do not cross array boundaries)
+ *
+ * Every section starts at an offset that is a multiple of
+ * CRS_FILE_ALIGNMENT, i.e. after mapping the file into memory (page aligned)
+ * the arrays are suitable for aligned SIMD loads. The sections are written
+ * in ascending order, i.e. the file can be written to and read from a
+ * stream without seeking (only the verification of the checksums while
+ * reading requires a seekable stream).
+ */
+struct CRSFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t endian_tag;
+	/** size of the indices in bytes, 4 or 8 */
+	uint32_t index_size;
+	/** CRS_FILE_FLOAT or CRS_FILE_DOUBLE */
+	uint32_t value_type;
+	uint64_t n_rows;
+	uint64_t n_cols;
+	uint64_t nnz;
+	uint64_t row_ptr_offset;
+	uint64_t col_idx_offset;
+	uint64_t data_offset;
+	/** offset of the checksums, 0 if the file does not contain checksums */
+	uint64_t checksum_offset;
+	uint64_t checksum_block_size;
+	uint64_t n_checksums;
+	uint64_t reserved[3];
+};
+
+const uint32_t CRS_FILE_VERSION = 1;
+const uint32_t CRS_FILE_ENDIAN_TAG = 0x01020304;
+const uint64_t CRS_FILE_ALIGNMENT = 64;
+const uint64_t CRS_FILE_CHECKSUM_BLOCK_SIZE = 1 << 20;
+enum CRSFileValueTypes {
+	CRS_FILE_FLOAT = 1,
+	CRS_FILE_DOUBLE = 2
+};
+
+/** maps the C++ type of the matrix entries to the type id within the file */
+template<typename FP_TYPE> struct CRSFileValueType;
+template<> struct CRSFileValueType<float> { enum { value = CRS_FILE_FLOAT }; };
+template<> struct CRSFileValueType<double> { enum { value = CRS_FILE_DOUBLE }; };
+
+/**
+ * checks if the data starts with the magic of a versioned CRS file
+ * @param data at least size bytes
+ * @param size number of bytes
+ */
+bool isCRSFile(char const* data, std::size_t size);
+
+/**
+ * checks the version, byte order, types and the consistency of the offsets
+ * @param header the header
+ * @param file_size the size of the file, 0 if unknown (non-seekable stream),
+ * the sections must not exceed the file
+ * @return true if the header is valid, else false (a message is written to std::cerr)
+ */
+bool checkCRSFileHeader(CRSFileHeader const& header, uint64_t file_size);
+
+/**
+ * initializes the header for a matrix, the offsets of the sections are
+ * aligned to CRS_FILE_ALIGNMENT
+ */
+void initCRSFileHeader(CRSFileHeader& header, uint64_t n, uint64_t nnz, uint32_t index_size,
+				uint32_t value_type, bool checksums);
+
+/**
+ * Fletcher-64 checksum of the given bytes (size has to be a multiple of 4)
+ */
+uint64_t fletcher64(char const* data, uint64_t size);
+
+/**
+ * computes the checksums of the blocks of a section, parallelized with OpenMP
+ * @param data the section
+ * @param size size of the section in bytes
+ * @param block_size size of the blocks in bytes
+ * @param checksums array with (size + block_size - 1) / block_size entries
+ */
+void computeCRSFileChecksums(char const* data, uint64_t size, uint64_t block_size, uint64_t* checksums);
+
+/**
+ * verifies the checksums of a file mapped into memory (see also
+ * BaseLib::MemoryMappedFile), parallelized with OpenMP
+ * @param file the complete file
+ * @param header the header of the file
+ * @return true if all checksums are correct or the file contains no checksums
+ */
+bool verifyCRSFileChecksums(char const* file, CRSFileHeader const& header);
+
+namespace detail {
+
+inline void writeCRSFilePadding(std::ostream& os, uint64_t pos, uint64_t offset)
+{
+	const char zero[CRS_FILE_ALIGNMENT] = { 0 };
+	if (offset > pos)
+		os.write(zero, offset - pos);
+}
+
+/**
+ * skips the gap between the end pos of a section and the beginning offset
+ * of the next section
+ * @return false if the stream ends within the gap
+ */
+inline bool readCRSFilePadding(std::istream& is, uint64_t pos, uint64_t offset)
+{
+	if (offset <= pos)
+		return true;
+	if (offset - pos > static_cast<uint64_t>(std::numeric_limits<std::streamsize>::max()))
+		return false;
+	is.ignore(static_cast<std::streamsize>(offset - pos));
+	if (static_cast<uint64_t>(is.gcount()) != offset - pos) {
+		std::cerr << "CRS file: unexpected end of file" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Reads a section of n entries of type T_FILE and converts them to type T.
+ * The section is read block wise, if checksums is not NULL the checksum of
+ * every block is verified.
+ * @return false, if reading fails or a checksum does not match
+ */
+template<typename T_FILE, typename T>
+bool readCRSFileSection(std::istream& is, uint64_t n, uint64_t block_size,
+				uint64_t const* checksums, T* dst)
+{
+	const uint64_t n_per_block(block_size / sizeof(T_FILE));
+	T_FILE *buffer(new T_FILE[n < n_per_block ? n : n_per_block]);
+	bool ok(true);
+	for (uint64_t beg(0), b(0); beg < n && ok; beg += n_per_block, b++) {
+		const uint64_t n_block(n - beg < n_per_block ? n - beg : n_per_block);
+		is.read(reinterpret_cast<char*>(buffer), n_block * sizeof(T_FILE));
+		if (!is) {
+			std::cerr << "CRS file: unexpected end of file" << std::endl;
+			ok = false;
+		} else if (checksums && fletcher64(reinterpret_cast<char*>(buffer), n_block * sizeof(T_FILE)) != checksums[b]) {
+			std::cerr << "CRS file: checksum error in block " << b << std::endl;
+			ok = false;
+		}
+		for (uint64_t k(0); k < n_block; k++)
+			dst[beg + k] = static_cast<T>(buffer[k]);
+	}
+	delete [] buffer;
+	return ok;
+}
+
+template<typename T>
+bool readCRSFileIndexSection(std::istream& is, uint32_t index_size, uint64_t n,
+				uint64_t block_size, uint64_t const* checksums, T* dst)
+{
+	if (index_size == sizeof(uint32_t))
+		return readCRSFileSection<uint32_t>(is, n, block_size, checksums, dst);
+	return readCRSFileSection<uint64_t>(is, n, block_size, checksums, dst);
+}
+
+} // end namespace detail
+
+/**
+ * Writes a matrix into a versioned CRS file. The type of the indices and
+ * the entries within the file are the types of the arrays.
+ * @param os output stream (opened in binary mode)
+ * @param n number of rows / columns
+ * @param iA row pointer array
+ * @param jA column index array
+ * @param A data entries
+ * @param checksums write the block checksums
+ * @return true on success
+ */
+template<typename FP_TYPE, typename IDX_TYPE>
+bool writeCRSFile(std::ostream& os, IDX_TYPE n, IDX_TYPE const* iA, IDX_TYPE const* jA,
+				FP_TYPE const* A, bool checksums = true)
+{
+	CRSFileHeader header;
+	initCRSFileHeader(header, n, iA[n], sizeof(IDX_TYPE), CRSFileValueType<FP_TYPE>::value, checksums);
+	const uint64_t nnz(header.nnz);
+	const uint64_t row_ptr_size((header.n_rows + 1) * sizeof(IDX_TYPE));
+	const uint64_t col_idx_size(nnz * sizeof(IDX_TYPE));
+	const uint64_t data_size(nnz * sizeof(FP_TYPE));
+
+	os.write(reinterpret_cast<char const*>(&header), sizeof(CRSFileHeader));
+	detail::writeCRSFilePadding(os, sizeof(CRSFileHeader), header.row_ptr_offset);
+	os.write(reinterpret_cast<char const*>(iA), row_ptr_size);
+	detail::writeCRSFilePadding(os, header.row_ptr_offset + row_ptr_size, header.col_idx_offset);
+	os.write(reinterpret_cast<char const*>(jA), col_idx_size);
+	detail::writeCRSFilePadding(os, header.col_idx_offset + col_idx_size, header.data_offset);
+	os.write(reinterpret_cast<char const*>(A), data_size);
+
+	if (checksums) {
+		const uint64_t bs(header.checksum_block_size);
+		uint64_t *sums(new uint64_t[header.n_checksums]);
+		uint64_t *s(sums);
+		computeCRSFileChecksums(reinterpret_cast<char const*>(iA), row_ptr_size, bs, s);
+		s += (row_ptr_size + bs - 1) / bs;
+		computeCRSFileChecksums(reinterpret_cast<char const*>(jA), col_idx_size, bs, s);
+		s += (col_idx_size + bs - 1) / bs;
+		computeCRSFileChecksums(reinterpret_cast<char const*>(A), data_size, bs, s);
+		detail::writeCRSFilePadding(os, header.data_offset + data_size, header.checksum_offset);
+		os.write(reinterpret_cast<char const*>(sums), header.n_checksums * sizeof(uint64_t));
+		delete [] sums;
+	}
+	return static_cast<bool>(os);
+}
+
+/**
+ * Reads a matrix from a versioned CRS file. The indices and entries are
+ * converted to IDX_TYPE and FP_TYPE. The arrays are allocated by the function.
+ * @param is input stream (opened in binary mode)
+ * @param n number of rows / columns
+ * @param iA row pointer array
+ * @param jA column index array
+ * @param A data entries
+ * @param verify verify the checksums (if the file contains checksums)
+ * @return true on success
+ */
+template<typename FP_TYPE, typename IDX_TYPE>
+bool readCRSFile(std::istream& is, unsigned& n, IDX_TYPE* &iA, IDX_TYPE* &jA, FP_TYPE* &A,
+				bool verify = false)
+{
+	// the size of the file (if the stream is seekable) bounds the section offsets
+	uint64_t file_size(0);
+	const std::istream::pos_type beg(is.tellg());
+	if (beg != std::istream::pos_type(-1)) {
+		is.seekg(0, std::ios::end);
+		const std::istream::pos_type end(is.tellg());
+		if (is && end != std::istream::pos_type(-1) && end > beg)
+			file_size = static_cast<uint64_t>(end - beg);
+		is.clear();
+		is.seekg(beg);
+	}
+
+	CRSFileHeader header;
+	is.read(reinterpret_cast<char*>(&header), sizeof(CRSFileHeader));
+	if (!is || !isCRSFile(header.magic, sizeof(header.magic)) || !checkCRSFileHeader(header, file_size))
+		return false;
+	if (header.n_rows > static_cast<uint64_t>(static_cast<unsigned>(-1))
+		|| (header.nnz > static_cast<uint64_t>(static_cast<IDX_TYPE>(-1)))) {
+		std::cerr << "CRS file: the matrix is too large for the index type" << std::endl;
+		return false;
+	}
+
+	n = static_cast<unsigned>(header.n_rows);
+	const uint64_t n_row_ptr(header.n_rows + 1);
+	const uint64_t nnz(header.nnz);
+	const uint64_t is_size(header.index_size);
+	const uint64_t bs(header.checksum_block_size);
+
+	// the checksums are located at the end of the file, in order to verify
+	// the blocks while reading the file has to be seekable
+	uint64_t *sums(NULL);
+	if (verify && header.checksum_offset != 0) {
+		const std::istream::pos_type pos(is.tellg());
+		sums = new uint64_t[header.n_checksums];
+		is.seekg(header.checksum_offset - sizeof(CRSFileHeader), std::ios::cur);
+		is.read(reinterpret_cast<char*>(sums), header.n_checksums * sizeof(uint64_t));
+		is.seekg(pos);
+		if (!is) {
+			std::cerr << "CRS file: cannot read checksums" << std::endl;
+			delete [] sums;
+			return false;
+		}
+	}
+	uint64_t const* row_ptr_sums(sums);
+	uint64_t const* col_idx_sums(sums ? row_ptr_sums + (n_row_ptr * is_size + bs - 1) / bs : NULL);
+	uint64_t const* data_sums(sums ? col_idx_sums + (nnz * is_size + bs - 1) / bs : NULL);
+
+	delete [] iA;
+	delete [] jA;
+	delete [] A;
+	iA = new IDX_TYPE[n_row_ptr];
+	jA = new IDX_TYPE[nnz];
+	A = new FP_TYPE[nnz];
+
+	bool ok(detail::readCRSFilePadding(is, sizeof(CRSFileHeader), header.row_ptr_offset)
+		&& detail::readCRSFileIndexSection(is, header.index_size, n_row_ptr, bs, row_ptr_sums, iA));
+	if (ok) {
+		ok = detail::readCRSFilePadding(is, header.row_ptr_offset + n_row_ptr * is_size, header.col_idx_offset)
+			&& detail::readCRSFileIndexSection(is, header.index_size, nnz, bs, col_idx_sums, jA);
+	}
+	if (ok)
+		ok = detail::readCRSFilePadding(is, header.col_idx_offset + nnz * is_size, header.data_offset);
+	if (ok) {
+		if (header.value_type == CRS_FILE_FLOAT)
+			ok = detail::readCRSFileSection<float>(is, nnz, bs, data_sums, A);
+		else
+			ok = detail::readCRSFileSection<double>(is, nnz, bs, data_sums, A);
+	}
+	delete [] sums;
+	return ok;
+}
+
+} // end namespace MathLib
+
+#endif /* CRSFILE_H_ */
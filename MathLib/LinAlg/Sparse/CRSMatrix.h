@@ -12,51 +12,102 @@
 #include <fstream>
 #include <iostream>
 #include <cassert>
+#include <cstring>
+#include <vector>
+#include <utility>
 
 // Base
 #include "swap.h"
+#include "MemoryMappedFile.h"
 
 // MathLib
 #include "SparseMatrixBase.h"
 #include "sparse.h"
+#include "CRSFile.h"
 #include "amuxCRS.h"
+#include "partitionRowsByNNZ.h"
 #include "../Preconditioner/generateDiagPrecond.h"
 
 namespace MathLib {
 
+/**
+ * the ways to access a file containing a matrix in binary compressed row
+ * storage format (see CS_write())
+ */
+enum CRSFileAccess {
+	CRS_READ_FILE, //!< the arrays are read into memory allocated by the matrix
+	CRS_MAP_FILE //!< the file is mapped into memory, the arrays point into the mapping
+};
+
+/**
+ * rows (parts of rows) with at most this number of entries are searched
+ * linearly for a column index, longer rows are searched binary
+ */
+const unsigned CRS_LINEAR_SEARCH_LENGTH = 16;
+
 template<typename FP_TYPE, typename IDX_TYPE>
 class CRSMatrix: public SparseMatrixBase<FP_TYPE, IDX_TYPE>
 {
 public:
 	CRSMatrix(std::string const &fname) :
 		SparseMatrixBase<FP_TYPE, IDX_TYPE>(),
-		_row_ptr(NULL), _col_idx(NULL), _data(NULL)
+		_row_ptr(NULL), _col_idx(NULL), _data(NULL), _mapped_file(NULL),
+		_row_partitions()
 	{
-		std::ifstream in(fname.c_str(), std::ios::in | std::ios::binary);
-		if (in) {
-			CS_read(in, SparseMatrixBase<FP_TYPE, IDX_TYPE>::_n_rows, _row_ptr, _col_idx, _data);
-			SparseMatrixBase<FP_TYPE, IDX_TYPE>::_n_cols = SparseMatrixBase<FP_TYPE, IDX_TYPE>::_n_rows;
-			in.close();
-		} else {
-			std::cout << "cannot open " << fname << std::endl;
+		readFile(fname, false);
+	}
+
+	/**
+	 * Constructor takes a file name of a matrix in binary compressed row
+	 * storage format, either the legacy format (see CS_write()) or the
+	 * versioned format (see CRSFileHeader). If access is CRS_MAP_FILE the file
+	 * is mapped into memory and the arrays _row_ptr, _col_idx and _data point
+	 * directly into the mapping (the mapping is private, i.e. changing entries
+	 * does not change the file). In the legacy format the data entries follow
+	 * the index arrays immediately, they are copied if they are not aligned
+	 * properly within the mapping. If the types of the versioned file differ
+	 * from IDX_TYPE and FP_TYPE the file is read and converted.
+	 * @param fname the name of the file
+	 * @param access read the file or map the file into memory
+	 * @param check_structure check the structure of the matrix (see CS_check())
+	 * and the checksums of a versioned file, if the check fails the matrix is
+	 * empty, see isValid()
+	 */
+	CRSMatrix(std::string const &fname, CRSFileAccess access, bool check_structure = false) :
+		SparseMatrixBase<FP_TYPE, IDX_TYPE>(),
+		_row_ptr(NULL), _col_idx(NULL), _data(NULL), _mapped_file(NULL),
+		_row_partitions()
+	{
+		if (access == CRS_MAP_FILE)
+			mapFile(fname, check_structure);
+		else
+			readFile(fname, check_structure);
+		if (check_structure && _row_ptr != NULL
+			&& !CS_check<IDX_TYPE>(MatrixBase::_n_rows, _row_ptr, _col_idx)) {
+			std::cout << "invalid structure of the matrix in " << fname << std::endl;
+			releaseArrays();
 		}
 	}
 
 	CRSMatrix(IDX_TYPE n, IDX_TYPE *iA, IDX_TYPE *jA, FP_TYPE* A) :
 		SparseMatrixBase<FP_TYPE, IDX_TYPE>(n,n),
-		_row_ptr(iA), _col_idx(jA), _data(A)
+		_row_ptr(iA), _col_idx(jA), _data(A), _mapped_file(NULL),
+		_row_partitions()
 	{}
 
 	CRSMatrix(IDX_TYPE n1) :
 		SparseMatrixBase<FP_TYPE, IDX_TYPE>(n1, n1),
-		_row_ptr(NULL), _col_idx(NULL), _data(NULL)
+		_row_ptr(NULL), _col_idx(NULL), _data(NULL), _mapped_file(NULL),
+		_row_partitions()
 	{}
 
 	virtual ~CRSMatrix()
 	{
-		delete [] _row_ptr;
-		delete [] _col_idx;
-		delete [] _data;
+		releaseArray(_row_ptr);
+		releaseArray(_col_idx);
+		releaseArray(_data);
+		delete _mapped_file;
+		invalidateRowPartition();
 	}
 
 	virtual void amux(FP_TYPE d, FP_TYPE const * const __restrict__ x, FP_TYPE * __restrict__ y) const
@@ -64,9 +115,38 @@ public:
 		amuxCRS<FP_TYPE, IDX_TYPE>(d, this->getNRows(), _row_ptr, _col_idx, _data, x, y);
 	}
 
+	/**
+	 * Multiplication with a block of k vectors stored row by row,
+	 * Y = d A X, see amuxCRSBlock()
+	 */
+	virtual void amuxBlock(FP_TYPE d, unsigned k, FP_TYPE const * const __restrict__ X,
+					FP_TYPE * __restrict__ Y) const
+	{
+		amuxCRSBlock<FP_TYPE, IDX_TYPE>(d, this->getNRows(), _row_ptr, _col_idx, _data, k, X, Y);
+	}
+
     virtual void precondApply(FP_TYPE* /*x*/) const
     {}
 
+    /**
+     * applies the preconditioner to a block of k vectors stored row by row,
+     * the default implementation copies every vector of the block into a
+     * contiguous array and applies precondApply() to it
+     */
+    virtual void precondApplyBlock(unsigned k, FP_TYPE* X) const
+    {
+        const IDX_TYPE n(this->getNRows());
+        FP_TYPE *x(new FP_TYPE[n]);
+        for (unsigned q(0); q < k; q++) {
+            for (IDX_TYPE i(0); i < n; i++)
+                x[i] = X[static_cast<size_t>(i) * k + q];
+            precondApply(x);
+            for (IDX_TYPE i(0); i < n; i++)
+                X[static_cast<size_t>(i) * k + q] = x[i];
+        }
+        delete [] x;
+    }
+
     /**
      * get the number of non-zero entries
      * @return number of non-zero entries
@@ -85,18 +165,11 @@ public:
 	{
 		assert(0 <= row && row < MatrixBase::_n_rows);
 
-		// linear search - for matrices with many entries per row binary search is much faster
-		const IDX_TYPE idx_end (_row_ptr[row+1]);
-		IDX_TYPE j(_row_ptr[row]), k;
-
-		while (j<idx_end && (k=_col_idx[j]) <= col) {
-			if (k == col) {
-				_data[j] = val;
-				return 0;
-			}
-			j++;
-		}
-		return 1;
+		const IDX_TYPE j(findEntry(col, _row_ptr[row], _row_ptr[row+1]));
+		if (j == _row_ptr[row+1])
+			return 1;
+		_data[j] = val;
+		return 0;
 	}
 
     /**
@@ -111,19 +184,114 @@ public:
 	{
 		assert(0 <= row && row < MatrixBase::_n_rows);
 
-		// linear search - for matrices with many entries per row binary search is much faster
+		const IDX_TYPE j(findEntry(col, _row_ptr[row], _row_ptr[row+1]));
+		if (j == _row_ptr[row+1])
+			return 1;
+		#pragma omp atomic
+		_data[j] += val;
+		return 0;
+	}
+
+    /**
+     * This method adds value val to an existing matrix entry at position
+     * row,col. The search for the entry starts at the position hint if hint is
+     * a position within the row in front of the entry, i.e. adding the entries
+     * of a row in ascending column order (for instance the entries of an
+     * element matrix with sorted node numbers) with the position of the
+     * previous entry as hint avoids searching the row from its beginning.
+	 * Precondition: the entry have to be in the sparsity pattern!
+     * @param row the row number
+     * @param col the column number
+     * @param val the value that should be set at pos row,col
+     * @param hint position of an entry of the row (input), position of the
+     * entry (row,col) (output, unchanged if the entry does not exist)
+     * @return a value > 0, if the entry is not contained in the sparsity pattern
+     */
+	int addValue(IDX_TYPE row, IDX_TYPE col, FP_TYPE val, IDX_TYPE &hint)
+	{
+		assert(0 <= row && row < MatrixBase::_n_rows);
+
 		const IDX_TYPE idx_end (_row_ptr[row+1]);
-		IDX_TYPE j(_row_ptr[row]), k;
+		IDX_TYPE beg (_row_ptr[row]);
+		if (beg <= hint && hint < idx_end && _col_idx[hint] <= col)
+			beg = hint;
+		const IDX_TYPE j(findEntry(col, beg, idx_end));
+		if (j == idx_end)
+			return 1;
+		#pragma omp atomic
+		_data[j] += val;
+		hint = j;
+		return 0;
+	}
+
+	/**
+	 * Adds a dense block (for instance an element matrix) to the matrix. If
+	 * the column indices are sorted ascending, the positions of the entries
+	 * of a row are found within a single walk over the row, otherwise every
+	 * entry is searched separately. In contrast to addValue() the entries are
+	 * updated without atomic operations, i.e. concurrent calls must not
+	 * change the same rows. This can be ensured by a coloring of the elements
+	 * (see colorElements()) or by an ownership of the rows, see
+	 * addBlock(IDX_TYPE, IDX_TYPE const*, IDX_TYPE, IDX_TYPE const*, FP_TYPE const*, IDX_TYPE, IDX_TYPE).
+	 * Precondition: the entries have to be in the sparsity pattern!
+	 * @param n_block_rows number of rows of the block
+	 * @param rows row numbers of the block
+	 * @param n_block_cols number of columns of the block
+	 * @param cols column numbers of the block
+	 * @param values the entries of the block stored row by row
+	 * @return the number of entries that are not contained in the sparsity pattern
+	 */
+	int addBlock(IDX_TYPE n_block_rows, IDX_TYPE const* rows, IDX_TYPE n_block_cols,
+					IDX_TYPE const* cols, FP_TYPE const* values)
+	{
+		return addBlock(n_block_rows, rows, n_block_cols, cols, values, 0,
+						static_cast<IDX_TYPE>(MatrixBase::_n_rows));
+	}
 
-		while (j<idx_end && (k=_col_idx[j]) <= col) {
-			if (k == col) {
-				#pragma omp atomic
-				_data[j] += val;
-				return 0;
+	/**
+	 * Adds those rows of a dense block to the matrix, whose row numbers are
+	 * in the range [row_beg, row_end). If every thread owns a range of rows,
+	 * the threads can add the blocks concurrently without atomic operations.
+	 * For the other parameters see addBlock(IDX_TYPE, IDX_TYPE const*,
+	 * IDX_TYPE, IDX_TYPE const*, FP_TYPE const*).
+	 * @param row_beg first row of the range
+	 * @param row_end end of the range
+	 */
+	int addBlock(IDX_TYPE n_block_rows, IDX_TYPE const* rows, IDX_TYPE n_block_cols,
+					IDX_TYPE const* cols, FP_TYPE const* values, IDX_TYPE row_beg, IDX_TYPE row_end)
+	{
+		bool sorted(true);
+		for (IDX_TYPE c(1); c < n_block_cols && sorted; c++)
+			sorted = cols[c - 1] < cols[c];
+
+		int n_missing(0);
+		for (IDX_TYPE r(0); r < n_block_rows; r++) {
+			const IDX_TYPE row(rows[r]);
+			if (row < row_beg || row_end <= row)
+				continue;
+			FP_TYPE const*const row_values(values + r * n_block_cols);
+			const IDX_TYPE idx_end(_row_ptr[row + 1]);
+			if (sorted) {
+				IDX_TYPE j(_row_ptr[row]);
+				for (IDX_TYPE c(0); c < n_block_cols; c++) {
+					while (j < idx_end && _col_idx[j] < cols[c])
+						j++;
+					if (j < idx_end && _col_idx[j] == cols[c])
+						_data[j] += row_values[c];
+					else
+						n_missing++;
+				}
+			} else {
+				for (IDX_TYPE c(0); c < n_block_cols; c++) {
+					const IDX_TYPE j(findEntry(cols[c], _row_ptr[row], idx_end));
+					if (j < idx_end)
+						_data[j] += row_values[c];
+					else
+						n_missing++;
+				}
 			}
-			j++;
 		}
-		return 1;
+		return n_missing;
 	}
 
     /**
@@ -137,17 +305,10 @@ public:
 	{
 		assert(0 <= row && row < MatrixBase::_n_rows);
 
-		// linear search - for matrices with many entries per row binary search is much faster
-		const IDX_TYPE idx_end (_row_ptr[row+1]);
-		IDX_TYPE j(_row_ptr[row]), k;
-
-		while (j<idx_end && (k=_col_idx[j]) <= col) {
-			if (k == col) {
-				return _data[j];
-			}
-			j++;
-		}
-		return 0.0;
+		const IDX_TYPE j(findEntry(col, _row_ptr[row], _row_ptr[row+1]));
+		if (j == _row_ptr[row+1])
+			return 0.0;
+		return _data[j];
 	}
 
     /**
@@ -161,17 +322,10 @@ public:
     {
     	assert(0 <= row && row < MatrixBase::_n_rows);
 
-    	// linear search - for matrices with many entries per row binary search is much faster
-    	const IDX_TYPE idx_end (_row_ptr[row+1]);
-    	IDX_TYPE j(_row_ptr[row]), k;
-
-    	while (j<idx_end && (k=_col_idx[j]) <= col) {
-    		if (k == col) {
-    			return _data[j];
-    		}
-    		j++;
-    	}
-    	return 0.0;
+    	const IDX_TYPE j(findEntry(col, _row_ptr[row], _row_ptr[row+1]));
+    	if (j == _row_ptr[row+1])
+    		return 0.0;
+    	return _data[j];
     }
 
 	/**
@@ -192,6 +346,37 @@ public:
 	 */
 	FP_TYPE const* getEntryArray() const { return _data; }
 
+	/**
+	 * get a partition of the rows into n_blocks blocks of consecutive rows with
+	 * (nearly) the same number of non-zero entries (see partitionRowsByNNZ()).
+	 * The partition is computed at the first call and cached for subsequent
+	 * calls with the same number of blocks. The cache is protected by a
+	 * critical section, i.e. amux() may be called concurrently for the same
+	 * matrix, and a cached partition is not released before the sparsity
+	 * pattern changes (which invalidates all cached partitions).
+	 * @param n_blocks number of blocks, for instance the number of threads
+	 * @return array of length n_blocks+1, block k consists of the rows
+	 * partition[k], ..., partition[k+1]-1
+	 */
+	IDX_TYPE const* getRowPartition(unsigned n_blocks) const
+	{
+		IDX_TYPE const* partition(NULL);
+		#pragma omp critical (CRSMatrix_getRowPartition)
+		{
+			for (std::size_t k(0); k < _row_partitions.size() && partition == NULL; k++) {
+				if (_row_partitions[k].first == n_blocks)
+					partition = _row_partitions[k].second;
+			}
+			if (partition == NULL) {
+				IDX_TYPE *new_partition(new IDX_TYPE[n_blocks + 1]);
+				partitionRowsByNNZ(static_cast<IDX_TYPE>(MatrixBase::_n_rows), _row_ptr, n_blocks, new_partition);
+				_row_partitions.push_back(std::make_pair(n_blocks, new_partition));
+				partition = new_partition;
+			}
+		}
+		return partition;
+	}
+
 	/**
 	 * erase rows and columns from sparse matrix
 	 * @param n_rows_cols number of rows / columns to remove
@@ -199,6 +384,8 @@ public:
 	 */
 	void eraseEntries(IDX_TYPE n_rows_cols, IDX_TYPE const* const rows_cols)
 	{
+		releaseMapping();
+		invalidateRowPartition();
 		IDX_TYPE n_cols(MatrixBase::_n_rows);
 		//*** remove the rows
 		removeRows(n_rows_cols, rows_cols);
@@ -231,7 +418,113 @@ public:
 		}
 	}
 
+	/**
+	 * @return false if the matrix could not be read from a file (the file
+	 * does not exist, is corrupted or the structure check failed), true otherwise
+	 */
+	bool isValid() const { return _row_ptr != NULL; }
+
+	/**
+	 * @return true if (some of) the arrays point into a memory mapped file
+	 */
+	bool isMapped() const { return _mapped_file != NULL; }
+
 protected:
+	/**
+	 * Y = d A X computed vector by vector with amux(), for derived classes
+	 * whose amux() can not be applied to a block directly
+	 */
+	void amuxBlockByColumns(FP_TYPE d, unsigned k, FP_TYPE const * const X, FP_TYPE * Y) const
+	{
+		const IDX_TYPE n(this->getNRows());
+		FP_TYPE *x(new FP_TYPE[n]);
+		FP_TYPE *y(new FP_TYPE[n]);
+		for (unsigned q(0); q < k; q++) {
+			for (IDX_TYPE i(0); i < n; i++)
+				x[i] = X[static_cast<size_t>(i) * k + q];
+			amux(d, x, y);
+			for (IDX_TYPE i(0); i < n; i++)
+				Y[static_cast<size_t>(i) * k + q] = y[i];
+		}
+		delete [] y;
+		delete [] x;
+	}
+
+	/**
+	 * Searches the column col within the part [beg, end) of the column index
+	 * array (the column indices of a row are sorted ascending). Long ranges
+	 * are narrowed by binary search, short ranges are searched linearly.
+	 * @return the position of the column or end if the column is not found
+	 */
+	IDX_TYPE findEntry(IDX_TYPE col, IDX_TYPE beg, IDX_TYPE end) const
+	{
+		IDX_TYPE hi(end);
+		while (hi - beg > CRS_LINEAR_SEARCH_LENGTH) {
+			const IDX_TYPE m(beg + (hi - beg) / 2);
+			if (_col_idx[m] < col)
+				beg = m + 1;
+			else
+				hi = m + 1;
+		}
+		while (beg < end && _col_idx[beg] < col)
+			beg++;
+		if (beg < end && _col_idx[beg] == col)
+			return beg;
+		return end;
+	}
+
+	/**
+	 * Copies the arrays that point into the mapped file into memory allocated
+	 * by new[] and releases the mapping. Has to be called before the arrays
+	 * are replaced, i.e. before the sparsity pattern changes.
+	 */
+	void releaseMapping()
+	{
+		if (_mapped_file == NULL)
+			return;
+		const IDX_TYPE n(MatrixBase::_n_rows);
+		const IDX_TYPE nnz(_row_ptr[n]);
+		if (_mapped_file->contains(_row_ptr)) {
+			IDX_TYPE *row_ptr(new IDX_TYPE[n + 1]);
+			for (IDX_TYPE k(0); k <= n; k++)
+				row_ptr[k] = _row_ptr[k];
+			_row_ptr = row_ptr;
+		}
+		if (_mapped_file->contains(_col_idx)) {
+			IDX_TYPE *col_idx(new IDX_TYPE[nnz]);
+			for (IDX_TYPE k(0); k < nnz; k++)
+				col_idx[k] = _col_idx[k];
+			_col_idx = col_idx;
+		}
+		if (_mapped_file->contains(_data)) {
+			FP_TYPE *data(new FP_TYPE[nnz]);
+			for (IDX_TYPE k(0); k < nnz; k++)
+				data[k] = _data[k];
+			_data = data;
+		}
+		delete _mapped_file;
+		_mapped_file = NULL;
+	}
+
+	/**
+	 * has to be called if the number of rows or the row pointer array changes
+	 */
+	void invalidateRowPartition()
+	{
+		for (std::size_t k(0); k < _row_partitions.size(); k++)
+			delete [] _row_partitions[k].second;
+		_row_partitions.clear();
+		invalidateStructureData();
+	}
+
+	/**
+	 * Derived classes that cache data depending on the structure of the
+	 * matrix (or on the row partitions) release it here. The method is
+	 * called by invalidateRowPartition(), i.e. whenever the structure changes.
+	 */
+	virtual void invalidateStructureData()
+	{}
+
 	void removeRows (IDX_TYPE n_rows_cols, IDX_TYPE const*const rows)
 	{
 		//*** determine the number of new rows and the number of entries without the rows
@@ -379,6 +672,162 @@ protected:
 	IDX_TYPE *_row_ptr;
 	IDX_TYPE *_col_idx;
 	FP_TYPE* _data;
+
+private:
+	void readFile(std::string const &fname, bool verify)
+	{
+		std::ifstream in(fname.c_str(), std::ios::in | std::ios::binary);
+		if (!in) {
+			std::cout << "cannot open " << fname << std::endl;
+			return;
+		}
+
+		char magic[sizeof(CRSFileHeader().magic)];
+		in.read(magic, sizeof(magic));
+		const bool versioned(in && isCRSFile(magic, sizeof(magic)));
+		in.clear();
+		in.seekg(0, std::ios::beg);
+
+		if (versioned) {
+			if (!readCRSFile(in, MatrixBase::_n_rows, _row_ptr, _col_idx, _data, verify)) {
+				std::cout << "error reading " << fname << std::endl;
+				releaseArrays();
+			}
+		} else {
+			CS_read(in, MatrixBase::_n_rows, _row_ptr, _col_idx, _data);
+		}
+		MatrixBase::_n_cols = MatrixBase::_n_rows;
+		in.close();
+	}
+
+	/**
+	 * maps the file, if the types of the file and the matrix differ the file is read
+	 */
+	void mapFile(std::string const &fname, bool verify)
+	{
+		_mapped_file = new BaseLib::MemoryMappedFile(fname);
+		if (!_mapped_file->isValid()) {
+			std::cout << "cannot map " << fname << std::endl;
+			delete _mapped_file;
+			_mapped_file = NULL;
+			return;
+		}
+
+		char *ptr(_mapped_file->getData());
+		const std::size_t size(_mapped_file->getSize());
+		CRSMapResult result(CRS_MAP_CONVERT);
+		if (isCRSFile(ptr, size) && size >= sizeof(CRSFileHeader))
+			result = mapVersionedFile(ptr, size, verify);
+		else if (sizeof(IDX_TYPE) == sizeof(unsigned))
+			result = mapLegacyFile(ptr, size) ? CRS_MAP_OK : CRS_MAP_CONVERT;
+
+		if (result == CRS_MAP_ERROR) {
+			std::cout << "error mapping " << fname << std::endl;
+			releaseArrays();
+		} else if (result == CRS_MAP_CONVERT) {
+			delete _mapped_file;
+			_mapped_file = NULL;
+			readFile(fname, verify);
+		}
+	}
+
+	/**
+	 * maps the legacy format: n, iA[n+1], jA[nnz], A[nnz] (see CS_write())
+	 */
+	bool mapLegacyFile(char *ptr, std::size_t size)
+	{
+		IDX_TYPE n(0), nnz(0);
+		std::size_t offset(sizeof(IDX_TYPE));
+		if (size >= offset) {
+			n = *reinterpret_cast<IDX_TYPE*>(ptr);
+			offset += (static_cast<std::size_t>(n) + 1) * sizeof(IDX_TYPE);
+		}
+		if (size >= offset) {
+			nnz = reinterpret_cast<IDX_TYPE*>(ptr + sizeof(IDX_TYPE))[n];
+			offset += static_cast<std::size_t>(nnz) * (sizeof(IDX_TYPE) + sizeof(FP_TYPE));
+		}
+		if (size < offset)
+			return false;
+
+		MatrixBase::_n_rows = MatrixBase::_n_cols = n;
+		_row_ptr = reinterpret_cast<IDX_TYPE*>(ptr + sizeof(IDX_TYPE));
+		_col_idx = _row_ptr + n + 1;
+		char *data(reinterpret_cast<char*>(_col_idx + nnz));
+		if (reinterpret_cast<std::size_t>(data) % sizeof(FP_TYPE) == 0) {
+			_data = reinterpret_cast<FP_TYPE*>(data);
+		} else {
+			_data = new FP_TYPE[nnz];
+			std::memcpy(_data, data, static_cast<std::size_t>(nnz) * sizeof(FP_TYPE));
+		}
+		return true;
+	}
+
+	/** results of mapping a file */
+	enum CRSMapResult {
+		CRS_MAP_OK, //!< the arrays point into the mapping
+		CRS_MAP_CONVERT, //!< the file can not be mapped directly, it has to be read
+		CRS_MAP_ERROR //!< the file is corrupted
+	};
+
+	/**
+	 * maps the sections of the versioned format (see CRSFileHeader), the
+	 * sections are aligned within the file
+	 * @return CRS_MAP_CONVERT if the types of the file differ from the types
+	 * of the matrix, CRS_MAP_ERROR if the header is invalid or the checksums
+	 * do not match
+	 */
+	CRSMapResult mapVersionedFile(char *ptr, std::size_t size, bool verify)
+	{
+		CRSFileHeader header;
+		std::memcpy(&header, ptr, sizeof(CRSFileHeader));
+		if (!checkCRSFileHeader(header, size))
+			return CRS_MAP_ERROR;
+		if (header.index_size != sizeof(IDX_TYPE)
+			|| header.value_type != static_cast<uint32_t>(CRSFileValueType<FP_TYPE>::value)
+			|| header.n_rows > static_cast<uint64_t>(static_cast<unsigned>(-1))
+			|| header.nnz > static_cast<uint64_t>(static_cast<std::size_t>(-1)))
+			return CRS_MAP_CONVERT;
+		if (verify && !verifyCRSFileChecksums(ptr, header)) {
+			std::cout << "CRS file: checksums do not match" << std::endl;
+			return CRS_MAP_ERROR;
+		}
+
+		MatrixBase::_n_rows = MatrixBase::_n_cols = static_cast<unsigned>(header.n_rows);
+		_row_ptr = reinterpret_cast<IDX_TYPE*>(ptr + header.row_ptr_offset);
+		_col_idx = reinterpret_cast<IDX_TYPE*>(ptr + header.col_idx_offset);
+		_data = reinterpret_cast<FP_TYPE*>(ptr + header.data_offset);
+		return CRS_MAP_OK;
+	}
+
+	/**
+	 * releases the arrays and the mapping, afterwards the matrix is empty
+	 */
+	void releaseArrays()
+	{
+		releaseArray(_row_ptr);
+		releaseArray(_col_idx);
+		releaseArray(_data);
+		_row_ptr = _col_idx = NULL;
+		_data = NULL;
+		delete _mapped_file;
+		_mapped_file = NULL;
+		MatrixBase::_n_rows = MatrixBase::_n_cols = 0;
+	}
+
+	/**
+	 * deletes the array if it does not point into the mapped file
+	 */
+	template <typename T> void releaseArray(T* array) const
+	{
+		if (_mapped_file == NULL || !_mapped_file->contains(array))
+			delete [] array;
+	}
+
+	/** the mapping of the file if the matrix is constructed with CRS_MAP_FILE */
+	BaseLib::MemoryMappedFile *_mapped_file;
+
+	/** cached partitions of the rows (number of blocks, partition), see getRowPartition() */
+	mutable std::vector<std::pair<unsigned, IDX_TYPE*> > _row_partitions;
 };
 
 } // end namespace MathLib
@@ -0,0 +1,89 @@
+/*
+ * CRSMatrixAMGPrecond.h
+ *
+ *  Created on: Jan 27, 2012
+ *      Author: TF
+ */
+
+#ifndef CRSMATRIXAMGPRECOND_H_
+#define CRSMATRIXAMGPRECOND_H_
+
+#include <string>
+
+#include "CRSMatrix.h"
+#include "../Preconditioner/SmoothedAggregationAMG.h"
+
+namespace MathLib {
+
+/**
+ * Class CRSMatrixAMGPrecond represents a symmetric positive definite matrix
+ * in compressed row storage format associated with a smoothed aggregation
+ * algebraic multigrid preconditioner. precondApply() performs one V-cycle.
+ *
+ * The user have to calculate the preconditioner explicit via calcPrecond() method!
+ */
+class CRSMatrixAMGPrecond : public CRSMatrix<double, unsigned>
+{
+public:
+	/**
+	 * Constructor takes a file name. The file is read in binary format
+	 * by the constructor of the base class (template) CRSMatrix.
+	 * @param fname the name of the file that contains the matrix in
+	 * binary compressed row storage format
+	 */
+	CRSMatrixAMGPrecond(std::string const &fname) :
+		CRSMatrix<double, unsigned> (fname), _amg(NULL)
+	{}
+
+	/**
+	 * Constructs a matrix object from given data.
+	 * @param n number of rows / columns of the matrix
+	 * @param iA row pointer of matrix in compressed row storage format
+	 * @param jA column index of matrix in compressed row storage format
+	 * @param A data entries of matrix in compressed row storage format
+	 */
+	CRSMatrixAMGPrecond(unsigned n, unsigned *iA, unsigned *jA, double* A) :
+		CRSMatrix<double, unsigned> (n, iA, jA, A), _amg(NULL)
+	{}
+
+	~CRSMatrixAMGPrecond()
+	{
+		delete _amg;
+	}
+
+	/**
+	 * builds the multigrid hierarchy
+	 * @param theta threshold for strong connections on the finest level
+	 * @param coarse_size the coarsening stops if a level has at most coarse_size rows
+	 * @param n_smooth number of pre and post smoothing steps
+	 */
+	void calcPrecond(double theta = 0.08, unsigned coarse_size = 500, unsigned n_smooth = 1)
+	{
+		delete _amg;
+		_amg = new SmoothedAggregationAMG(_n_rows, _row_ptr, _col_idx, _data, theta,
+						coarse_size, 25, n_smooth);
+	}
+
+	/**
+	 * x = M^{-1} x, where M^{-1} is one V-cycle, without a hierarchy (i.e.
+	 * before calcPrecond() is called) x is not changed
+	 */
+	void precondApply(double* x) const
+	{
+		if (_amg)
+			_amg->apply(x);
+	}
+
+	SmoothedAggregationAMG const* getAMG() const { return _amg; }
+
+private:
+	// noncopyable
+	CRSMatrixAMGPrecond(CRSMatrixAMGPrecond const&);
+	CRSMatrixAMGPrecond& operator= (CRSMatrixAMGPrecond const&);
+
+	SmoothedAggregationAMG* _amg;
+};
+
+} // end namespace MathLib
+
+#endif /* CRSMATRIXAMGPRECOND_H_ */
@@ -37,6 +37,16 @@ public:
 		CRSMatrix<double, unsigned> (fname), _inv_diag(NULL)
 	{}
 
+	/**
+	 * Constructor takes a file name, the file is read or mapped into memory,
+	 * see CRSMatrix::CRSMatrix(std::string const&, CRSFileAccess, bool).
+	 *
+	 * The user have to calculate the preconditioner explicit via calcPrecond() method!
+	 */
+	CRSMatrixDiagPrecond(std::string const &fname, CRSFileAccess access, bool check_structure = false) :
+		CRSMatrix<double, unsigned> (fname, access, check_structure), _inv_diag(NULL)
+	{}
+
 	/**
 	 * Constructs a matrix object from given data.
 	 *
@@ -80,6 +90,16 @@ public:
 		}
 	}
 
+	void precondApplyBlock(unsigned k, double* X) const
+	{
+		for (unsigned i=0; i<_n_rows; ++i) {
+			double *x_i (X + static_cast<size_t>(i)*k);
+			for (unsigned q=0; q<k; ++q) {
+				x_i[q] *= _inv_diag[i];
+			}
+		}
+	}
+
 	~CRSMatrixDiagPrecond()
 	{
 		delete [] _inv_diag;
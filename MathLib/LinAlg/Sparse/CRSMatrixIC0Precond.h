@@ -0,0 +1,188 @@
+/*
+ * CRSMatrixIC0Precond.h
+ *
+ *  Created on: Jan 25, 2012
+ *      Author: TF
+ */
+
+#ifndef CRSMATRIXIC0PRECOND_H_
+#define CRSMATRIXIC0PRECOND_H_
+
+#include <string>
+#include <iostream>
+
+#include "CRSMatrix.h"
+#include "../Preconditioner/generateILU0Precond.h"
+#include "../Preconditioner/TriangularLevelSchedule.h"
+
+namespace MathLib {
+
+/**
+ * Class CRSMatrixIC0Precond represents a symmetric positive definite matrix
+ * in compressed row storage format associated with an incomplete Cholesky
+ * factorization without fill in (IC(0)) as preconditioner. The factor
+ * \f$L\f$ has the sparsity pattern of the lower triangular part of the
+ * matrix, it is stored row wise (for the forward substitution) and
+ * column wise, i.e. as \f$L^T\f$ (for the backward substitution). Both
+ * substitutions within precondApply() are level scheduled and run in
+ * parallel if the code is compiled with OpenMP.
+ *
+ * The user have to calculate the preconditioner explicit via calcPrecond() method!
+ */
+class CRSMatrixIC0Precond : public CRSMatrix<double, unsigned>
+{
+public:
+	/**
+	 * Constructor takes a file name. The file is read in binary format
+	 * by the constructor of the base class (template) CRSMatrix.
+	 * @param fname the name of the file that contains the matrix in
+	 * binary compressed row storage format
+	 */
+	CRSMatrixIC0Precond(std::string const &fname) :
+		CRSMatrix<double, unsigned> (fname),
+		_iL(NULL), _jL(NULL), _L(NULL), _L_diag_idx(NULL),
+		_iLT(NULL), _jLT(NULL), _LT(NULL), _LT_diag_idx(NULL)
+	{}
+
+	/**
+	 * Constructs a matrix object from given data.
+	 * @param n number of rows / columns of the matrix
+	 * @param iA row pointer of matrix in compressed row storage format
+	 * @param jA column index of matrix in compressed row storage format
+	 * @param A data entries of matrix in compressed row storage format
+	 */
+	CRSMatrixIC0Precond(unsigned n, unsigned *iA, unsigned *jA, double* A) :
+		CRSMatrix<double, unsigned> (n, iA, jA, A),
+		_iL(NULL), _jL(NULL), _L(NULL), _L_diag_idx(NULL),
+		_iLT(NULL), _jLT(NULL), _LT(NULL), _LT_diag_idx(NULL)
+	{}
+
+	~CRSMatrixIC0Precond()
+	{
+		releaseFactor();
+	}
+
+	/**
+	 * Computes the IC(0) factorization. If the factorization breaks down (a
+	 * row without diagonal entry or a non positive pivot) the factor is
+	 * discarded and precondApply() is the identity.
+	 * @return true, if the factorization succeeds, else false
+	 */
+	bool calcPrecond()
+	{
+		releaseFactor();
+
+		// extract the lower triangular part
+		_iL = new unsigned[_n_rows + 1];
+		_iL[0] = 0;
+		for (unsigned i(0); i < _n_rows; i++) {
+			_iL[i + 1] = _iL[i];
+			for (unsigned j(_row_ptr[i]); j < _row_ptr[i + 1]; j++) {
+				if (_col_idx[j] <= i)
+					_iL[i + 1]++;
+			}
+		}
+		const unsigned nnz(_iL[_n_rows]);
+		_jL = new unsigned[nnz];
+		_L = new double[nnz];
+		for (unsigned i(0), k(0); i < _n_rows; i++) {
+			for (unsigned j(_row_ptr[i]); j < _row_ptr[i + 1]; j++) {
+				if (_col_idx[j] <= i) {
+					_jL[k] = _col_idx[j];
+					_L[k++] = _data[j];
+				}
+			}
+		}
+
+		if (!generateIC0Precond(_n_rows, _iL, _jL, _L)) {
+			std::cout << "Could not create IC(0) preconditioner, using no preconditioner" << std::endl;
+			releaseFactor();
+			return false;
+		}
+
+		// transpose the factor
+		_iLT = new unsigned[_n_rows + 1];
+		_jLT = new unsigned[nnz];
+		_LT = new double[nnz];
+		for (unsigned i(0); i <= _n_rows; i++)
+			_iLT[i] = 0;
+		for (unsigned k(0); k < nnz; k++)
+			_iLT[_jL[k] + 1]++;
+		for (unsigned i(0); i < _n_rows; i++)
+			_iLT[i + 1] += _iLT[i];
+		unsigned *pos(new unsigned[_n_rows]);
+		for (unsigned i(0); i < _n_rows; i++)
+			pos[i] = _iLT[i];
+		for (unsigned i(0); i < _n_rows; i++) {
+			for (unsigned j(_iL[i]); j < _iL[i + 1]; j++) {
+				const unsigned k(pos[_jL[j]]++);
+				_jLT[k] = i;
+				_LT[k] = _L[j];
+			}
+		}
+		delete [] pos;
+
+		// the diagonal is the last entry of a row of L and the first of a row of L^T
+		_L_diag_idx = new unsigned[_n_rows];
+		_LT_diag_idx = new unsigned[_n_rows];
+		for (unsigned i(0); i < _n_rows; i++) {
+			_L_diag_idx[i] = _iL[i + 1] - 1;
+			_LT_diag_idx[i] = _iLT[i];
+		}
+
+		_lower_levels.calcLower(_n_rows, _iL, _jL);
+		_upper_levels.calcUpper(_n_rows, _iLT, _jLT);
+		return true;
+	}
+
+	/**
+	 * x = (L L^T)^{-1} x, the identity if there is no valid factorization
+	 */
+	void precondApply(double* x) const
+	{
+		if (_L == NULL)
+			return;
+		_lower_levels.forwardSolve(_iL, _jL, _L, _L_diag_idx, x);
+		_upper_levels.backwardSolve(_iLT, _jLT, _LT, _LT_diag_idx, x);
+	}
+
+private:
+	// noncopyable
+	CRSMatrixIC0Precond(CRSMatrixIC0Precond const&);
+	CRSMatrixIC0Precond& operator= (CRSMatrixIC0Precond const&);
+
+	void releaseFactor()
+	{
+		delete [] _iL;
+		_iL = NULL;
+		delete [] _jL;
+		_jL = NULL;
+		delete [] _L;
+		_L = NULL;
+		delete [] _L_diag_idx;
+		_L_diag_idx = NULL;
+		delete [] _iLT;
+		_iLT = NULL;
+		delete [] _jLT;
+		_jLT = NULL;
+		delete [] _LT;
+		_LT = NULL;
+		delete [] _LT_diag_idx;
+		_LT_diag_idx = NULL;
+	}
+
+	unsigned *_iL;
+	unsigned *_jL;
+	double *_L;
+	unsigned *_L_diag_idx;
+	unsigned *_iLT;
+	unsigned *_jLT;
+	double *_LT;
+	unsigned *_LT_diag_idx;
+	TriangularLevelSchedule _lower_levels;
+	TriangularLevelSchedule _upper_levels;
+};
+
+} // end namespace MathLib
+
+#endif /* CRSMATRIXIC0PRECOND_H_ */
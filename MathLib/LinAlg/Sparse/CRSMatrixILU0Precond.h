@@ -0,0 +1,115 @@
+/*
+ * CRSMatrixILU0Precond.h
+ *
+ *  Created on: Jan 25, 2012
+ *      Author: TF
+ */
+
+#ifndef CRSMATRIXILU0PRECOND_H_
+#define CRSMATRIXILU0PRECOND_H_
+
+#include <string>
+#include <iostream>
+
+#include "CRSMatrix.h"
+#include "../Preconditioner/generateILU0Precond.h"
+#include "../Preconditioner/TriangularLevelSchedule.h"
+
+namespace MathLib {
+
+/**
+ * Class CRSMatrixILU0Precond represents a matrix in compressed row storage
+ * format associated with an incomplete LU factorization without fill in
+ * (ILU(0)) as preconditioner. The factors share the sparsity pattern
+ * (_row_ptr, _col_idx) of the matrix. The forward and backward substitutions
+ * within precondApply() are level scheduled and run in parallel if the code
+ * is compiled with OpenMP.
+ *
+ * The user have to calculate the preconditioner explicit via calcPrecond() method!
+ */
+class CRSMatrixILU0Precond : public CRSMatrix<double, unsigned>
+{
+public:
+	/**
+	 * Constructor takes a file name. The file is read in binary format
+	 * by the constructor of the base class (template) CRSMatrix.
+	 * @param fname the name of the file that contains the matrix in
+	 * binary compressed row storage format
+	 */
+	CRSMatrixILU0Precond(std::string const &fname) :
+		CRSMatrix<double, unsigned> (fname), _lu(NULL), _diag_idx(NULL)
+	{}
+
+	/**
+	 * Constructs a matrix object from given data.
+	 * @param n number of rows / columns of the matrix
+	 * @param iA row pointer of matrix in compressed row storage format
+	 * @param jA column index of matrix in compressed row storage format
+	 * @param A data entries of matrix in compressed row storage format
+	 */
+	CRSMatrixILU0Precond(unsigned n, unsigned *iA, unsigned *jA, double* A) :
+		CRSMatrix<double, unsigned> (n, iA, jA, A), _lu(NULL), _diag_idx(NULL)
+	{}
+
+	~CRSMatrixILU0Precond()
+	{
+		releaseFactor();
+	}
+
+	/**
+	 * Computes the ILU(0) factorization. If the factorization fails (a row
+	 * without diagonal entry or a zero pivot) the factors are discarded and
+	 * precondApply() is the identity.
+	 * @return true, if the factorization succeeds, else false
+	 */
+	bool calcPrecond()
+	{
+		releaseFactor();
+		_lu = new double[_row_ptr[_n_rows]];
+		_diag_idx = new unsigned[_n_rows];
+
+		if (!generateILU0Precond(_n_rows, _row_ptr, _col_idx, _data, _lu, _diag_idx)) {
+			std::cout << "Could not create ILU(0) preconditioner, using no preconditioner" << std::endl;
+			releaseFactor();
+			return false;
+		}
+		_lower_levels.calcLower(_n_rows, _row_ptr, _col_idx);
+		_upper_levels.calcUpper(_n_rows, _row_ptr, _col_idx);
+		return true;
+	}
+
+	/**
+	 * x = (LU)^{-1} x, the identity if there is no valid factorization
+	 */
+	void precondApply(double* x) const
+	{
+		if (_lu == NULL)
+			return;
+		_lower_levels.forwardSolve(_row_ptr, _col_idx, _lu, NULL, x);
+		_upper_levels.backwardSolve(_row_ptr, _col_idx, _lu, _diag_idx, x);
+	}
+
+private:
+	// noncopyable
+	CRSMatrixILU0Precond(CRSMatrixILU0Precond const&);
+	CRSMatrixILU0Precond& operator= (CRSMatrixILU0Precond const&);
+
+	void releaseFactor()
+	{
+		delete [] _lu;
+		_lu = NULL;
+		delete [] _diag_idx;
+		_diag_idx = NULL;
+	}
+
+	/** entries of the factors L and U */
+	double *_lu;
+	/** positions of the diagonal entries */
+	unsigned *_diag_idx;
+	TriangularLevelSchedule _lower_levels;
+	TriangularLevelSchedule _upper_levels;
+};
+
+} // end namespace MathLib
+
+#endif /* CRSMATRIXILU0PRECOND_H_ */
@@ -9,6 +9,7 @@
 #define CRSMATRIXOPENMP_H_
 
 #ifdef _OPENMP
+#include <omp.h>
 #include <string>
 
 #include "CRSMatrix.h"
@@ -22,6 +23,14 @@ public:
 			CRSMatrix<FP_TYPE, IDX_TYPE>(fname), _num_of_threads (num_of_threads)
 	{}
 
+	/**
+	 * see CRSMatrix::CRSMatrix(std::string const&, CRSFileAccess, bool)
+	 */
+	CRSMatrixOpenMP(std::string const &fname, unsigned num_of_threads, CRSFileAccess access,
+					bool check_structure = false) :
+			CRSMatrix<FP_TYPE, IDX_TYPE>(fname, access, check_structure), _num_of_threads (num_of_threads)
+	{}
+
 	CRSMatrixOpenMP(unsigned n, IDX_TYPE *iA, IDX_TYPE *jA, FP_TYPE* A, unsigned num_of_threads) :
 		CRSMatrix<FP_TYPE, IDX_TYPE>(n, iA, jA, A), _num_of_threads (num_of_threads)
 	{}
@@ -33,9 +42,26 @@ public:
 	virtual ~CRSMatrixOpenMP()
 	{}
 
+	/**
+	 * The rows are distributed to the threads in blocks with equal number of
+	 * non-zero entries, see CRSMatrix::getRowPartition().
+	 */
 	virtual void amux(FP_TYPE d, FP_TYPE const * const x, FP_TYPE *y) const
 	{
-		amuxCRSParallelOpenMP(d, MatrixBase::_n_rows, CRSMatrix<FP_TYPE,IDX_TYPE>::_row_ptr, CRSMatrix<FP_TYPE,IDX_TYPE>::_col_idx, CRSMatrix<FP_TYPE,IDX_TYPE>::_data, x, y);
+		const unsigned n_threads(omp_get_max_threads());
+		amuxCRSParallelOpenMP(d, CRSMatrix<FP_TYPE,IDX_TYPE>::_row_ptr, CRSMatrix<FP_TYPE,IDX_TYPE>::_col_idx,
+						CRSMatrix<FP_TYPE,IDX_TYPE>::_data, x, y, n_threads, this->getRowPartition(n_threads));
+	}
+
+	/**
+	 * parallel version of CRSMatrix::amuxBlock(), the rows are distributed
+	 * in the same way as in amux()
+	 */
+	virtual void amuxBlock(FP_TYPE d, unsigned k, FP_TYPE const * const X, FP_TYPE *Y) const
+	{
+		const unsigned n_threads(omp_get_max_threads());
+		amuxCRSBlockParallelOpenMP(d, CRSMatrix<FP_TYPE,IDX_TYPE>::_row_ptr, CRSMatrix<FP_TYPE,IDX_TYPE>::_col_idx,
+						CRSMatrix<FP_TYPE,IDX_TYPE>::_data, k, X, Y, n_threads, this->getRowPartition(n_threads));
 	}
 
 private:
@@ -14,39 +14,73 @@
 #include "sparse.h"
 #include "CRSMatrix.h"
 #include "amuxCRS.h"
+#include "AmuxThreadPool.h"
 
 namespace MathLib {
 
+/**
+ * Class CRSMatrixPThreads computes the matrix vector multiplication in
+ * parallel using pthreads. The threads are held in a pool that is created
+ * by the constructor, i.e. they are reused for all calls of amux(). The rows
+ * are distributed to the threads by means of the number of non-zero entries.
+ */
 template<class T> class CRSMatrixPThreads : public CRSMatrix<T,unsigned>
 {
 public:
 	CRSMatrixPThreads(std::string const &fname, unsigned num_of_threads) :
-		CRSMatrix<T,unsigned>(fname), _num_of_threads (num_of_threads)
+		CRSMatrix<T,unsigned>(fname),
+		_thread_pool (new AmuxThreadPool(num_of_threads))
+	{}
+
+	/**
+	 * see CRSMatrix::CRSMatrix(std::string const&, CRSFileAccess, bool)
+	 */
+	CRSMatrixPThreads(std::string const &fname, unsigned num_of_threads, CRSFileAccess access,
+					bool check_structure = false) :
+		CRSMatrix<T,unsigned>(fname, access, check_structure),
+		_thread_pool (new AmuxThreadPool(num_of_threads))
 	{}
 
 	CRSMatrixPThreads(unsigned n, unsigned *iA, unsigned *jA, T* A, unsigned num_of_threads) :
-		CRSMatrix<T,unsigned>(n, iA, jA, A), _num_of_threads (num_of_threads)
+		CRSMatrix<T,unsigned>(n, iA, jA, A),
+		_thread_pool (new AmuxThreadPool(num_of_threads))
 	{}
 
 	CRSMatrixPThreads(unsigned n1) :
-		CRSMatrix<T,unsigned>(n1), _num_of_threads (1)
+		CRSMatrix<T,unsigned>(n1),
+		_thread_pool (new AmuxThreadPool(1))
 	{}
 
 	virtual ~CRSMatrixPThreads()
-	{}
+	{
+		delete _thread_pool;
+	}
 
 	virtual void amux(T d, T const * const x, T *y) const
 	{
-		amuxCRSParallelPThreads(d, SparseMatrixBase<T, unsigned>::_n_rows,
-						CRSMatrix<T, unsigned>::_row_ptr, CRSMatrix<T, unsigned>::_col_idx,
-						CRSMatrix<T, unsigned>::_data, x, y, _num_of_threads);
+		_thread_pool->amux(d, CRSMatrix<T, unsigned>::_row_ptr, CRSMatrix<T, unsigned>::_col_idx,
+						CRSMatrix<T, unsigned>::_data, x, y,
+						this->getRowPartition(_thread_pool->getNumberOfThreads()));
 	}
 
-protected:
-	unsigned _num_of_threads;
+	/**
+	 * parallel version of CRSMatrix::amuxBlock() using the thread pool
+	 */
+	virtual void amuxBlock(T d, unsigned k, T const * const X, T *Y) const
+	{
+		_thread_pool->amuxBlock(d, CRSMatrix<T, unsigned>::_row_ptr, CRSMatrix<T, unsigned>::_col_idx,
+						CRSMatrix<T, unsigned>::_data, k, X, Y,
+						this->getRowPartition(_thread_pool->getNumberOfThreads()));
+	}
+
+private:
+	// noncopyable
+	CRSMatrixPThreads(CRSMatrixPThreads const&);
+	CRSMatrixPThreads& operator= (CRSMatrixPThreads const&);
+
+	AmuxThreadPool* _thread_pool;
 };
 
 } // end namespace MathLib
 
 #endif
-
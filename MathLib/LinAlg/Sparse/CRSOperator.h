@@ -0,0 +1,96 @@
+/*
+ * CRSOperator.h
+ *
+ *  Created on: Feb 6, 2012
+ *      Author: TF
+ */
+
+#ifndef CRSOPERATOR_H_
+#define CRSOPERATOR_H_
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "CRSMatrix.h"
+#include "CRSSymMatrix.h"
+#include "amuxCRS.h"
+
+namespace MathLib {
+
+/**
+ * Lightweight view of a CRSMatrix for the templated iterative solvers (see
+ * CGTemplate.h, BiCGStabTemplate.h and GMResTemplate.h). In contrast to
+ * CRSMatrix::amux() the method amux() of this class is not virtual, i.e.
+ * the compiler is able to inline the matrix vector multiplication into
+ * the solver loop. The view does not own the data of the matrix, the matrix
+ * must outlive the view and its sparsity pattern must not change.
+ *
+ * A CRSSymMatrix stores only the upper triangular part, i.e. its arrays can
+ * not be used by the kernels of the view. For such a matrix the view calls
+ * the (virtual) methods of the matrix.
+ */
+template <typename FP_TYPE, typename IDX_TYPE>
+class CRSOperator
+{
+public:
+	explicit CRSOperator(CRSMatrix<FP_TYPE, IDX_TYPE> const& mat) :
+		_n_rows(mat.getNRows()), _iA(mat.getRowPtrArray()), _jA(mat.getColIdxArray()),
+		_A(mat.getEntryArray()),
+		_sym_mat(dynamic_cast<CRSSymMatrix<FP_TYPE, IDX_TYPE> const*>(&mat)),
+#ifdef _OPENMP
+		_n_blocks(omp_get_max_threads()), _row_partition(mat.getRowPartition(_n_blocks))
+#else
+		_n_blocks(1), _row_partition(NULL)
+#endif
+	{}
+
+	unsigned getNRows() const { return _n_rows; }
+
+	/**
+	 * y = d A x
+	 */
+	void amux(FP_TYPE d, FP_TYPE const * const __restrict__ x, FP_TYPE * __restrict__ y) const
+	{
+		if (_sym_mat) {
+			_sym_mat->amux(d, x, y);
+			return;
+		}
+#ifdef _OPENMP
+		amuxCRSParallelOpenMP(d, _iA, _jA, _A, x, y, _n_blocks, _row_partition);
+#else
+		amuxCRS<FP_TYPE, IDX_TYPE>(d, _n_rows, _iA, _jA, _A, x, y);
+#endif
+	}
+
+	/**
+	 * Y = d A X for a block of k vectors stored row by row, see amuxCRSBlock()
+	 */
+	void amuxBlock(FP_TYPE d, unsigned k, FP_TYPE const * const __restrict__ X,
+					FP_TYPE * __restrict__ Y) const
+	{
+		if (_sym_mat) {
+			_sym_mat->amuxBlock(d, k, X, Y);
+			return;
+		}
+#ifdef _OPENMP
+		amuxCRSBlockParallelOpenMP(d, _iA, _jA, _A, k, X, Y, _n_blocks, _row_partition);
+#else
+		amuxCRSBlock<FP_TYPE, IDX_TYPE>(d, _n_rows, _iA, _jA, _A, k, X, Y);
+#endif
+	}
+
+private:
+	const IDX_TYPE _n_rows;
+	IDX_TYPE const* const _iA;
+	IDX_TYPE const* const _jA;
+	FP_TYPE const* const _A;
+	/** the matrix if it is stored symmetric, otherwise NULL */
+	CRSSymMatrix<FP_TYPE, IDX_TYPE> const* const _sym_mat;
+	const unsigned _n_blocks;
+	IDX_TYPE const* const _row_partition;
+};
+
+} // end namespace MathLib
+
+#endif /* CRSOPERATOR_H_ */
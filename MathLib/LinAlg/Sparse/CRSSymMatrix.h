@@ -8,57 +8,392 @@
 #ifndef CRSSYMMATRIX_H_
 #define CRSSYMMATRIX_H_
 
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "CRSMatrix.h"
+#include "amuxCRS.h"
+
+namespace MathLib {
+
+/**
+ * minimal number of rows of a symmetric matrix for which the parallel matrix
+ * vector multiplication is used, for smaller matrices the synchronization
+ * does not pay off
+ */
+const unsigned CRS_SYM_PARALLEL_AMUX_MIN_ROWS = 10000;
 
-template<class T> class CRSSymMatrix : public CRSMatrix<T>
+/**
+ * number of row blocks per thread for the coloring of row blocks, the
+ * coloring is used if there are at most this number of colors
+ */
+const unsigned CRS_SYM_COLORING_BLOCKS_PER_THREAD = 4;
+
+/**
+ * Class CRSSymMatrix stores only the upper triangular part (including the
+ * diagonal) of a symmetric matrix. The matrix vector multiplication reads
+ * the matrix entries only once for the upper and the lower triangular part.
+ *
+ * If the code is compiled with OpenMP and the matrix is large enough, the
+ * matrix vector multiplication is executed in parallel. The rows of a block
+ * of rows write to the range from the first row of the block to the largest
+ * column index of the block. The strategy is chosen (once per number of
+ * threads) by means of these ranges:
+ * - If a coloring of CRS_SYM_COLORING_BLOCKS_PER_THREAD * n_threads blocks
+ *   needs at most CRS_SYM_COLORING_BLOCKS_PER_THREAD colors (for instance
+ *   for banded matrices, see the reorderings in MathLib), the blocks are
+ *   processed color by color, see amuxCRSSymColoredOpenMP().
+ * - Otherwise every thread accumulates its results in a private buffer that
+ *   covers only the range of its block (see amuxCRSSymParallelOpenMP()),
+ *   provided that the buffers hold at most as many entries as the matrix.
+ *   The buffers cost at most n * n_threads entries, larger buffers would
+ *   cause more memory traffic than the multiplication saves.
+ * - Otherwise the coloring is used regardless of the number of colors, i.e.
+ *   the memory stays bounded, but the multiplication scales poorly. Such
+ *   matrices should be reordered first.
+ */
+template<typename FP_TYPE, typename IDX_TYPE> class CRSSymMatrix : public CRSMatrix<FP_TYPE, IDX_TYPE>
 {
 public:
+	/**
+	 * Reads the (full) matrix from a file in binary compressed row storage
+	 * format and removes the lower triangular part.
+	 * @param fname the name of the file
+	 */
 	CRSSymMatrix(std::string const &fname)
-	: CRSMatrix<T> (fname)
+	: CRSMatrix<FP_TYPE, IDX_TYPE> (fname), _plans()
+	{
+		extractUpperTriangle();
+	}
+
+	/**
+	 * Constructs the object from the (full) matrix in compressed row storage
+	 * format, the lower triangular part is removed.
+	 * @param n number of rows / columns of the matrix
+	 * @param iA row pointer of matrix in compressed row storage format
+	 * @param jA column index of matrix in compressed row storage format
+	 * @param A data entries of matrix in compressed row storage format
+	 */
+	CRSSymMatrix(IDX_TYPE n, IDX_TYPE *iA, IDX_TYPE *jA, FP_TYPE* A)
+	: CRSMatrix<FP_TYPE, IDX_TYPE> (n, iA, jA, A), _plans()
+	{
+		extractUpperTriangle();
+	}
+
+	virtual ~CRSSymMatrix()
+	{
+		releasePlans();
+	}
+
+	void amux(FP_TYPE d, FP_TYPE const * const x, FP_TYPE *y) const
+	{
+		const IDX_TYPE n(MatrixBase::_n_rows);
+#ifdef _OPENMP
+		const unsigned n_threads(omp_get_max_threads());
+		if (n_threads > 1 && n >= CRS_SYM_PARALLEL_AMUX_MIN_ROWS) {
+			AmuxPlan const& plan(getAmuxPlan(n_threads));
+			if (plan._coloring) {
+				amuxCRSSymColoredOpenMP (d, n, CRSMatrix<FP_TYPE, IDX_TYPE>::_row_ptr,
+								CRSMatrix<FP_TYPE, IDX_TYPE>::_col_idx, CRSMatrix<FP_TYPE, IDX_TYPE>::_data,
+								x, y, plan._row_partition, plan._n_colors, &plan._color_ptr[0],
+								&plan._color_blocks[0]);
+				return;
+			}
+			// concurrent calls must not share the buffers
+			FP_TYPE *buffer(acquireBuffer(plan));
+			amuxCRSSymParallelOpenMP (d, n, CRSMatrix<FP_TYPE, IDX_TYPE>::_row_ptr,
+							CRSMatrix<FP_TYPE, IDX_TYPE>::_col_idx, CRSMatrix<FP_TYPE, IDX_TYPE>::_data,
+							x, y, plan._n_blocks, plan._row_partition, &plan._col_end[0],
+							&plan._buffer_offset[0], buffer);
+			releaseBuffer(plan, buffer);
+			return;
+		}
+#endif
+		amuxCRSSym (d, n, CRSMatrix<FP_TYPE, IDX_TYPE>::_row_ptr, CRSMatrix<FP_TYPE, IDX_TYPE>::_col_idx,
+						CRSMatrix<FP_TYPE, IDX_TYPE>::_data, x, y);
+	}
+
+	/**
+	 * Only the upper triangular part is stored, i.e. the kernel of
+	 * CRSMatrix::amuxBlock() does not apply. The vectors of the block are
+	 * multiplied one after the other with amux().
+	 */
+	virtual void amuxBlock(FP_TYPE d, unsigned k, FP_TYPE const * const X, FP_TYPE * Y) const
+	{
+		this->amuxBlockByColumns(d, k, X, Y);
+	}
+
+	/**
+	 * @return true if the parallel matrix vector multiplication with the
+	 * given number of threads uses the coloring of row blocks, false if it
+	 * uses thread private buffers
+	 */
+	bool usesColoring(unsigned n_threads) const
+	{
+		return getAmuxPlan(n_threads)._coloring;
+	}
+
+private:
+	// noncopyable
+	CRSSymMatrix(CRSSymMatrix const&);
+	CRSSymMatrix& operator= (CRSSymMatrix const&);
+
+	/**
+	 * the data of the parallel matrix vector multiplication for a number of threads
+	 */
+	struct AmuxPlan {
+		AmuxPlan() : _n_threads(0), _coloring(false), _n_blocks(0), _row_partition(NULL),
+			_n_colors(0), _buffer(NULL), _buffer_in_use(false)
+		{}
+		~AmuxPlan() { delete [] _buffer; }
+
+		/**
+		 * exchanges the data of the row blocks (partition, column ranges and
+		 * coloring) with the other plan
+		 */
+		void swapBlocks(AmuxPlan &other)
+		{
+			std::swap(_n_blocks, other._n_blocks);
+			std::swap(_row_partition, other._row_partition);
+			_col_end.swap(other._col_end);
+			std::swap(_n_colors, other._n_colors);
+			_color_ptr.swap(other._color_ptr);
+			_color_blocks.swap(other._color_blocks);
+		}
+
+		unsigned _n_threads;
+		bool _coloring;
+		unsigned _n_blocks;
+		IDX_TYPE const* _row_partition; //!< see CRSMatrix::getRowPartition()
+		std::vector<IDX_TYPE> _col_end; //!< one past the largest column index of a block
+		// coloring of the blocks
+		unsigned _n_colors;
+		std::vector<unsigned> _color_ptr;
+		std::vector<unsigned> _color_blocks;
+		// thread private buffers
+		std::vector<size_t> _buffer_offset; //!< of length _n_blocks+1
+		FP_TYPE* _buffer;
+		bool _buffer_in_use;
+
+	private:
+		// noncopyable, the plan owns the buffer
+		AmuxPlan(AmuxPlan const&);
+		AmuxPlan& operator= (AmuxPlan const&);
+	};
+
+	/**
+	 * computes the end of the column range of every row block
+	 */
+	void computeColumnRanges(AmuxPlan &plan) const
 	{
-		unsigned nnz (0);
+		IDX_TYPE const*const iA(CRSMatrix<FP_TYPE, IDX_TYPE>::_row_ptr);
+		IDX_TYPE const*const jA(CRSMatrix<FP_TYPE, IDX_TYPE>::_col_idx);
+		plan._col_end.resize(plan._n_blocks);
+		for (unsigned b(0); b < plan._n_blocks; b++) {
+			// the column indices of a row are sorted, the last one is the largest
+			IDX_TYPE col_end(plan._row_partition[b + 1]);
+			for (IDX_TYPE i(plan._row_partition[b]); i < plan._row_partition[b + 1]; i++) {
+				if (iA[i] < iA[i + 1] && jA[iA[i + 1] - 1] >= col_end)
+					col_end = jA[iA[i + 1] - 1] + 1;
+			}
+			plan._col_end[b] = col_end;
+		}
+	}
+
+	/**
+	 * Greedy coloring of the row blocks such that the column ranges of
+	 * blocks with the same color are disjoint. Since the ranges are
+	 * intervals ordered by their beginning the number of colors is minimal.
+	 */
+	void colorBlocks(AmuxPlan &plan) const
+	{
+		std::vector<unsigned> color(plan._n_blocks);
+		std::vector<IDX_TYPE> color_end; // end of the range of the last block of a color
+		for (unsigned b(0); b < plan._n_blocks; b++) {
+			unsigned c(0);
+			while (c < color_end.size() && color_end[c] > plan._row_partition[b])
+				c++;
+			if (c == color_end.size())
+				color_end.push_back(plan._col_end[b]);
+			else
+				color_end[c] = plan._col_end[b];
+			color[b] = c;
+		}
+
+		plan._n_colors = color_end.size();
+		plan._color_ptr.assign(plan._n_colors + 1, 0);
+		for (unsigned b(0); b < plan._n_blocks; b++)
+			plan._color_ptr[color[b] + 1]++;
+		for (unsigned c(0); c < plan._n_colors; c++)
+			plan._color_ptr[c + 1] += plan._color_ptr[c];
+		plan._color_blocks.resize(plan._n_blocks);
+		std::vector<unsigned> pos(plan._color_ptr.begin(), plan._color_ptr.end() - 1);
+		for (unsigned b(0); b < plan._n_blocks; b++)
+			plan._color_blocks[pos[color[b]]++] = b;
+	}
+
+	/**
+	 * chooses the strategy of the parallel matrix vector multiplication,
+	 * see the description of the class
+	 */
+	void setupAmuxPlan(AmuxPlan &plan) const
+	{
+		const unsigned n_threads(plan._n_threads);
+
+		// try the coloring with several blocks per thread
+		plan._n_blocks = CRS_SYM_COLORING_BLOCKS_PER_THREAD * n_threads;
+		plan._row_partition = this->getRowPartition(plan._n_blocks);
+		computeColumnRanges(plan);
+		colorBlocks(plan);
+		if (plan._n_colors <= CRS_SYM_COLORING_BLOCKS_PER_THREAD) {
+			plan._coloring = true;
+			return;
+		}
+		// keep the coloring in case the buffers are too large
+		AmuxPlan coloring_plan;
+		coloring_plan.swapBlocks(plan);
+
+		// one buffer per thread, limited to the column range of its block
+		plan._n_blocks = n_threads;
+		plan._row_partition = this->getRowPartition(n_threads);
+		computeColumnRanges(plan);
+		plan._buffer_offset.resize(n_threads + 1);
+		plan._buffer_offset[0] = 0;
+		for (unsigned b(0); b < n_threads; b++)
+			plan._buffer_offset[b + 1] = plan._buffer_offset[b] + (plan._col_end[b] - plan._row_partition[b]);
+		if (plan._buffer_offset[n_threads] <= static_cast<size_t>(this->getNNZ())) {
+			plan._coloring = false;
+			return;
+		}
+
+		plan.swapBlocks(coloring_plan);
+		plan._buffer_offset.clear();
+		plan._coloring = true;
+	}
+
+	/**
+	 * get the plan of the parallel matrix vector multiplication, the plan is
+	 * computed at the first call and cached (see CRSMatrix::getRowPartition()),
+	 * the plans are released if the structure of the matrix changes (see
+	 * invalidateStructureData())
+	 */
+	AmuxPlan const& getAmuxPlan(unsigned n_threads) const
+	{
+		AmuxPlan const* plan(NULL);
+		#pragma omp critical (CRSSymMatrix_getAmuxPlan)
+		{
+			for (std::size_t k(0); k < _plans.size() && plan == NULL; k++) {
+				if (_plans[k]->_n_threads == n_threads)
+					plan = _plans[k];
+			}
+			if (plan == NULL) {
+				AmuxPlan *new_plan(new AmuxPlan);
+				new_plan->_n_threads = n_threads;
+				setupAmuxPlan(*new_plan);
+				_plans.push_back(new_plan);
+				plan = new_plan;
+			}
+		}
+		return *plan;
+	}
+
+	/**
+	 * @return the buffers of the plan, or newly allocated buffers if the
+	 * buffers of the plan are used by a concurrent call of amux()
+	 */
+	FP_TYPE* acquireBuffer(AmuxPlan const& plan) const
+	{
+		AmuxPlan &p(const_cast<AmuxPlan&>(plan));
+		FP_TYPE *buffer(NULL);
+		#pragma omp critical (CRSSymMatrix_buffer)
+		{
+			if (!p._buffer_in_use) {
+				if (p._buffer == NULL)
+					p._buffer = new FP_TYPE[p._buffer_offset[p._n_blocks]];
+				p._buffer_in_use = true;
+				buffer = p._buffer;
+			}
+		}
+		if (buffer == NULL)
+			buffer = new FP_TYPE[p._buffer_offset[p._n_blocks]];
+		return buffer;
+	}
+
+	void releaseBuffer(AmuxPlan const& plan, FP_TYPE* buffer) const
+	{
+		AmuxPlan &p(const_cast<AmuxPlan&>(plan));
+		if (buffer != p._buffer) {
+			delete [] buffer;
+			return;
+		}
+		#pragma omp critical (CRSSymMatrix_buffer)
+		p._buffer_in_use = false;
+	}
+
+	/**
+	 * the plans refer to the row partitions and the structure of the matrix
+	 */
+	virtual void invalidateStructureData()
+	{
+		releasePlans();
+	}
+
+	void releasePlans()
+	{
+		for (std::size_t k(0); k < _plans.size(); k++)
+			delete _plans[k];
+		_plans.clear();
+	}
+
+	void extractUpperTriangle()
+	{
+		const IDX_TYPE n(MatrixBase::_n_rows);
+		IDX_TYPE nnz (0);
 
 		// count number of non-zeros in the upper triangular part
-		for (unsigned i = 0; i < SparseMatrixBase<T>::_n_rows; i++) {
-			unsigned idx = CRSMatrix<T>::_row_ptr[i+1];
-			for (unsigned j = CRSMatrix<T>::_row_ptr[i]; j < idx; j++)
-				if (CRSMatrix<T>::_col_idx[j] >= i)
+		for (IDX_TYPE i = 0; i < n; i++) {
+			const IDX_TYPE idx = CRSMatrix<FP_TYPE, IDX_TYPE>::_row_ptr[i+1];
+			for (IDX_TYPE j = CRSMatrix<FP_TYPE, IDX_TYPE>::_row_ptr[i]; j < idx; j++)
+				if (CRSMatrix<FP_TYPE, IDX_TYPE>::_col_idx[j] >= i)
 					++nnz;
 		}
 
-		double *A_new (new double[nnz]);
-		unsigned *jA_new (new unsigned[nnz]);
-		unsigned *iA_new (new unsigned[SparseMatrixBase<T>::_n_rows+1]);
+		FP_TYPE *A_new (new FP_TYPE[nnz]);
+		IDX_TYPE *jA_new (new IDX_TYPE[nnz]);
+		IDX_TYPE *iA_new (new IDX_TYPE[n+1]);
 
 		iA_new[0] = nnz = 0;
 
-		for (unsigned i = 0; i < SparseMatrixBase<T>::_n_rows; i++) {
-			const unsigned idx (CRSMatrix<T>::_row_ptr[i+1]);
-			for (unsigned j = CRSMatrix<T>::_row_ptr[i]; j < idx; j++) {
-				if (CRSMatrix<T>::_col_idx[j] >= i) {
-					A_new[nnz] = CRSMatrix<T>::_data[j];
-					jA_new[nnz++] = CRSMatrix<T>::_col_idx[j];
+		for (IDX_TYPE i = 0; i < n; i++) {
+			const IDX_TYPE idx (CRSMatrix<FP_TYPE, IDX_TYPE>::_row_ptr[i+1]);
+			for (IDX_TYPE j = CRSMatrix<FP_TYPE, IDX_TYPE>::_row_ptr[i]; j < idx; j++) {
+				if (CRSMatrix<FP_TYPE, IDX_TYPE>::_col_idx[j] >= i) {
+					A_new[nnz] = CRSMatrix<FP_TYPE, IDX_TYPE>::_data[j];
+					jA_new[nnz++] = CRSMatrix<FP_TYPE, IDX_TYPE>::_col_idx[j];
 				}
 			}
 			iA_new[i+1] = nnz;
 		}
 
-		std::swap(CRSMatrix<T>::_row_ptr, iA_new);
-		std::swap(CRSMatrix<T>::_col_idx, jA_new);
-		std::swap(CRSMatrix<T>::_data, A_new);
+		BaseLib::swap(CRSMatrix<FP_TYPE, IDX_TYPE>::_row_ptr, iA_new);
+		BaseLib::swap(CRSMatrix<FP_TYPE, IDX_TYPE>::_col_idx, jA_new);
+		BaseLib::swap(CRSMatrix<FP_TYPE, IDX_TYPE>::_data, A_new);
+		this->invalidateRowPartition();
 
 		delete[] iA_new;
 		delete[] jA_new;
 		delete[] A_new;
 	}
 
-	virtual ~CRSSymMatrix() {}
-
-	void amux(T d, T const * const x, T *y) const
-	{
-		amuxCRSSym (d, SparseMatrixBase<T>::_n_rows, CRSMatrix<T>::_row_ptr, CRSMatrix<T>::_col_idx, CRSMatrix<T>::_data, x, y);
-	}
-
+	/** cached plans of the parallel matrix vector multiplication, see getAmuxPlan() */
+	mutable std::vector<AmuxPlan*> _plans;
 };
 
+} // end namespace MathLib
+
 #endif /* CRSSYMMATRIX_H_ */
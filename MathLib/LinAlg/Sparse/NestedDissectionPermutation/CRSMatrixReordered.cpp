@@ -5,63 +5,205 @@
  *      Author: TF
  */
 
+// STL
+#include <vector>
+
 // BaseLib
 #include "quicksort.h"
 
 #include "LinAlg/Sparse/NestedDissectionPermutation/CRSMatrixReordered.h"
+#include "LinAlg/Sparse/NestedDissectionPermutation/ClusterBase.h"
+#include "LinAlg/Sparse/amuxCRS.h"
 
 namespace MathLib {
 
+namespace {
+
+/**
+ * collects the row ranges of the leaf clusters and of the separators in
+ * post order, i.e. the separators of the lower levels come first
+ */
+void collectRanges(ClusterBase const* cluster, std::vector<unsigned> &leaves,
+				std::vector<unsigned> &separators)
+{
+	if (cluster->getNSons() == 0) {
+		std::vector<unsigned> &ranges(cluster->isSeparator() ? separators : leaves);
+		if (cluster->getBeg() < cluster->getEnd()) {
+			ranges.push_back(cluster->getBeg());
+			ranges.push_back(cluster->getEnd());
+		}
+		return;
+	}
+	for (unsigned k(0); k < cluster->getNSons(); k++)
+		collectRanges(cluster->getSon(k), leaves, separators);
+}
+
+/**
+ * Distributes the row ranges in their order to the threads such that the work
+ * (number of non-zero entries plus number of rows) is nearly equal. If split
+ * is false the ranges are kept as a whole, otherwise they are cut at the
+ * boundaries between the threads.
+ * @param ptr array of length n_threads+1 (output, allocated via new [])
+ * @param out the row ranges of thread t are [out[2k], out[2k+1]) for
+ * ptr[t] <= k < ptr[t+1] (output, allocated via new [])
+ */
+void distributeRanges(std::vector<unsigned> const& ranges, unsigned const*const iA,
+				unsigned n_threads, bool split, unsigned* &ptr, unsigned* &out)
+{
+	double total(0.0);
+	for (std::size_t k(0); k < ranges.size(); k += 2)
+		total += iA[ranges[k + 1]] - iA[ranges[k]] + ranges[k + 1] - ranges[k];
+
+	std::vector<unsigned> pieces, owners;
+	double acc(0.0);
+	for (std::size_t k(0); k < ranges.size(); k += 2) {
+		unsigned beg(ranges[k]);
+		const unsigned end(ranges[k + 1]);
+		const double work(iA[end] - iA[beg] + end - beg);
+		// the work position of row i is offset + iA[i] + i
+		const double offset(acc - iA[beg] - beg);
+		while (beg < end) {
+			const double pos(split ? offset + iA[beg] + beg : acc + 0.5 * work);
+			unsigned t(total > 0.0 ? static_cast<unsigned>(pos * n_threads / total) : 0);
+			if (t >= n_threads)
+				t = n_threads - 1;
+			unsigned piece_end(end);
+			if (split) {
+				// first row reaching the work boundary of the next thread
+				const double bound(total * (t + 1) / n_threads);
+				unsigned lo(beg + 1), hi(end);
+				while (lo < hi) {
+					const unsigned m(lo + (hi - lo) / 2);
+					if (offset + iA[m] + m < bound)
+						lo = m + 1;
+					else
+						hi = m;
+				}
+				piece_end = lo;
+			}
+			pieces.push_back(beg);
+			pieces.push_back(piece_end);
+			owners.push_back(t);
+			beg = piece_end;
+		}
+		acc += work;
+	}
+
+	ptr = new unsigned[n_threads + 1];
+	for (unsigned t(0); t <= n_threads; t++)
+		ptr[t] = 0;
+	for (std::size_t k(0); k < owners.size(); k++)
+		ptr[owners[k] + 1]++;
+	for (unsigned t(0); t < n_threads; t++)
+		ptr[t + 1] += ptr[t];
+	out = new unsigned[pieces.size()];
+	for (std::size_t k(0); k < pieces.size(); k++)
+		out[k] = pieces[k];
+}
+
+} // end anonymous namespace
+
 CRSMatrixReordered::CRSMatrixReordered(std::string const &fname) :
-	CRSMatrix<double,unsigned>(fname)
+	CRSMatrix<double,unsigned>(fname), _n_threads(0), _leaf_ptr(NULL), _leaf_ranges(NULL),
+	_sep_ptr(NULL), _sep_ranges(NULL)
 {}
 
 CRSMatrixReordered::CRSMatrixReordered(unsigned n, unsigned *iA, unsigned *jA, double* A) :
-	CRSMatrix<double, unsigned> (n, iA, jA, A)
+	CRSMatrix<double, unsigned> (n, iA, jA, A), _n_threads(0), _leaf_ptr(NULL), _leaf_ranges(NULL),
+	_sep_ptr(NULL), _sep_ranges(NULL)
 {}
 
 CRSMatrixReordered::~CRSMatrixReordered()
-{}
+{
+	releaseSchedule();
+}
+
+void CRSMatrixReordered::setClusterTree(ClusterBase const* cluster_tree, unsigned n_threads)
+{
+	releaseSchedule();
+	std::vector<unsigned> leaves, separators;
+	collectRanges(cluster_tree, leaves, separators);
+	_n_threads = n_threads;
+	distributeRanges(leaves, _row_ptr, n_threads, false, _leaf_ptr, _leaf_ranges);
+	distributeRanges(separators, _row_ptr, n_threads, true, _sep_ptr, _sep_ranges);
+}
+
+void CRSMatrixReordered::amux(double d, double const * const __restrict__ x, double * __restrict__ y) const
+{
+	if (_n_threads == 0) {
+		CRSMatrix<double, unsigned>::amux(d, x, y);
+		return;
+	}
+
+	OPENMP_LOOP_TYPE t;
+	#pragma omp parallel
+	{
+		// both loops are distributed in the same way, i.e. every thread
+		// processes its separator rows directly after its leaf clusters
+		#pragma omp for schedule(static, 1) nowait
+		for (t = 0; t < _n_threads; t++) {
+			for (unsigned k(_leaf_ptr[t]); k < _leaf_ptr[t + 1]; k++) {
+				const unsigned beg(_leaf_ranges[2 * k]);
+				amuxCRS(d, _leaf_ranges[2 * k + 1] - beg, _row_ptr + beg, _col_idx, _data, x, y + beg);
+			}
+		}
+		#pragma omp for schedule(static, 1)
+		for (t = 0; t < _n_threads; t++) {
+			for (unsigned k(_sep_ptr[t]); k < _sep_ptr[t + 1]; k++) {
+				const unsigned beg(_sep_ranges[2 * k]);
+				amuxCRS(d, _sep_ranges[2 * k + 1] - beg, _row_ptr + beg, _col_idx, _data, x, y + beg);
+			}
+		}
+	}
+}
+
+void CRSMatrixReordered::releaseSchedule()
+{
+	_n_threads = 0;
+	delete [] _leaf_ptr;
+	delete [] _leaf_ranges;
+	delete [] _sep_ptr;
+	delete [] _sep_ranges;
+	_leaf_ptr = _leaf_ranges = _sep_ptr = _sep_ranges = NULL;
+}
 
 void CRSMatrixReordered::reorderMatrix(unsigned const*const op_perm, unsigned const*const po_perm)
 {
-	unsigned i; // row and col idx in permuted matrix
-	unsigned j, idx; // pointer in jA
+	OPENMP_LOOP_TYPE i; // row and col idx in permuted matrix
 
+	releaseMapping();
+	releaseSchedule();
 	const unsigned size(getNRows());
 
-	unsigned *pos(new unsigned[size + 1]);
+	unsigned *iAn(new unsigned[size + 1]);
+	iAn[0] = 0;
+	#pragma omp parallel for
 	for (i = 0; i < size; i++) {
 		const unsigned original_row(op_perm[i]);
-		pos[i] = _row_ptr[original_row+1] - _row_ptr[original_row];
+		iAn[i + 1] = _row_ptr[original_row+1] - _row_ptr[original_row];
 	}
-	pos[size] = 0;
-
-	unsigned *iAn(new unsigned[size + 1]);
-	iAn[0] = 0;
-	for (i = 0; i < size; i++)
-		iAn[i + 1] = iAn[i] + pos[i];
-	for (i = 0; i < size; i++)
-		pos[i] = iAn[i];
+	for (unsigned k(0); k < size; k++)
+		iAn[k + 1] += iAn[k];
 
+	// every permuted row is copied and sorted independently of the other rows
 	unsigned *jAn(new unsigned[iAn[size]]);
 	double *An(new double[iAn[size]]);
+	#pragma omp parallel for schedule(dynamic, 1024)
 	for (i = 0; i < size; i++) {
 		const unsigned original_row(op_perm[i]);
-		idx = _row_ptr[original_row+1];
-		for (j = _row_ptr[original_row]; j < idx; j++) {
-			jAn[pos[i]] = po_perm[_col_idx[j]];
-			An[pos[i]++] = _data[j];
+		const unsigned idx(_row_ptr[original_row+1]);
+		unsigned pos(iAn[i]);
+		for (unsigned j(_row_ptr[original_row]); j < idx; j++) {
+			jAn[pos] = po_perm[_col_idx[j]];
+			An[pos++] = _data[j];
 		}
-	}
-
-	delete[] pos;
-	for (i = 0; i < size; ++i)
 		quicksort(jAn, static_cast<size_t>(iAn[i]), static_cast<size_t>(iAn[i + 1]), An);
+	}
 
 	BaseLib::swap(iAn, _row_ptr);
 	BaseLib::swap(jAn, _col_idx);
 	BaseLib::swap(An, _data);
+	invalidateRowPartition();
 
 	delete [] iAn;
 	delete [] jAn;
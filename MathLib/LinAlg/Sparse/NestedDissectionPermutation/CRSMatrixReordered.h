@@ -12,6 +12,8 @@
 
 namespace MathLib {
 
+class ClusterBase;
+
 class CRSMatrixReordered: public MathLib::CRSMatrix<double,unsigned>
 {
 public:
@@ -19,6 +21,41 @@ public:
 	CRSMatrixReordered(unsigned n, unsigned *iA, unsigned *jA, double* A);
 	virtual ~CRSMatrixReordered();
 	void reorderMatrix(unsigned const*const op_perm, unsigned const*const po_perm);
+
+	/**
+	 * Sets up the hierarchical matrix vector multiplication for a matrix that
+	 * is reordered (see reorderMatrix()) with the permutation of the cluster
+	 * tree. The leaf clusters are distributed to the threads as whole (with
+	 * nearly equal number of non-zero entries per thread), i.e. a thread
+	 * accesses mainly the entries of x belonging to its own leaves. The rows
+	 * of the separators are distributed afterwards, the separators of the
+	 * lower levels come first. The schedule is discarded by reorderMatrix().
+	 * @param cluster_tree the root of the cluster tree
+	 * @param n_threads number of threads used by amux()
+	 */
+	void setClusterTree(ClusterBase const* cluster_tree, unsigned n_threads);
+
+	/**
+	 * If a cluster tree is set (see setClusterTree()) thread t processes
+	 * its leaf clusters and afterwards its part of the separator rows,
+	 * otherwise CRSMatrix::amux() is used.
+	 */
+	virtual void amux(double d, double const * const __restrict__ x, double * __restrict__ y) const;
+
+private:
+	void releaseSchedule();
+
+	/** number of threads the schedule is built for, 0 if there is no schedule */
+	unsigned _n_threads;
+	/**
+	 * the row ranges [_leaf_ranges[2k], _leaf_ranges[2k+1]) for
+	 * _leaf_ptr[t] <= k < _leaf_ptr[t+1] are processed by thread t
+	 */
+	unsigned *_leaf_ptr;
+	unsigned *_leaf_ranges;
+	/** the separator row ranges of the threads, same layout as for the leaves */
+	unsigned *_sep_ptr;
+	unsigned *_sep_ranges;
 };
 
 }
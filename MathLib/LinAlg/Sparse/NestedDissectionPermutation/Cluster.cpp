@@ -5,25 +5,112 @@
  *      Author: TF
  */
 
+#ifdef HAVE_METIS
 #include "metis.h"
+#endif
 
 // BaseLib
 #include "swap.h"
 
 #include "LinAlg/Sparse/NestedDissectionPermutation/Cluster.h"
-//#include "blas.h"
+#include "LinAlg/Sparse/reverseCuthillMcKee.h"
 #include "Cluster.h"
 #include "Separator.h"
 #include "AdjMat.h"
 
-// METIS function
-//extern "C" void METIS_ComputeVertexSeparator(unsigned*, unsigned*, unsigned*,
-//					   unsigned*, unsigned*, unsigned*, unsigned*);
+namespace MathLib {
+
+/**
+ * Clusters with more rows are subdivided by a new OpenMP task, for smaller
+ * clusters the overhead of the task would exceed the work.
+ */
+const unsigned PARALLEL_SUBDIVIDE_THRESHOLD = 10000;
 
-//extern "C" void METIS_NodeND(unsigned*, unsigned*, unsigned*,
-//				   unsigned*, unsigned*, unsigned*, unsigned*);
+namespace {
 
-namespace MathLib {
+/**
+ * Computes a vertex separator of the graph given by the symmetric adjacency
+ * structure (iA, jA). On output part[v] is 0 or 1 if node v belongs to the
+ * first or second sub-graph and 2 if v belongs to the separator.
+ *
+ * Without METIS the separator is a level of a breadth first search: the
+ * components are traversed one after another starting at pseudo-peripheral
+ * nodes, the separator is the level of the component containing the median
+ * of the traversal. Since edges only connect nodes within the same or
+ * neighbouring levels the nodes traversed before the separator level are not
+ * adjacent to the nodes traversed after it.
+ */
+void computeSeparator(unsigned n, unsigned const*const iA, unsigned const*const jA, unsigned* part)
+{
+#ifdef HAVE_METIS
+	idx_t n_rows(n), sepsize(0);
+	idx_t options[METIS_NOPTIONS];
+	METIS_SetDefaultOptions(options);
+	// the width of idx_t depends on the configuration of METIS (IDXTYPEWIDTH),
+	// so the adjacency structure is copied instead of reinterpreted
+	idx_t *xadj(new idx_t[n + 1]);
+	for (unsigned k(0); k <= n; k++)
+		xadj[k] = iA[k];
+	idx_t *adjncy(new idx_t[iA[n]]);
+	for (unsigned k(0); k < iA[n]; k++)
+		adjncy[k] = jA[k];
+	idx_t *metis_part(new idx_t[n]);
+	METIS_ComputeVertexSeparator(&n_rows, xadj, adjncy, NULL, options, &sepsize, metis_part);
+	for (unsigned k(0); k < n; k++)
+		part[k] = metis_part[k];
+	delete [] metis_part;
+	delete [] adjncy;
+	delete [] xadj;
+#else
+	unsigned *level(new unsigned[n]);
+	unsigned *order(new unsigned[n]);
+	for (unsigned k(0); k < n; k++)
+		level[k] = n;
+
+	const unsigned median(n / 2);
+	unsigned n_ordered(0), sep_comp_beg(0), sep_comp_end(0), sep_level(0);
+	for (unsigned s(0); s < n; s++) {
+		if (level[s] != n)
+			continue;
+		// breadth first search within the component, the queue is the part of
+		// order behind the nodes of the previous components
+		unsigned *queue(order + n_ordered);
+		const unsigned root(findPseudoPeripheralNode(n, iA, jA, s, level, queue));
+		unsigned head(0), tail(1);
+		queue[0] = root;
+		level[root] = 0;
+		while (head < tail) {
+			const unsigned v(queue[head++]);
+			for (unsigned k(iA[v]); k < iA[v + 1]; k++) {
+				if (level[jA[k]] == n) {
+					level[jA[k]] = level[v] + 1;
+					queue[tail++] = jA[k];
+				}
+			}
+		}
+		if (n_ordered <= median && median < n_ordered + tail) {
+			sep_comp_beg = n_ordered;
+			sep_comp_end = n_ordered + tail;
+			sep_level = level[order[median]];
+		}
+		n_ordered += tail;
+	}
+
+	for (unsigned k(0); k < sep_comp_beg; k++)
+		part[order[k]] = 0;
+	for (unsigned k(sep_comp_beg); k < sep_comp_end; k++) {
+		const unsigned v(order[k]);
+		part[v] = level[v] < sep_level ? 0 : (level[v] == sep_level ? 2 : 1);
+	}
+	for (unsigned k(sep_comp_end); k < n; k++)
+		part[order[k]] = 1;
+
+	delete [] order;
+	delete [] level;
+#endif
+}
+
+} // end anonymous namespace
 
 Cluster::Cluster (unsigned n, unsigned* iA, unsigned* jA)
   : ClusterBase (n, iA, jA)
@@ -40,86 +127,67 @@ void Cluster::subdivide(unsigned bmin)
 {
 	const unsigned size(_end - _beg);
 	if (size > bmin) {
+		// subdivide the index set into three parts
+		unsigned *part(new unsigned[size]);
+		computeSeparator(size, _l_adj_mat->getRowPtrArray(), _l_adj_mat->getColIdxArray(), part);
+
+		// create and init local permutations
+		unsigned *l_op_perm(new unsigned[size]);
+		unsigned *l_po_perm(new unsigned[size]);
+		for (unsigned i = 0; i < size; ++i)
+			l_op_perm[i] = l_po_perm[i] = i;
+
+		unsigned isep1, isep2;
+		updatePerm(part, isep1, isep2, l_op_perm, l_po_perm);
+		delete[] part;
+
+		// update global permutation
+		unsigned *t_op_perm = new unsigned[size];
+		for (unsigned k = 0; k < size; ++k)
+			t_op_perm[k] = _g_op_perm[_beg + l_op_perm[k]];
+
+		for (unsigned k = _beg; k < _end; ++k) {
+			_g_op_perm[k] = t_op_perm[k - _beg];
+			_g_po_perm[_g_op_perm[k]] = k;
+		}
+		delete[] t_op_perm;
 
-		unsigned n_rows(_l_adj_mat->getNRows());
-		unsigned *xadj(const_cast<unsigned*>(_l_adj_mat->getRowPtrArray()));
-		unsigned *adjncy(const_cast<unsigned*>(_l_adj_mat->getColIdxArray()));
-//		unsigned nparts = 2;
-		unsigned options[METIS_NOPTIONS]; // for METIS
-		METIS_SetDefaultOptions(options);
-//		options[METIS OPTION PTYPE] = METIS PTYPE RB;
-//		options[METIS OPTION OBJTYPE] = METIS OBJTYPE CUT;
-//		options[METIS OPTION CTYPE] = METIS CTYPE SHEM;
-//		options[] = ;
-//		options[] = ;
-//		options[] = ;
-
-//		unsigned sepsize(0); // for METIS
-		unsigned *vwgt(new unsigned[n_rows + 1]);
-//		const unsigned nnz(xadj[n_rows]);
-//		unsigned *adjwgt(new unsigned[nnz]);
-		for (unsigned k(0); k < n_rows + 1; k++)
-			vwgt[k] = 1;
-//		for (unsigned k(0); k < nnz; k++)
-//			adjwgt[k] = 1;
-//		unsigned *part(new unsigned[n_rows + 1]);
-
-		// subdivide the index set into three parts employing METIS
-//		METIS_ComputeVertexSeparator(&n_rows, xadj, adjncy, vwgt, &options,
-//				&sepsize, part);
-		METIS_NodeND(&n_rows, xadj, adjncy, vwgt, options, _g_op_perm, _g_po_perm);
-
-//		// create and init local permutations
-//		unsigned *l_op_perm(new unsigned[size]);
-//		unsigned *l_po_perm(new unsigned[size]);
-//		for (unsigned i = 0; i < size; ++i)
-//			l_op_perm[i] = l_po_perm[i] = i;
-//
-//		unsigned isep1, isep2;
-//		updatePerm(part, isep1, isep2, l_op_perm, l_po_perm);
-//		delete[] part;
-//
-//		// update global permutation
-//		unsigned *t_op_perm = new unsigned[size];
-//		for (unsigned k = 0; k < size; ++k)
-//			t_op_perm[k] = _g_op_perm[_beg + l_op_perm[k]];
-//
-//		for (unsigned k = _beg; k < _end; ++k) {
-//			_g_op_perm[k] = t_op_perm[k - _beg];
-//			_g_po_perm[_g_op_perm[k]] = k;
-//		}
-//		delete[] t_op_perm;
-//
-//		// next recursion step
-//		if ((isep1 >= bmin) && (isep2 - isep1 >= bmin)) {
-//			// construct adj matrices for [0, isep1), [isep1,isep2), [isep2, _end)
-//			AdjMat *l_adj0(_l_adj_mat->getMat(0, isep1, l_op_perm, l_po_perm));
-//			AdjMat *l_adj1(_l_adj_mat->getMat(isep1, isep2, l_op_perm, l_po_perm));
-//			AdjMat *l_adj2(_l_adj_mat->getMat(isep2, size, l_op_perm, l_po_perm));
-//
-//			delete[] l_op_perm;
-//			delete[] l_po_perm;
-//			delete _l_adj_mat;
-//			_l_adj_mat = NULL;
-//
-//			_n_sons = 3;
-//			_sons = new ClusterBase*[_n_sons];
-//
-//			isep1 += _beg;
-//			isep2 += _beg;
-//
-//			// constructing child nodes for index cluster tree
-//			_sons[0] = new Cluster(this, _beg, isep1, _g_op_perm, _g_po_perm, _g_adj_mat, l_adj0);
-//			_sons[1] = new Cluster(this, isep1, isep2, _g_op_perm, _g_po_perm, _g_adj_mat, l_adj1);
-//			_sons[2] = new Separator(this, isep2, _end, _g_op_perm,	_g_po_perm, _g_adj_mat, l_adj2);
-//
-//			dynamic_cast<Cluster*>(_sons[0])->subdivide(bmin);
-//			dynamic_cast<Cluster*>(_sons[1])->subdivide(bmin);
-//
-//		} else {
-//			delete _l_adj_mat;
-//			_l_adj_mat = NULL;
-//		} // end if next recursion step
+		// next recursion step
+		if ((isep1 >= bmin) && (isep2 - isep1 >= bmin)) {
+			// construct adj matrices for [0, isep1), [isep1,isep2), [isep2, _end)
+			AdjMat *l_adj0(_l_adj_mat->getMat(0, isep1, l_op_perm, l_po_perm));
+			AdjMat *l_adj1(_l_adj_mat->getMat(isep1, isep2, l_op_perm, l_po_perm));
+			AdjMat *l_adj2(_l_adj_mat->getMat(isep2, size, l_op_perm, l_po_perm));
+
+			delete[] l_op_perm;
+			delete[] l_po_perm;
+			delete _l_adj_mat;
+			_l_adj_mat = NULL;
+
+			_n_sons = 3;
+			_sons = new ClusterBase*[_n_sons];
+
+			isep1 += _beg;
+			isep2 += _beg;
+
+			// constructing child nodes for index cluster tree
+			_sons[0] = new Cluster(this, _beg, isep1, _g_op_perm, _g_po_perm, _g_adj_mat, l_adj0);
+			_sons[1] = new Cluster(this, isep1, isep2, _g_op_perm, _g_po_perm, _g_adj_mat, l_adj1);
+			_sons[2] = new Separator(this, isep2, _end, _g_op_perm,	_g_po_perm, _g_adj_mat, l_adj2);
+
+			// the two sub-clusters are decoupled by the separator and work on
+			// disjoint parts of the permutation arrays, i.e. they can be
+			// subdivided concurrently
+			#pragma omp task if (size > PARALLEL_SUBDIVIDE_THRESHOLD)
+			static_cast<Cluster*>(_sons[0])->subdivide(bmin);
+			static_cast<Cluster*>(_sons[1])->subdivide(bmin);
+			#pragma omp taskwait
+		} else {
+			delete[] l_op_perm;
+			delete[] l_po_perm;
+			delete _l_adj_mat;
+			_l_adj_mat = NULL;
+		} // end if next recursion step
 	} // end if ( connected && size () > bmin )
 
 }
@@ -172,16 +240,17 @@ void Cluster::createClusterTree(unsigned* op_perm, unsigned* po_perm,
 	_g_op_perm = op_perm;
 	_g_po_perm = po_perm;
 
-	// *** 1 create local problem
-	unsigned n = _g_adj_mat->getNRows();
-	unsigned *l_op_perm = new unsigned[n];
-	unsigned *l_po_perm = new unsigned[n];
-	for (unsigned k = 0; k < n; ++k)
-		l_op_perm[k] = l_po_perm[k] = k;
-	_l_adj_mat = _l_adj_mat->getMat(0, n, l_op_perm, l_po_perm);
+	// *** 1 create local problem with respect to the given permutation
+	const unsigned n = _g_adj_mat->getNRows();
+	delete _l_adj_mat;
+	_l_adj_mat = _g_adj_mat->getMat(0, n, op_perm, po_perm);
 
-	// *** 2 create cluster tree
-	subdivide(bmin);
+	// *** 2 create cluster tree, the sub-trees are created by OpenMP tasks
+	#pragma omp parallel
+	{
+		#pragma omp single
+		subdivide(bmin);
+	}
 }
 
 } // end namespace MathLib
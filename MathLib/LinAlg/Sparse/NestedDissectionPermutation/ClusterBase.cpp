@@ -57,6 +57,9 @@ ClusterBase::ClusterBase(ClusterBase *father, unsigned beg, unsigned end,
 
 ClusterBase::~ClusterBase()
 {
+	for (unsigned k(0); k < _n_sons; k++)
+		delete _sons[k];
+	delete [] _sons;
 	if (_parent == NULL)
 		delete _g_adj_mat;
 	delete _l_adj_mat;
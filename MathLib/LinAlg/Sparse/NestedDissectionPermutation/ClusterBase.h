@@ -46,6 +46,28 @@ public:
 
 	virtual bool isSeparator() const = 0;
 
+	/**
+	 * @return the beginning index of the cluster in the permuted numbering
+	 */
+	unsigned getBeg() const { return _beg; }
+
+	/**
+	 * @return the beginning index of the next cluster in the permuted numbering
+	 */
+	unsigned getEnd() const { return _end; }
+
+	/**
+	 * @return the number of sons, 0 iff the cluster is a leaf of the cluster tree
+	 */
+	unsigned getNSons() const { return _n_sons; }
+
+	/**
+	 * @param k number of the son, the sons 0 and 1 are clusters, the son 2 is
+	 * the separator decoupling them
+	 * @return the son k
+	 */
+	ClusterBase const* getSon(unsigned k) const { return _sons[k]; }
+
 #ifndef NDEBUG
 	AdjMat const* getGlobalAdjMat() const { return _g_adj_mat; }
 #endif
@@ -0,0 +1,206 @@
+/*
+ * SELLMatrix.h
+ *
+ *  Created on: Jan 16, 2012
+ *      Author: TF
+ */
+
+#ifndef SELLMATRIX_H_
+#define SELLMATRIX_H_
+
+#include <string>
+#include <algorithm>
+
+#include "CRSMatrix.h"
+#include "amuxSELL.h"
+
+namespace MathLib {
+
+/**
+ * Class SELLMatrix represents a sparse matrix that is additionally stored in the
+ * chunked, sorted sliced ELLPACK format (SELL-C-sigma) in order to use SIMD
+ * instructions within the matrix vector multiplication.
+ *
+ * The rows of the matrix are sorted by their number of non-zero entries within
+ * windows of sigma consecutive rows. Afterwards C consecutive (sorted) rows are
+ * grouped into a chunk. The rows of a chunk are padded to the length of the
+ * longest row of the chunk and the entries are stored column by column, such
+ * that C rows can be processed simultaneously.
+ *
+ * The class is derived from CRSMatrix, i.e. all methods (setValue(), addValue(),
+ * precondApply(), ...) work on the compressed row storage data and the solvers
+ * can be used with a SELLMatrix unchanged. Only the method amux() works on the
+ * SELL-C-sigma data. After changing entries of the matrix the SELL-C-sigma data
+ * have to be updated via the method update().
+ */
+template<typename FP_TYPE, typename IDX_TYPE>
+class SELLMatrix: public CRSMatrix<FP_TYPE, IDX_TYPE>
+{
+public:
+	/**
+	 * Constructor reads the matrix in binary compressed row storage format
+	 * (see CS_read()) and converts it into the SELL-C-sigma format.
+	 * @param fname the name of the file that contains the matrix
+	 * @param chunk_size number of rows per chunk (C), at most SELL_MAX_CHUNK_SIZE
+	 * @param sigma sorting scope (sigma), will be rounded up to a multiple of chunk_size
+	 */
+	SELLMatrix(std::string const &fname, unsigned chunk_size = 8, unsigned sigma = 256) :
+		CRSMatrix<FP_TYPE, IDX_TYPE>(fname),
+		_chunk_size(chunk_size), _sigma(sigma),
+		_chunk_ptr(NULL), _chunk_len(NULL), _sell_col_idx(NULL), _sell_data(NULL), _perm(NULL)
+	{
+		update();
+	}
+
+	/**
+	 * Constructs a matrix object from given data in compressed row storage format.
+	 * @param n number of rows / columns of the matrix
+	 * @param iA row pointer of matrix in compressed row storage format
+	 * @param jA column index of matrix in compressed row storage format
+	 * @param A data entries of matrix in compressed row storage format
+	 * @param chunk_size number of rows per chunk (C), at most SELL_MAX_CHUNK_SIZE
+	 * @param sigma sorting scope (sigma), will be rounded up to a multiple of chunk_size
+	 */
+	SELLMatrix(IDX_TYPE n, IDX_TYPE *iA, IDX_TYPE *jA, FP_TYPE* A,
+				unsigned chunk_size = 8, unsigned sigma = 256) :
+		CRSMatrix<FP_TYPE, IDX_TYPE>(n, iA, jA, A),
+		_chunk_size(chunk_size), _sigma(sigma),
+		_chunk_ptr(NULL), _chunk_len(NULL), _sell_col_idx(NULL), _sell_data(NULL), _perm(NULL)
+	{
+		update();
+	}
+
+	virtual ~SELLMatrix()
+	{
+		delete [] _chunk_ptr;
+		delete [] _chunk_len;
+		delete [] _sell_col_idx;
+		delete [] _sell_data;
+		delete [] _perm;
+	}
+
+	virtual void amux(FP_TYPE d, FP_TYPE const * const __restrict__ x, FP_TYPE * __restrict__ y) const
+	{
+		amuxSELL(d, static_cast<IDX_TYPE>(MatrixBase::_n_rows), _chunk_size, _chunk_ptr, _chunk_len,
+						_sell_col_idx, _sell_data, _perm, x, y);
+	}
+
+	/**
+	 * (re-)creates the SELL-C-sigma data from the compressed row storage data
+	 */
+	void update()
+	{
+		delete [] _chunk_ptr;
+		delete [] _chunk_len;
+		delete [] _sell_col_idx;
+		delete [] _sell_data;
+		delete [] _perm;
+
+		if (_chunk_size == 0 || _chunk_size > SELL_MAX_CHUNK_SIZE) {
+			std::cout << "SELLMatrix: chunk size " << _chunk_size << " not supported, using 8" << std::endl;
+			_chunk_size = 8;
+		}
+		if (_sigma < _chunk_size)
+			_sigma = _chunk_size;
+		_sigma = ((_sigma + _chunk_size - 1) / _chunk_size) * _chunk_size;
+
+		const IDX_TYPE n(MatrixBase::_n_rows);
+		IDX_TYPE const*const row_ptr(CRSMatrix<FP_TYPE, IDX_TYPE>::_row_ptr);
+		IDX_TYPE const*const col_idx(CRSMatrix<FP_TYPE, IDX_TYPE>::_col_idx);
+		FP_TYPE const*const data(CRSMatrix<FP_TYPE, IDX_TYPE>::_data);
+
+		// sort the rows within the sigma windows descending by the row lengths
+		_perm = new IDX_TYPE[n];
+		for (IDX_TYPE k(0); k < n; k++)
+			_perm[k] = k;
+		RowLengthGreater greater(row_ptr);
+		for (IDX_TYPE beg(0); beg < n; beg += _sigma) {
+			const IDX_TYPE end((beg + _sigma < n) ? beg + _sigma : n);
+			std::stable_sort(_perm + beg, _perm + end, greater);
+		}
+
+		// determine the length of the chunks
+		const IDX_TYPE n_chunks((n + _chunk_size - 1) / _chunk_size);
+		_chunk_ptr = new IDX_TYPE[n_chunks + 1];
+		_chunk_len = new IDX_TYPE[n_chunks];
+		_chunk_ptr[0] = 0;
+		for (IDX_TYPE c(0); c < n_chunks; c++) {
+			// the first row of a chunk is the longest one
+			const IDX_TYPE first(_perm[c * _chunk_size]);
+			_chunk_len[c] = row_ptr[first + 1] - row_ptr[first];
+			_chunk_ptr[c + 1] = _chunk_ptr[c] + _chunk_len[c] * _chunk_size;
+		}
+
+		// fill the chunks column by column, padding entries get the value zero and
+		// (for locality reasons) the last column index of the row
+		const IDX_TYPE sell_nnz(_chunk_ptr[n_chunks]);
+		_sell_col_idx = new IDX_TYPE[sell_nnz];
+		_sell_data = new FP_TYPE[sell_nnz];
+		for (IDX_TYPE c(0); c < n_chunks; c++) {
+			for (unsigned r(0); r < _chunk_size; r++) {
+				const IDX_TYPE sorted_row(c * _chunk_size + r);
+				IDX_TYPE offset(_chunk_ptr[c] + r);
+				IDX_TYPE j(0), pad_col(0);
+				if (sorted_row < n) {
+					const IDX_TYPE row(_perm[sorted_row]);
+					const IDX_TYPE row_end(row_ptr[row + 1]);
+					for (IDX_TYPE k(row_ptr[row]); k < row_end; k++, j++) {
+						_sell_col_idx[offset] = pad_col = col_idx[k];
+						_sell_data[offset] = data[k];
+						offset += _chunk_size;
+					}
+				}
+				for (; j < _chunk_len[c]; j++) {
+					_sell_col_idx[offset] = pad_col;
+					_sell_data[offset] = 0.0;
+					offset += _chunk_size;
+				}
+			}
+		}
+	}
+
+	/**
+	 * get the number of stored entries including the padding entries
+	 * @return number of entries in the SELL-C-sigma data structure
+	 */
+	IDX_TYPE getNNZPadded() const
+	{
+		return _chunk_ptr[(MatrixBase::_n_rows + _chunk_size - 1) / _chunk_size];
+	}
+
+	unsigned getChunkSize() const { return _chunk_size; }
+	unsigned getSigma() const { return _sigma; }
+
+private:
+	/**
+	 * comparison of two rows by means of the number of non-zero entries
+	 */
+	class RowLengthGreater
+	{
+	public:
+		RowLengthGreater(IDX_TYPE const*const row_ptr) : _row_ptr(row_ptr) {}
+		bool operator() (IDX_TYPE i, IDX_TYPE j) const
+		{
+			return _row_ptr[i + 1] - _row_ptr[i] > _row_ptr[j + 1] - _row_ptr[j];
+		}
+	private:
+		IDX_TYPE const* _row_ptr;
+	};
+
+	/** number of rows per chunk (C) */
+	unsigned _chunk_size;
+	/** sorting scope (sigma) */
+	unsigned _sigma;
+	/** offsets of the chunks in the arrays _sell_col_idx and _sell_data */
+	IDX_TYPE *_chunk_ptr;
+	/** number of (padded) entries per row in each chunk */
+	IDX_TYPE *_chunk_len;
+	IDX_TYPE *_sell_col_idx;
+	FP_TYPE *_sell_data;
+	/** original row index of the sorted rows */
+	IDX_TYPE *_perm;
+};
+
+} // end namespace MathLib
+
+#endif /* SELLMATRIX_H_ */
@@ -0,0 +1,129 @@
+/*
+ * amuxBCSR.cpp
+ *
+ *  Created on: Feb 7, 2012
+ *      Author: TF
+ */
+
+#include "amuxBCSR.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace MathLib {
+
+#if defined(__AVX2__)
+namespace {
+
+inline __m256d bcsrFMA(__m256d a, __m256d b, __m256d c)
+{
+#if defined(__FMA__)
+	return _mm256_fmadd_pd(a, b, c);
+#else
+	return _mm256_add_pd(c, _mm256_mul_pd(a, b));
+#endif
+}
+
+/** @return (sum of acc0, sum of acc1, sum of acc2, sum of acc3) */
+inline __m256d bcsrHorizontalSums(__m256d acc0, __m256d acc1, __m256d acc2, __m256d acc3)
+{
+	const __m256d t0(_mm256_hadd_pd(acc0, acc1));
+	const __m256d t1(_mm256_hadd_pd(acc2, acc3));
+	return _mm256_add_pd(_mm256_permute2f128_pd(t0, t1, 0x20), _mm256_permute2f128_pd(t0, t1, 0x31));
+}
+
+} // end anonymous namespace
+
+/**
+ * BS = 2: a block fills one register, it is multiplied with (x0, x1, x0, x1)
+ */
+void amuxBCSRBlockRows2(double a, unsigned beg, unsigned end, unsigned const * const iA,
+			unsigned const * const jA, double const * const A, double const * const x,
+			double* y)
+{
+	for (unsigned i(beg); i < end; i++) {
+		__m256d acc(_mm256_setzero_pd());
+		const unsigned row_end(iA[i + 1]);
+		for (unsigned j(iA[i]); j < row_end; j++) {
+			const __m256d xj(_mm256_broadcast_pd((__m128d const*) (x + jA[j] * 2)));
+			acc = bcsrFMA(_mm256_loadu_pd(A + j * 4), xj, acc);
+		}
+		// (acc0 + acc1, acc2 + acc3)
+		const __m256d sums(_mm256_permute4x64_pd(_mm256_hadd_pd(acc, acc), 0x08));
+		_mm_storeu_pd(y + i * 2, _mm_mul_pd(_mm_set1_pd(a), _mm256_castpd256_pd128(sums)));
+	}
+}
+
+/**
+ * BS = 3: every row of a block is loaded masked into one register, the
+ * partial sums are reduced once per block row
+ */
+void amuxBCSRBlockRows3(double a, unsigned beg, unsigned end, unsigned const * const iA,
+			unsigned const * const jA, double const * const A, double const * const x,
+			double* y)
+{
+	const __m256i mask(_mm256_set_epi64x(0, -1, -1, -1));
+	for (unsigned i(beg); i < end; i++) {
+		__m256d acc0(_mm256_setzero_pd()), acc1(_mm256_setzero_pd()), acc2(_mm256_setzero_pd());
+		const unsigned row_end(iA[i + 1]);
+		for (unsigned j(iA[i]); j < row_end; j++) {
+			double const*const block(A + j * 9);
+			const __m256d xj(_mm256_maskload_pd(x + jA[j] * 3, mask));
+			acc0 = bcsrFMA(_mm256_maskload_pd(block, mask), xj, acc0);
+			acc1 = bcsrFMA(_mm256_maskload_pd(block + 3, mask), xj, acc1);
+			acc2 = bcsrFMA(_mm256_maskload_pd(block + 6, mask), xj, acc2);
+		}
+		const __m256d sums(bcsrHorizontalSums(acc0, acc1, acc2, _mm256_setzero_pd()));
+		_mm256_maskstore_pd(y + i * 3, mask, _mm256_mul_pd(_mm256_set1_pd(a), sums));
+	}
+}
+
+/**
+ * BS = 4: every row of a block fills one register, the partial sums are
+ * reduced once per block row
+ */
+void amuxBCSRBlockRows4(double a, unsigned beg, unsigned end, unsigned const * const iA,
+			unsigned const * const jA, double const * const A, double const * const x,
+			double* y)
+{
+	for (unsigned i(beg); i < end; i++) {
+		__m256d acc0(_mm256_setzero_pd()), acc1(_mm256_setzero_pd()),
+			acc2(_mm256_setzero_pd()), acc3(_mm256_setzero_pd());
+		const unsigned row_end(iA[i + 1]);
+		for (unsigned j(iA[i]); j < row_end; j++) {
+			double const*const block(A + j * 16);
+			const __m256d xj(_mm256_loadu_pd(x + jA[j] * 4));
+			acc0 = bcsrFMA(_mm256_loadu_pd(block), xj, acc0);
+			acc1 = bcsrFMA(_mm256_loadu_pd(block + 4), xj, acc1);
+			acc2 = bcsrFMA(_mm256_loadu_pd(block + 8), xj, acc2);
+			acc3 = bcsrFMA(_mm256_loadu_pd(block + 12), xj, acc3);
+		}
+		const __m256d sums(bcsrHorizontalSums(acc0, acc1, acc2, acc3));
+		_mm256_storeu_pd(y + i * 4, _mm256_mul_pd(_mm256_set1_pd(a), sums));
+	}
+}
+#else
+void amuxBCSRBlockRows2(double a, unsigned beg, unsigned end, unsigned const * const iA,
+			unsigned const * const jA, double const * const A, double const * const x,
+			double* y)
+{
+	amuxBCSRBlockRowsGeneric<double, unsigned, 2>(a, beg, end, iA, jA, A, x, y);
+}
+
+void amuxBCSRBlockRows3(double a, unsigned beg, unsigned end, unsigned const * const iA,
+			unsigned const * const jA, double const * const A, double const * const x,
+			double* y)
+{
+	amuxBCSRBlockRowsGeneric<double, unsigned, 3>(a, beg, end, iA, jA, A, x, y);
+}
+
+void amuxBCSRBlockRows4(double a, unsigned beg, unsigned end, unsigned const * const iA,
+			unsigned const * const jA, double const * const A, double const * const x,
+			double* y)
+{
+	amuxBCSRBlockRowsGeneric<double, unsigned, 4>(a, beg, end, iA, jA, A, x, y);
+}
+#endif
+
+} // end namespace MathLib
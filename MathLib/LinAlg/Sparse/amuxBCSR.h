@@ -0,0 +1,178 @@
+/*
+ * amuxBCSR.h
+ *
+ *  Created on: Feb 7, 2012
+ *      Author: TF
+ */
+
+#ifndef AMUXBCSR_H_
+#define AMUXBCSR_H_
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace MathLib {
+
+/**
+ * Multiplies the block row i of a matrix in block compressed row storage
+ * format with the vector x: \f$y_i = a \cdot \sum_j A_{ij} x_j\f$. The block
+ * size is a compile time constant, i.e. the loops over the entries of a block
+ * are unrolled completely and the partial sums of the BS rows of the block row
+ * are kept in registers.
+ */
+template<typename FP_TYPE, typename IDX_TYPE, unsigned BS>
+inline void amuxBCSRBlockRowGeneric(FP_TYPE a, IDX_TYPE i, IDX_TYPE const * const iA,
+				IDX_TYPE const * const jA, FP_TYPE const * const A, FP_TYPE const * const x,
+				FP_TYPE* y)
+{
+	FP_TYPE tmp[BS];
+	for (unsigned r(0); r < BS; r++)
+		tmp[r] = 0.0;
+	const IDX_TYPE end(iA[i + 1]);
+	for (IDX_TYPE j(iA[i]); j < end; j++) {
+		FP_TYPE const*const block(A + j * BS * BS);
+		FP_TYPE const*const xj(x + jA[j] * BS);
+		for (unsigned r(0); r < BS; r++)
+			for (unsigned c(0); c < BS; c++)
+				tmp[r] += block[r * BS + c] * xj[c];
+	}
+	FP_TYPE *const yi(y + i * BS);
+	for (unsigned r(0); r < BS; r++)
+		yi[r] = a * tmp[r];
+}
+
+/**
+ * Multiplies the block rows beg, ..., end-1 of a matrix in block compressed
+ * row storage format with the vector x, see amuxBCSRBlockRowGeneric().
+ */
+template<typename FP_TYPE, typename IDX_TYPE, unsigned BS>
+inline void amuxBCSRBlockRowsGeneric(FP_TYPE a, IDX_TYPE beg, IDX_TYPE end,
+				IDX_TYPE const * const iA, IDX_TYPE const * const jA, FP_TYPE const * const A,
+				FP_TYPE const * const x, FP_TYPE* y)
+{
+	for (IDX_TYPE i(beg); i < end; i++)
+		amuxBCSRBlockRowGeneric<FP_TYPE, IDX_TYPE, BS>(a, i, iA, jA, A, x, y);
+}
+
+/**
+ * Selects the kernel for a range of block rows. For double precision,
+ * unsigned indices and BS = 2, 3, 4 the kernels are implemented in
+ * amuxBCSR.cpp (in the same way the SELL kernels are kept in amuxSELL.cpp),
+ * they use AVX2 intrinsics if the library is compiled with AVX2 support.
+ * The loop over the block rows is part of the kernels, i.e. there is only
+ * one (not inlined) call per matrix vector multiplication and thread.
+ */
+template<typename FP_TYPE, typename IDX_TYPE, unsigned BS>
+struct BCSRBlockRowsKernel
+{
+	static void apply(FP_TYPE a, IDX_TYPE beg, IDX_TYPE end, IDX_TYPE const * const iA,
+					IDX_TYPE const * const jA, FP_TYPE const * const A, FP_TYPE const * const x,
+					FP_TYPE* y)
+	{
+		amuxBCSRBlockRowsGeneric<FP_TYPE, IDX_TYPE, BS>(a, beg, end, iA, jA, A, x, y);
+	}
+};
+
+/** kernels for the block rows beg, ..., end-1, implemented in amuxBCSR.cpp */
+void amuxBCSRBlockRows2(double a, unsigned beg, unsigned end, unsigned const * const iA,
+				unsigned const * const jA, double const * const A, double const * const x,
+				double* y);
+void amuxBCSRBlockRows3(double a, unsigned beg, unsigned end, unsigned const * const iA,
+				unsigned const * const jA, double const * const A, double const * const x,
+				double* y);
+void amuxBCSRBlockRows4(double a, unsigned beg, unsigned end, unsigned const * const iA,
+				unsigned const * const jA, double const * const A, double const * const x,
+				double* y);
+
+template<>
+struct BCSRBlockRowsKernel<double, unsigned, 2>
+{
+	static void apply(double a, unsigned beg, unsigned end, unsigned const * const iA,
+					unsigned const * const jA, double const * const A, double const * const x,
+					double* y)
+	{
+		amuxBCSRBlockRows2(a, beg, end, iA, jA, A, x, y);
+	}
+};
+
+template<>
+struct BCSRBlockRowsKernel<double, unsigned, 3>
+{
+	static void apply(double a, unsigned beg, unsigned end, unsigned const * const iA,
+					unsigned const * const jA, double const * const A, double const * const x,
+					double* y)
+	{
+		amuxBCSRBlockRows3(a, beg, end, iA, jA, A, x, y);
+	}
+};
+
+template<>
+struct BCSRBlockRowsKernel<double, unsigned, 4>
+{
+	static void apply(double a, unsigned beg, unsigned end, unsigned const * const iA,
+					unsigned const * const jA, double const * const A, double const * const x,
+					double* y)
+	{
+		amuxBCSRBlockRows4(a, beg, end, iA, jA, A, x, y);
+	}
+};
+
+/**
+ * see BCSRBlockRowsKernel
+ */
+template<typename FP_TYPE, typename IDX_TYPE, unsigned BS>
+inline void amuxBCSRBlockRows(FP_TYPE a, IDX_TYPE beg, IDX_TYPE end, IDX_TYPE const * const iA,
+				IDX_TYPE const * const jA, FP_TYPE const * const A, FP_TYPE const * const x,
+				FP_TYPE* y)
+{
+	BCSRBlockRowsKernel<FP_TYPE, IDX_TYPE, BS>::apply(a, beg, end, iA, jA, A, x, y);
+}
+
+/**
+ * Matrix vector multiplication \f$y = a \cdot A x\f$ with a matrix \f$A\f$ in
+ * block compressed row storage format. The blocks are dense BS x BS matrices
+ * stored row by row, block j of the matrix starts at position j * BS * BS in
+ * the array A, its block column index is jA[j].
+ * @param a scalar factor
+ * @param n_block_rows number of block rows
+ * @param iA block row pointer array of length n_block_rows+1
+ * @param jA block column indices
+ * @param A entries of the blocks
+ * @param x vector to multiply with
+ * @param y result vector
+ */
+template<typename FP_TYPE, typename IDX_TYPE, unsigned BS>
+void amuxBCSR(FP_TYPE a, IDX_TYPE n_block_rows, IDX_TYPE const * const iA,
+				IDX_TYPE const * const jA, FP_TYPE const * const A, FP_TYPE const * const x,
+				FP_TYPE* y)
+{
+	amuxBCSRBlockRows<FP_TYPE, IDX_TYPE, BS>(a, 0, n_block_rows, iA, jA, A, x, y);
+}
+
+#ifdef _OPENMP
+/**
+ * OpenMP parallel version of amuxBCSR(), the block rows are distributed to the
+ * threads according to the given partition (see amuxCRSParallelOpenMP())
+ * @param n_blocks number of parts of the partition, should be the number of threads
+ * @param row_partition array of length n_blocks+1, part k consists of the block
+ * rows row_partition[k], ..., row_partition[k+1]-1
+ */
+template<typename FP_TYPE, typename IDX_TYPE, unsigned BS>
+void amuxBCSRParallelOpenMP(FP_TYPE a, IDX_TYPE const * const iA, IDX_TYPE const * const jA,
+				FP_TYPE const * const A, FP_TYPE const * const x, FP_TYPE* y,
+				unsigned n_blocks, IDX_TYPE const * const row_partition)
+{
+#pragma omp parallel
+	{
+		const unsigned n_threads(omp_get_num_threads());
+		for (unsigned b(omp_get_thread_num()); b < n_blocks; b += n_threads)
+			amuxBCSRBlockRows<FP_TYPE, IDX_TYPE, BS>(a, row_partition[b], row_partition[b + 1],
+							iA, jA, A, x, y);
+	}
+}
+#endif
+
+} // end namespace MathLib
+
+#endif /* AMUXBCSR_H_ */
@@ -6,6 +6,7 @@
  */
 
 #include "amuxCRS.h"
+#include "partitionRowsByNNZ.h"
 #include <cstddef>
 #ifdef _OPENMP
 #include <omp.h>
@@ -66,14 +67,14 @@ void amuxCRSParallelPThreads (double a,
 	unsigned num_of_pthreads)
 {
 #ifdef HAVE_PTHREADS
-	// fill thread data objects
+	// fill thread data objects, the rows are distributed by the number of non-zero entries
+	unsigned *row_partition (new unsigned[num_of_pthreads+1]);
+	partitionRowsByNNZ(n, iA, num_of_pthreads, row_partition);
 	MatMultThreadParam** thread_param_array (new MatMultThreadParam*[num_of_pthreads]);
-	double step_size ((double)(n)/(double)(num_of_pthreads));
 	for (unsigned k(0); k<num_of_pthreads; k++) {
-		const unsigned beg (static_cast<unsigned>(k*step_size));
-		const unsigned end (static_cast<unsigned>((k+1)*step_size));
-		thread_param_array[k] = new MatMultThreadParam (a, beg, end, iA, jA, A, x, y);
+		thread_param_array[k] = new MatMultThreadParam (a, row_partition[k], row_partition[k+1], iA, jA, A, x, y);
 	}
+	delete [] row_partition;
 
 	// allocate thread_array and return value array
 	pthread_t *thread_array (new pthread_t[num_of_pthreads]);
@@ -100,31 +101,4 @@ void amuxCRSParallelPThreads (double a,
 #endif
 }
 
-void amuxCRSSym (double a,
-	unsigned n, unsigned const * const iA, unsigned const * const jA,
-        double const * const A, double const * const x, double* y)
-{
-	for (unsigned i(0); i<n; i++) {
-			y[i] = 0.0;
-	}
-
-	for (unsigned i(0); i<n; i++) {
-		unsigned j (iA[i]);
-		// handle diagonal
-		if (jA[j] == i) {
-			y[i] += A[j] * x[jA[j]];
-			j++;
-		}
-		const unsigned end (iA[i+1]);
-		for (; j<end; j++) {
-				y[i] += A[j] * x[jA[j]];
-				y[jA[j]] += A[j] * x[i];
-		}
-	}
-
-	for (unsigned i(0); i<n; i++) {
-		y[i] *= a;
-	}
-}
-
 } // end namespace MathLib
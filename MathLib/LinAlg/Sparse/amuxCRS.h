@@ -1,6 +1,12 @@
 #ifndef AMUXCRS_H
 #define AMUXCRS_H
 
+#include <cstddef>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace MathLib {
 
 template<typename FP_TYPE, typename IDX_TYPE>
@@ -17,6 +23,66 @@ void amuxCRS(FP_TYPE a, IDX_TYPE n, IDX_TYPE const * const iA, IDX_TYPE const *
 	}
 }
 
+/**
+ * Y_c = a * A * X_c for the K columns c of the blocks X and Y (stored row by
+ * row, the leading dimension is k), the number of columns is a compile time
+ * constant, such that the accumulators are kept in registers
+ */
+template<unsigned K, typename FP_TYPE, typename IDX_TYPE>
+void amuxCRSBlockColumns(FP_TYPE a, IDX_TYPE n, IDX_TYPE const * const iA, IDX_TYPE const * const jA,
+				FP_TYPE const * const A, unsigned k, FP_TYPE const * const __restrict__ X,
+				FP_TYPE* __restrict__ Y)
+{
+	for (IDX_TYPE i(0); i < n; i++) {
+		FP_TYPE acc[K];
+		for (unsigned q(0); q < K; q++)
+			acc[q] = 0.0;
+		const IDX_TYPE end(iA[i + 1]);
+		for (IDX_TYPE j(iA[i]); j < end; j++) {
+			const FP_TYPE a_ij (A[j]);
+			FP_TYPE const*const x_j (X + static_cast<size_t>(jA[j]) * k);
+			for (unsigned q(0); q < K; q++)
+				acc[q] += a_ij * x_j[q];
+		}
+		FP_TYPE *y_i (Y + static_cast<size_t>(i) * k);
+		for (unsigned q(0); q < K; q++)
+			y_i[q] = a * acc[q];
+	}
+}
+
+/**
+ * Multiplication of the matrix with a block of k vectors (SpMM) Y = a * A * X.
+ * The blocks X and Y are stored row by row, i.e. the entry i of vector q is
+ * X[i*k+q]. The vectors are processed in groups of 16, 8, 4, 2 and 1 vectors,
+ * every entry of the matrix is read once per group.
+ * @param k number of vectors
+ * @param X block of n x k entries
+ * @param Y block of n x k entries, at the end the result
+ */
+template<typename FP_TYPE, typename IDX_TYPE>
+void amuxCRSBlock(FP_TYPE a, IDX_TYPE n, IDX_TYPE const * const iA, IDX_TYPE const * const jA,
+				FP_TYPE const * const A, unsigned k, FP_TYPE const * const __restrict__ X,
+				FP_TYPE* __restrict__ Y)
+{
+	unsigned q(0);
+	for (; q + 16 <= k; q += 16)
+		amuxCRSBlockColumns<16>(a, n, iA, jA, A, k, X + q, Y + q);
+	if (q + 8 <= k) {
+		amuxCRSBlockColumns<8>(a, n, iA, jA, A, k, X + q, Y + q);
+		q += 8;
+	}
+	if (q + 4 <= k) {
+		amuxCRSBlockColumns<4>(a, n, iA, jA, A, k, X + q, Y + q);
+		q += 4;
+	}
+	if (q + 2 <= k) {
+		amuxCRSBlockColumns<2>(a, n, iA, jA, A, k, X + q, Y + q);
+		q += 2;
+	}
+	if (q < k)
+		amuxCRSBlockColumns<1>(a, n, iA, jA, A, k, X + q, Y + q);
+}
+
 void amuxCRSParallelPThreads (double a,
 	unsigned n, unsigned const * const iA, unsigned const * const jA,
         double const * const A, double const * const x, double* y,
@@ -41,11 +107,220 @@ void amuxCRSParallelOpenMP (FP_TYPE a,
 		}
 	}
 }
+
+/**
+ * OpenMP parallel matrix vector multiplication, where the rows are distributed
+ * to the threads block-wise according to a given partition (for instance a
+ * partition with equal number of non-zero entries per block, see
+ * partitionRowsByNNZ()).
+ * @param n_blocks number of blocks, should be the number of threads
+ * @param row_partition array of length n_blocks+1, block k consists of the rows
+ * row_partition[k], ..., row_partition[k+1]-1
+ */
+template<typename FP_TYPE, typename IDX_TYPE>
+void amuxCRSParallelOpenMP (FP_TYPE a,
+				IDX_TYPE const * const __restrict__ iA, IDX_TYPE const * const __restrict__ jA,
+				FP_TYPE const * const A, FP_TYPE const * const __restrict__ x, FP_TYPE* __restrict__ y,
+				unsigned n_blocks, IDX_TYPE const * const row_partition)
+{
+#pragma omp parallel
+	{
+		const unsigned n_threads(omp_get_num_threads());
+		for (unsigned b(omp_get_thread_num()); b < n_blocks; b += n_threads) {
+			const IDX_TYPE end_row(row_partition[b + 1]);
+			for (IDX_TYPE i(row_partition[b]); i < end_row; i++) {
+				const IDX_TYPE end(iA[i + 1]);
+				FP_TYPE tmp(0.0);
+				for (IDX_TYPE j(iA[i]); j < end; j++) {
+					tmp += A[j] * x[jA[j]];
+				}
+				y[i] = a * tmp;
+			}
+		}
+	}
+}
+
+/**
+ * OpenMP parallel version of amuxCRSBlock(), the rows are distributed to the
+ * threads according to the given partition (see amuxCRSParallelOpenMP()).
+ * @param n_blocks number of blocks, should be the number of threads
+ * @param row_partition array of length n_blocks+1
+ */
+template<typename FP_TYPE, typename IDX_TYPE>
+void amuxCRSBlockParallelOpenMP (FP_TYPE a,
+				IDX_TYPE const * const __restrict__ iA, IDX_TYPE const * const __restrict__ jA,
+				FP_TYPE const * const A, unsigned k, FP_TYPE const * const __restrict__ X,
+				FP_TYPE* __restrict__ Y, unsigned n_blocks, IDX_TYPE const * const row_partition)
+{
+#pragma omp parallel
+	{
+		const unsigned n_threads(omp_get_num_threads());
+		for (unsigned b(omp_get_thread_num()); b < n_blocks; b += n_threads) {
+			const IDX_TYPE beg_row(row_partition[b]);
+			amuxCRSBlock(a, row_partition[b + 1] - beg_row, iA + beg_row, jA, A, k, X,
+							Y + static_cast<size_t>(beg_row) * k);
+		}
+	}
+}
 #endif
 
-void amuxCRSSym (double a,
-	unsigned n, unsigned const * const iA, unsigned const * const jA,
-        double const * const A, double const * const x, double* y);
+/**
+ * Matrix vector multiplication y = a * A * x for a symmetric matrix A, where
+ * only the upper triangular part (including the diagonal) is stored in
+ * compressed row storage format.
+ */
+template<typename FP_TYPE, typename IDX_TYPE>
+void amuxCRSSym (FP_TYPE a,
+	IDX_TYPE n, IDX_TYPE const * const iA, IDX_TYPE const * const jA,
+	FP_TYPE const * const A, FP_TYPE const * const x, FP_TYPE* y)
+{
+	for (IDX_TYPE i(0); i<n; i++) {
+			y[i] = 0.0;
+	}
+
+	for (IDX_TYPE i(0); i<n; i++) {
+		IDX_TYPE j (iA[i]);
+		const IDX_TYPE end (iA[i+1]);
+		// handle diagonal
+		if (j<end && jA[j] == i) {
+			y[i] += A[j] * x[jA[j]];
+			j++;
+		}
+		for (; j<end; j++) {
+				y[i] += A[j] * x[jA[j]];
+				y[jA[j]] += A[j] * x[i];
+		}
+	}
+
+	for (IDX_TYPE i(0); i<n; i++) {
+		y[i] *= a;
+	}
+}
+
+#ifdef _OPENMP
+/**
+ * OpenMP parallel version of amuxCRSSym() using thread private buffers.
+ * Block b of rows (given by the row partition) is processed by one thread
+ * that accumulates its results in a private buffer, afterwards the buffers
+ * are summed up in parallel. Since only the upper triangular part is stored,
+ * the rows of block b write only to the entries row_partition[b], ...,
+ * col_end[b]-1, i.e. the buffer of the block needs only this range.
+ * @param n_blocks number of row blocks
+ * @param row_partition array of length n_blocks+1
+ * @param col_end array of length n_blocks, col_end[b] is one past the
+ * largest column index within block b (at least row_partition[b+1])
+ * @param buffer_offset array of length n_blocks, the buffer of block b
+ * starts at buffer + buffer_offset[b] and has col_end[b] - row_partition[b] entries
+ * @param buffer the buffers of all blocks
+ */
+template<typename FP_TYPE, typename IDX_TYPE>
+void amuxCRSSymParallelOpenMP (FP_TYPE a,
+	IDX_TYPE n, IDX_TYPE const * const __restrict__ iA, IDX_TYPE const * const __restrict__ jA,
+	FP_TYPE const * const A, FP_TYPE const * const __restrict__ x, FP_TYPE* __restrict__ y,
+	unsigned n_blocks, IDX_TYPE const * const row_partition, IDX_TYPE const * const col_end,
+	size_t const * const buffer_offset, FP_TYPE* buffer)
+{
+#pragma omp parallel
+	{
+		const unsigned n_threads(omp_get_num_threads());
+		for (unsigned b(omp_get_thread_num()); b < n_blocks; b += n_threads) {
+			const IDX_TYPE beg_row(row_partition[b]);
+			const IDX_TYPE end_row(row_partition[b + 1]);
+			// yb[i] is the buffer entry of row i
+			FP_TYPE* const __restrict__ yb(buffer + buffer_offset[b] - beg_row);
+			for (IDX_TYPE i(beg_row); i < col_end[b]; i++) {
+				yb[i] = 0.0;
+			}
+			for (IDX_TYPE i(beg_row); i < end_row; i++) {
+				IDX_TYPE j (iA[i]);
+				const IDX_TYPE end (iA[i+1]);
+				FP_TYPE tmp(0.0);
+				// handle diagonal
+				if (j<end && jA[j] == i) {
+					tmp = A[j] * x[i];
+					j++;
+				}
+				const FP_TYPE xi(x[i]);
+				for (; j<end; j++) {
+					tmp += A[j] * x[jA[j]];
+					yb[jA[j]] += A[j] * xi;
+				}
+				yb[i] += tmp;
+			}
+		}
+
+#pragma omp barrier
+
+		// sum up the buffers, buffer b contributes to the rows
+		// row_partition[b], ..., col_end[b]-1 only
+		OPENMP_LOOP_TYPE i;
+#pragma omp for
+		for (i = 0; i < n; i++) {
+			FP_TYPE tmp(0.0);
+			for (unsigned b(0); b < n_blocks && row_partition[b] <= i; b++) {
+				if (i < col_end[b])
+					tmp += buffer[buffer_offset[b] + i - row_partition[b]];
+			}
+			y[i] = a * tmp;
+		}
+	}
+}
+
+/**
+ * OpenMP parallel version of amuxCRSSym() using a coloring of row blocks.
+ * The rows of block b write only to the entries row_partition[b], ...,
+ * col_end[b]-1 of y. Blocks of the same color write to disjoint ranges, so
+ * the colors are processed one after the other and the blocks of a color
+ * are processed in parallel, writing directly to y without extra memory.
+ * @param n_blocks number of row blocks
+ * @param row_partition array of length n_blocks+1
+ * @param n_colors number of colors
+ * @param color_ptr array of length n_colors+1, the blocks of color c are
+ * color_blocks[color_ptr[c]], ..., color_blocks[color_ptr[c+1]-1]
+ * @param color_blocks array of length n_blocks
+ */
+template<typename FP_TYPE, typename IDX_TYPE>
+void amuxCRSSymColoredOpenMP (FP_TYPE a,
+	IDX_TYPE n, IDX_TYPE const * const __restrict__ iA, IDX_TYPE const * const __restrict__ jA,
+	FP_TYPE const * const A, FP_TYPE const * const __restrict__ x, FP_TYPE* __restrict__ y,
+	IDX_TYPE const * const row_partition, unsigned n_colors,
+	unsigned const * const color_ptr, unsigned const * const color_blocks)
+{
+#pragma omp parallel
+	{
+		OPENMP_LOOP_TYPE i;
+#pragma omp for
+		for (i = 0; i < n; i++) {
+			y[i] = 0.0;
+		}
+
+		for (unsigned c(0); c < n_colors; c++) {
+			OPENMP_LOOP_TYPE k;
+#pragma omp for schedule(dynamic)
+			for (k = color_ptr[c]; k < color_ptr[c + 1]; k++) {
+				const unsigned b(color_blocks[k]);
+				const IDX_TYPE end_row(row_partition[b + 1]);
+				for (IDX_TYPE r(row_partition[b]); r < end_row; r++) {
+					IDX_TYPE j (iA[r]);
+					const IDX_TYPE end (iA[r+1]);
+					FP_TYPE tmp(0.0);
+					// handle diagonal
+					if (j<end && jA[j] == r) {
+						tmp = A[j] * x[r];
+						j++;
+					}
+					const FP_TYPE xr(a * x[r]);
+					for (; j<end; j++) {
+						tmp += A[j] * x[jA[j]];
+						y[jA[j]] += A[j] * xr;
+					}
+					y[r] += a * tmp;
+				}
+			}
+		}
+	}
+}
+#endif
 
 } // end namespace MathLib
 
@@ -0,0 +1,117 @@
+/*
+ * amuxSELL.cpp
+ *
+ *  Created on: Jan 16, 2012
+ *      Author: TF
+ */
+
+#include "amuxSELL.h"
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace MathLib {
+
+#if defined(__AVX512F__)
+static void amuxSELLAVX512(double a, unsigned n, unsigned chunk_size,
+				unsigned const * const chunk_ptr, unsigned const * const chunk_len,
+				unsigned const * const col_idx, double const * const data,
+				unsigned const * const perm, double const * const x, double* y)
+{
+	const unsigned n_chunks((n + chunk_size - 1) / chunk_size);
+	const __m512d scalar(_mm512_set1_pd(a));
+
+	OPENMP_LOOP_TYPE c;
+#pragma omp parallel for
+	for (c = 0; c < n_chunks; c++) {
+		double tmp[SELL_MAX_CHUNK_SIZE];
+		const unsigned len(chunk_len[c]);
+		for (unsigned r(0); r < chunk_size; r += 8) {
+			__m512d acc(_mm512_setzero_pd());
+			unsigned offset(chunk_ptr[c] + r);
+			for (unsigned j(0); j < len; j++) {
+				const __m256i idx(_mm256_loadu_si256((__m256i const*) (col_idx + offset)));
+				// the masked gather with a zero source avoids -Wmaybe-uninitialized
+				const __m512d x_gathered(_mm512_mask_i32gather_pd(_mm512_setzero_pd(),
+								(__mmask8) 0xff, idx, x, 8));
+				acc = _mm512_fmadd_pd(_mm512_loadu_pd(data + offset), x_gathered, acc);
+				offset += chunk_size;
+			}
+			_mm512_storeu_pd(tmp + r, _mm512_mul_pd(scalar, acc));
+		}
+
+		const unsigned beg_row(c * chunk_size);
+		const unsigned n_rows_chunk((beg_row + chunk_size < n) ? chunk_size : n - beg_row);
+		for (unsigned r(0); r < n_rows_chunk; r++) {
+			y[perm[beg_row + r]] = tmp[r];
+		}
+	}
+}
+#endif
+
+#if defined(__AVX2__)
+static void amuxSELLAVX2(double a, unsigned n, unsigned chunk_size,
+				unsigned const * const chunk_ptr, unsigned const * const chunk_len,
+				unsigned const * const col_idx, double const * const data,
+				unsigned const * const perm, double const * const x, double* y)
+{
+	const unsigned n_chunks((n + chunk_size - 1) / chunk_size);
+	const __m256d scalar(_mm256_set1_pd(a));
+
+	OPENMP_LOOP_TYPE c;
+#pragma omp parallel for
+	for (c = 0; c < n_chunks; c++) {
+		double tmp[SELL_MAX_CHUNK_SIZE];
+		const unsigned len(chunk_len[c]);
+		for (unsigned r(0); r < chunk_size; r += 4) {
+			__m256d acc(_mm256_setzero_pd());
+			unsigned offset(chunk_ptr[c] + r);
+			for (unsigned j(0); j < len; j++) {
+				const __m128i idx(_mm_loadu_si128((__m128i const*) (col_idx + offset)));
+				const __m256d x_gathered(_mm256_mask_i32gather_pd(_mm256_setzero_pd(),
+								x, idx, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8));
+#if defined(__FMA__)
+				acc = _mm256_fmadd_pd(_mm256_loadu_pd(data + offset), x_gathered, acc);
+#else
+				acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(data + offset), x_gathered));
+#endif
+				offset += chunk_size;
+			}
+			_mm256_storeu_pd(tmp + r, _mm256_mul_pd(scalar, acc));
+		}
+
+		const unsigned beg_row(c * chunk_size);
+		const unsigned n_rows_chunk((beg_row + chunk_size < n) ? chunk_size : n - beg_row);
+		for (unsigned r(0); r < n_rows_chunk; r++) {
+			y[perm[beg_row + r]] = tmp[r];
+		}
+	}
+}
+#endif
+
+void amuxSELL(double a, unsigned n, unsigned chunk_size,
+				unsigned const * const chunk_ptr, unsigned const * const chunk_len,
+				unsigned const * const col_idx, double const * const data,
+				unsigned const * const perm, double const * const x, double* y)
+{
+#if defined(__AVX512F__) || defined(__AVX2__)
+	// the gather instructions interpret the indices as signed 32 bit integers
+	const bool indices_fit (n < 0x80000000u);
+#endif
+#if defined(__AVX512F__)
+	if (indices_fit && chunk_size % 8 == 0) {
+		amuxSELLAVX512(a, n, chunk_size, chunk_ptr, chunk_len, col_idx, data, perm, x, y);
+		return;
+	}
+#endif
+#if defined(__AVX2__)
+	if (indices_fit && chunk_size % 4 == 0) {
+		amuxSELLAVX2(a, n, chunk_size, chunk_ptr, chunk_len, col_idx, data, perm, x, y);
+		return;
+	}
+#endif
+	amuxSELL<double, unsigned>(a, n, chunk_size, chunk_ptr, chunk_len, col_idx, data, perm, x, y);
+}
+
+} // end namespace MathLib
@@ -0,0 +1,91 @@
+/*
+ * amuxSELL.h
+ *
+ *  Created on: Jan 16, 2012
+ *      Author: TF
+ */
+
+#ifndef AMUXSELL_H_
+#define AMUXSELL_H_
+
+#include <cassert>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace MathLib {
+
+/**
+ * maximal number of rows in a chunk of the sliced ELLPACK format
+ */
+const unsigned SELL_MAX_CHUNK_SIZE = 32;
+
+/**
+ * Matrix vector multiplication \f$y = a \cdot A x\f$ with a matrix \f$A\f$ stored
+ * in the chunked, sorted sliced ELLPACK format (SELL-C-sigma). The rows of a chunk
+ * are stored column by column, i.e. the j-th entry of row r of chunk c is located at
+ * position chunk_ptr[c] + j * chunk_size + r in the arrays col_idx and data.
+ * Generic (scalar) version, the compiler is able to vectorize the inner loop over
+ * the rows of a chunk.
+ * @param a scalar factor
+ * @param n number of rows
+ * @param chunk_size number of rows per chunk (at most SELL_MAX_CHUNK_SIZE)
+ * @param chunk_ptr array of length n_chunks+1, offsets of the chunks in col_idx and data
+ * @param chunk_len array of length n_chunks, number of (padded) entries of each row of the chunk
+ * @param col_idx column indices
+ * @param data matrix entries
+ * @param perm original row index of the k-th sorted row
+ * @param x vector to multiply with
+ * @param y result vector
+ */
+template<typename FP_TYPE, typename IDX_TYPE>
+void amuxSELL(FP_TYPE a, IDX_TYPE n, unsigned chunk_size,
+				IDX_TYPE const * const chunk_ptr, IDX_TYPE const * const chunk_len,
+				IDX_TYPE const * const col_idx, FP_TYPE const * const data,
+				IDX_TYPE const * const perm, FP_TYPE const * const x, FP_TYPE* y)
+{
+	assert(chunk_size <= SELL_MAX_CHUNK_SIZE);
+	const IDX_TYPE n_chunks((n + chunk_size - 1) / chunk_size);
+
+	OPENMP_LOOP_TYPE c;
+#pragma omp parallel for
+	for (c = 0; c < n_chunks; c++) {
+		FP_TYPE tmp[SELL_MAX_CHUNK_SIZE];
+		for (unsigned r(0); r < chunk_size; r++) {
+			tmp[r] = 0.0;
+		}
+
+		const IDX_TYPE len(chunk_len[c]);
+		IDX_TYPE offset(chunk_ptr[c]);
+		for (IDX_TYPE j(0); j < len; j++) {
+			for (unsigned r(0); r < chunk_size; r++) {
+				tmp[r] += data[offset + r] * x[col_idx[offset + r]];
+			}
+			offset += chunk_size;
+		}
+
+		// the last chunk can contain padding rows
+		const IDX_TYPE beg_row(c * chunk_size);
+		const IDX_TYPE n_rows_chunk((beg_row + chunk_size < n) ? chunk_size : n - beg_row);
+		for (IDX_TYPE r(0); r < n_rows_chunk; r++) {
+			y[perm[beg_row + r]] = a * tmp[r];
+		}
+	}
+}
+
+/**
+ * Matrix vector multiplication for matrices in SELL-C-sigma format, specialized
+ * for the most common data types. Depending on the instruction set the code is
+ * compiled for, AVX-512 (chunk size a multiple of 8) or AVX2 (chunk size a multiple
+ * of 4) gather kernels are used. In all other cases the generic version is called.
+ * The parameters have the same meaning as in the template version.
+ */
+void amuxSELL(double a, unsigned n, unsigned chunk_size,
+				unsigned const * const chunk_ptr, unsigned const * const chunk_len,
+				unsigned const * const col_idx, double const * const data,
+				unsigned const * const perm, double const * const x, double* y);
+
+} // end namespace MathLib
+
+#endif /* AMUXSELL_H_ */
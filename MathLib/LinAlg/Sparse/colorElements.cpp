@@ -0,0 +1,69 @@
+/*
+ * colorElements.cpp
+ *
+ *  Created on: Feb 9, 2012
+ *      Author: TF
+ */
+
+#include <stdint.h>
+
+#include "colorElements.h"
+
+namespace MathLib {
+
+unsigned colorElements(unsigned n_nodes, unsigned n_elements, unsigned const*const element_ptr,
+				unsigned const*const element_nodes, unsigned* &color_ptr, unsigned* &elements)
+{
+	// the colors are assigned in rounds of 64 colors, within a round the bit c
+	// of node_colors[v] is set if an element of color 64*round+c contains node v
+	uint64_t *node_colors(new uint64_t[n_nodes]);
+	unsigned *element_colors(new unsigned[n_elements]);
+	const unsigned uncolored(static_cast<unsigned>(-1));
+	for (unsigned e(0); e < n_elements; e++)
+		element_colors[e] = uncolored;
+
+	unsigned n_colors(0), n_colored(0);
+	for (unsigned round(0); n_colored < n_elements; round++) {
+		for (unsigned v(0); v < n_nodes; v++)
+			node_colors[v] = 0;
+		for (unsigned e(0); e < n_elements; e++) {
+			if (element_colors[e] != uncolored)
+				continue;
+			uint64_t forbidden(0);
+			for (unsigned k(element_ptr[e]); k < element_ptr[e + 1]; k++)
+				forbidden |= node_colors[element_nodes[k]];
+			if (forbidden == ~static_cast<uint64_t>(0))
+				continue;
+			unsigned c(0);
+			while (forbidden & (static_cast<uint64_t>(1) << c))
+				c++;
+			for (unsigned k(element_ptr[e]); k < element_ptr[e + 1]; k++)
+				node_colors[element_nodes[k]] |= static_cast<uint64_t>(1) << c;
+			element_colors[e] = 64 * round + c;
+			if (element_colors[e] + 1 > n_colors)
+				n_colors = element_colors[e] + 1;
+			n_colored++;
+		}
+	}
+
+	// sort the elements by color
+	color_ptr = new unsigned[n_colors + 1];
+	for (unsigned c(0); c <= n_colors; c++)
+		color_ptr[c] = 0;
+	for (unsigned e(0); e < n_elements; e++)
+		color_ptr[element_colors[e] + 1]++;
+	for (unsigned c(0); c < n_colors; c++)
+		color_ptr[c + 1] += color_ptr[c];
+	elements = new unsigned[n_elements];
+	for (unsigned e(0); e < n_elements; e++)
+		elements[color_ptr[element_colors[e]]++] = e;
+	for (unsigned c(n_colors); c > 0; c--)
+		color_ptr[c] = color_ptr[c - 1];
+	color_ptr[0] = 0;
+
+	delete [] element_colors;
+	delete [] node_colors;
+	return n_colors;
+}
+
+} // end namespace MathLib
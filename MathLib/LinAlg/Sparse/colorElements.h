@@ -0,0 +1,35 @@
+/*
+ * colorElements.h
+ *
+ *  Created on: Feb 9, 2012
+ *      Author: TF
+ */
+
+#ifndef COLORELEMENTS_H_
+#define COLORELEMENTS_H_
+
+namespace MathLib {
+
+/**
+ * Greedy coloring of the elements of a mesh such that elements of the same
+ * color do not share a node. The element matrices of the elements of one
+ * color can be added to the global matrix concurrently without atomic
+ * operations (see CRSMatrix::addBlock()), the colors are processed one after
+ * another.
+ * @param n_nodes number of nodes
+ * @param n_elements number of elements
+ * @param element_ptr array of length n_elements+1, the nodes of element e are
+ * element_nodes[element_ptr[e]], ..., element_nodes[element_ptr[e+1]-1]
+ * @param element_nodes the node numbers of the elements
+ * @param color_ptr array of length n_colors+1 (output, allocated via new [])
+ * @param elements the elements sorted by color, the elements of color c are
+ * elements[color_ptr[c]], ..., elements[color_ptr[c+1]-1] (output, allocated
+ * via new [])
+ * @return the number of colors
+ */
+unsigned colorElements(unsigned n_nodes, unsigned n_elements, unsigned const*const element_ptr,
+				unsigned const*const element_nodes, unsigned* &color_ptr, unsigned* &elements);
+
+} // end namespace MathLib
+
+#endif /* COLORELEMENTS_H_ */
@@ -0,0 +1,155 @@
+/*
+ * generateStencilMatrix.cpp
+ *
+ *  Created on: Feb 28, 2012
+ *      Author: TF
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <map>
+#include <stdint.h>
+
+#include "generateStencilMatrix.h"
+
+namespace MathLib {
+
+void generateLayeredCoefficients(unsigned nx, unsigned ny, unsigned nz, unsigned n_layers,
+				double contrast, double* k)
+{
+	const bool three_dim (nz > 1);
+	const unsigned n_last (three_dim ? nz : ny);
+	if (n_layers == 0)
+		n_layers = 1;
+	for (unsigned kk(0); kk < nz; kk++) {
+		for (unsigned j(0); j < ny; j++) {
+			const unsigned pos (three_dim ? kk : j);
+			const unsigned layer ((static_cast<std::size_t>(pos) * n_layers) / n_last);
+			const double val (layer % 2 == 0 ? 1.0 : contrast);
+			double *k_row (k + (static_cast<std::size_t>(kk) * ny + j) * nx);
+			for (unsigned i(0); i < nx; i++)
+				k_row[i] = val;
+		}
+	}
+}
+
+void generateRandomCoefficients(unsigned nx, unsigned ny, unsigned nz, double contrast,
+				unsigned seed, double* k)
+{
+	const std::size_t n (static_cast<std::size_t>(nx) * ny * nz);
+	const double log_contrast (log(contrast));
+	// 64 bit linear congruential generator (constants of D. Knuth, MMIX)
+	uint64_t state (seed);
+	for (std::size_t l(0); l < n; l++) {
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		// the upper 53 bits give a uniformly distributed number in [0,1)
+		const double u (static_cast<double>(state >> 11) / 9007199254740992.0);
+		k[l] = exp(u * log_contrast);
+	}
+}
+
+/**
+ * parses "NXxNYxNZ" or "NXxNY"
+ */
+static bool parseGridSize(std::string const& str, unsigned &nx, unsigned &ny, unsigned &nz)
+{
+	std::istringstream is(str);
+	char sep;
+	nz = 1;
+	if (!(is >> nx >> sep >> ny) || sep != 'x')
+		return false;
+	if (is >> sep) {
+		if (sep != 'x' || !(is >> nz))
+			return false;
+		// no trailing characters
+		if (is >> sep)
+			return false;
+	}
+	return nx > 0 && ny > 0 && nz > 0;
+}
+
+/**
+ * parses "key=value,key=value,..."
+ */
+static bool parseParameters(std::string const& str, std::map<std::string, double> &params)
+{
+	std::size_t beg (0);
+	while (beg < str.size()) {
+		std::size_t end (str.find(',', beg));
+		if (end == std::string::npos)
+			end = str.size();
+		const std::string item (str.substr(beg, end - beg));
+		const std::size_t eq (item.find('='));
+		if (eq == std::string::npos)
+			return false;
+		std::istringstream is(item.substr(eq + 1));
+		double val;
+		if (!(is >> val))
+			return false;
+		params[item.substr(0, eq)] = val;
+		beg = end + 1;
+	}
+	return true;
+}
+
+static double getParameter(std::map<std::string, double> const& params, std::string const& key,
+				double default_value)
+{
+	std::map<std::string, double>::const_iterator it (params.find(key));
+	return it == params.end() ? default_value : it->second;
+}
+
+bool generateProblem(std::string const& spec, unsigned &n, unsigned* &iA, unsigned* &jA, double* &A)
+{
+	const std::size_t p0 (spec.find(':'));
+	if (p0 == std::string::npos)
+		return false;
+	const std::string name (spec.substr(0, p0));
+	const std::size_t p1 (spec.find(':', p0 + 1));
+	const std::string grid (spec.substr(p0 + 1, p1 == std::string::npos ? std::string::npos : p1 - p0 - 1));
+	std::map<std::string, double> params;
+	if (p1 != std::string::npos && !parseParameters(spec.substr(p1 + 1), params))
+		return false;
+
+	unsigned nx, ny, nz;
+	if (!parseGridSize(grid, nx, ny, nz))
+		return false;
+
+	if (name == "poisson5" || name == "poisson9") {
+		if (nz != 1)
+			return false;
+		return generateStencilMatrix(PoissonStencil(nx, ny, 1, name == "poisson5" ? 5 : 9), n, iA, jA, A);
+	}
+	if (name == "poisson7" || name == "poisson27") {
+		if (nz == 1)
+			return false;
+		return generateStencilMatrix(PoissonStencil(nx, ny, nz, name == "poisson7" ? 7 : 27), n, iA, jA, A);
+	}
+	if (name == "anisotropic") {
+		const DiffusionStencil stencil(nx, ny, nz, NULL, getParameter(params, "ax", 1.0),
+						getParameter(params, "ay", 1e-3), getParameter(params, "az", 1e-3));
+		return generateStencilMatrix(stencil, n, iA, jA, A);
+	}
+	if (name == "layered" || name == "random") {
+		const double contrast (getParameter(params, "contrast", 1e4));
+		double *k (new double[static_cast<std::size_t>(nx) * ny * nz]);
+		if (name == "layered")
+			generateLayeredCoefficients(nx, ny, nz, static_cast<unsigned>(getParameter(params, "layers", 8)),
+							contrast, k);
+		else
+			generateRandomCoefficients(nx, ny, nz, contrast,
+							static_cast<unsigned>(getParameter(params, "seed", 1)), k);
+		const bool ok (generateStencilMatrix(DiffusionStencil(nx, ny, nz, k, 1.0, 1.0, 1.0), n, iA, jA, A));
+		delete [] k;
+		return ok;
+	}
+	if (name == "elasticity") {
+		const ElasticityStencil stencil(nx, ny, nz, getParameter(params, "lambda", 1.0),
+						getParameter(params, "mu", 1.0));
+		return generateStencilMatrix(stencil, n, iA, jA, A);
+	}
+	return false;
+}
+
+} // end namespace MathLib
@@ -0,0 +1,340 @@
+/*
+ * generateStencilMatrix.h
+ *
+ *  Created on: Feb 28, 2012
+ *      Author: TF
+ */
+
+#ifndef GENERATESTENCILMATRIX_H_
+#define GENERATESTENCILMATRIX_H_
+
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace MathLib {
+
+/**
+ * Synthetic test problems: finite difference discretizations on a
+ * structured grid of nx x ny x nz nodes (nz = 1 for two dimensional
+ * problems) with mesh width 1 and homogeneous Dirichlet boundary conditions,
+ * i.e. the boundary nodes are eliminated and the matrices are symmetric
+ * positive definite. The nodes are numbered lexicographically (x fastest),
+ * the degrees of freedom of a node are numbered consecutively.
+ *
+ * A stencil class provides getNDOF() and
+ * value(i, j, k, dx, dy, dz, c_row, c_col), the entry of the row of
+ * component c_row of node (i,j,k) that belongs to component c_col of node
+ * (i+dx, j+dy, k+dz), -1 <= dx, dy, dz <= 1. Entries with value zero are
+ * not stored.
+ */
+class StencilBase
+{
+public:
+	StencilBase(unsigned nx, unsigned ny, unsigned nz, unsigned n_dof) :
+		_nx (nx), _ny (ny), _nz (nz), _n_dof (n_dof)
+	{}
+
+	unsigned getNX() const { return _nx; }
+	unsigned getNY() const { return _ny; }
+	unsigned getNZ() const { return _nz; }
+	unsigned getNDOF() const { return _n_dof; }
+
+protected:
+	const unsigned _nx;
+	const unsigned _ny;
+	const unsigned _nz;
+	const unsigned _n_dof;
+};
+
+/**
+ * Poisson problem -div grad u = f with the 5 point (2D), 7 point (3D),
+ * 9 point (2D) or 27 point (3D) stencil. The 9 and 27 point stencils have
+ * the entries -1 for all neighbors (and 8 and 26 on the diagonal).
+ */
+class PoissonStencil : public StencilBase
+{
+public:
+	/**
+	 * @param n_points 5, 7, 9 or 27, the 5 and 9 point stencils require nz = 1,
+	 * the 7 and 27 point stencils nz > 1
+	 */
+	PoissonStencil(unsigned nx, unsigned ny, unsigned nz, unsigned n_points) :
+		StencilBase (nx, ny, nz, 1), _full (n_points == 9 || n_points == 27),
+		_diag (n_points - 1.0)
+	{}
+
+	double value(unsigned /*i*/, unsigned /*j*/, unsigned /*k*/, int dx, int dy, int dz,
+					unsigned /*c_row*/, unsigned /*c_col*/) const
+	{
+		const int dist (abs(dx) + abs(dy) + abs(dz));
+		if (dist == 0)
+			return _diag;
+		return (_full || dist == 1) ? -1.0 : 0.0;
+	}
+
+private:
+	const bool _full;
+	const double _diag;
+};
+
+/**
+ * Anisotropic heterogeneous diffusion -div (K grad u) = f with K = k(x)
+ * diag(a_x, a_y, a_z), 5 point (2D) or 7 point (3D) stencil. The
+ * coefficient k is given at the nodes, the coefficient of the flux between
+ * two nodes is the harmonic mean of the nodal values (the value of the node
+ * itself for fluxes over the boundary).
+ */
+class DiffusionStencil : public StencilBase
+{
+public:
+	/**
+	 * @param k nodal coefficients (nx*ny*nz values, not copied) or NULL for k = 1
+	 * @param ax, ay, az the anisotropy factors
+	 */
+	DiffusionStencil(unsigned nx, unsigned ny, unsigned nz, double const* k,
+					double ax, double ay, double az) :
+		StencilBase (nx, ny, nz, 1), _k (k)
+	{
+		_a[0] = ax;
+		_a[1] = ay;
+		_a[2] = az;
+	}
+
+	double value(unsigned i, unsigned j, unsigned k, int dx, int dy, int dz,
+					unsigned /*c_row*/, unsigned /*c_col*/) const
+	{
+		const int dist (abs(dx) + abs(dy) + abs(dz));
+		if (dist > 1)
+			return 0.0;
+		if (dist == 1)
+			return -flux(i, j, k, dx, dy, dz);
+
+		double diag (0.0);
+		const unsigned dim (_nz > 1 ? 3 : 2);
+		for (unsigned d(0); d < dim; d++) {
+			for (int s(-1); s <= 1; s += 2)
+				diag += flux(i, j, k, d == 0 ? s : 0, d == 1 ? s : 0, d == 2 ? s : 0);
+		}
+		return diag;
+	}
+
+private:
+	/** coefficient of the flux between node (i,j,k) and the neighbor */
+	double flux(unsigned i, unsigned j, unsigned k, int dx, int dy, int dz) const
+	{
+		const double a (dx != 0 ? _a[0] : (dy != 0 ? _a[1] : _a[2]));
+		if (_k == NULL)
+			return a;
+		const std::size_t node ((static_cast<std::size_t>(k) * _ny + j) * _nx + i);
+		const double k0 (_k[node]);
+		const long ni (static_cast<long>(i) + dx), nj (static_cast<long>(j) + dy),
+						nk (static_cast<long>(k) + dz);
+		if (ni < 0 || nj < 0 || nk < 0 || ni >= static_cast<long>(_nx) || nj >= static_cast<long>(_ny)
+				|| nk >= static_cast<long>(_nz))
+			return a * k0;
+		const double k1 (_k[(static_cast<std::size_t>(nk) * _ny + nj) * _nx + ni]);
+		return a * 2.0 * k0 * k1 / (k0 + k1);
+	}
+
+	double const* const _k;
+	double _a[3];
+};
+
+/**
+ * Linear elasticity (Navier-Lame equations)
+ * -mu div grad u - (lambda + mu) grad div u = f
+ * with 2 (nz = 1) or 3 displacement components per node. The second
+ * derivatives are discretized by the 3 point stencil, the mixed derivatives
+ * by the 4 point stencil over the diagonal neighbors (19 point pattern in
+ * 3D). The resulting matrix is symmetric positive definite for mu > 0 and
+ * lambda + mu >= 0.
+ */
+class ElasticityStencil : public StencilBase
+{
+public:
+	ElasticityStencil(unsigned nx, unsigned ny, unsigned nz, double lambda, double mu) :
+		StencilBase (nx, ny, nz, nz > 1 ? 3 : 2), _lambda (lambda), _mu (mu)
+	{}
+
+	double value(unsigned /*i*/, unsigned /*j*/, unsigned /*k*/, int dx, int dy, int dz,
+					unsigned c_row, unsigned c_col) const
+	{
+		const int d[3] = { dx, dy, dz };
+		const int dist (abs(dx) + abs(dy) + abs(dz));
+		const double lm (_lambda + _mu);
+
+		if (c_row == c_col) {
+			if (dist == 0)
+				return 2.0 * _n_dof * _mu + 2.0 * lm;
+			if (dist == 1)
+				return d[c_row] != 0 ? -_mu - lm : -_mu;
+			return 0.0;
+		}
+		// - (lambda + mu) d^2 / dx_{c_row} dx_{c_col}
+		if (dist == 2 && d[c_row] != 0 && d[c_col] != 0)
+			return -0.25 * lm * d[c_row] * d[c_col];
+		return 0.0;
+	}
+
+private:
+	const double _lambda;
+	const double _mu;
+};
+
+/**
+ * computes the entries of a row of a stencil matrix, the columns are
+ * in ascending order
+ * @param cols, vals the column indices and entries, if cols is NULL the
+ * entries are only counted
+ * @return the number of entries of the row
+ */
+template <typename FP_TYPE, typename IDX_TYPE, class STENCIL>
+unsigned generateStencilRow(STENCIL const& stencil, unsigned i, unsigned j, unsigned k,
+				unsigned c_row, IDX_TYPE* cols, FP_TYPE* vals)
+{
+	const long nx (stencil.getNX()), ny (stencil.getNY()), nz (stencil.getNZ());
+	const unsigned n_dof (stencil.getNDOF());
+	unsigned cnt (0);
+	for (int dz(-1); dz <= 1; dz++) {
+		const long nk (static_cast<long>(k) + dz);
+		if (nk < 0 || nk >= nz) continue;
+		for (int dy(-1); dy <= 1; dy++) {
+			const long nj (static_cast<long>(j) + dy);
+			if (nj < 0 || nj >= ny) continue;
+			for (int dx(-1); dx <= 1; dx++) {
+				const long ni (static_cast<long>(i) + dx);
+				if (ni < 0 || ni >= nx) continue;
+				const std::size_t node ((static_cast<std::size_t>(nk) * ny + nj) * nx + ni);
+				for (unsigned c(0); c < n_dof; c++) {
+					const double v (stencil.value(i, j, k, dx, dy, dz, c_row, c));
+					if (v == 0.0)
+						continue;
+					if (cols) {
+						cols[cnt] = static_cast<IDX_TYPE>(node * n_dof + c);
+						vals[cnt] = static_cast<FP_TYPE>(v);
+					}
+					cnt++;
+				}
+			}
+		}
+	}
+	return cnt;
+}
+
+/**
+ * Generates the matrix of the stencil in compressed row storage format.
+ * The rows are generated in parallel (OpenMP) in two passes: the first pass
+ * counts the entries, the second pass writes them.
+ * @param n the number of rows
+ * @param iA, jA, A the arrays of the matrix (allocated by the function)
+ * @return false if the number of rows or entries can not be represented by
+ * IDX_TYPE, in this case no memory is allocated
+ */
+template <typename FP_TYPE, typename IDX_TYPE, class STENCIL>
+bool generateStencilMatrix(STENCIL const& stencil, IDX_TYPE &n, IDX_TYPE* &iA, IDX_TYPE* &jA,
+				FP_TYPE* &A)
+{
+	const unsigned nx (stencil.getNX()), ny (stencil.getNY()), nz (stencil.getNZ());
+	const unsigned n_dof (stencil.getNDOF());
+	const std::size_t n_nodes (static_cast<std::size_t>(nx) * ny * nz);
+	const std::size_t n_rows (n_nodes * n_dof);
+	const std::size_t idx_max (static_cast<std::size_t>(std::numeric_limits<IDX_TYPE>::max()));
+	if (n_nodes == 0 || n_rows > idx_max || n_nodes > std::numeric_limits<unsigned>::max())
+		return false;
+
+	iA = new IDX_TYPE[n_rows + 1];
+	iA[0] = 0;
+
+	OPENMP_LOOP_TYPE node;
+#pragma omp parallel for
+	for (node = 0; node < n_nodes; node++) {
+		const unsigned i (node % nx), j ((node / nx) % ny), k (node / (static_cast<std::size_t>(nx) * ny));
+		for (unsigned c(0); c < n_dof; c++)
+			iA[static_cast<std::size_t>(node) * n_dof + c + 1] = generateStencilRow<FP_TYPE, IDX_TYPE>(stencil, i, j, k, c,
+							static_cast<IDX_TYPE*>(NULL), static_cast<FP_TYPE*>(NULL));
+	}
+
+	std::size_t nnz (0);
+	for (std::size_t r(0); r < n_rows; r++) {
+		nnz += iA[r + 1];
+		if (nnz > idx_max) {
+			delete [] iA;
+			iA = NULL;
+			return false;
+		}
+		iA[r + 1] = static_cast<IDX_TYPE>(nnz);
+	}
+
+	jA = new IDX_TYPE[nnz];
+	A = new FP_TYPE[nnz];
+#pragma omp parallel for
+	for (node = 0; node < n_nodes; node++) {
+		const unsigned i (node % nx), j ((node / nx) % ny), k (node / (static_cast<std::size_t>(nx) * ny));
+		for (unsigned c(0); c < n_dof; c++) {
+			const std::size_t beg (iA[static_cast<std::size_t>(node) * n_dof + c]);
+			generateStencilRow<FP_TYPE, IDX_TYPE>(stencil, i, j, k, c, jA + beg, A + beg);
+		}
+	}
+	n = static_cast<IDX_TYPE>(n_rows);
+	return true;
+}
+
+/**
+ * Creates a matrix object of type MATRIX (e.g. CRSMatrix<double,unsigned>,
+ * CRSMatrixDiagPrecond, ...) that takes the ownership of the arrays
+ * generated by generateStencilMatrix().
+ * @return the matrix or NULL if the problem is too large for unsigned indices
+ */
+template <class MATRIX, class STENCIL>
+MATRIX* createStencilMatrix(STENCIL const& stencil)
+{
+	unsigned n (0), *iA (NULL), *jA (NULL);
+	double *A (NULL);
+	if (!generateStencilMatrix(stencil, n, iA, jA, A))
+		return NULL;
+	return new MATRIX(n, iA, jA, A);
+}
+
+/**
+ * nodal coefficients for DiffusionStencil: n_layers layers of equal
+ * thickness normal to the last axis (z in 3D, y in 2D) with the values 1
+ * and contrast alternating
+ * @param k array of nx*ny*nz values
+ */
+void generateLayeredCoefficients(unsigned nx, unsigned ny, unsigned nz, unsigned n_layers,
+				double contrast, double* k);
+
+/**
+ * nodal coefficients for DiffusionStencil: log-uniformly distributed random
+ * values in [1, contrast]. The values are produced by a linear congruential
+ * generator, i.e. they depend only on the seed (and not on the platform).
+ * @param k array of nx*ny*nz values
+ */
+void generateRandomCoefficients(unsigned nx, unsigned ny, unsigned nz, double contrast,
+				unsigned seed, double* k);
+
+/**
+ * Generates a synthetic problem described by a string of the form
+ * name:NXxNYxNZ[:key=value,...] (NZ may be omitted for 2D problems), e.g.
+ * "poisson7:100x100x100" or "elasticity:50x50x50:lambda=10,mu=1".
+ * Problems and keys:
+ * - poisson5, poisson9 (2D), poisson7, poisson27 (3D, i.e. NZ > 1)
+ * - anisotropic: ax, ay, az (defaults 1, 1e-3, 1e-3)
+ * - layered: layers (default 8), contrast (default 1e4)
+ * - random: contrast (default 1e4), seed (default 1)
+ * - elasticity: lambda (default 1), mu (default 1)
+ * @param spec the description of the problem
+ * @param n, iA, jA, A the matrix in compressed row storage format
+ * @return false if the description is not valid or the problem is too large
+ */
+bool generateProblem(std::string const& spec, unsigned &n, unsigned* &iA, unsigned* &jA, double* &A);
+
+} // end namespace MathLib
+
+#endif /* GENERATESTENCILMATRIX_H_ */
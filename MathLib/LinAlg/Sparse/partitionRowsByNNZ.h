@@ -0,0 +1,49 @@
+/*
+ * partitionRowsByNNZ.h
+ *
+ *  Created on: Jan 19, 2012
+ *      Author: TF
+ */
+
+#ifndef PARTITIONROWSBYNNZ_H_
+#define PARTITIONROWSBYNNZ_H_
+
+namespace MathLib {
+
+/**
+ * Splits the rows of a matrix in compressed row storage format into n_blocks
+ * blocks of consecutive rows, such that the work for the matrix vector
+ * multiplication is (nearly) equal for all blocks. The work for row i is
+ * estimated by the number of non-zero entries plus one for writing the result,
+ * i.e. the prefix sum of the work is iA[i] + i and the block boundaries are
+ * determined by binary search within the row pointer array.
+ * @param n number of rows
+ * @param iA row pointer array of length n+1
+ * @param n_blocks number of blocks
+ * @param partition array of length n_blocks+1, block k consists of the rows
+ * partition[k], ..., partition[k+1]-1
+ */
+template<typename IDX_TYPE>
+void partitionRowsByNNZ(IDX_TYPE n, IDX_TYPE const* const iA, unsigned n_blocks, IDX_TYPE* partition)
+{
+	const double work(static_cast<double>(iA[n]) + n);
+	partition[0] = 0;
+	for (unsigned k(1); k < n_blocks; k++) {
+		const double target(work * k / n_blocks);
+		// find the first row i with iA[i] + i >= target
+		IDX_TYPE beg(partition[k - 1]), end(n);
+		while (beg < end) {
+			const IDX_TYPE m(beg + (end - beg) / 2);
+			if (static_cast<double>(iA[m]) + m < target)
+				beg = m + 1;
+			else
+				end = m;
+		}
+		partition[k] = beg;
+	}
+	partition[n_blocks] = n;
+}
+
+} // end namespace MathLib
+
+#endif /* PARTITIONROWSBYNNZ_H_ */
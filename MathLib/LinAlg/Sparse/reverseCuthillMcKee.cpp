@@ -0,0 +1,203 @@
+/*
+ * reverseCuthillMcKee.cpp
+ *
+ *  Created on: Feb 10, 2012
+ *      Author: TF
+ */
+
+#include "reverseCuthillMcKee.h"
+
+namespace MathLib {
+
+namespace {
+
+/**
+ * breadth first search starting at root, the visited nodes are stored level by
+ * level in queue, level[v] is set to the level of the visited node v
+ * @return the number of visited nodes
+ */
+unsigned buildLevelStructure(unsigned n, unsigned const*const iA, unsigned const*const jA,
+				unsigned root, unsigned* level, unsigned* queue)
+{
+	unsigned head(0), tail(1);
+	queue[0] = root;
+	level[root] = 0;
+	while (head < tail) {
+		const unsigned v(queue[head++]);
+		for (unsigned k(iA[v]); k < iA[v + 1]; k++) {
+			const unsigned w(jA[k]);
+			if (level[w] == n) {
+				level[w] = level[v] + 1;
+				queue[tail++] = w;
+			}
+		}
+	}
+	return tail;
+}
+
+void resetLevels(unsigned n, unsigned n_visited, unsigned const*const queue, unsigned* level)
+{
+	for (unsigned k(0); k < n_visited; k++)
+		level[queue[k]] = n;
+}
+
+} // end anonymous namespace
+
+unsigned findPseudoPeripheralNode(unsigned n, unsigned const*const iA, unsigned const*const jA,
+				unsigned start, unsigned* level, unsigned* queue)
+{
+	unsigned root(start);
+	unsigned n_visited(buildLevelStructure(n, iA, jA, root, level, queue));
+	unsigned eccentricity(level[queue[n_visited - 1]]);
+
+	while (true) {
+		// node of minimal degree within the last level
+		unsigned k(n_visited - 1);
+		while (k > 0 && level[queue[k - 1]] == eccentricity)
+			k--;
+		unsigned candidate(queue[k]);
+		for (; k < n_visited; k++)
+			if (iA[queue[k] + 1] - iA[queue[k]] < iA[candidate + 1] - iA[candidate])
+				candidate = queue[k];
+
+		resetLevels(n, n_visited, queue, level);
+		n_visited = buildLevelStructure(n, iA, jA, candidate, level, queue);
+		const unsigned candidate_eccentricity(level[queue[n_visited - 1]]);
+		resetLevels(n, n_visited, queue, level);
+		if (candidate_eccentricity <= eccentricity)
+			return root;
+
+		root = candidate;
+		eccentricity = candidate_eccentricity;
+		n_visited = buildLevelStructure(n, iA, jA, root, level, queue);
+	}
+}
+
+void reverseCuthillMcKee(unsigned n, unsigned const*const iA, unsigned const*const jA,
+				unsigned* op_perm, unsigned* po_perm)
+{
+	// *** adjacency structure of the symmetrized pattern without diagonal entries
+	unsigned *adj_ptr(new unsigned[n + 1]);
+	unsigned *pos(new unsigned[n + 1]);
+	for (unsigned i(0); i <= n; i++)
+		pos[i] = 0;
+	for (unsigned i(0); i < n; i++) {
+		for (unsigned k(iA[i]); k < iA[i + 1]; k++) {
+			if (jA[k] != i) {
+				pos[i + 1]++;
+				pos[jA[k] + 1]++;
+			}
+		}
+	}
+	for (unsigned i(0); i < n; i++)
+		pos[i + 1] += pos[i];
+	for (unsigned i(0); i <= n; i++)
+		adj_ptr[i] = pos[i];
+
+	unsigned *adj(new unsigned[pos[n]]);
+	for (unsigned i(0); i < n; i++) {
+		for (unsigned k(iA[i]); k < iA[i + 1]; k++) {
+			const unsigned j(jA[k]);
+			if (j != i) {
+				adj[pos[i]++] = j;
+				adj[pos[j]++] = i;
+			}
+		}
+	}
+
+	// remove duplicate entries in place, level is used as marker array
+	unsigned *level(new unsigned[n]);
+	for (unsigned i(0); i < n; i++)
+		level[i] = n;
+	unsigned k(0);
+	for (unsigned i(0); i < n; i++) {
+		const unsigned row_end(adj_ptr[i + 1]);
+		unsigned l(adj_ptr[i]);
+		adj_ptr[i] = k;
+		for (; l < row_end; l++) {
+			if (level[adj[l]] != i) {
+				level[adj[l]] = i;
+				adj[k++] = adj[l];
+			}
+		}
+	}
+	adj_ptr[n] = k;
+	for (unsigned i(0); i < n; i++)
+		level[i] = n;
+
+	// *** Cuthill-McKee numbering, po_perm[v] == n marks unnumbered nodes,
+	// op_perm serves as breadth first search queue
+	for (unsigned i(0); i < n; i++)
+		po_perm[i] = n;
+	unsigned n_numbered(0);
+	for (unsigned s(0); s < n; s++) {
+		if (po_perm[s] != n)
+			continue;
+		const unsigned root(findPseudoPeripheralNode(n, adj_ptr, adj, s, level, pos));
+		unsigned head(n_numbered);
+		op_perm[n_numbered] = root;
+		po_perm[root] = n_numbered++;
+		while (head < n_numbered) {
+			const unsigned v(op_perm[head++]);
+			const unsigned beg(n_numbered);
+			for (unsigned l(adj_ptr[v]); l < adj_ptr[v + 1]; l++) {
+				const unsigned w(adj[l]);
+				if (po_perm[w] == n) {
+					po_perm[w] = n_numbered;
+					op_perm[n_numbered++] = w;
+				}
+			}
+			// insertion sort of the new nodes by ascending degree
+			for (unsigned l(beg + 1); l < n_numbered; l++) {
+				const unsigned w(op_perm[l]);
+				const unsigned deg(adj_ptr[w + 1] - adj_ptr[w]);
+				unsigned m(l);
+				for (; m > beg && adj_ptr[op_perm[m - 1] + 1] - adj_ptr[op_perm[m - 1]] > deg; m--)
+					op_perm[m] = op_perm[m - 1];
+				op_perm[m] = w;
+			}
+		}
+	}
+
+	// *** reverse the numbering
+	for (unsigned i(0); i < n / 2; i++) {
+		const unsigned tmp(op_perm[i]);
+		op_perm[i] = op_perm[n - 1 - i];
+		op_perm[n - 1 - i] = tmp;
+	}
+	for (unsigned i(0); i < n; i++)
+		po_perm[op_perm[i]] = i;
+
+	delete [] level;
+	delete [] adj;
+	delete [] pos;
+	delete [] adj_ptr;
+}
+
+unsigned calcBandwidth(unsigned n, unsigned const*const iA, unsigned const*const jA)
+{
+	unsigned bandwidth(0);
+	for (unsigned i(0); i < n; i++) {
+		for (unsigned k(iA[i]); k < iA[i + 1]; k++) {
+			const unsigned dist(jA[k] < i ? i - jA[k] : jA[k] - i);
+			if (dist > bandwidth)
+				bandwidth = dist;
+		}
+	}
+	return bandwidth;
+}
+
+std::size_t calcProfile(unsigned n, unsigned const*const iA, unsigned const*const jA)
+{
+	std::size_t profile(0);
+	for (unsigned i(0); i < n; i++) {
+		unsigned first(i);
+		for (unsigned k(iA[i]); k < iA[i + 1]; k++)
+			if (jA[k] < first)
+				first = jA[k];
+		profile += i - first;
+	}
+	return profile;
+}
+
+} // end namespace MathLib
@@ -0,0 +1,68 @@
+/*
+ * reverseCuthillMcKee.h
+ *
+ *  Created on: Feb 10, 2012
+ *      Author: TF
+ */
+
+#ifndef REVERSECUTHILLMCKEE_H_
+#define REVERSECUTHILLMCKEE_H_
+
+// STL
+#include <cstddef>
+
+namespace MathLib {
+
+/**
+ * Finds a pseudo-peripheral node of the connected component containing the
+ * node start with the algorithm of George and Liu: a level structure is built
+ * from the current node, a node of minimal degree within the last level is
+ * chosen and the procedure is repeated as long as the eccentricity grows.
+ * @param n number of nodes
+ * @param iA row pointer array of a symmetric adjacency structure without
+ * diagonal entries
+ * @param jA column index array of the adjacency structure
+ * @param start a node of the component
+ * @param level array of length n, all entries have to be n on input, the
+ * entries of the nodes of the component are reset to n on output
+ * @param queue buffer of length n
+ * @return the pseudo-peripheral node
+ */
+unsigned findPseudoPeripheralNode(unsigned n, unsigned const*const iA, unsigned const*const jA,
+				unsigned start, unsigned* level, unsigned* queue);
+
+/**
+ * Computes the reverse Cuthill-McKee ordering of the (symmetrized) sparsity
+ * pattern of a matrix in compressed row storage format. Every connected
+ * component is numbered by a breadth first search starting at a
+ * pseudo-peripheral node, the neighbours of a node are visited in ascending
+ * order of their degree. The ordering reduces the bandwidth and the profile
+ * of the matrix, i.e. the entries x[jA[j]] accessed by the rows of a matrix
+ * vector multiplication are close to each other.
+ * The permutation arrays are compatible with
+ * CRSMatrixReordered::reorderMatrix().
+ * @param n number of rows / columns
+ * @param iA row pointer array of length n+1
+ * @param jA column index array
+ * @param op_perm array of length n, op_perm[i] is the original index of the
+ * row / column i of the permuted matrix (output)
+ * @param po_perm array of length n, the inverse permutation of op_perm, i.e.
+ * po_perm[op_perm[i]] = i (output)
+ */
+void reverseCuthillMcKee(unsigned n, unsigned const*const iA, unsigned const*const jA,
+				unsigned* op_perm, unsigned* po_perm);
+
+/**
+ * @return the bandwidth max |i-j| over all entries (i,j) of the matrix
+ */
+unsigned calcBandwidth(unsigned n, unsigned const*const iA, unsigned const*const jA);
+
+/**
+ * @return the profile (envelope size) of the lower triangular part of the
+ * matrix, i.e. the sum over the rows i of i - min {j <= i : (i,j) is an entry}
+ */
+std::size_t calcProfile(unsigned n, unsigned const*const iA, unsigned const*const jA);
+
+} // end namespace MathLib
+
+#endif /* REVERSECUTHILLMCKEE_H_ */
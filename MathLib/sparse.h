@@ -7,6 +7,54 @@
 //extern void CS_write(char*, unsigned, unsigned const*, unsigned const*, double const*);
 //extern void CS_read(char*, unsigned&, unsigned*&, unsigned*&, double*&);
 
+/**
+ * Checks the structure of a matrix in compressed row storage format: the
+ * row pointer array has to start with 0 and has to be monotonically
+ * increasing, the column indices have to be smaller than n. The check is
+ * parallelized with OpenMP.
+ * @param n number of rows / columns
+ * @param iA row pointer array
+ * @param jA column index array
+ * @return true if the structure is valid, else false
+ */
+template<class IDX_TYPE> bool CS_check(IDX_TYPE n, IDX_TYPE const* iA, IDX_TYPE const* jA)
+{
+	if (iA[0] != 0) {
+		std::cerr << std::endl << "CRS matrix: array iA doesn't start with 0" << std::endl;
+		return false;
+	}
+
+	OPENMP_LOOP_TYPE k;
+	unsigned n_invalid_rows(0);
+	#pragma omp parallel for reduction(+:n_invalid_rows)
+	for (k = 0; k < static_cast<OPENMP_LOOP_TYPE>(n); k++) {
+		if (iA[k + 1] < iA[k])
+			n_invalid_rows++;
+	}
+	if (n_invalid_rows > 0) {
+		std::cerr << std::endl << "CRS matrix: array iA is not monotonically increasing in "
+						<< n_invalid_rows << " rows" << std::endl;
+		return false;
+	}
+
+	// row wise, since the number of non-zeros can exceed the range of OPENMP_LOOP_TYPE
+	unsigned n_invalid_entries(0);
+	#pragma omp parallel for reduction(+:n_invalid_entries)
+	for (k = 0; k < static_cast<OPENMP_LOOP_TYPE>(n); k++) {
+		const IDX_TYPE end(iA[k + 1]);
+		for (IDX_TYPE j(iA[k]); j < end; j++) {
+			if (jA[j] >= n)
+				n_invalid_entries++;
+		}
+	}
+	if (n_invalid_entries > 0) {
+		std::cerr << std::endl << "CRS matrix: " << n_invalid_entries
+						<< " entries of jA are out of bounds" << std::endl;
+		return false;
+	}
+	return true;
+}
+
 template<class T> void CS_write(std::ostream &os, unsigned n, unsigned const* iA, unsigned const* jA, T const* A)
 {
 	os.write((char*) &n, sizeof(unsigned));
@@ -36,18 +84,31 @@ template<class T> void CS_read(std::istream &is, unsigned &n, unsigned* &iA, uns
 	is.read((char*) A, iA[n] * sizeof(T));
 
 #ifndef NDEBUG
-	// do simple checks
-	if (iA[0] != 0) std::cerr << std::endl << "CRS matrix: array iA doesn't start with 0"
-					<< std::endl;
-
-	unsigned i = 0;
-	while (i < iA[n] && jA[i] < n)
-		++i;
-	if (i < iA[n]) std::cerr << std::endl << "CRS matrix: the " << i
-					<< "th entry of jA has the value " << jA[i] << ", which is out of bounds."
-					<< std::endl;
+	CS_check(n, iA, jA);
 #endif
 }
 
+/**
+ * reads a matrix in binary compressed row storage format (see CS_write())
+ * and converts the indices to IDX_TYPE
+ */
+template<class T, class IDX_TYPE> void CS_read(std::istream &is, unsigned &n, IDX_TYPE* &iA, IDX_TYPE* &jA, T* &A)
+{
+	unsigned *iA_file(NULL), *jA_file(NULL);
+	CS_read(is, n, iA_file, jA_file, A);
+
+	delete[] iA;
+	delete[] jA;
+	iA = new IDX_TYPE[n + 1];
+	for (unsigned k(0); k <= n; k++)
+		iA[k] = iA_file[k];
+	jA = new IDX_TYPE[iA_file[n]];
+	for (unsigned k(0); k < iA_file[n]; k++)
+		jA[k] = jA_file[k];
+
+	delete[] iA_file;
+	delete[] jA_file;
+}
+
 #endif
 
@@ -0,0 +1,113 @@
+/*
+ * ConvertCRSFile.cpp
+ *
+ *  Created on: Feb 1, 2012
+ *      Author: TF
+ */
+
+#include <fstream>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+// Base
+#include "RunTimeTimer.h"
+
+// MathLib
+#include "sparse.h"
+#include "LinAlg/Sparse/CRSFile.h"
+#include "LinAlg/Sparse/CRSMatrix.h"
+
+/**
+ * converts the matrix to the given types, writes it in the versioned format
+ * and checks the written file by mapping it into memory
+ */
+template<typename FP_TYPE, typename IDX_TYPE>
+bool convert(unsigned n, unsigned const* iA, unsigned const* jA, double const* A,
+				std::string const& fname, bool checksums)
+{
+	const unsigned nnz(iA[n]);
+	IDX_TYPE *iA_new(new IDX_TYPE[n + 1]);
+	IDX_TYPE *jA_new(new IDX_TYPE[nnz]);
+	FP_TYPE *A_new(new FP_TYPE[nnz]);
+	for (unsigned k(0); k <= n; k++)
+		iA_new[k] = iA[k];
+	for (unsigned k(0); k < nnz; k++) {
+		jA_new[k] = jA[k];
+		A_new[k] = static_cast<FP_TYPE>(A[k]);
+	}
+
+	RunTimeTimer timer;
+	std::cout << "writing " << fname << " ... " << std::flush;
+	timer.start();
+	std::ofstream out(fname.c_str(), std::ios::out | std::ios::binary);
+	bool ok(out && MathLib::writeCRSFile(out, static_cast<IDX_TYPE>(n), iA_new, jA_new, A_new, checksums));
+	out.close();
+	timer.stop();
+	std::cout << (ok ? "ok, " : "failed, ") << timer.elapsed() << " s" << std::endl;
+
+	if (ok) {
+		std::cout << "mapping and checking " << fname << " ... " << std::flush;
+		timer.start();
+		MathLib::CRSMatrix<FP_TYPE, IDX_TYPE> mat(fname, MathLib::CRS_MAP_FILE, true);
+		timer.stop();
+		ok = mat.isValid() && mat.getNRows() == n && mat.getNNZ() == nnz && mat.isMapped();
+		for (unsigned k(0); k <= n && ok; k++)
+			ok = mat.getRowPtrArray()[k] == iA_new[k];
+		for (unsigned k(0); k < nnz && ok; k++)
+			ok = mat.getColIdxArray()[k] == jA_new[k] && mat.getEntryArray()[k] == A_new[k];
+		std::cout << (ok ? "ok, " : "failed, ") << timer.elapsed() << " s" << std::endl;
+	}
+
+	delete [] iA_new;
+	delete [] jA_new;
+	delete [] A_new;
+	return ok;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		std::cout << "Usage: " << argv[0] << " legacy_matrix new_matrix [double|float] [32|64] [nochecksums]" << std::endl;
+		std::cout << "\tconverts a matrix from the legacy binary CRS format (CS_write) into the versioned format" << std::endl;
+		return 1;
+	}
+
+	const std::string fname_in(argv[1]);
+	const std::string fname_out(argv[2]);
+	const bool single_precision(argc > 3 && std::strcmp(argv[3], "float") == 0);
+	const bool wide_indices(argc > 4 && std::atoi(argv[4]) == 64);
+	const bool checksums(!(argc > 5 && std::strcmp(argv[5], "nochecksums") == 0));
+
+	std::ifstream in(fname_in.c_str(), std::ios::in | std::ios::binary);
+	if (!in) {
+		std::cout << "cannot open " << fname_in << std::endl;
+		return 1;
+	}
+	unsigned n, *iA(NULL), *jA(NULL);
+	double *A(NULL);
+	CS_read(in, n, iA, jA, A);
+	in.close();
+	if (!CS_check(n, iA, jA))
+		return 1;
+	std::cout << "read " << fname_in << ": n=" << n << ", nnz=" << iA[n] << std::endl;
+
+	bool ok;
+	if (single_precision) {
+		if (wide_indices)
+			ok = convert<float, std::size_t>(n, iA, jA, A, fname_out, checksums);
+		else
+			ok = convert<float, unsigned>(n, iA, jA, A, fname_out, checksums);
+	} else {
+		if (wide_indices)
+			ok = convert<double, std::size_t>(n, iA, jA, A, fname_out, checksums);
+		else
+			ok = convert<double, unsigned>(n, iA, jA, A, fname_out, checksums);
+	}
+
+	delete [] iA;
+	delete [] jA;
+	delete [] A;
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,216 @@
+/*
+ * ElementAssembly.cpp
+ *
+ *  Created on: Feb 9, 2012
+ *      Author: TF
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Base
+#include "RunTimeTimer.h"
+
+// MathLib
+#include "LinAlg/Sparse/CRSAssembler.h"
+#include "LinAlg/Sparse/CRSMatrix.h"
+#include "LinAlg/Sparse/colorElements.h"
+
+/**
+ * Benchmark for the assembly of the stiffness matrix of a synthetic finite
+ * element problem: a structured mesh of nx x nx x nx hexahedral elements with
+ * 8 nodes, the element matrices are dense 8 x 8 matrices (7 on the diagonal,
+ * -1 elsewhere). The element matrices are added to the matrix
+ *  - entry by entry via addValue() (atomic updates),
+ *  - via addBlock() where the elements are processed color by color,
+ *  - via addBlock() where every thread owns a range of rows,
+ * for 1, 2, 4, ... threads.
+ */
+
+const unsigned N_ELEMENT_NODES = 8;
+
+/**
+ * global node numbers of element e in ascending order
+ */
+void getElementNodes(unsigned nx, unsigned e, unsigned* nodes)
+{
+	const unsigned i(e % nx), j((e / nx) % nx), k(e / (nx * nx));
+	const unsigned n1(nx + 1);
+	for (unsigned l(0); l < N_ELEMENT_NODES; l++)
+		nodes[l] = (i + (l & 1)) + (j + ((l >> 1) & 1)) * n1 + (k + ((l >> 2) & 1)) * n1 * n1;
+}
+
+void zero(MathLib::CRSMatrix<double, unsigned> &mat)
+{
+	unsigned const*const iA(mat.getRowPtrArray());
+	unsigned const*const jA(mat.getColIdxArray());
+	for (unsigned i(0); i < mat.getNRows(); i++)
+		for (unsigned j(iA[i]); j < iA[i + 1]; j++)
+			mat.setValue(i, jA[j], 0.0);
+}
+
+double maxDifference(MathLib::CRSMatrix<double, unsigned> const& mat, double const* ref)
+{
+	double const*const A(mat.getEntryArray());
+	double diff(0.0);
+	for (unsigned k(0); k < mat.getNNZ(); k++)
+		diff = std::max(diff, fabs(A[k] - ref[k]));
+	return diff;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		std::cout << "Usage: " << argv[0] << " number-of-elements-per-direction max-number-of-threads" << std::endl;
+		return 1;
+	}
+
+	const unsigned nx(atoi(argv[1]));
+	const unsigned max_threads(atoi(argv[2]));
+	const unsigned n((nx + 1) * (nx + 1) * (nx + 1));
+	const unsigned n_elements(nx * nx * nx);
+
+	double element_matrix[N_ELEMENT_NODES * N_ELEMENT_NODES];
+	for (unsigned k(0); k < N_ELEMENT_NODES * N_ELEMENT_NODES; k++)
+		element_matrix[k] = (k % (N_ELEMENT_NODES + 1) == 0) ? 7.0 : -1.0;
+
+	// *** the element nodes and the sparsity pattern
+	unsigned *element_ptr(new unsigned[n_elements + 1]);
+	unsigned *element_nodes(new unsigned[n_elements * N_ELEMENT_NODES]);
+	for (unsigned e(0); e <= n_elements; e++)
+		element_ptr[e] = e * N_ELEMENT_NODES;
+	for (unsigned e(0); e < n_elements; e++)
+		getElementNodes(nx, e, element_nodes + e * N_ELEMENT_NODES);
+
+	MathLib::CRSAssembler<double, unsigned> assembler(n);
+	for (unsigned e(0); e < n_elements; e++)
+		for (unsigned r(0); r < N_ELEMENT_NODES; r++)
+			for (unsigned c(0); c < N_ELEMENT_NODES; c++)
+				assembler.add(element_nodes[e * N_ELEMENT_NODES + r], element_nodes[e * N_ELEMENT_NODES + c], 0.0);
+	MathLib::CRSMatrix<double, unsigned> *mat(assembler.createMatrix());
+	std::cout << "n=" << n << ", nnz=" << mat->getNNZ() << ", number of elements " << n_elements << std::endl;
+
+	RunTimeTimer timer;
+	timer.start();
+	unsigned *color_ptr(NULL), *colored_elements(NULL);
+	const unsigned n_colors(MathLib::colorElements(n, n_elements, element_ptr, element_nodes,
+					color_ptr, colored_elements));
+	timer.stop();
+	std::cout << "coloring: " << n_colors << " colors, " << timer.elapsed() << " s" << std::endl;
+
+	// *** reference: sequential assembly
+	zero(*mat);
+	for (unsigned e(0); e < n_elements; e++)
+		mat->addBlock(N_ELEMENT_NODES, element_nodes + e * N_ELEMENT_NODES, N_ELEMENT_NODES,
+						element_nodes + e * N_ELEMENT_NODES, element_matrix);
+	double *ref(new double[mat->getNNZ()]);
+	std::copy(mat->getEntryArray(), mat->getEntryArray() + mat->getNNZ(), ref);
+
+	std::cout << "threads\taddValue (atomic)\taddBlock (coloring)\taddBlock (row ownership)" << std::endl;
+	bool ok(true);
+	for (unsigned n_threads(1); n_threads <= max_threads; n_threads *= 2) {
+#ifdef _OPENMP
+		omp_set_num_threads(n_threads);
+#endif
+		double times[3];
+		OPENMP_LOOP_TYPE e;
+
+		// addValue
+		zero(*mat);
+		timer.start();
+		#pragma omp parallel for
+		for (e = 0; e < n_elements; e++) {
+			unsigned const*const nodes(element_nodes + e * N_ELEMENT_NODES);
+			for (unsigned r(0); r < N_ELEMENT_NODES; r++) {
+				unsigned hint(0);
+				for (unsigned c(0); c < N_ELEMENT_NODES; c++)
+					mat->addValue(nodes[r], nodes[c], element_matrix[r * N_ELEMENT_NODES + c], hint);
+			}
+		}
+		timer.stop();
+		times[0] = timer.elapsed();
+		ok = ok && maxDifference(*mat, ref) < 1e-12;
+
+		// addBlock, coloring
+		zero(*mat);
+		timer.start();
+		for (unsigned c(0); c < n_colors; c++) {
+			OPENMP_LOOP_TYPE k;
+			#pragma omp parallel for
+			for (k = color_ptr[c]; k < color_ptr[c + 1]; k++) {
+				unsigned const*const nodes(element_nodes + colored_elements[k] * N_ELEMENT_NODES);
+				mat->addBlock(N_ELEMENT_NODES, nodes, N_ELEMENT_NODES, nodes, element_matrix);
+			}
+		}
+		timer.stop();
+		times[1] = timer.elapsed();
+		ok = ok && maxDifference(*mat, ref) < 1e-12;
+
+		// addBlock, row ownership: thread t owns the rows of part t of the nnz
+		// balanced partition and processes all elements that have a node within
+		// its rows (the element lists are set up once for a mesh)
+		unsigned const*const partition(mat->getRowPartition(n_threads));
+		unsigned *thread_elements_ptr(new unsigned[n_threads + 1]);
+		unsigned *thread_elements(NULL);
+		for (unsigned t(0); t <= n_threads; t++)
+			thread_elements_ptr[t] = 0;
+		for (unsigned pass(0); pass < 2; pass++) {
+			for (unsigned el(0); el < n_elements; el++) {
+				unsigned const*const nodes(element_nodes + el * N_ELEMENT_NODES);
+				// the nodes are sorted, the owners are the parts from the part of
+				// the first node to the part of the last node
+				const unsigned first(std::upper_bound(partition, partition + n_threads + 1, nodes[0]) - partition - 1);
+				const unsigned last(std::upper_bound(partition, partition + n_threads + 1, nodes[N_ELEMENT_NODES - 1]) - partition - 1);
+				for (unsigned t(first); t <= last; t++) {
+					if (pass == 0)
+						thread_elements_ptr[t + 1]++;
+					else
+						thread_elements[thread_elements_ptr[t]++] = el;
+				}
+			}
+			if (pass == 0) {
+				for (unsigned t(0); t < n_threads; t++)
+					thread_elements_ptr[t + 1] += thread_elements_ptr[t];
+				thread_elements = new unsigned[thread_elements_ptr[n_threads]];
+			} else {
+				for (unsigned t(n_threads); t > 0; t--)
+					thread_elements_ptr[t] = thread_elements_ptr[t - 1];
+				thread_elements_ptr[0] = 0;
+			}
+		}
+
+		zero(*mat);
+		timer.start();
+		OPENMP_LOOP_TYPE t;
+		#pragma omp parallel for schedule(static, 1)
+		for (t = 0; t < n_threads; t++) {
+			for (unsigned k(thread_elements_ptr[t]); k < thread_elements_ptr[t + 1]; k++) {
+				unsigned const*const nodes(element_nodes + thread_elements[k] * N_ELEMENT_NODES);
+				mat->addBlock(N_ELEMENT_NODES, nodes, N_ELEMENT_NODES, nodes, element_matrix,
+								partition[t], partition[t + 1]);
+			}
+		}
+		timer.stop();
+		times[2] = timer.elapsed();
+		ok = ok && maxDifference(*mat, ref) < 1e-12;
+		delete [] thread_elements;
+		delete [] thread_elements_ptr;
+
+		std::cout << n_threads << "\t" << times[0] << "\t" << times[1] << "\t" << times[2] << std::endl;
+	}
+	std::cout << (ok ? "all results are equal" : "FAILED: the results differ") << std::endl;
+
+	delete [] ref;
+	delete [] color_ptr;
+	delete [] colored_elements;
+	delete [] element_nodes;
+	delete [] element_ptr;
+	delete mat;
+	return ok ? 0 : 1;
+}
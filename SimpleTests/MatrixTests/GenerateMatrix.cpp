@@ -0,0 +1,96 @@
+/*
+ * GenerateMatrix.cpp
+ *
+ *  Created on: Feb 28, 2012
+ *      Author: TF
+ */
+
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+// Base
+#include "RunTimeTimer.h"
+
+// MathLib
+#include "sparse.h"
+#include "LinAlg/Sparse/generateStencilMatrix.h"
+
+/**
+ * checks the structure of the matrix and whether it is symmetric with
+ * positive diagonal entries
+ */
+bool checkMatrix(unsigned n, unsigned const* iA, unsigned const* jA, double const* A)
+{
+	if (!CS_check(n, iA, jA))
+		return false;
+	for (unsigned i(0); i < n; i++) {
+		bool diag(false);
+		for (unsigned k(iA[i]); k < iA[i+1]; k++) {
+			const unsigned j(jA[k]);
+			if (j == i) {
+				diag = A[k] > 0.0;
+				continue;
+			}
+			unsigned const*const pos(std::lower_bound(jA + iA[j], jA + iA[j+1], i));
+			if (pos == jA + iA[j+1] || *pos != i || fabs(A[pos - jA] - A[k]) > 1e-12 * fabs(A[k])) {
+				std::cout << "matrix is not symmetric: entry (" << i << "," << j << ")" << std::endl;
+				return false;
+			}
+		}
+		if (!diag) {
+			std::cout << "diagonal entry of row " << i << " is not positive" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		std::cout << "Usage: " << argv[0] << " problem output-matrix [check]" << std::endl
+			<< "  problem: name:NXxNYxNZ[:key=value,...], e.g. poisson7:100x100x100," << std::endl
+			<< "  names: poisson5, poisson9 (2D), poisson7, poisson27, anisotropic (ax,ay,az)," << std::endl
+			<< "  layered (layers,contrast), random (contrast,seed), elasticity (lambda,mu)" << std::endl;
+		return 1;
+	}
+
+	unsigned n(0), *iA(NULL), *jA(NULL);
+	double *A(NULL);
+	RunTimeTimer timer;
+	timer.start();
+	if (!MathLib::generateProblem(argv[1], n, iA, jA, A)) {
+		std::cout << "could not generate problem " << argv[1] << std::endl;
+		return 1;
+	}
+	timer.stop();
+	std::cout << "generated " << argv[1] << ": n=" << n << ", nnz=" << iA[n] << ", "
+			<< timer.elapsed() << " s" << std::endl;
+
+	bool ok(true);
+	if (argc > 3 && std::string(argv[3]) == "check") {
+		ok = checkMatrix(n, iA, jA, A);
+		std::cout << "check " << (ok ? "passed" : "failed") << std::endl;
+	}
+
+	timer.start();
+	std::ofstream out(argv[2], std::ios::out | std::ios::binary);
+	if (out) {
+		CS_write(out, n, iA, jA, A);
+		out.close();
+		timer.stop();
+		std::cout << "written to " << argv[2] << ", " << timer.elapsed() << " s" << std::endl;
+	} else {
+		std::cout << "could not open " << argv[2] << std::endl;
+		ok = false;
+	}
+
+	delete [] iA;
+	delete [] jA;
+	delete [] A;
+
+	return ok ? 0 : 1;
+}
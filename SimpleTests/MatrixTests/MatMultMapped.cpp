@@ -0,0 +1,100 @@
+/*
+ * MatMultMapped.cpp
+ *
+ *  Created on: Jan 30, 2012
+ *      Author: TF
+ */
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+
+// Base
+#include "RunTimeTimer.h"
+
+// MathLib
+#include "LinAlg/Sparse/CRSMatrix.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * Compares reading a matrix in binary compressed row storage format
+ * (CS_read()) with mapping the file into memory. Since the pages of the
+ * mapping are loaded on demand the time of the first matrix vector
+ * multiplication is reported separately.
+ */
+int main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		std::cout << "Usage: " << argv[0] << " matrix number_of_multiplications [num_of_threads]" << std::endl;
+		return 1;
+	}
+
+	std::string fname_mat (argv[1]);
+	const unsigned n_mults (atoi (argv[2]));
+#ifdef _OPENMP
+	if (argc > 3)
+		omp_set_num_threads(atoi(argv[3]));
+#endif
+
+	RunTimeTimer timer;
+	std::cout << "reading matrix from " << fname_mat << " ... " << std::flush;
+	timer.start();
+	MathLib::CRSMatrix<double, unsigned> mat (fname_mat, MathLib::CRS_READ_FILE);
+	timer.stop();
+	std::cout << timer.elapsed() << " s" << std::endl;
+
+	std::cout << "mapping matrix from " << fname_mat << " ... " << std::flush;
+	timer.start();
+	MathLib::CRSMatrix<double, unsigned> mapped_mat (fname_mat, MathLib::CRS_MAP_FILE);
+	timer.stop();
+	std::cout << timer.elapsed() << " s" << std::endl;
+	if (!mat.isValid() || !mapped_mat.isValid())
+		return 1;
+
+	std::cout << "checking structure of the mapped matrix ... " << std::flush;
+	timer.start();
+	const bool valid (CS_check(mapped_mat.getNRows(), mapped_mat.getRowPtrArray(), mapped_mat.getColIdxArray()));
+	timer.stop();
+	std::cout << (valid ? "ok, " : "failed, ") << timer.elapsed() << " s" << std::endl;
+
+	const unsigned n (mat.getNRows());
+	std::cout << "Parameters read: n=" << n << ", nnz=" << mat.getNNZ() << std::endl;
+
+	double *x(new double[n]);
+	double *y(new double[n]);
+	double *y_mapped(new double[n]);
+	for (unsigned k(0); k < n; ++k)
+		x[k] = 1.0 + (k % 7);
+
+	timer.start();
+	mapped_mat.amux(1.0, x, y_mapped);
+	timer.stop();
+	std::cout << "first multiplication with mapped matrix: " << timer.elapsed() << " s" << std::endl;
+
+	timer.start();
+	for (unsigned k(0); k < n_mults; k++)
+		mat.amux(1.0, x, y);
+	timer.stop();
+	std::cout << n_mults << " multiplications with read matrix: " << timer.elapsed() << " s" << std::endl;
+
+	timer.start();
+	for (unsigned k(0); k < n_mults; k++)
+		mapped_mat.amux(1.0, x, y_mapped);
+	timer.stop();
+	std::cout << n_mults << " multiplications with mapped matrix: " << timer.elapsed() << " s" << std::endl;
+
+	double max_diff (0.0);
+	for (unsigned k(0); k < n; k++)
+		if (fabs(y[k] - y_mapped[k]) > max_diff)
+			max_diff = fabs(y[k] - y_mapped[k]);
+	std::cout << "max difference of the results: " << max_diff << std::endl;
+
+	delete [] x;
+	delete [] y;
+	delete [] y_mapped;
+
+	return 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * MatMultPThreads.cpp
+ *
+ *  Created on: Jan 18, 2012
+ *      Author: TF
+ */
+
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+// Base
+#include "RunTimeTimer.h"
+
+// MathLib
+#include "LinAlg/Sparse/CRSMatrix.h"
+#include "LinAlg/Sparse/CRSMatrixPThreads.h"
+#include "LinAlg/Sparse/amuxCRS.h"
+
+/**
+ * Compares the time per matrix vector multiplication of amuxCRSParallelPThreads(),
+ * that creates and joins the threads in every call, with the thread pool of
+ * class CRSMatrixPThreads for 1, 2, 4, ..., max_threads threads.
+ */
+int main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		std::cout << "Usage: " << argv[0] << " matrix number_of_multiplications [max_threads]" << std::endl;
+		return 1;
+	}
+
+	std::string fname_mat (argv[1]);
+	const unsigned n_mults (atoi (argv[2]));
+	unsigned max_threads (64);
+	if (argc == 4)
+		max_threads = atoi (argv[3]);
+
+	MathLib::CRSMatrix<double, unsigned> mat (fname_mat);
+	const unsigned n (mat.getNRows());
+	if (n == 0) {
+		return 1;
+	}
+	std::cout << "Parameters read: n=" << n << ", nnz=" << mat.getNNZ() << std::endl;
+
+	double *x(new double[n]);
+	double *y_ref(new double[n]);
+	double *y(new double[n]);
+	for (unsigned k(0); k < n; ++k)
+		x[k] = 1.0 + (k % 7);
+	mat.amux(1.0, x, y_ref);
+
+	std::cout << "threads\tcreate/join [us/call]\tpool [us/call]\tmax diff" << std::endl;
+	for (unsigned n_threads(1); n_threads <= max_threads; n_threads *= 2) {
+		RunTimeTimer timer;
+		timer.start();
+		for (unsigned k(0); k < n_mults; k++) {
+			MathLib::amuxCRSParallelPThreads(1.0, n, mat.getRowPtrArray(), mat.getColIdxArray(),
+							mat.getEntryArray(), x, y, n_threads);
+		}
+		timer.stop();
+		const double t_create_join (timer.elapsed());
+
+		// the pool matrix works on a copy of the data
+		const unsigned nnz (mat.getNNZ());
+		unsigned *iA(new unsigned[n + 1]);
+		unsigned *jA(new unsigned[nnz]);
+		double *A(new double[nnz]);
+		for (unsigned k(0); k <= n; k++)
+			iA[k] = mat.getRowPtrArray()[k];
+		for (unsigned k(0); k < nnz; k++) {
+			jA[k] = mat.getColIdxArray()[k];
+			A[k] = mat.getEntryArray()[k];
+		}
+		MathLib::CRSMatrixPThreads<double> pool_mat (n, iA, jA, A, n_threads);
+
+		timer.start();
+		for (unsigned k(0); k < n_mults; k++) {
+			pool_mat.amux(1.0, x, y);
+		}
+		timer.stop();
+		const double t_pool (timer.elapsed());
+
+		double diff(0.0);
+		for (unsigned k(0); k < n; k++) {
+			if (fabs(y_ref[k] - y[k]) > diff)
+				diff = fabs(y_ref[k] - y[k]);
+		}
+
+		std::cout << n_threads << "\t" << t_create_join / n_mults * 1e6 << "\t"
+				<< t_pool / n_mults * 1e6 << "\t" << diff << std::endl;
+	}
+
+	// the pool works for every value type, e.g. single precision
+	{
+		const unsigned nnz (mat.getNNZ());
+		unsigned *iA(new unsigned[n + 1]);
+		unsigned *jA(new unsigned[nnz]);
+		float *A(new float[nnz]);
+		float *xf(new float[n]);
+		float *yf(new float[n]);
+		for (unsigned k(0); k <= n; k++)
+			iA[k] = mat.getRowPtrArray()[k];
+		for (unsigned k(0); k < nnz; k++) {
+			jA[k] = mat.getColIdxArray()[k];
+			A[k] = static_cast<float>(mat.getEntryArray()[k]);
+		}
+		for (unsigned k(0); k < n; k++)
+			xf[k] = static_cast<float>(x[k]);
+		MathLib::CRSMatrixPThreads<float> float_mat (n, iA, jA, A, max_threads);
+		float_mat.amux(1.0f, xf, yf);
+
+		double diff(0.0), nrm(0.0);
+		for (unsigned k(0); k < n; k++) {
+			diff = std::max(diff, fabs(y_ref[k] - yf[k]));
+			nrm = std::max(nrm, fabs(y_ref[k]));
+		}
+		std::cout << "float, " << max_threads << " threads: relative max diff " << diff / nrm << std::endl;
+		delete [] xf;
+		delete [] yf;
+	}
+
+	delete [] x;
+	delete [] y_ref;
+	delete [] y;
+
+	return 0;
+}
@@ -0,0 +1,121 @@
+/*
+ * MatMultSELL.cpp
+ *
+ *  Created on: Jan 16, 2012
+ *      Author: TF
+ */
+
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+
+// Base
+#include "RunTimeTimer.h"
+
+// MathLib
+#include "LinAlg/Sparse/CRSMatrix.h"
+#include "LinAlg/Sparse/CRSMatrixOpenMP.h"
+#include "LinAlg/Sparse/SELLMatrix.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * executes n_mults matrix vector multiplications and returns the elapsed wall clock time
+ */
+double timeAmux(MathLib::SparseMatrixBase<double, unsigned> const& mat, unsigned n_mults,
+				double const*const x, double *y)
+{
+	RunTimeTimer run_timer;
+	run_timer.start();
+	for (unsigned k(0); k < n_mults; k++) {
+		mat.amux(1.0, x, y);
+	}
+	run_timer.stop();
+	return run_timer.elapsed();
+}
+
+double maxDiff(unsigned n, double const*const y0, double const*const y1)
+{
+	double diff(0.0);
+	for (unsigned k(0); k < n; k++) {
+		if (fabs(y0[k] - y1[k]) > diff)
+			diff = fabs(y0[k] - y1[k]);
+	}
+	return diff;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 4) {
+		std::cout << "Usage: " << argv[0] << " num_of_threads matrix number_of_multiplications [chunk_size sigma]" << std::endl;
+		return 1;
+	}
+
+	const unsigned n_threads (atoi (argv[1]));
+	std::string fname_mat (argv[2]);
+	const unsigned n_mults (atoi (argv[3]));
+	unsigned chunk_size (8), sigma (256);
+	if (argc == 6) {
+		chunk_size = atoi (argv[4]);
+		sigma = atoi (argv[5]);
+	}
+
+	std::cout << "reading matrix from " << fname_mat << " ... " << std::flush;
+	RunTimeTimer timer;
+	timer.start();
+	MathLib::CRSMatrix<double, unsigned> crs_mat (fname_mat);
+	timer.stop();
+	std::cout << "ok, " << timer.elapsed() << " s" << std::endl;
+
+	const unsigned n (crs_mat.getNRows());
+	const unsigned nnz (crs_mat.getNNZ());
+	std::cout << "Parameters read: n=" << n << ", nnz=" << nnz << std::endl;
+
+	std::cout << "converting matrix into SELL-" << chunk_size << "-" << sigma << " format ... " << std::flush;
+	timer.start();
+	MathLib::SELLMatrix<double, unsigned> sell_mat (fname_mat, chunk_size, sigma);
+	timer.stop();
+	std::cout << "ok, " << timer.elapsed() << " s (incl. reading), fill ratio "
+			<< static_cast<double>(sell_mat.getNNZPadded()) / nnz << std::endl;
+
+	double *x(new double[n]);
+	double *y_crs(new double[n]);
+	double *y(new double[n]);
+	for (unsigned k(0); k < n; ++k)
+		x[k] = 1.0 + (k % 7);
+
+	const double flops (2.0 * nnz * n_mults);
+
+#ifdef _OPENMP
+	omp_set_num_threads(1);
+#endif
+	double t (timeAmux(crs_mat, n_mults, x, y_crs));
+	std::cout << "CRSMatrix:       " << t << " s, " << flops / t * 1e-9 << " GFLOP/s" << std::endl;
+
+	t = timeAmux(sell_mat, n_mults, x, y);
+	std::cout << "SELLMatrix (1):  " << t << " s, " << flops / t * 1e-9 << " GFLOP/s, max diff "
+			<< maxDiff(n, y_crs, y) << std::endl;
+
+#ifdef _OPENMP
+	omp_set_num_threads(n_threads);
+	MathLib::CRSMatrixOpenMP<double, unsigned> omp_mat (fname_mat, n_threads);
+	t = timeAmux(omp_mat, n_mults, x, y);
+	std::cout << "CRSMatrixOpenMP (" << n_threads << "): " << t << " s, " << flops / t * 1e-9
+			<< " GFLOP/s, max diff " << maxDiff(n, y_crs, y) << std::endl;
+
+	t = timeAmux(sell_mat, n_mults, x, y);
+	std::cout << "SELLMatrix (" << n_threads << "):      " << t << " s, " << flops / t * 1e-9
+			<< " GFLOP/s, max diff " << maxDiff(n, y_crs, y) << std::endl;
+#else
+	(void) n_threads;
+#endif
+
+	delete [] x;
+	delete [] y_crs;
+	delete [] y;
+
+	return 0;
+}
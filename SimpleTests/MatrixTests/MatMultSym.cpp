@@ -0,0 +1,95 @@
+/*
+ * MatMultSym.cpp
+ *
+ *  Created on: Jan 20, 2012
+ *      Author: TF
+ */
+
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+
+// Base
+#include "RunTimeTimer.h"
+
+// MathLib
+#include "LinAlg/Sparse/CRSMatrix.h"
+#include "LinAlg/Sparse/CRSMatrixOpenMP.h"
+#include "LinAlg/Sparse/CRSSymMatrix.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * Compares the matrix vector multiplication of a symmetric matrix stored
+ * completely (CRSMatrix / CRSMatrixOpenMP) with the multiplication using only
+ * the upper triangular part (CRSSymMatrix).
+ */
+int main(int argc, char *argv[])
+{
+	if (argc < 4) {
+		std::cout << "Usage: " << argv[0] << " num_of_threads matrix number_of_multiplications" << std::endl;
+		return 1;
+	}
+
+	const unsigned n_threads (atoi (argv[1]));
+	std::string fname_mat (argv[2]);
+	const unsigned n_mults (atoi (argv[3]));
+
+#ifdef _OPENMP
+	omp_set_num_threads(n_threads);
+	MathLib::CRSMatrixOpenMP<double, unsigned> mat (fname_mat, n_threads);
+#else
+	(void) n_threads;
+	MathLib::CRSMatrix<double, unsigned> mat (fname_mat);
+#endif
+	MathLib::CRSSymMatrix<double, unsigned> sym_mat (fname_mat);
+
+	const unsigned n (mat.getNRows());
+	std::cout << "Parameters read: n=" << n << ", nnz=" << mat.getNNZ()
+			<< ", nnz (upper triangular part)=" << sym_mat.getNNZ() << std::endl;
+#ifdef _OPENMP
+	if (n_threads > 1)
+		std::cout << "parallel multiplication uses "
+				<< (sym_mat.usesColoring(n_threads) ? "a coloring of row blocks" : "thread private buffers")
+				<< std::endl;
+#endif
+
+	double *x(new double[n]);
+	double *y(new double[n]);
+	double *y_sym(new double[n]);
+	for (unsigned k(0); k < n; ++k)
+		x[k] = 1.0 + (k % 7);
+
+	const double flops (2.0 * mat.getNNZ() * n_mults);
+
+	RunTimeTimer timer;
+	timer.start();
+	for (unsigned k(0); k < n_mults; k++)
+		mat.amux(1.0, x, y);
+	timer.stop();
+	const double t (timer.elapsed());
+	std::cout << "full matrix:    " << t << " s, " << flops / t * 1e-9 << " GFLOP/s" << std::endl;
+
+	timer.start();
+	for (unsigned k(0); k < n_mults; k++)
+		sym_mat.amux(1.0, x, y_sym);
+	timer.stop();
+	const double t_sym (timer.elapsed());
+
+	double diff(0.0);
+	for (unsigned k(0); k < n; k++) {
+		if (fabs(y[k] - y_sym[k]) > diff)
+			diff = fabs(y[k] - y_sym[k]);
+	}
+	std::cout << "upper triangle: " << t_sym << " s, " << flops / t_sym * 1e-9 << " GFLOP/s, speedup "
+			<< t / t_sym << ", max diff " << diff << std::endl;
+
+	delete [] x;
+	delete [] y;
+	delete [] y_sym;
+
+	return 0;
+}
@@ -6,6 +6,12 @@
  */
 
 #include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 // BaseLib
 #include "RunTimeTimer.h"
@@ -18,6 +24,23 @@
 #include "LinAlg/Sparse/NestedDissectionPermutation/CRSMatrixReordered.h"
 #include "LinAlg/Sparse/NestedDissectionPermutation/Cluster.h"
 #include "LinAlg/Sparse/CRSMatrix.h"
+#include "LinAlg/Sparse/amuxCRS.h"
+
+/**
+ * writes the timing to the result file if given, otherwise to std::cout
+ */
+void writeTiming(int argc, char *argv[], double cpu_time, double run_time, std::string const& text)
+{
+	if (argc == 4) {
+		std::ofstream result_os(argv[3], std::ios::app);
+		if (result_os) {
+			result_os << cpu_time << "\t" << run_time << " " << text << std::endl;
+		}
+		result_os.close();
+	} else {
+		std::cout << cpu_time << "\t" << run_time << " " << text << std::endl;
+	}
+}
 
 int main(int argc, char *argv[])
 {
@@ -164,8 +187,43 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	// *** compare the row parallel and the hierarchical matrix vector
+	// multiplication that exploits the block structure given by the cluster tree
+#ifdef _OPENMP
+	const unsigned n_threads(omp_get_max_threads());
+	run_timer.start();
+	cpu_timer.start();
+	for (size_t k(0); k<n_mults; k++) {
+		MathLib::amuxCRSParallelOpenMP(1.0, mat.getRowPtrArray(), mat.getColIdxArray(), mat.getEntryArray(),
+						x, y, n_threads, mat.getRowPartition(n_threads));
+	}
+	cpu_timer.stop();
+	run_timer.stop();
+	writeTiming(argc, argv, cpu_timer.elapsed(), run_timer.elapsed(), "row parallel MatVecMults");
+#else
+	const unsigned n_threads(1);
+#endif
+
+	double *y_tree(new double[n]);
+	mat.setClusterTree(&cluster_tree, n_threads);
+	run_timer.start();
+	cpu_timer.start();
+	for (size_t k(0); k<n_mults; k++) {
+		mat.amux (1.0, x, y_tree);
+	}
+	cpu_timer.stop();
+	run_timer.stop();
+	writeTiming(argc, argv, cpu_timer.elapsed(), run_timer.elapsed(), "cluster tree MatVecMults");
+
+	double diff(0.0);
+	for (unsigned k(0); k<n && n_mults>0; k++)
+		diff = std::max(diff, fabs(y[k] - y_tree[k]));
+	if (diff > 1e-10)
+		std::cout << "error: results of cluster tree MatVecMult differ by " << diff << std::endl;
+
 	delete [] x;
 	delete [] y;
+	delete [] y_tree;
 
-	return 0;
+	return diff > 1e-10 ? 1 : 0;
 }
@@ -0,0 +1,116 @@
+/*
+ * MatVecMultRCM.cpp
+ *
+ *  Created on: Feb 10, 2012
+ *      Author: TF
+ */
+
+#include <cstdlib>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+// BaseLib
+#include "RunTimeTimer.h"
+#include "CPUTimeTimer.h"
+
+// MathLib
+#include "sparse.h"
+#include "LinAlg/Sparse/NestedDissectionPermutation/CRSMatrixReordered.h"
+#include "LinAlg/Sparse/reverseCuthillMcKee.h"
+
+void printStatistics(std::string const& name, MathLib::CRSMatrix<double, unsigned> const& mat)
+{
+	std::cout << name << ": bandwidth " << MathLib::calcBandwidth(mat.getNRows(), mat.getRowPtrArray(), mat.getColIdxArray())
+			<< ", profile " << MathLib::calcProfile(mat.getNRows(), mat.getRowPtrArray(), mat.getColIdxArray())
+			<< std::endl;
+}
+
+double timeMatVecMults(MathLib::CRSMatrix<double, unsigned> const& mat, unsigned n_mults, double const* x, double* y)
+{
+	RunTimeTimer run_timer;
+	run_timer.start();
+	for (unsigned k(0); k < n_mults; k++)
+		mat.amux(1.0, x, y);
+	run_timer.stop();
+	return run_timer.elapsed();
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		std::cout << "Usage: " << argv[0] << " matrix number_of_multiplications" << std::endl;
+		return 1;
+	}
+
+	std::string fname_mat(argv[1]);
+	const unsigned n_mults(atoi(argv[2]));
+
+	// *** reading matrix in crs format from file
+	std::ifstream in(fname_mat.c_str(), std::ios::in | std::ios::binary);
+	double *A(NULL);
+	unsigned *iA(NULL), *jA(NULL), n;
+	if (!in) {
+		std::cout << "error reading matrix from " << fname_mat << std::endl;
+		return 1;
+	}
+	CS_read(in, n, iA, jA, A);
+	in.close();
+	std::cout << "Parameters read: n=" << n << ", nnz=" << iA[n] << std::endl;
+
+	MathLib::CRSMatrixReordered mat(n, iA, jA, A);
+
+	double *x(new double[n]);
+	double *y(new double[n]);
+	double *x_perm(new double[n]);
+	double *y_perm(new double[n]);
+	for (unsigned k(0); k < n; k++)
+		x[k] = 1.0 + (k % 17) * 0.125;
+
+	printStatistics("original matrix", mat);
+	std::cout << n_mults << " matrix vector multiplications: " << timeMatVecMults(mat, n_mults, x, y)
+			<< " s" << std::endl;
+
+	// *** calculate and apply the reverse Cuthill-McKee ordering
+	RunTimeTimer run_timer;
+	CPUTimeTimer cpu_timer;
+	unsigned *op_perm(new unsigned[n]);
+	unsigned *po_perm(new unsigned[n]);
+	run_timer.start();
+	cpu_timer.start();
+	MathLib::reverseCuthillMcKee(n, mat.getRowPtrArray(), mat.getColIdxArray(), op_perm, po_perm);
+	cpu_timer.stop();
+	run_timer.stop();
+	std::cout << "calc reverse Cuthill-McKee ordering: " << cpu_timer.elapsed() << "\t"
+			<< run_timer.elapsed() << std::endl;
+
+	run_timer.start();
+	cpu_timer.start();
+	mat.reorderMatrix(op_perm, po_perm);
+	cpu_timer.stop();
+	run_timer.stop();
+	std::cout << "applying reverse Cuthill-McKee ordering: " << cpu_timer.elapsed() << "\t"
+			<< run_timer.elapsed() << std::endl;
+
+	for (unsigned k(0); k < n; k++)
+		x_perm[po_perm[k]] = x[k];
+	printStatistics("reordered matrix", mat);
+	std::cout << n_mults << " matrix vector multiplications: " << timeMatVecMults(mat, n_mults, x_perm, y_perm)
+			<< " s" << std::endl;
+
+	// *** compare the results
+	double diff(0.0);
+	for (unsigned k(0); k < n; k++)
+		if (fabs(y_perm[po_perm[k]] - y[k]) > diff)
+			diff = fabs(y_perm[po_perm[k]] - y[k]);
+	std::cout << "max difference of the results: " << diff << std::endl;
+
+	delete [] op_perm;
+	delete [] po_perm;
+	delete [] x;
+	delete [] y;
+	delete [] x_perm;
+	delete [] y_perm;
+
+	return diff < 1e-10 ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+/*
+ * TripletAssembly.cpp
+ *
+ *  Created on: Feb 8, 2012
+ *      Author: TF
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Base
+#include "RunTimeTimer.h"
+
+// MathLib
+#include "LinAlg/Sparse/CRSAssembler.h"
+#include "LinAlg/Sparse/CRSMatrix.h"
+
+/**
+ * stiffness matrix of the Laplace operator for a bilinear element on a square
+ * (local node numbering counterclockwise)
+ */
+const double element_matrix[4][4] = {
+	{ 4.0 / 6, -1.0 / 6, -2.0 / 6, -1.0 / 6 },
+	{ -1.0 / 6, 4.0 / 6, -1.0 / 6, -2.0 / 6 },
+	{ -2.0 / 6, -1.0 / 6, 4.0 / 6, -1.0 / 6 },
+	{ -1.0 / 6, -2.0 / 6, -1.0 / 6, 4.0 / 6 }
+};
+
+/**
+ * local node numbers of an element sorted by the global node numbers
+ */
+const unsigned sorted_local_nodes[4] = { 0, 1, 3, 2 };
+
+/**
+ * global node numbers of element e of a structured mesh with nx x nx elements
+ */
+void getElementNodes(unsigned nx, unsigned e, unsigned* nodes)
+{
+	const unsigned i(e % nx), j(e / nx);
+	nodes[0] = j * (nx + 1) + i;
+	nodes[1] = nodes[0] + 1;
+	nodes[2] = nodes[0] + nx + 2;
+	nodes[3] = nodes[0] + nx + 1;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		std::cout << "Usage: " << argv[0] << " number-of-elements-per-direction number-of-threads" << std::endl;
+		std::cout << "\tassembles the stiffness matrix of the Laplace operator on a structured mesh of bilinear elements" << std::endl;
+		return 1;
+	}
+
+	const unsigned nx(atoi(argv[1]));
+	unsigned num_omp_threads (1);
+	num_omp_threads = atoi (argv[2]);
+#ifdef _OPENMP
+	omp_set_num_threads(num_omp_threads);
+#endif
+
+	const unsigned n((nx + 1) * (nx + 1));
+	const unsigned n_elements(nx * nx);
+	std::cout << "n=" << n << ", number of elements " << n_elements << std::endl;
+
+	// *** assembly from triplets
+	RunTimeTimer timer;
+	timer.start();
+	MathLib::CRSAssembler<double, unsigned> assembler(n);
+	assembler.reserve(16 * static_cast<std::size_t>(n_elements) / num_omp_threads + 16);
+	OPENMP_LOOP_TYPE e;
+	#pragma omp parallel for
+	for (e = 0; e < n_elements; e++) {
+		unsigned nodes[4];
+		getElementNodes(nx, e, nodes);
+		for (unsigned r(0); r < 4; r++)
+			for (unsigned c(0); c < 4; c++)
+				assembler.add(nodes[r], nodes[c], element_matrix[r][c]);
+	}
+	timer.stop();
+	std::cout << "adding " << assembler.getNTriplets() << " triplets: " << timer.elapsed() << " s" << std::endl;
+	timer.start();
+	MathLib::CRSMatrix<double, unsigned>* mat(assembler.createMatrix());
+	timer.stop();
+	std::cout << "sorting and merging: " << timer.elapsed() << " s" << std::endl;
+
+	// *** checks: number of entries of the nine point stencil, the row sums vanish
+	const unsigned expected_nnz((3 * (nx + 1) - 2) * (3 * (nx + 1) - 2));
+	unsigned const*const iA(mat->getRowPtrArray());
+	unsigned const*const jA(mat->getColIdxArray());
+	double const*const A(mat->getEntryArray());
+	bool ok(mat->getNNZ() == expected_nnz);
+	double max_row_sum(0.0);
+	for (unsigned i(0); i < n && ok; i++) {
+		double row_sum(0.0);
+		for (unsigned j(iA[i]); j < iA[i + 1]; j++) {
+			row_sum += A[j];
+			if (j > iA[i] && jA[j - 1] >= jA[j])
+				ok = false;
+		}
+		max_row_sum = std::max(max_row_sum, fabs(row_sum));
+	}
+	ok = ok && max_row_sum < 1e-12;
+	std::cout << "nnz=" << mat->getNNZ() << " (expected " << expected_nnz << "), max |row sum| = "
+			<< max_row_sum << (ok ? ", ok" : ", FAILED") << std::endl;
+
+	// *** assembly into the existing pattern via addValue() with hint
+	const unsigned nnz(mat->getNNZ());
+	double *A0(new double[nnz]);
+	for (unsigned k(0); k < nnz; k++)
+		A0[k] = A[k];
+	for (unsigned i(0); i < n; i++)
+		for (unsigned j(iA[i]); j < iA[i + 1]; j++)
+			mat->setValue(i, jA[j], 0.0);
+	timer.start();
+	#pragma omp parallel for
+	for (e = 0; e < n_elements; e++) {
+		unsigned nodes[4];
+		getElementNodes(nx, e, nodes);
+		for (unsigned r(0); r < 4; r++) {
+			// the columns in ascending order, i.e. the search starts at the previous entry
+			unsigned hint(iA[nodes[r]]);
+			for (unsigned k(0); k < 4; k++) {
+				const unsigned c(sorted_local_nodes[k]);
+				mat->addValue(nodes[r], nodes[c], element_matrix[r][c], hint);
+			}
+		}
+	}
+	timer.stop();
+	double max_diff(0.0);
+	for (unsigned k(0); k < nnz; k++)
+		max_diff = std::max(max_diff, fabs(A[k] - A0[k]));
+	ok = ok && max_diff < 1e-12;
+	std::cout << "addValue() into existing pattern: " << timer.elapsed() << " s, max difference "
+			<< max_diff << (ok ? ", ok" : ", FAILED") << std::endl;
+
+	delete [] A0;
+	delete mat;
+	return ok ? 0 : 1;
+}
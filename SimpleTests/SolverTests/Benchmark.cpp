@@ -0,0 +1,511 @@
+/*
+ * Benchmark.cpp
+ *
+ *  Created on: Feb 27, 2012
+ *      Author: TF
+ */
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <list>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// BaseLib
+#include "RunTimeTimer.h"
+#include "StringTools.h"
+#include "BenchmarkReport.h"
+
+// MathLib
+#include "sparse.h"
+#include "LinAlg/Sparse/CRSMatrix.h"
+#include "LinAlg/Sparse/CRSMatrixDiagPrecond.h"
+#include "LinAlg/Sparse/CRSMatrixOpenMP.h"
+#include "LinAlg/Sparse/CRSMatrixPThreads.h"
+#include "LinAlg/Sparse/NestedDissectionPermutation/CRSMatrixReordered.h"
+#include "LinAlg/Sparse/NestedDissectionPermutation/Cluster.h"
+#include "LinAlg/Sparse/generateStencilMatrix.h"
+#include "LinAlg/Solvers/CG.h"
+#include "LinAlg/Solvers/BiCGStab.h"
+#include "LinAlg/Solvers/GMRes.h"
+
+/**
+ * Benchmark driver for the matrix vector multiplication backends and the
+ * iterative solvers, see printUsage(). Every benchmark is executed a number
+ * of times without measurement (warm up) and then repeated, the statistics of
+ * the repetitions are written as JSON or CSV.
+ *
+ * The derived rates are based on the median of the run times:
+ * - matrix vector multiplication: 2 nnz flops, the traffic is nnz values and
+ *   column indices, n+1 row pointers and one read of x and one write of y
+ *   (i.e. a perfect cache for x)
+ * - solvers: the costs of an iteration are estimated by the number of matrix
+ *   vector multiplications and the flops and vector streams of the vector
+ *   operations (see SolverModel), the costs of the set up and of the
+ *   restarts of GMRes are neglected
+ */
+
+struct Options
+{
+	Options() :
+		kind("all"), backends("serial,openmp,pthreads,reordered"), solvers("cg,bicgstab,gmres"),
+		threads("1"), format(""), output(""), warmup(2), reps(10), n_mults(10),
+		eps(1e-8), max_iter(4000), restart(30), verbose(true)
+	{}
+	std::string matrix;
+	std::string kind;
+	std::string backends;
+	std::string solvers;
+	std::string threads;
+	std::string format;
+	std::string output;
+	unsigned warmup;
+	unsigned reps;
+	unsigned n_mults;
+	double eps;
+	unsigned max_iter;
+	unsigned restart;
+	bool verbose;
+};
+
+void printUsage(char const* prog)
+{
+	std::cout << "Usage: " << prog << " matrix [options]" << std::endl
+		<< "  matrix                  file in binary CRS format or a synthetic problem," << std::endl
+		<< "                          e.g. poisson7:100x100x100 (see MathLib::generateProblem())" << std::endl
+		<< "  -k spmv|solver|all      benchmarks to run (default all)" << std::endl
+		<< "  -b list                 amux backends: serial,openmp,pthreads,reordered" << std::endl
+		<< "  -s list                 solvers: cg,bicgstab,gmres" << std::endl
+		<< "  -t list                 thread counts of the sweep, e.g. 1,2,4,8 (default 1)" << std::endl
+		<< "  -w n                    warm up runs (default 2)" << std::endl
+		<< "  -r n                    measured repetitions (default 10)" << std::endl
+		<< "  -m n                    matrix vector multiplications per repetition (default 10)" << std::endl
+		<< "  -e eps -i n -g m        solver tolerance, max iterations, GMRes restart" << std::endl
+		<< "  -o file                 output file (default std::cout)" << std::endl
+		<< "  -f json|csv             output format (default from the file extension, json)" << std::endl
+		<< "  -q                      no progress output" << std::endl;
+}
+
+bool parseOptions(int argc, char *argv[], Options &opt)
+{
+	if (argc < 2 || argv[1][0] == '-')
+		return false;
+	opt.matrix = argv[1];
+	for (int k(2); k < argc; k++) {
+		const std::string arg(argv[k]);
+		if (arg == "-q") {
+			opt.verbose = false;
+			continue;
+		}
+		if (arg.size() != 2 || arg[0] != '-' || k + 1 >= argc)
+			return false;
+		const std::string val(argv[++k]);
+		switch (arg[1]) {
+		case 'k': opt.kind = val; break;
+		case 'b': opt.backends = val; break;
+		case 's': opt.solvers = val; break;
+		case 't': opt.threads = val; break;
+		case 'w': opt.warmup = atoi(val.c_str()); break;
+		case 'r': opt.reps = std::max(atoi(val.c_str()), 1); break;
+		case 'm': opt.n_mults = std::max(atoi(val.c_str()), 1); break;
+		case 'e': opt.eps = atof(val.c_str()); break;
+		case 'i': opt.max_iter = atoi(val.c_str()); break;
+		case 'g': opt.restart = std::max(atoi(val.c_str()), 1); break;
+		case 'o': opt.output = val; break;
+		case 'f': opt.format = val; break;
+		default: return false;
+		}
+	}
+	if (opt.format.empty()) {
+		const std::size_t len(opt.output.size());
+		opt.format = (len > 4 && opt.output.substr(len - 4) == ".csv") ? "csv" : "json";
+	}
+	return opt.format == "json" || opt.format == "csv";
+}
+
+/**
+ * a benchmark kernel, run() is timed
+ */
+class BenchmarkKernel
+{
+public:
+	virtual ~BenchmarkKernel() {}
+	virtual void run() = 0;
+};
+
+class AmuxKernel : public BenchmarkKernel
+{
+public:
+	AmuxKernel(MathLib::CRSMatrix<double,unsigned> const& mat, double const* x, double* y,
+					unsigned n_mults) :
+		_mat(mat), _x(x), _y(y), _n_mults(n_mults)
+	{}
+	virtual void run()
+	{
+		for (unsigned k(0); k < _n_mults; k++)
+			_mat.amux(1.0, _x, _y);
+	}
+private:
+	MathLib::CRSMatrix<double,unsigned> const& _mat;
+	double const* _x;
+	double* _y;
+	const unsigned _n_mults;
+};
+
+/**
+ * estimated costs of an iteration of a solver
+ */
+struct SolverModel
+{
+	double spmvs;   //!< matrix vector multiplications
+	double flops;   //!< flops of the vector operations per unknown
+	double streams; //!< vectors read or written by the vector operations
+};
+
+class SolverKernel : public BenchmarkKernel
+{
+public:
+	SolverKernel(std::string const& solver, unsigned n_threads, MathLib::CRSMatrixDiagPrecond const& mat,
+					double* b, double* x, Options const& opt) :
+		_solver(solver), _n_threads(n_threads), _mat(mat), _b(b), _x(x), _opt(opt),
+		_ret(0), _steps(0), _resid(0.0)
+	{}
+
+	virtual void run()
+	{
+		const unsigned n(_mat.getNRows());
+		for (unsigned k(0); k < n; k++)
+			_x[k] = 0.0;
+		_resid = _opt.eps;
+		_steps = _opt.max_iter;
+		if (_solver == "cg") {
+#ifdef _OPENMP
+			if (_n_threads > 1)
+				_ret = MathLib::CGParallel(&_mat, _b, _x, _resid, _steps);
+			else
+#endif
+				_ret = MathLib::CG(&_mat, _b, _x, _resid, _steps);
+		} else if (_solver == "bicgstab")
+			_ret = MathLib::BiCGStab(_mat, _b, _x, _resid, _steps);
+		else
+			_ret = MathLib::GMRes(_mat, _b, _x, _resid, _opt.restart, _steps);
+	}
+
+	SolverModel getModel() const
+	{
+		SolverModel model;
+		if (_solver == "cg") {
+			model.spmvs = 1.0;
+			model.flops = 13.0;
+			model.streams = 20.0;
+		} else if (_solver == "bicgstab") {
+			model.spmvs = 2.0;
+			model.flops = 26.0;
+			model.streams = 39.0;
+		} else {
+			// modified Gram-Schmidt against (restart+1)/2 basis vectors on average
+			const double n_basis(0.5 * (_opt.restart + 1));
+			model.spmvs = 1.0;
+			model.flops = 4.0 + 4.0 * n_basis;
+			model.streams = 9.0 + 5.0 * n_basis;
+		}
+		return model;
+	}
+
+	unsigned getReturnValue() const { return _ret; }
+	unsigned getNSteps() const { return _steps; }
+	double getResidual() const { return _resid; }
+
+private:
+	std::string const _solver;
+	unsigned const _n_threads;
+	MathLib::CRSMatrixDiagPrecond const& _mat;
+	double* _b;
+	double* _x;
+	Options const& _opt;
+	unsigned _ret;
+	unsigned _steps;
+	double _resid;
+};
+
+/**
+ * executes the warm up runs and the measured repetitions of the kernel
+ * @return the run times of the repetitions
+ */
+std::vector<double> measure(BenchmarkKernel &kernel, Options const& opt)
+{
+	for (unsigned k(0); k < opt.warmup; k++)
+		kernel.run();
+
+	std::vector<double> times;
+	RunTimeTimer timer;
+	for (unsigned k(0); k < opt.reps; k++) {
+		timer.start();
+		kernel.run();
+		timer.stop();
+		times.push_back(timer.elapsed());
+	}
+	return times;
+}
+
+template <typename T>
+T* copyArray(T const* src, std::size_t n)
+{
+	T* dest(new T[n]);
+	std::memcpy(dest, src, n * sizeof(T));
+	return dest;
+}
+
+std::list<std::string> splitList(std::string const& str)
+{
+	std::list<std::string> l(splitString(str, ','));
+	for (std::list<std::string>::iterator it(l.begin()); it != l.end(); ) {
+		if (it->empty()) it = l.erase(it);
+		else ++it;
+	}
+	return l;
+}
+
+void setNumberOfThreads(unsigned n_threads)
+{
+#ifdef _OPENMP
+	omp_set_num_threads(n_threads);
+#else
+	(void)n_threads;
+#endif
+}
+
+void beginRecord(BenchmarkReport &report, std::string const& kind, std::string const& name,
+				unsigned n_threads, Options const& opt, unsigned n, unsigned nnz)
+{
+	report.beginRecord();
+	report.add("kind", kind);
+	report.add("name", name);
+	report.add("threads", n_threads);
+	report.add("n", n);
+	report.add("nnz", nnz);
+	report.add("warmup", opt.warmup);
+	report.add("reps", opt.reps);
+}
+
+void runSpMVBenchmarks(Options const& opt, unsigned n, unsigned const* iA, unsigned const* jA,
+				double const* A, std::list<unsigned> const& threads, BenchmarkReport &report)
+{
+	const unsigned nnz(iA[n]);
+	double *x(new double[n]);
+	double *y(new double[n]);
+	for (unsigned k(0); k < n; k++)
+		x[k] = 1.0;
+
+	const double flops(2.0 * nnz);
+	const double bytes(nnz * (sizeof(double) + sizeof(unsigned)) + (n + 1.0) * sizeof(unsigned)
+					+ 2.0 * n * sizeof(double));
+
+	// the nested dissection ordering is computed once for all thread counts
+	MathLib::Cluster *cluster_tree(NULL);
+	unsigned *op_perm(NULL), *po_perm(NULL);
+
+	const std::list<std::string> backends(splitList(opt.backends));
+	for (std::list<std::string>::const_iterator it(backends.begin()); it != backends.end(); ++it) {
+		std::string const& backend(*it);
+		if (backend == "reordered" && cluster_tree == NULL) {
+			// the cluster tree copies the arrays
+			cluster_tree = new MathLib::Cluster(n, const_cast<unsigned*>(iA), const_cast<unsigned*>(jA));
+			op_perm = new unsigned[n];
+			po_perm = new unsigned[n];
+			for (unsigned k(0); k < n; k++)
+				op_perm[k] = po_perm[k] = k;
+			cluster_tree->createClusterTree(op_perm, po_perm, 1000);
+		}
+
+		for (std::list<unsigned>::const_iterator t(threads.begin()); t != threads.end(); ++t) {
+			const unsigned n_threads(*t);
+			// the serial backend is measured once
+			if (backend == "serial" && t != threads.begin())
+				break;
+			setNumberOfThreads(n_threads);
+
+			// the matrices take the ownership of the arrays
+			MathLib::CRSMatrix<double,unsigned> *mat(NULL);
+			if (backend == "serial") {
+				mat = new MathLib::CRSMatrix<double,unsigned>(n, copyArray(iA, n + 1),
+								copyArray(jA, nnz), copyArray(A, nnz));
+			} else if (backend == "openmp") {
+#ifdef _OPENMP
+				mat = new MathLib::CRSMatrixOpenMP<double,unsigned>(n, copyArray(iA, n + 1),
+								copyArray(jA, nnz), copyArray(A, nnz), n_threads);
+#endif
+			} else if (backend == "pthreads") {
+				mat = new MathLib::CRSMatrixPThreads<double>(n, copyArray(iA, n + 1),
+								copyArray(jA, nnz), copyArray(A, nnz), n_threads);
+			} else if (backend == "reordered") {
+				MathLib::CRSMatrixReordered *reordered(new MathLib::CRSMatrixReordered(n,
+								copyArray(iA, n + 1), copyArray(jA, nnz), copyArray(A, nnz)));
+				reordered->reorderMatrix(op_perm, po_perm);
+				reordered->setClusterTree(cluster_tree, n_threads);
+				mat = reordered;
+			}
+			if (mat == NULL) {
+				std::cerr << "backend " << backend << " is not available" << std::endl;
+				break;
+			}
+
+			if (opt.verbose)
+				std::cerr << "amux " << backend << ", " << n_threads << " threads ... " << std::flush;
+			AmuxKernel kernel(*mat, x, y, opt.n_mults);
+			const BenchmarkStatistics stats(computeBenchmarkStatistics(measure(kernel, opt)));
+			const double t_mult(stats.median / opt.n_mults);
+			if (opt.verbose)
+				std::cerr << t_mult << " s per amux" << std::endl;
+
+			beginRecord(report, "spmv", backend, n_threads, opt, n, nnz);
+			report.add("mults_per_rep", opt.n_mults);
+			report.add("time", stats);
+			report.add("time_per_mult", t_mult);
+			report.add("gflops", t_mult > 0.0 ? flops / t_mult * 1e-9 : 0.0);
+			report.add("gbytes_per_s", t_mult > 0.0 ? bytes / t_mult * 1e-9 : 0.0);
+			delete mat;
+		}
+	}
+
+	delete cluster_tree;
+	delete [] op_perm;
+	delete [] po_perm;
+	delete [] x;
+	delete [] y;
+}
+
+void runSolverBenchmarks(Options const& opt, unsigned n, unsigned const* iA, unsigned const* jA,
+				double const* A, std::list<unsigned> const& threads, BenchmarkReport &report)
+{
+	const unsigned nnz(iA[n]);
+	MathLib::CRSMatrixDiagPrecond mat(n, copyArray(iA, n + 1), copyArray(jA, nnz), copyArray(A, nnz));
+	mat.calcPrecond();
+
+	// right hand side with known solution
+	double *x(new double[n]);
+	double *b(new double[n]);
+	for (unsigned k(0); k < n; k++)
+		x[k] = 1.0 + (k % 7) * 0.1;
+	mat.amux(1.0, x, b);
+
+	const double spmv_flops(2.0 * nnz);
+	const double spmv_bytes(nnz * (sizeof(double) + sizeof(unsigned)) + (n + 1.0) * sizeof(unsigned)
+					+ 2.0 * n * sizeof(double));
+
+	const std::list<std::string> solvers(splitList(opt.solvers));
+	for (std::list<std::string>::const_iterator it(solvers.begin()); it != solvers.end(); ++it) {
+		std::string const& solver(*it);
+		if (solver != "cg" && solver != "bicgstab" && solver != "gmres") {
+			std::cerr << "unknown solver " << solver << std::endl;
+			continue;
+		}
+		for (std::list<unsigned>::const_iterator t(threads.begin()); t != threads.end(); ++t) {
+			const unsigned n_threads(*t);
+			// only CG has a parallel version (CGParallel())
+			if (solver != "cg" && t != threads.begin())
+				break;
+			setNumberOfThreads(n_threads);
+
+			if (opt.verbose)
+				std::cerr << solver << ", " << n_threads << " threads ... " << std::flush;
+			SolverKernel kernel(solver, n_threads, mat, b, x, opt);
+			const BenchmarkStatistics stats(computeBenchmarkStatistics(measure(kernel, opt)));
+			const unsigned steps(std::max(kernel.getNSteps(), 1u));
+			const double t_iter(stats.median / steps);
+			if (opt.verbose)
+				std::cerr << kernel.getNSteps() << " iterations, " << stats.median << " s" << std::endl;
+
+			const SolverModel model(kernel.getModel());
+			const double flops(model.spmvs * spmv_flops + model.flops * n);
+			const double bytes(model.spmvs * spmv_bytes + model.streams * n * sizeof(double));
+
+			beginRecord(report, "solver", solver, n_threads, opt, n, nnz);
+			report.add("preconditioner", "jacobi");
+			report.add("return_value", kernel.getReturnValue());
+			report.add("iterations", kernel.getNSteps());
+			report.add("residual", kernel.getResidual());
+			report.add("time", stats);
+			report.add("time_per_iteration", t_iter);
+			report.add("gflops", t_iter > 0.0 ? flops / t_iter * 1e-9 : 0.0);
+			report.add("gbytes_per_s", t_iter > 0.0 ? bytes / t_iter * 1e-9 : 0.0);
+		}
+	}
+
+	delete [] x;
+	delete [] b;
+}
+
+int main(int argc, char *argv[])
+{
+	Options opt;
+	if (!parseOptions(argc, argv, opt)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	double *A(NULL);
+	unsigned *iA(NULL), *jA(NULL), n(0);
+	std::ifstream in(opt.matrix.c_str(), std::ios::in | std::ios::binary);
+	if (in) {
+		CS_read(in, n, iA, jA, A);
+		in.close();
+	} else if (!MathLib::generateProblem(opt.matrix, n, iA, jA, A)) {
+		std::cerr << "error reading matrix from " << opt.matrix << std::endl;
+		return 1;
+	}
+	if (opt.verbose)
+		std::cerr << "Parameters read: n=" << n << ", nnz=" << iA[n] << std::endl;
+
+	std::list<unsigned> threads;
+	const std::list<std::string> thread_list(splitList(opt.threads));
+	for (std::list<std::string>::const_iterator it(thread_list.begin()); it != thread_list.end(); ++it)
+		threads.push_back(std::max(atoi(it->c_str()), 1));
+	if (threads.empty())
+		threads.push_back(1);
+
+	BenchmarkReport report;
+	report.setMetaData("matrix", opt.matrix);
+	const std::time_t now(std::time(NULL));
+	char date[32];
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+	report.setMetaData("date", date);
+#ifdef _OPENMP
+	report.setMetaData("openmp_max_threads", number2str(omp_get_max_threads()));
+#else
+	report.setMetaData("openmp_max_threads", "0");
+#endif
+
+	if (opt.kind == "spmv" || opt.kind == "all")
+		runSpMVBenchmarks(opt, n, iA, jA, A, threads, report);
+	if (opt.kind == "solver" || opt.kind == "all")
+		runSolverBenchmarks(opt, n, iA, jA, A, threads, report);
+
+	std::ofstream out;
+	if (!opt.output.empty()) {
+		out.open(opt.output.c_str());
+		if (!out) {
+			std::cerr << "could not open " << opt.output << std::endl;
+			return 1;
+		}
+	}
+	std::ostream &os(opt.output.empty() ? std::cout : out);
+	if (opt.format == "csv")
+		report.writeCSV(os);
+	else
+		report.writeJSON(os);
+
+	delete [] iA;
+	delete [] jA;
+	delete [] A;
+
+	return 0;
+}
@@ -0,0 +1,97 @@
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include "LinAlg/Solvers/BiCGStab.h"
+#include "LinAlg/Sparse/CRSMatrixILU0Precond.h"
+#include "sparse.h"
+#include "vector_io.h"
+#include "RunTimeTimer.h"
+#include "CPUTimeTimer.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+int main(int argc, char *argv[])
+{
+	if (argc != 4) {
+		std::cout << "Usage: " << argv[0] << " matrix rhs number-of-threads" << std::endl;
+		return -1;
+	}
+
+	// read number of threads
+	unsigned num_omp_threads (1);
+	num_omp_threads = atoi (argv[3]);
+#ifdef _OPENMP
+	omp_set_num_threads(num_omp_threads);
+#endif
+
+	// *** reading matrix in crs format from file
+	std::string fname(argv[1]);
+	MathLib::CRSMatrixILU0Precond *mat (new MathLib::CRSMatrixILU0Precond(fname));
+
+	unsigned n (mat->getNRows());
+	bool verbose (true);
+	if (verbose)
+		std::cout << "Parameters read: n=" << n << std::endl;
+
+	double *x(new double[n]);
+	double *b(new double[n]);
+
+	// *** init start vector x
+	for (size_t k(0); k<n; k++) {
+		x[k] = 0.0;
+	}
+	// *** read rhs
+	fname = argv[2];
+	std::ifstream in(fname.c_str());
+	if (in) {
+		read (in, n, b);
+		in.close();
+	} else {
+		std::cout << "problem reading rhs - initializing b with 1.0" << std::endl;
+		for (size_t k(0); k<n; k++) {
+			b[k] = 1.0;
+		}
+	}
+
+	RunTimeTimer run_timer;
+	CPUTimeTimer cpu_timer;
+
+	if (verbose)
+		std::cout << "calculating ILU(0) preconditioner ... " << std::flush;
+	run_timer.start();
+	cpu_timer.start();
+	mat->calcPrecond();
+	cpu_timer.stop();
+	run_timer.stop();
+	if (verbose)
+		std::cout << "took " << cpu_timer.elapsed() << " sec time and " << run_timer.elapsed() << " sec" << std::endl;
+
+	if (verbose)
+		std::cout << "solving system with BiCGStab method (ILU(0) preconditioner) ... " << std::flush;
+
+	double eps (1.0e-6);
+	unsigned steps (4000);
+	run_timer.start();
+	cpu_timer.start();
+
+	MathLib::BiCGStab ((*mat), b, x, eps, steps);
+
+	cpu_timer.stop();
+	run_timer.stop();
+
+	if (verbose) {
+		std::cout << " in " << steps << " iterations" << std::endl;
+		std::cout << "\t(residuum is " << eps << ") took " << cpu_timer.elapsed() << " sec time and " << run_timer.elapsed() << " sec" << std::endl;
+	} else {
+		std::cout << cpu_timer.elapsed() << std::endl;
+	}
+
+	delete mat;
+	delete [] x;
+	delete [] b;
+
+	return 0;
+}
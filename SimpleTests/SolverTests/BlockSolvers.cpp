@@ -0,0 +1,88 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "LinAlg/Solvers/BlockKrylovTemplate.h"
+#include "LinAlg/Solvers/SolverWorkspace.h"
+#include "LinAlg/Sparse/CRSMatrixDiagPrecond.h"
+#include "LinAlg/Sparse/CRSOperator.h"
+#include "RunTimeTimer.h"
+
+/**
+ * largest relative residual |b_q - A x_q| / |b_q| of the columns of the blocks
+ */
+double maxRelResidual(MathLib::CRSMatrix<double, unsigned> const& mat, unsigned k,
+				double const* B, double const* X)
+{
+	const unsigned n(mat.getNRows());
+	double *R(new double[static_cast<size_t>(n) * k]);
+	mat.amuxBlock(1.0, k, X, R);
+	double max_resid(0.0);
+	for (unsigned q(0); q < k; q++) {
+		double rr(0.0), bb(0.0);
+		for (unsigned i(0); i < n; i++) {
+			const double r(B[i*k+q] - R[i*k+q]);
+			rr += r * r;
+			bb += B[i*k+q] * B[i*k+q];
+		}
+		max_resid = std::max(max_resid, sqrt(rr / bb));
+	}
+	delete [] R;
+	return max_resid;
+}
+
+/**
+ * The test solves the system with k = 1, ..., max_k right hand sides at once
+ * using the block CG and the block BiCGStab method (diagonal preconditioner)
+ * and reports the time per right hand side.
+ */
+int main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		std::cout << "Usage: " << argv[0] << " matrix [max-k]" << std::endl;
+		return -1;
+	}
+	const unsigned max_k(argc > 2 ? atoi(argv[2]) : 32);
+
+	std::string fname(argv[1]);
+	MathLib::CRSMatrixDiagPrecond mat(fname);
+	mat.calcPrecond();
+	MathLib::CRSOperator<double, unsigned> op(mat);
+	const unsigned n(mat.getNRows());
+	std::cout << "Parameters read: n=" << n << ", nnz=" << mat.getNNZ() << std::endl;
+
+	double *B(new double[static_cast<size_t>(n) * max_k]);
+	double *X(new double[static_cast<size_t>(n) * max_k]);
+	MathLib::SolverWorkspace<double> work;
+	RunTimeTimer timer;
+	unsigned ret(0);
+
+	for (unsigned method(0); method < 2; method++) {
+		const char* name(method == 0 ? "block CG" : "block BiCGStab");
+		for (unsigned k(1); k <= max_k; k++) {
+			// right hand sides B_q = A x_q with different x_q
+			for (unsigned i(0); i < n; i++)
+				for (unsigned q(0); q < k; q++)
+					X[i*k+q] = 1.0 + ((i * (q%10+1) + q) % 11) * 0.1;
+			mat.amuxBlock(1.0, k, X, B);
+			std::fill(X, X + static_cast<size_t>(n) * k, 0.0);
+
+			double eps(1.0e-8);
+			unsigned steps(4000);
+			timer.start();
+			if (method == 0)
+				ret |= MathLib::BlockCG(op, mat, k, B, X, eps, steps, work);
+			else
+				ret |= MathLib::BlockBiCGStab(op, mat, k, B, X, eps, steps, work);
+			timer.stop();
+			std::cout << name << " k=" << k << ": " << steps << " iterations, "
+					<< timer.elapsed() << " s, " << timer.elapsed() / k << " s per rhs, "
+					<< "max |b-Ax|/|b| = " << maxRelResidual(mat, k, B, X) << std::endl;
+		}
+	}
+
+	delete [] B;
+	delete [] X;
+
+	return ret == 0 ? 0 : 1;
+}
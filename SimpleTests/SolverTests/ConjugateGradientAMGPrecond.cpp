@@ -0,0 +1,122 @@
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include "LinAlg/Solvers/CG.h"
+#include "LinAlg/Sparse/CRSMatrixAMGPrecond.h"
+#include "sparse.h"
+#include "vector_io.h"
+#include "RunTimeTimer.h"
+#include "CPUTimeTimer.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+int main(int argc, char *argv[])
+{
+	if (argc != 4) {
+		std::cout << "Usage: " << argv[0] << " matrix rhs number-of-threads" << std::endl;
+		return -1;
+	}
+
+	// read number of threads
+	unsigned num_omp_threads (1);
+	num_omp_threads = atoi (argv[3]);
+#ifdef _OPENMP
+	omp_set_num_threads(num_omp_threads);
+#endif
+
+	// *** reading matrix in crs format from file
+	std::string fname(argv[1]);
+	MathLib::CRSMatrixAMGPrecond *mat (new MathLib::CRSMatrixAMGPrecond(fname));
+
+	unsigned n (mat->getNRows());
+	bool verbose (true);
+	if (verbose)
+		std::cout << "Parameters read: n=" << n << std::endl;
+
+	double *x(new double[n]);
+	double *b(new double[n]);
+
+	// *** init start vector x
+	for (size_t k(0); k<n; k++) {
+		x[k] = 0.0;
+	}
+	// *** read rhs
+	fname = argv[2];
+	std::ifstream in(fname.c_str());
+	if (in) {
+		read (in, n, b);
+		in.close();
+	} else {
+		std::cout << "problem reading rhs - initializing b with 1.0" << std::endl;
+		for (size_t k(0); k<n; k++) {
+			b[k] = 1.0;
+		}
+	}
+
+	RunTimeTimer run_timer;
+	CPUTimeTimer cpu_timer;
+
+	if (verbose)
+		std::cout << "setup of AMG preconditioner ... " << std::flush;
+	run_timer.start();
+	cpu_timer.start();
+	mat->calcPrecond();
+	cpu_timer.stop();
+	run_timer.stop();
+	if (verbose)
+		std::cout << "took " << cpu_timer.elapsed() << " sec time and " << run_timer.elapsed() << " sec" << std::endl;
+
+	MathLib::SmoothedAggregationAMG const* amg(mat->getAMG());
+	if (verbose) {
+		for (unsigned l(0); l < amg->getNLevels(); l++)
+			std::cout << "\tlevel " << l << ": " << amg->getNRows(l) << " rows, " << amg->getNNZ(l) << " non-zeros" << std::endl;
+		std::cout << "\toperator complexity " << amg->getOperatorComplexity() << std::endl;
+	}
+
+	// *** time of a single V-cycle
+	const unsigned n_cycles(10);
+	for (size_t k(0); k<n; k++) {
+		x[k] = b[k];
+	}
+	run_timer.start();
+	cpu_timer.start();
+	for (unsigned k(0); k<n_cycles; k++) {
+		mat->precondApply(x);
+	}
+	cpu_timer.stop();
+	run_timer.stop();
+	if (verbose)
+		std::cout << "V-cycle took " << cpu_timer.elapsed()/n_cycles << " sec time and " << run_timer.elapsed()/n_cycles << " sec" << std::endl;
+	for (size_t k(0); k<n; k++) {
+		x[k] = 0.0;
+	}
+
+	if (verbose)
+		std::cout << "solving system with PCG method (AMG preconditioner) ... " << std::flush;
+
+	double eps (1.0e-6);
+	unsigned steps (4000);
+	run_timer.start();
+	cpu_timer.start();
+
+	MathLib::CG(mat, b, x, eps, steps);
+
+	cpu_timer.stop();
+	run_timer.stop();
+
+	if (verbose) {
+		std::cout << " in " << steps << " iterations" << std::endl;
+		std::cout << "\t(residuum is " << eps << ") took " << cpu_timer.elapsed() << " sec time and " << run_timer.elapsed() << " sec" << std::endl;
+	} else {
+		std::cout << cpu_timer.elapsed() << std::endl;
+	}
+
+	delete mat;
+	delete [] x;
+	delete [] b;
+
+	return 0;
+}
@@ -0,0 +1,153 @@
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "LinAlg/Solvers/CGTemplate.h"
+#include "LinAlg/Solvers/SolverWorkspace.h"
+#include "LinAlg/Sparse/BCSRMatrix.h"
+#include "LinAlg/Sparse/CRSMatrixDiagPrecond.h"
+#include "LinAlg/Sparse/CRSOperator.h"
+#include "sparse.h"
+#include "RunTimeTimer.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * The test builds the matrix A \otimes B from the scalar matrix A read from
+ * file and the symmetric positive definite BS x BS matrix B = I + ones, i.e.
+ * every unknown of A is replaced by BS coupled unknowns. The matrix vector
+ * multiplication and the CG method are compared for the compressed row
+ * storage format (diagonal preconditioner) and the block compressed row
+ * storage format (block Jacobi preconditioner).
+ */
+template<unsigned BS>
+void run(unsigned n, unsigned const* iA, unsigned const* jA, double const* A, unsigned n_mults)
+{
+	// A \otimes B in compressed row storage format
+	const unsigned N(n * BS);
+	unsigned *iK(new unsigned[N + 1]);
+	unsigned *jK(new unsigned[iA[n] * BS * BS]);
+	double *K(new double[iA[n] * BS * BS]);
+	iK[0] = 0;
+	for (unsigned i(0); i < n; i++) {
+		for (unsigned r(0); r < BS; r++) {
+			unsigned pos(iK[i * BS + r]);
+			for (unsigned j(iA[i]); j < iA[i + 1]; j++) {
+				for (unsigned c(0); c < BS; c++) {
+					jK[pos] = jA[j] * BS + c;
+					K[pos] = A[j] * (r == c ? 2.0 : 1.0);
+					pos++;
+				}
+			}
+			iK[i * BS + r + 1] = pos;
+		}
+	}
+	MathLib::CRSMatrixDiagPrecond crs(N, iK, jK, K);
+	crs.calcPrecond();
+
+	RunTimeTimer timer;
+	timer.start();
+	MathLib::BCSRMatrix<double, unsigned, BS> bcsr(crs);
+	const unsigned n_singular(bcsr.calcPrecond());
+	timer.stop();
+	std::cout << "block size " << BS << ": n=" << N << ", nnz=" << crs.getNNZ() << ", blocks="
+			<< bcsr.getNBlocks() << ", conversion and preconditioner " << timer.elapsed() << " s" << std::endl;
+	if (n_singular > 0)
+		std::cout << n_singular << " diagonal blocks are missing or singular" << std::endl;
+
+	double *x(new double[N]);
+	double *y0(new double[N]);
+	double *y1(new double[N]);
+	for (unsigned k(0); k < N; k++)
+		x[k] = 1.0 + (k % 7);
+
+	MathLib::CRSOperator<double, unsigned> op(crs);
+	timer.start();
+	for (unsigned k(0); k < n_mults; k++)
+		op.amux(1.0, x, y0);
+	timer.stop();
+	std::cout << "\t" << n_mults << " amux CRS: " << timer.elapsed() << " s" << std::endl;
+
+	timer.start();
+	for (unsigned k(0); k < n_mults; k++)
+		bcsr.amux(1.0, x, y1);
+	timer.stop();
+	double diff(0.0);
+	for (unsigned k(0); k < N; k++)
+		diff = std::max(diff, fabs(y0[k] - y1[k]));
+	std::cout << "\t" << n_mults << " amux BCSR: " << timer.elapsed() << " s, max difference "
+			<< diff << std::endl;
+
+	MathLib::SolverWorkspace<double> work;
+	for (unsigned k(0); k < N; k++)
+		y0[k] = 1.0;
+	for (unsigned block(0); block < 2; block++) {
+		for (unsigned k(0); k < N; k++)
+			x[k] = 0.0;
+		double eps(1.0e-8);
+		unsigned steps(4000);
+		timer.start();
+		if (block)
+			MathLib::CG(bcsr, bcsr, y0, x, eps, steps, work);
+		else
+			MathLib::CG(op, crs, y0, x, eps, steps, work);
+		timer.stop();
+		std::cout << "\tCG " << (block ? "BCSR, block Jacobi: " : "CRS, Jacobi: ") << steps
+				<< " iterations, " << timer.elapsed() << " s, eps = " << eps << std::endl;
+	}
+
+	delete [] x;
+	delete [] y0;
+	delete [] y1;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 4) {
+		std::cout << "Usage: " << argv[0] << " matrix block-size number-of-threads [number-of-multiplications]" << std::endl;
+		std::cout << "\tblock-size 2, 3 or 4" << std::endl;
+		return -1;
+	}
+
+	const unsigned block_size(atoi(argv[2]));
+	unsigned num_omp_threads (1);
+	num_omp_threads = atoi (argv[3]);
+#ifdef _OPENMP
+	omp_set_num_threads(num_omp_threads);
+#endif
+	const unsigned n_mults(argc > 4 ? atoi(argv[4]) : 100);
+
+	// *** reading matrix in crs format from file
+	std::ifstream in(argv[1], std::ios::in | std::ios::binary);
+	if (!in) {
+		std::cout << "cannot open " << argv[1] << std::endl;
+		return 1;
+	}
+	unsigned n, *iA(NULL), *jA(NULL);
+	double *A(NULL);
+	CS_read(in, n, iA, jA, A);
+	in.close();
+
+	switch (block_size) {
+	case 2:
+		run<2>(n, iA, jA, A, n_mults);
+		break;
+	case 3:
+		run<3>(n, iA, jA, A, n_mults);
+		break;
+	case 4:
+		run<4>(n, iA, jA, A, n_mults);
+		break;
+	default:
+		std::cout << "block size " << block_size << " not supported" << std::endl;
+	}
+
+	delete [] iA;
+	delete [] jA;
+	delete [] A;
+
+	return 0;
+}
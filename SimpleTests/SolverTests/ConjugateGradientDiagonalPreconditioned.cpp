@@ -15,10 +15,11 @@
 
 int main(int argc, char *argv[])
 {
-	if (argc != 4) {
-		std::cout << "Usage: " << argv[0] << " matrix rhs number-of-threads" << std::endl;
+	if (argc != 4 && argc != 5) {
+		std::cout << "Usage: " << argv[0] << " matrix rhs number-of-threads [pipelined]" << std::endl;
 		return -1;
 	}
+	const bool pipelined (argc == 5 && std::string(argv[4]) == "pipelined");
 
 	// read number of threads
 	unsigned num_omp_threads (1);
@@ -27,6 +28,7 @@ int main(int argc, char *argv[])
 	// *** reading matrix in crs format from file
 	std::string fname(argv[1]);
 	MathLib::CRSMatrixDiagPrecond *mat (new MathLib::CRSMatrixDiagPrecond(fname));
+	mat->calcPrecond();
 
 	unsigned n (mat->getNRows());
 	bool verbose (true);
@@ -64,7 +66,12 @@ int main(int argc, char *argv[])
 	run_timer.start();
 	cpu_timer.start();
 
-	if (num_omp_threads == 1) {
+	if (pipelined) {
+		#ifdef _OPENMP
+		omp_set_num_threads(num_omp_threads);
+		#endif
+		MathLib::CGPipelined(mat, b, x, eps, steps);
+	} else if (num_omp_threads == 1) {
 		MathLib::CG(mat, b, x, eps, steps);
 	} else {
 		#ifdef _OPENMP
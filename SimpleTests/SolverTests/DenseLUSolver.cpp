@@ -0,0 +1,103 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "LinAlg/Dense/Matrix.h"
+#include "LinAlg/Solvers/GaussAlgorithm.h"
+#include "RunTimeTimer.h"
+
+/**
+ * unblocked Gauss elimination with partial pivoting (the algorithm
+ * GaussAlgorithm used before the blocked version), used as reference
+ */
+static void unblockedLU(MathLib::Matrix<double> &mat, size_t *perm)
+{
+	const size_t n (mat.getNRows());
+	for (size_t k=0; k<n; k++) {
+		double t = fabs(mat(k,k));
+		perm[k] = k;
+		for (size_t i=k+1; i<n; i++) {
+			if (fabs(mat(i,k)) > t) {
+				t = fabs(mat(i,k));
+				perm[k] = i;
+			}
+		}
+		if (perm[k] != k)
+			for (size_t j=0; j<n; j++)
+				std::swap(mat(perm[k],j), mat(k,j));
+		for (size_t i=k+1; i<n; i++) {
+			const double l (mat(i,k) / mat(k,k));
+			mat(i,k) = l;
+			for (size_t j=k+1; j<n; j++)
+				mat(i,j) -= l * mat(k,j);
+		}
+	}
+}
+
+/**
+ * The test factorizes a random n x n matrix with the unblocked reference
+ * elimination and with GaussAlgorithm and solves for n_rhs right hand sides
+ * with known solutions.
+ */
+int main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		std::cout << "Usage: " << argv[0] << " n [n_rhs]" << std::endl;
+		return 1;
+	}
+
+	const size_t n (atoi(argv[1]));
+	const size_t n_rhs (argc > 2 ? atoi(argv[2]) : 1);
+
+	srand(42);
+	MathLib::Matrix<double> mat(n, n);
+	for (size_t i=0; i<n; i++)
+		for (size_t j=0; j<n; j++)
+			mat(i,j) = rand() / static_cast<double>(RAND_MAX) - 0.5;
+	MathLib::Matrix<double> mat_ref(mat);
+	MathLib::Matrix<double> mat_copy(mat);
+
+	RunTimeTimer timer;
+	size_t *perm (new size_t[n]);
+	timer.start();
+	unblockedLU(mat_ref, perm);
+	timer.stop();
+	const double t_ref (timer.elapsed());
+	std::cout << "unblocked LU: " << t_ref << " s" << std::endl;
+	delete [] perm;
+
+	timer.start();
+	MathLib::GaussAlgorithm gauss(mat);
+	timer.stop();
+	std::cout << "blocked LU: " << timer.elapsed() << " s, speedup " << t_ref / timer.elapsed() << std::endl;
+
+	// right hand sides b_q = A x_q
+	double *x (new double[n*n_rhs]);
+	double *b (new double[n*n_rhs]);
+	for (size_t q=0; q<n_rhs; q++) {
+		for (size_t i=0; i<n; i++)
+			x[q*n+i] = 1.0 + ((i+q) % 7);
+		for (size_t i=0; i<n; i++) {
+			double s (0.0);
+			for (size_t j=0; j<n; j++)
+				s += mat_copy(i,j) * x[q*n+j];
+			b[q*n+i] = s;
+		}
+	}
+
+	timer.start();
+	gauss.execute(b, n_rhs);
+	timer.stop();
+	double err(0.0), x_max(0.0);
+	for (size_t k=0; k<n*n_rhs; k++) {
+		err = std::max(err, fabs(x[k] - b[k]));
+		x_max = std::max(x_max, fabs(x[k]));
+	}
+	std::cout << "solve " << n_rhs << " right hand sides: " << timer.elapsed()
+			<< " s, relative error " << err / x_max << std::endl;
+
+	delete [] x;
+	delete [] b;
+
+	return err / x_max < 1e-6 ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "LinAlg/Dense/Matrix.h"
+#include "LinAlg/Solvers/blas.h"
+#include "RunTimeTimer.h"
+
+static double maxDiff(size_t n, double const*const a, double const*const b)
+{
+	double diff(0.0);
+	for (size_t k(0); k < n; k++)
+		diff = std::max(diff, fabs(a[k] - b[k]));
+	return diff;
+}
+
+/**
+ * The benchmark compares the blocked matrix matrix and matrix vector
+ * multiplication of class Matrix with the (triple loop) implementation used
+ * before and with the dgemm / dgemv of the linked BLAS library. The matrices
+ * of class Matrix are stored row by row, BLAS works on the transposed
+ * (column major) matrices.
+ */
+int main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		std::cout << "Usage: " << argv[0] << " n [n_mults]" << std::endl;
+		return 1;
+	}
+
+	const size_t n (atoi(argv[1]));
+	const unsigned n_mults (argc > 2 ? atoi(argv[2]) : 10);
+	const unsigned n_blas (n);
+
+	srand(42);
+	MathLib::Matrix<double> A(n, n), B(n, n), C(n, n), C_ref(n, n);
+	for (size_t i(0); i < n; i++) {
+		for (size_t j(0); j < n; j++) {
+			A(i,j) = rand() / static_cast<double>(RAND_MAX) - 0.5;
+			B(i,j) = rand() / static_cast<double>(RAND_MAX) - 0.5;
+		}
+	}
+	const double gemm_flops (2.0 * n * n * n);
+	RunTimeTimer timer;
+
+	// *** matrix matrix multiplication
+	if (n <= 2000) {
+		timer.start();
+		for (size_t i(0); i < n; i++) {
+			for (size_t j(0); j < n; j++) {
+				double s (0.0);
+				for (size_t k(0); k < n; k++)
+					s += A(i,k) * B(k,j);
+				C_ref(i,j) = s;
+			}
+		}
+		timer.stop();
+		std::cout << "gemm triple loop: " << timer.elapsed() << " s, "
+				<< gemm_flops / timer.elapsed() * 1e-9 << " GFlop/s" << std::endl;
+	}
+
+	timer.start();
+	A.mult(B, C);
+	timer.stop();
+	std::cout << "gemm Matrix::mult: " << timer.elapsed() << " s, "
+			<< gemm_flops / timer.elapsed() * 1e-9 << " GFlop/s" << std::endl;
+
+	const double one (1.0), zero (0.0);
+	timer.start();
+	// C^T = B^T A^T in column major storage
+	dgemm_("N", "N", &n_blas, &n_blas, &n_blas, &one, B.getData(), &n_blas,
+			A.getData(), &n_blas, &zero, C_ref.getData(), &n_blas);
+	timer.stop();
+	std::cout << "gemm BLAS: " << timer.elapsed() << " s, "
+			<< gemm_flops / timer.elapsed() * 1e-9 << " GFlop/s" << std::endl;
+	const double gemm_diff (maxDiff(n*n, C.getData(), C_ref.getData()));
+	std::cout << "gemm max difference: " << gemm_diff << std::endl;
+
+	// *** matrix vector multiplication
+	double *x (new double[n]);
+	double *y (new double[n]);
+	double *y_ref (new double[n]);
+	for (size_t k(0); k < n; k++)
+		x[k] = 1.0 + (k % 5);
+	const double gemv_flops (2.0 * n * n * n_mults);
+
+	timer.start();
+	for (unsigned m(0); m < n_mults; m++)
+		A.mult(x, y);
+	timer.stop();
+	std::cout << "gemv Matrix::mult: " << timer.elapsed() << " s, "
+			<< gemv_flops / timer.elapsed() * 1e-9 << " GFlop/s" << std::endl;
+
+	const unsigned inc (1);
+	timer.start();
+	for (unsigned m(0); m < n_mults; m++)
+		dgemv_("T", &n_blas, &n_blas, &one, A.getData(), &n_blas, x, &inc, &zero, y_ref, &inc);
+	timer.stop();
+	std::cout << "gemv BLAS: " << timer.elapsed() << " s, "
+			<< gemv_flops / timer.elapsed() * 1e-9 << " GFlop/s" << std::endl;
+	const double gemv_diff (maxDiff(n, y, y_ref));
+	std::cout << "gemv max difference: " << gemv_diff << std::endl;
+
+	// y = 2 A x - y_ref has to be y_ref
+	A.axpy(2.0, x, -1.0, y_ref);
+	const double axpy_diff (maxDiff(n, y, y_ref));
+	std::cout << "axpy max difference: " << axpy_diff << std::endl;
+
+	delete [] x;
+	delete [] y;
+	delete [] y_ref;
+
+	return (gemm_diff < 1e-8 && gemv_diff < 1e-8 && axpy_diff < 1e-8) ? 0 : 1;
+}
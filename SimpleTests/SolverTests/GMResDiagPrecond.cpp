@@ -16,14 +16,19 @@
 
 int main(int argc, char *argv[])
 {
-	if (argc != 3) {
-		std::cout << "Usage: " << argv[0] << " matrix rhs" << std::endl;
+	if (argc < 3) {
+		std::cout << "Usage: " << argv[0] << " matrix rhs [restart] [mgs|cgs2]" << std::endl;
 		return -1;
 	}
+	const unsigned restart(argc > 3 ? atoi(argv[3]) : 30);
+	MathLib::GMResOrthogonalization orth(MathLib::GMRES_MGS);
+	if (argc > 4 && std::string(argv[4]) == "cgs2")
+		orth = MathLib::GMRES_CGS2;
 
 	// *** reading matrix in crs format from file
 	std::string fname(argv[1]);
 	MathLib::CRSMatrixDiagPrecond *mat(new MathLib::CRSMatrixDiagPrecond(fname));
+	mat->calcPrecond();
 
 	unsigned n(mat->getNRows());
 	bool verbose(true);
@@ -51,8 +56,9 @@ int main(int argc, char *argv[])
 	}
 
 	if (verbose)
-		std::cout << "solving system with GMRes method (diagonal preconditioner) ... "
-			<< std::flush;
+		std::cout << "solving system with GMRes(" << restart << ") method ("
+			<< (orth == MathLib::GMRES_CGS2 ? "CGS2" : "MGS")
+			<< ", diagonal preconditioner) ... " << std::flush;
 
 	double eps(1.0e-6);
 	unsigned steps(4000);
@@ -61,7 +67,7 @@ int main(int argc, char *argv[])
 	run_timer.start();
 	cpu_timer.start();
 
-	MathLib::GMRes((*mat), b, x, eps, 30, steps);
+	MathLib::GMRes((*mat), b, x, eps, restart, steps, orth);
 
 	cpu_timer.stop();
 	run_timer.stop();
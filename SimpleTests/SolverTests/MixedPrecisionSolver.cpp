@@ -0,0 +1,126 @@
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "LinAlg/Solvers/CG.h"
+#include "LinAlg/Solvers/BiCGStab.h"
+#include "LinAlg/Sparse/CRSMatrixDiagPrecond.h"
+#include "LinAlg/Sparse/CRSSymMatrix.h"
+#include "sparse.h"
+#include "vector_io.h"
+#include "RunTimeTimer.h"
+#include "CPUTimeTimer.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * relative residual |b - A x| / |b| computed in double precision
+ */
+double relResidual(MathLib::CRSMatrix<double, unsigned> const& mat, double const* b, double const* x)
+{
+	const unsigned n(mat.getNRows());
+	double *r(new double[n]);
+	mat.amux(1.0, x, r);
+	double rr(0.0), bb(0.0);
+	for (unsigned k(0); k < n; k++) {
+		rr += (b[k] - r[k]) * (b[k] - r[k]);
+		bb += b[k] * b[k];
+	}
+	delete [] r;
+	return sqrt(rr / bb);
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 4) {
+		std::cout << "Usage: " << argv[0] << " matrix rhs number-of-threads [cg|bicgstab]" << std::endl;
+		return -1;
+	}
+
+	// read number of threads
+	unsigned num_omp_threads (1);
+	num_omp_threads = atoi (argv[3]);
+#ifdef _OPENMP
+	omp_set_num_threads(num_omp_threads);
+#endif
+	const bool use_cg(argc < 5 || strcmp(argv[4], "bicgstab") != 0);
+
+	// *** reading matrix in crs format from file
+	std::string fname(argv[1]);
+	MathLib::CRSMatrixDiagPrecond *mat (new MathLib::CRSMatrixDiagPrecond(fname));
+	mat->calcPrecond();
+
+	unsigned n (mat->getNRows());
+	std::cout << "Parameters read: n=" << n << std::endl;
+
+	double *x(new double[n]);
+	double *b(new double[n]);
+
+	// *** read rhs
+	fname = argv[2];
+	std::ifstream in(fname.c_str());
+	if (in) {
+		read (in, n, b);
+		in.close();
+	} else {
+		std::cout << "problem reading rhs - initializing b with 1.0" << std::endl;
+		for (size_t k(0); k<n; k++) {
+			b[k] = 1.0;
+		}
+	}
+
+	RunTimeTimer run_timer;
+	const char* name(use_cg ? "CG" : "BiCGStab");
+
+	for (unsigned mixed(0); mixed < 2; mixed++) {
+		for (size_t k(0); k<n; k++) {
+			x[k] = 0.0;
+		}
+		double eps (1.0e-10);
+		unsigned steps (4000);
+
+		std::cout << (mixed ? "mixed precision " : "double precision ") << name
+				<< " (diagonal preconditioner) ... " << std::flush;
+		run_timer.start();
+		if (use_cg) {
+			if (mixed)
+				MathLib::CGMixedPrecision(mat, b, x, eps, steps);
+			else
+				MathLib::CG(mat, b, x, eps, steps);
+		} else {
+			if (mixed)
+				MathLib::BiCGStabMixedPrecision(*mat, b, x, eps, steps);
+			else
+				MathLib::BiCGStab(*mat, b, x, eps, steps);
+		}
+		run_timer.stop();
+
+		std::cout << steps << " iterations, " << run_timer.elapsed() << " s, |b-Ax|/|b| = "
+				<< relResidual(*mat, b, x) << std::endl;
+	}
+
+	if (use_cg) {
+		// the matrix stores only the upper triangular part
+		MathLib::CRSSymMatrix<double, unsigned> sym_mat(argv[1]);
+		for (size_t k(0); k<n; k++) {
+			x[k] = 0.0;
+		}
+		double eps (1.0e-10);
+		unsigned steps (4000);
+		std::cout << "mixed precision CG (symmetric storage) ... " << std::flush;
+		run_timer.start();
+		MathLib::CGMixedPrecision(&sym_mat, b, x, eps, steps);
+		run_timer.stop();
+		std::cout << steps << " iterations, " << run_timer.elapsed() << " s, |b-Ax|/|b| = "
+				<< relResidual(*mat, b, x) << std::endl;
+	}
+
+	delete mat;
+	delete [] x;
+	delete [] b;
+
+	return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * SolverTelemetry.cpp
+ *
+ *  Created on: Feb 24, 2012
+ *      Author: TF
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include "LinAlg/Solvers/CG.h"
+#include "LinAlg/Solvers/BiCGStab.h"
+#include "LinAlg/Solvers/GMRes.h"
+#include "LinAlg/Solvers/CGTemplate.h"
+#include "LinAlg/Solvers/BiCGStabTemplate.h"
+#include "LinAlg/Solvers/GMResTemplate.h"
+#include "LinAlg/Solvers/BlockKrylovTemplate.h"
+#include "LinAlg/Solvers/SolverWorkspace.h"
+#include "LinAlg/Solvers/SolverObserver.h"
+#include "LinAlg/Sparse/CRSMatrixDiagPrecond.h"
+#include "RunTimeTimer.h"
+
+/**
+ * The test solves a system with known solution using the Jacobi
+ * preconditioned CG, CGPipelined, BiCGStab and GMRes methods, the solver
+ * templates and the block solvers (one right hand side) and prints the distribution of
+ * the processor cycles to the phases of the iterations, see
+ * MathLib::SolverObserver. With the argument "log" every iteration is written
+ * to std::cout.
+ */
+int main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		std::cout << "Usage: " << argv[0] << " matrix [log]" << std::endl;
+		return -1;
+	}
+	const bool log(argc > 2 && std::string(argv[2]) == "log");
+
+	MathLib::CRSMatrixDiagPrecond mat(argv[1]);
+	mat.calcPrecond();
+	const unsigned n(mat.getNRows());
+	std::cout << "Parameters read: n=" << n << std::endl;
+
+	double *x(new double[n]);
+	double *b(new double[n]);
+	for (unsigned k(0); k < n; k++)
+		x[k] = 1.0 + (k % 7) * 0.1;
+	mat.amux(1.0, x, b);
+
+	const unsigned n_methods(9);
+	const char* names[n_methods] = { "CG", "CGPipelined", "BiCGStab", "GMRes(30)",
+		"CG template", "BiCGStab template", "GMRes(30) template", "BlockCG", "BlockBiCGStab" };
+	MathLib::SolverWorkspace<double> work;
+	RunTimeTimer timer;
+	for (unsigned method(0); method < n_methods; method++) {
+		MathLib::SolverStatistics stats(true, log ? &std::cout : NULL);
+		for (unsigned k(0); k < n; k++)
+			x[k] = 0.0;
+		double eps(1.0e-8);
+		unsigned steps(4000);
+
+		timer.start();
+		switch (method) {
+		case 0:
+			MathLib::CG(&mat, b, x, eps, steps, &stats);
+			break;
+		case 1:
+			MathLib::CGPipelined(&mat, b, x, eps, steps, &stats);
+			break;
+		case 2:
+			MathLib::BiCGStab(mat, b, x, eps, steps, &stats);
+			break;
+		case 3:
+			MathLib::GMRes(mat, b, x, eps, 30, steps, MathLib::GMRES_MGS, &stats);
+			break;
+		case 4:
+			MathLib::CG(mat, b, x, eps, steps, work, &stats);
+			break;
+		case 5:
+			MathLib::BiCGStab(mat, b, x, eps, steps, work, &stats);
+			break;
+		case 6:
+			MathLib::GMRes(mat, b, x, eps, 30, steps, work, &stats);
+			break;
+		case 7:
+			MathLib::BlockCG(mat, mat, 1, b, x, eps, steps, work, &stats);
+			break;
+		default:
+			MathLib::BlockBiCGStab(mat, mat, 1, b, x, eps, steps, work, &stats);
+		}
+		timer.stop();
+
+		std::cout << names[method] << ": returned " << stats.getReturnValue() << " after "
+				<< stats.getNSteps() << " iterations, residual " << stats.getResidual()
+				<< ", " << timer.elapsed() << " s" << std::endl;
+		stats.printTiming(std::cout);
+	}
+
+	delete [] x;
+	delete [] b;
+
+	return 0;
+}
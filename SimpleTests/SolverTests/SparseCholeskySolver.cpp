@@ -0,0 +1,94 @@
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "LinAlg/Solvers/SparseCholesky.h"
+#include "LinAlg/Sparse/NestedDissectionPermutation/Cluster.h"
+#include "LinAlg/Sparse/amuxCRS.h"
+#include "sparse.h"
+#include "RunTimeTimer.h"
+
+/**
+ * The test computes a nested dissection ordering of the (symmetric positive
+ * definite) matrix read from file, factorizes the matrix with the supernodal
+ * sparse Cholesky factorization and solves a system with known solution.
+ * The numeric factorization is executed twice in order to show the costs of
+ * a refactorization with the same sparsity pattern.
+ */
+int main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		std::cout << "Usage: " << argv[0] << " matrix [min-cluster-size]" << std::endl;
+		return 1;
+	}
+
+	std::string fname_mat(argv[1]);
+	const unsigned bmin(argc > 2 ? atoi(argv[2]) : 64);
+
+	// *** reading matrix in crs format from file
+	std::ifstream in(fname_mat.c_str(), std::ios::in | std::ios::binary);
+	double *A(NULL);
+	unsigned *iA(NULL), *jA(NULL), n;
+	if (!in) {
+		std::cout << "error reading matrix from " << fname_mat << std::endl;
+		return 1;
+	}
+	CS_read(in, n, iA, jA, A);
+	in.close();
+	std::cout << "Parameters read: n=" << n << ", nnz=" << iA[n] << std::endl;
+
+	RunTimeTimer timer;
+	timer.start();
+	MathLib::Cluster cluster_tree(n, iA, jA);
+	unsigned *op_perm(new unsigned[n]);
+	unsigned *po_perm(new unsigned[n]);
+	for (unsigned k(0); k < n; k++)
+		op_perm[k] = po_perm[k] = k;
+	cluster_tree.createClusterTree(op_perm, po_perm, bmin);
+	timer.stop();
+	std::cout << "nested dissection ordering: " << timer.elapsed() << " s" << std::endl;
+
+	timer.start();
+	MathLib::SparseCholesky cholesky(n, iA, jA, op_perm, po_perm);
+	timer.stop();
+	std::cout << "symbolic factorization: " << timer.elapsed() << " s, " << cholesky.getNSupernodes()
+			<< " supernodes, nnz(L)=" << cholesky.getNNZ() << std::endl;
+
+	for (unsigned k(0); k < 2; k++) {
+		timer.start();
+		const bool ok(cholesky.factorize(A));
+		timer.stop();
+		std::cout << "numeric factorization: " << timer.elapsed() << " s" << std::endl;
+		if (!ok) {
+			std::cout << "matrix is not positive definite" << std::endl;
+			return 1;
+		}
+	}
+
+	double *x(new double[n]);
+	double *b(new double[n]);
+	for (unsigned k(0); k < n; k++)
+		x[k] = 1.0 + (k % 5);
+	MathLib::amuxCRS(1.0, n, iA, jA, A, x, b);
+
+	timer.start();
+	cholesky.execute(b);
+	timer.stop();
+	double err(0.0), x_max(0.0);
+	for (unsigned k(0); k < n; k++) {
+		err = std::max(err, fabs(x[k] - b[k]));
+		x_max = std::max(x_max, fabs(x[k]));
+	}
+	std::cout << "solve: " << timer.elapsed() << " s, relative error " << err / x_max << std::endl;
+
+	delete [] x;
+	delete [] b;
+	delete [] op_perm;
+	delete [] po_perm;
+	delete [] iA;
+	delete [] jA;
+	delete [] A;
+
+	return err / x_max < 1e-8 ? 0 : 1;
+}
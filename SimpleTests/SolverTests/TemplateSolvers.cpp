@@ -0,0 +1,133 @@
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include "LinAlg/Solvers/CG.h"
+#include "LinAlg/Solvers/BiCGStab.h"
+#include "LinAlg/Solvers/GMRes.h"
+#include "LinAlg/Solvers/CGTemplate.h"
+#include "LinAlg/Solvers/BiCGStabTemplate.h"
+#include "LinAlg/Solvers/GMResTemplate.h"
+#include "LinAlg/Solvers/SolverWorkspace.h"
+#include "LinAlg/Sparse/CRSMatrixDiagPrecond.h"
+#include "LinAlg/Sparse/CRSOperator.h"
+#include "sparse.h"
+#include "vector_io.h"
+#include "RunTimeTimer.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * relative residual |b - A x| / |b|
+ */
+double relResidual(MathLib::CRSMatrix<double, unsigned> const& mat, double const* b, double const* x)
+{
+	const unsigned n(mat.getNRows());
+	double *r(new double[n]);
+	mat.amux(1.0, x, r);
+	double rr(0.0), bb(0.0);
+	for (unsigned k(0); k < n; k++) {
+		rr += (b[k] - r[k]) * (b[k] - r[k]);
+		bb += b[k] * b[k];
+	}
+	delete [] r;
+	return sqrt(rr / bb);
+}
+
+void report(const char* name, unsigned n_solves, unsigned steps, double time,
+				MathLib::CRSMatrix<double, unsigned> const& mat, double const* b, double const* x)
+{
+	std::cout << name << ": " << n_solves << " solves, " << steps << " iterations (last solve), "
+			<< time << " s, |b-Ax|/|b| = " << relResidual(mat, b, x) << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 4) {
+		std::cout << "Usage: " << argv[0] << " matrix rhs number-of-threads [number-of-solves]" << std::endl;
+		std::cout << "\tcompares the solvers for CRSMatrix with the templated solvers using a persistent workspace" << std::endl;
+		return -1;
+	}
+
+	// read number of threads
+	unsigned num_omp_threads (1);
+	num_omp_threads = atoi (argv[3]);
+#ifdef _OPENMP
+	omp_set_num_threads(num_omp_threads);
+#endif
+	const unsigned n_solves(argc > 4 ? atoi(argv[4]) : 5);
+
+	// *** reading matrix in crs format from file
+	std::string fname(argv[1]);
+	MathLib::CRSMatrixDiagPrecond *mat (new MathLib::CRSMatrixDiagPrecond(fname));
+	mat->calcPrecond();
+	// non-virtual view of the matrix, the diagonal preconditioner is applied by mat
+	MathLib::CRSOperator<double, unsigned> op(*mat);
+
+	unsigned n (mat->getNRows());
+	std::cout << "Parameters read: n=" << n << std::endl;
+
+	double *x(new double[n]);
+	double *b(new double[n]);
+
+	// *** read rhs
+	fname = argv[2];
+	std::ifstream in(fname.c_str());
+	if (in) {
+		read (in, n, b);
+		in.close();
+	} else {
+		std::cout << "problem reading rhs - initializing b with 1.0" << std::endl;
+		for (size_t k(0); k<n; k++) {
+			b[k] = 1.0;
+		}
+	}
+
+	RunTimeTimer run_timer;
+	MathLib::SolverWorkspace<double> work;
+	const unsigned max_steps(4000), m(30);
+	unsigned steps(0);
+
+	for (unsigned method(0); method < 3; method++) {
+		for (unsigned templated(0); templated < 2; templated++) {
+			run_timer.start();
+			for (unsigned s(0); s < n_solves; s++) {
+				for (size_t k(0); k<n; k++) {
+					x[k] = 0.0;
+				}
+				double eps (1.0e-8);
+				steps = max_steps;
+				if (method == 0) {
+					if (templated)
+						MathLib::CG(op, *mat, b, x, eps, steps, work);
+					else
+						MathLib::CG(mat, b, x, eps, steps);
+				} else if (method == 1) {
+					if (templated)
+						MathLib::BiCGStab(op, *mat, b, x, eps, steps, work);
+					else
+						MathLib::BiCGStab(*mat, b, x, eps, steps);
+				} else {
+					if (templated)
+						MathLib::GMRes(op, *mat, b, x, eps, m, steps, work);
+					else
+						MathLib::GMRes(*mat, b, x, eps, m, steps);
+				}
+			}
+			run_timer.stop();
+
+			const char* names[3] = { "CG", "BiCGStab", "GMRes(30)" };
+			std::cout << (templated ? "templated " : "") << std::flush;
+			report(names[method], n_solves, steps, run_timer.elapsed(), *mat, b, x);
+		}
+	}
+	std::cout << "workspace size: " << work.getSize() << " entries" << std::endl;
+
+	delete mat;
+	delete [] x;
+	delete [] b;
+
+	return 0;
+}
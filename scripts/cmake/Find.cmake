@@ -24,4 +24,15 @@ IF(OPENMP_FOUND)
 ENDIF()
 
 FIND_PACKAGE(Metis)
+IF(METIS_FOUND)
+	ADD_DEFINITIONS(-DHAVE_METIS)
+ENDIF()
+
+## pthread ##
+SET ( CMAKE_THREAD_PREFER_PTHREAD On )
+FIND_PACKAGE( Threads )
+IF ( CMAKE_USE_PTHREADS_INIT )
+	SET (HAVE_PTHREADS TRUE)
+	ADD_DEFINITIONS(-DHAVE_PTHREADS)
+ENDIF (CMAKE_USE_PTHREADS_INIT )
 